@@ -0,0 +1,73 @@
+#include "Benchmark.h"
+#include "utils/AsyncQueue.h"
+
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using dorado::utils::AsyncQueue;
+using dorado::utils::AsyncQueueBackend;
+using dorado::utils::AsyncQueueStatus;
+
+constexpr size_t kItemsPerProducer = 200000;
+constexpr size_t kQueueCapacity = 1000;
+
+// Pipeline messages are owning pointers, so use the same shape of item here.
+using Item = std::unique_ptr<size_t>;
+
+size_t run_queue(AsyncQueueBackend backend, int num_producers, int num_consumers) {
+    AsyncQueue<Item> queue(kQueueCapacity, backend);
+
+    std::vector<std::thread> consumers;
+    for (int i = 0; i < num_consumers; ++i) {
+        consumers.emplace_back([&queue] {
+            Item item;
+            while (queue.try_pop(item) == AsyncQueueStatus::Success) {
+            }
+        });
+    }
+
+    std::vector<std::thread> producers;
+    for (int i = 0; i < num_producers; ++i) {
+        producers.emplace_back([&queue] {
+            for (size_t j = 0; j < kItemsPerProducer; ++j) {
+                queue.try_push(std::make_unique<size_t>(j));
+            }
+        });
+    }
+
+    for (auto& producer : producers) {
+        producer.join();
+    }
+    queue.terminate();
+    for (auto& consumer : consumers) {
+        consumer.join();
+    }
+    return num_producers * kItemsPerProducer;
+}
+
+void register_async_queue_benchmarks() {
+    const std::pair<AsyncQueueBackend, std::string> backends[] = {
+            {AsyncQueueBackend::Mutex, "Mutex"},
+            {AsyncQueueBackend::LockFree, "LockFree"},
+    };
+    const std::pair<int, int> thread_counts[] = {{1, 1}, {1, 4}, {4, 1}, {4, 4}, {16, 16}};
+
+    for (const auto& [backend, backend_name] : backends) {
+        for (const auto& [producers, consumers] : thread_counts) {
+            dorado::benchmarks::add_benchmark(
+                    "AsyncQueue/" + backend_name + "/p" + std::to_string(producers) + "_c" +
+                            std::to_string(consumers),
+                    [backend = backend, producers = producers, consumers = consumers] {
+                        return run_queue(backend, producers, consumers);
+                    });
+        }
+    }
+}
+
+}  // namespace
+
+DORADO_REGISTER_BENCHMARKS(register_async_queue_benchmarks);
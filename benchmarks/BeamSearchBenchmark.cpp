@@ -0,0 +1,58 @@
+#include "Benchmark.h"
+#include "basecall/decode/beam_search.h"
+#include "basecall/decode/forward_backward.h"
+
+#include <torch/torch.h>
+
+#include <string>
+
+namespace {
+
+// One chunk of a typical state_len 5 model.
+constexpr int kNumBlocks = 1000;
+constexpr int kStateLen = 5;
+constexpr float kStayScore = 2.0f;
+
+struct DecodeInputs {
+    at::Tensor scores;
+    at::Tensor back_guides;
+    at::Tensor posts;
+};
+
+// Back guides and posts come from the real forward/backward scan, so that the beam behaves
+// as it would on model output.
+const DecodeInputs& get_inputs() {
+    return dorado::benchmarks::lazy_input([] {
+        at::InferenceMode inference_mode_guard;
+        namespace decode = dorado::basecall::decode;
+        const int C = 4 << (2 * kStateLen);
+        torch::manual_seed(42);
+        const auto scores = torch::randn({kNumBlocks, 1, C}, torch::kFloat) * 2.0f;
+        const auto fwd = decode::forward_scores(scores, kStayScore);
+        const auto bwd = decode::backward_scores(scores, kStayScore);
+        DecodeInputs inputs;
+        inputs.scores = scores.squeeze(1);
+        inputs.back_guides = bwd.squeeze(1).contiguous();
+        inputs.posts = at::softmax(fwd + bwd, -1).squeeze(1).contiguous();
+        return inputs;
+    });
+}
+
+size_t run_beam_search(size_t beam_width) {
+    const auto& inputs = get_inputs();
+    dorado::basecall::decode::beam_search_decode(inputs.scores, inputs.back_guides,
+                                                 inputs.posts, beam_width, 100.0f, kStayScore,
+                                                 0.0f, 1.0f, 1.0f);
+    return kNumBlocks;
+}
+
+void register_beam_search_benchmarks() {
+    for (size_t beam_width : {8, 32, 64, 256}) {
+        dorado::benchmarks::add_benchmark("BeamSearch/width" + std::to_string(beam_width),
+                                          [beam_width] { return run_beam_search(beam_width); });
+    }
+}
+
+}  // namespace
+
+DORADO_REGISTER_BENCHMARKS(register_beam_search_benchmarks);
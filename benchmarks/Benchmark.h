@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <functional>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace dorado::benchmarks {
+
+// Runs one repetition of a benchmark's workload and returns the number of items
+// processed, from which throughput is reported.
+using BenchmarkFn = std::function<size_t()>;
+
+struct Benchmark {
+    std::string name;
+    BenchmarkFn fn;
+};
+
+// All benchmarks linked into dorado_benchmarks, in registration order.
+std::vector<Benchmark>& registry();
+
+// Adds a benchmark to the registry.
+void add_benchmark(std::string name, BenchmarkFn fn);
+
+// Records a value measured by the running benchmark, such as memory used, to report alongside
+// its throughput.  The value set by the last repetition is reported.
+void set_counter(const std::string& name, double value);
+
+// Path of a file or directory in the source tree's tests/data, for benchmarks which need real
+// reads rather than synthetic ones.
+std::filesystem::path get_test_data_path(const std::string& sub_path);
+
+// Returns the value made by make_fn, which is only called the first time.  Each lambda passed in
+// has its own value.  Inputs are made this way rather than as globals since torch may not be ready
+// during static initialisation, and so that listing the benchmarks doesn't pay to make them.
+template <typename MakeFn>
+auto& lazy_input(MakeFn make_fn) {
+    static_assert(std::is_class_v<MakeFn>, "Functions of the same type would share a value");
+    static auto value = make_fn();
+    return value;
+}
+
+}  // namespace dorado::benchmarks
+
+// Calls register_fn during static initialisation.  register_fn should call add_benchmark
+// once per benchmark, which allows parameter sweeps to be registered in a loop.
+#define DORADO_REGISTER_BENCHMARKS(register_fn) \
+    [[maybe_unused]] static const bool register_fn##_registered = (register_fn(), true)
@@ -0,0 +1,281 @@
+#include "Benchmark.h"
+#include "demux/AdapterDetector.h"
+#include "demux/BarcodeClassifier.h"
+#include "demux/MultiPatternAligner.h"
+#include "read_pipeline/AdapterDetectorNode.h"
+#include "read_pipeline/BarcodeClassifierNode.h"
+#include "read_pipeline/ReadEndAnnotatorNode.h"
+#include "utils/barcode_kits.h"
+#include "utils/sequence_utils.h"
+
+#include <ATen/Functions.h>
+#include <edlib.h>
+
+#include <map>
+#include <memory>
+#include <optional>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr size_t kNumReads = 200;
+constexpr size_t kReadLen = 2000;
+
+std::string random_bases(std::mt19937& gen, size_t len) {
+    std::uniform_int_distribution<int> base(0, 3);
+    std::string seq(len, 'A');
+    for (auto& b : seq) {
+        b = "ACGT"[base(gen)];
+    }
+    return seq;
+}
+
+// Reads with the kit's flanks and one of its barcodes at the front (and for double ended kits,
+// the reverse complement of the bottom strand's at the rear), with a few bases of adapter
+// before them.
+std::vector<std::string> make_barcoded_reads(const std::string& kit_name) {
+    const auto& kit = dorado::barcode_kits::get_kit_infos().at(kit_name);
+    const auto& barcodes = dorado::barcode_kits::get_barcodes();
+    std::mt19937 gen(42);
+    std::uniform_int_distribution<size_t> barcode_idx(0, kit.barcodes.size() - 1);
+    std::vector<std::string> reads;
+    for (size_t i = 0; i < kNumReads; ++i) {
+        const size_t idx = barcode_idx(gen);
+        std::string read = random_bases(gen, 20) + kit.top_front_flank +
+                           barcodes.at(kit.barcodes[idx]) + kit.top_rear_flank +
+                           random_bases(gen, kReadLen);
+        if (kit.double_ends) {
+            const auto& rear_barcode = kit.ends_different ? kit.barcodes2[idx] : kit.barcodes[idx];
+            read += dorado::utils::reverse_complement(kit.bottom_front_flank +
+                                                      barcodes.at(rear_barcode) +
+                                                      kit.bottom_rear_flank) +
+                    random_bases(gen, 20);
+        }
+        reads.push_back(std::move(read));
+    }
+    return reads;
+}
+
+// Reads with an adapter and primer at the front and their reverse complements at the rear.
+std::vector<std::string> make_adapter_reads() {
+    dorado::demux::AdapterDetector detector;
+    const auto& adapter = detector.get_adapter_sequences().front();
+    const auto& primer = detector.get_primer_sequences().front();
+    std::mt19937 gen(42);
+    std::vector<std::string> reads;
+    for (size_t i = 0; i < kNumReads; ++i) {
+        reads.push_back(random_bases(gen, 6) + adapter.sequence + primer.sequence +
+                        random_bases(gen, kReadLen) + primer.sequence_rev + adapter.sequence_rev +
+                        random_bases(gen, 3));
+    }
+    return reads;
+}
+
+struct BarcodeInputs {
+    dorado::demux::BarcodeClassifier classifier;
+    std::vector<std::string> reads;
+};
+
+// Built on first use, since building a classifier for each kit during static initialisation
+// would slow down listing the benchmarks.
+const BarcodeInputs& get_barcode_inputs(const std::string& kit_name) {
+    static std::map<std::string, std::unique_ptr<BarcodeInputs>> inputs;
+    auto& kit_inputs = inputs[kit_name];
+    if (!kit_inputs) {
+        kit_inputs.reset(new BarcodeInputs{{{kit_name}, std::nullopt, std::nullopt},
+                                           make_barcoded_reads(kit_name)});
+    }
+    return *kit_inputs;
+}
+
+size_t run_barcode_classifier(const std::string& kit_name, bool barcode_both_ends) {
+    const auto& inputs = get_barcode_inputs(kit_name);
+    for (const auto& read : inputs.reads) {
+        inputs.classifier.barcode(read, barcode_both_ends, std::nullopt);
+    }
+    return inputs.reads.size();
+}
+
+// The barcodes of a kit, and windows of reads which contain one of them with a few errors.
+struct BarcodeWindows {
+    std::vector<std::string> barcodes;
+    std::vector<std::string> windows;
+};
+
+const BarcodeWindows& get_barcode_windows() {
+    static const BarcodeWindows inputs = [] {
+        const auto& kit = dorado::barcode_kits::get_kit_infos().at("SQK-NBD114-96");
+        BarcodeWindows result;
+        for (const auto& name : kit.barcodes) {
+            result.barcodes.push_back(dorado::barcode_kits::get_barcodes().at(name));
+        }
+        std::mt19937 gen(42);
+        for (size_t i = 0; i < kNumReads; ++i) {
+            auto window = result.barcodes[gen() % result.barcodes.size()];
+            for (int edit = 0; edit < 3; ++edit) {
+                window[gen() % window.size()] = "ACGT"[gen() % 4];
+            }
+            result.windows.push_back(std::move(window));
+        }
+        return result;
+    }();
+    return inputs;
+}
+
+// Scores every barcode against each window, as BarcodeClassifier does for each end of a read.
+size_t run_multi_pattern_aligner() {
+    const auto& inputs = get_barcode_windows();
+    static const dorado::demux::MultiPatternAligner aligner(inputs.barcodes);
+    for (const auto& window : inputs.windows) {
+        aligner.edit_distances(window);
+    }
+    return inputs.windows.size() * inputs.barcodes.size();
+}
+
+// The same with an edlib alignment per barcode, which BarcodeClassifier used to do.
+size_t run_edlib_per_barcode() {
+    const auto& inputs = get_barcode_windows();
+    EdlibAlignConfig config = edlibDefaultAlignConfig();
+    config.mode = EDLIB_MODE_NW;
+    config.task = EDLIB_TASK_LOC;
+    for (const auto& window : inputs.windows) {
+        for (const auto& barcode : inputs.barcodes) {
+            auto result = edlibAlign(barcode.data(), int(barcode.length()), window.data(),
+                                     int(window.length()), config);
+            edlibFreeAlignResult(result);
+        }
+    }
+    return inputs.windows.size() * inputs.barcodes.size();
+}
+
+size_t run_find_adapters() {
+    static const auto reads = make_adapter_reads();
+    static dorado::demux::AdapterDetector detector;
+    for (const auto& read : reads) {
+        detector.find_adapters(read);
+    }
+    return reads.size();
+}
+
+size_t run_find_primers() {
+    static const auto reads = make_adapter_reads();
+    static dorado::demux::AdapterDetector detector;
+    for (const auto& read : reads) {
+        detector.find_primers(read);
+    }
+    return reads.size();
+}
+
+// Drops everything it is sent.
+class DiscardSink : public dorado::MessageSink {
+public:
+    DiscardSink() : MessageSink(1000) { start_threads(); }
+    ~DiscardSink() override { stop_input_processing(); }
+    void terminate(const dorado::FlushOptions&) override { stop_input_processing(); }
+    void restart() override {
+        restart_input_queue();
+        start_threads();
+    }
+
+private:
+    void start_threads() {
+        start_input_processing([](std::vector<dorado::Message>& messages) { messages.clear(); },
+                               1);
+    }
+};
+
+// Basecalled reads with an adapter, primer and SQK-RBK114-96 barcode at the front, with the moves
+// and signal which trimming cuts down.
+std::vector<dorado::SimplexReadPtr> make_simplex_reads() {
+    constexpr int kStride = 6;
+    static const auto sequences = [] {
+        dorado::demux::AdapterDetector detector;
+        const auto& adapter = detector.get_adapter_sequences().front().sequence;
+        const auto& primer = detector.get_primer_sequences().front().sequence;
+        auto reads = make_barcoded_reads("SQK-RBK114-96");
+        for (auto& read : reads) {
+            read = adapter + primer + read;
+        }
+        return reads;
+    }();
+    std::vector<dorado::SimplexReadPtr> reads;
+    for (size_t i = 0; i < sequences.size(); ++i) {
+        auto read = std::make_unique<dorado::SimplexRead>();
+        read->read_common.seq = sequences[i];
+        read->read_common.qstring = std::string(sequences[i].length(), '5');
+        read->read_common.read_id = std::to_string(i);
+        read->read_common.model_stride = kStride;
+        for (size_t j = 0; j < sequences[i].length(); ++j) {
+            read->read_common.moves.insert(read->read_common.moves.end(), {1, 0});
+        }
+        read->read_common.raw_data = at::zeros(int64_t(read->read_common.moves.size()) * kStride);
+        read->read_common.num_trimmed_samples = 0;
+        reads.push_back(std::move(read));
+    }
+    return reads;
+}
+
+// The read end nodes of the basecaller's pipeline: an AdapterDetectorNode followed by a
+// BarcodeClassifierNode, or the ReadEndAnnotatorNode which replaces them, with the same number of
+// threads in total.  Built once, so the classifier is only set up once.
+dorado::Pipeline& get_read_end_pipeline(bool fused) {
+    constexpr int kThreads = 4;
+    static std::unique_ptr<dorado::Pipeline> pipelines[2];
+    auto& pipeline = pipelines[fused];
+    if (!pipeline) {
+        const std::vector<std::string> kits = {"SQK-RBK114-96"};
+        dorado::PipelineDescriptor pipeline_desc;
+        auto sink = pipeline_desc.add_node<DiscardSink>({});
+        if (fused) {
+            pipeline_desc.add_node<dorado::ReadEndAnnotatorNode>(
+                    {sink}, kThreads, true, true, kits, false, false, std::nullopt, std::nullopt,
+                    std::nullopt, 0);
+        } else {
+            auto barcoder = pipeline_desc.add_node<dorado::BarcodeClassifierNode>(
+                    {sink}, kThreads / 2, kits, false, false, std::nullopt, std::nullopt,
+                    std::nullopt, 0);
+            pipeline_desc.add_node<dorado::AdapterDetectorNode>({barcoder}, kThreads / 2, true,
+                                                                true);
+        }
+        pipeline = dorado::Pipeline::create(std::move(pipeline_desc), nullptr);
+    }
+    return *pipeline;
+}
+
+// Both include making the reads, since trimming consumes them.
+size_t run_read_end_nodes(bool fused) {
+    auto& pipeline = get_read_end_pipeline(fused);
+    for (auto& read : make_simplex_reads()) {
+        pipeline.push_message(std::move(read));
+    }
+    pipeline.terminate(dorado::DefaultFlushOptions());
+    pipeline.restart();
+    return kNumReads;
+}
+
+void register_demux_benchmarks() {
+    using dorado::benchmarks::add_benchmark;
+
+    add_benchmark("BarcodeClassifier/SQK-RBK114-96",
+                  [] { return run_barcode_classifier("SQK-RBK114-96", false); });
+    add_benchmark("BarcodeClassifier/SQK-NBD114-96",
+                  [] { return run_barcode_classifier("SQK-NBD114-96", false); });
+    add_benchmark("BarcodeClassifier/SQK-NBD114-96_both_ends",
+                  [] { return run_barcode_classifier("SQK-NBD114-96", true); });
+    add_benchmark("BarcodeClassifier/SQK-PCB114-24",
+                  [] { return run_barcode_classifier("SQK-PCB114-24", false); });
+    add_benchmark("BarcodeScoring/MultiPatternAligner_NB96",
+                  [] { return run_multi_pattern_aligner(); });
+    add_benchmark("BarcodeScoring/edlib_NB96", [] { return run_edlib_per_barcode(); });
+    add_benchmark("AdapterDetector/find_adapters", [] { return run_find_adapters(); });
+    add_benchmark("AdapterDetector/find_primers", [] { return run_find_primers(); });
+    add_benchmark("ReadEndNodes/AdapterDetectorNode_BarcodeClassifierNode",
+                  [] { return run_read_end_nodes(false); });
+    add_benchmark("ReadEndNodes/ReadEndAnnotatorNode", [] { return run_read_end_nodes(true); });
+}
+
+}  // namespace
+
+DORADO_REGISTER_BENCHMARKS(register_demux_benchmarks);
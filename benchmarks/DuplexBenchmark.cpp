@@ -0,0 +1,126 @@
+#include "Benchmark.h"
+#include "read_pipeline/ReadPipeline.h"
+#include "read_pipeline/StereoDuplexEncoderNode.h"
+#include "read_pipeline/stereo_features.h"
+#include "splitter/DuplexReadSplitter.h"
+#include "splitter/ReadSplitter.h"
+
+#include <torch/torch.h>
+
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+namespace {
+
+using dorado::benchmarks::get_test_data_path;
+
+std::string read_file(const std::string& sub_path) {
+    std::ifstream in(get_test_data_path(sub_path), std::ios::in | std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+std::vector<uint8_t> read_moves(const std::string& sub_path) {
+    const auto moves = read_file(sub_path);
+    return std::vector<uint8_t>(moves.begin(), moves.end());
+}
+
+at::Tensor read_signal(const std::string& sub_path) {
+    at::Tensor signal;
+    torch::load(signal, get_test_data_path(sub_path).string());
+    return signal.to(at::ScalarType::Half);
+}
+
+// The read in tests/data/split, which the splitter splits into 4 subreads.
+struct SplitInputs {
+    std::string seq;
+    std::string qstring;
+    std::vector<uint8_t> moves;
+    at::Tensor raw_data;
+};
+
+const SplitInputs& get_split_inputs() {
+    return dorado::benchmarks::lazy_input([] {
+        SplitInputs inputs;
+        inputs.seq = read_file("split/seq");
+        inputs.qstring = read_file("split/qstring");
+        inputs.moves = read_moves("split/moves");
+        inputs.raw_data = read_signal("split/raw.tensor");
+        return inputs;
+    });
+}
+
+dorado::SimplexReadPtr make_split_read() {
+    const auto& inputs = get_split_inputs();
+    auto read = dorado::make_simplex_read();
+    read->range = 0;
+    read->offset = -287;
+    read->scaling = 0.14620706f;
+    read->read_common.sample_rate = 4000;
+    read->read_common.shift = 94.717316f;
+    read->read_common.scale = 26.888939f;
+    read->read_common.model_stride = 5;
+    read->read_common.read_id = "00a2dd45-f6a9-49ba-86ee-5d2a37b861cb";
+    read->read_common.num_trimmed_samples = 10;
+    read->read_common.attributes.num_samples = 256790;
+    read->read_common.attributes.start_time = "2023-02-21T12:46:01.526+00:00";
+    read->start_sample = 29767426;
+    read->end_sample = 30024216;
+    read->run_acquisition_start_time_ms = 1676976119670;
+    read->read_common.seq = inputs.seq;
+    read->read_common.qstring = inputs.qstring;
+    read->read_common.moves = inputs.moves;
+    read->read_common.raw_data = inputs.raw_data;
+    return read;
+}
+
+size_t run_duplex_read_splitter() {
+    static const dorado::splitter::DuplexReadSplitter splitter(
+            dorado::splitter::DuplexSplitSettings(false));
+    const auto subreads = splitter.split(make_split_read());
+    dorado::benchmarks::set_counter("subreads", double(subreads.size()));
+    return 1;
+}
+
+dorado::ReadPair::ReadData make_stereo_read(const std::string& strand, uint64_t start_time_ms) {
+    dorado::ReadPair::ReadData read{};
+    read.read_common.seq = read_file("stereo/" + strand + "_seq");
+    read.read_common.qstring = read_file("stereo/" + strand + "_qstring");
+    read.read_common.moves = read_moves("stereo/" + strand + "_moves");
+    read.read_common.raw_data = read_signal("stereo/" + strand + "_raw_data.tensor");
+    read.read_common.start_time_ms = start_time_ms;
+    read.seq_start = 0;
+    read.seq_end = read.read_common.seq.length();
+    return read;
+}
+
+// The inputs to stereo features generation for the pair in tests/data/stereo.  Aligning the
+// pair is part of stereo_encode, so isn't timed.
+const dorado::DuplexRead::StereoFeatureInputs& get_stereo_inputs() {
+    return dorado::benchmarks::lazy_input([] {
+        dorado::ReadPair read_pair;
+        read_pair.template_read = make_stereo_read("template", 0);
+        read_pair.complement_read = make_stereo_read("complement", 100);
+        dorado::StereoDuplexEncoderNode stereo_node(5);
+        return stereo_node.stereo_encode(read_pair)->stereo_feature_inputs;
+    });
+}
+
+size_t run_generate_stereo_features() {
+    const auto& inputs = get_stereo_inputs();
+    dorado::generate_stereo_features(inputs);
+    return 1;
+}
+
+void register_duplex_benchmarks() {
+    using dorado::benchmarks::add_benchmark;
+
+    add_benchmark("DuplexReadSplitter/split", [] { return run_duplex_read_splitter(); });
+    add_benchmark("Stereo/generate_stereo_features",
+                  [] { return run_generate_stereo_features(); });
+}
+
+}  // namespace
+
+DORADO_REGISTER_BENCHMARKS(register_duplex_benchmarks);
@@ -0,0 +1,61 @@
+#include "Benchmark.h"
+#include "basecall/decode/forward_backward.h"
+
+#include <torch/torch.h>
+
+#include <map>
+#include <string>
+
+namespace {
+
+namespace decode = dorado::basecall::decode;
+
+// Roughly one batch of CPU decoding work for each thread in CPUDecoder.
+constexpr int kNumTimesteps = 1000;
+constexpr int kNumChunks = 16;
+constexpr float kStayScore = 2.0f;
+constexpr int kStateLens[] = {3, 5};
+
+const at::Tensor& get_scores(int state_len) {
+    const auto& scores_by_state_len = dorado::benchmarks::lazy_input([] {
+        std::map<int, at::Tensor> scores;
+        torch::manual_seed(42);
+        for (int n : kStateLens) {
+            const int C = 4 << (2 * n);
+            scores[n] = torch::randn({kNumTimesteps, kNumChunks, C}, torch::kFloat);
+        }
+        return scores;
+    });
+    return scores_by_state_len.at(state_len);
+}
+
+template <class ScanFn>
+size_t run_scan(int state_len, ScanFn scan_fn) {
+    at::InferenceMode inference_mode_guard;
+    const auto result = scan_fn(get_scores(state_len), kStayScore);
+    // Timesteps processed, summed over chunks.
+    return size_t(result.size(0) - 1) * result.size(1);
+}
+
+void register_forward_backward_benchmarks() {
+    for (int state_len : kStateLens) {
+        const std::string suffix = "/state_len" + std::to_string(state_len);
+
+        dorado::benchmarks::add_benchmark("ForwardBackward/ATen/forward" + suffix, [state_len] {
+            return run_scan(state_len, decode::forward_scores_aten);
+        });
+        dorado::benchmarks::add_benchmark("ForwardBackward/ATen/backward" + suffix, [state_len] {
+            return run_scan(state_len, decode::backward_scores_aten);
+        });
+        dorado::benchmarks::add_benchmark("ForwardBackward/Kernel/forward" + suffix, [state_len] {
+            return run_scan(state_len, decode::forward_scores);
+        });
+        dorado::benchmarks::add_benchmark("ForwardBackward/Kernel/backward" + suffix, [state_len] {
+            return run_scan(state_len, decode::backward_scores);
+        });
+    }
+}
+
+}  // namespace
+
+DORADO_REGISTER_BENCHMARKS(register_forward_backward_benchmarks);
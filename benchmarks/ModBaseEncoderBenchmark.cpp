@@ -0,0 +1,76 @@
+#include "Benchmark.h"
+#include "modbase/ModbaseEncoder.h"
+#include "modbase/MotifMatcher.h"
+#include "utils/sequence_utils.h"
+
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+using dorado::modbase::ModBaseEncoder;
+
+// A 10 kb read called by a stride 6 model, encoded as for a typical 5mCG model.
+constexpr size_t kSeqLen = 10000;
+constexpr size_t kStride = 6;
+constexpr size_t kContextSamples = 150;
+constexpr int kBasesBefore = 4;
+constexpr int kBasesAfter = 4;
+
+struct EncoderInputs {
+    ModBaseEncoder encoder{kStride, kContextSamples, kBasesBefore, kBasesAfter};
+    // Positions of the C in each CG, whose contexts a 5mCG model would call.
+    std::vector<size_t> positions;
+};
+
+const EncoderInputs& get_inputs() {
+    static const EncoderInputs inputs = [] {
+        std::mt19937 gen(42);
+        std::uniform_int_distribution<int> base(0, 3);
+        // Bases take between 1 and 4 blocks.
+        std::uniform_int_distribution<int> stay_blocks(0, 3);
+        std::string seq;
+        std::vector<uint8_t> moves;
+        for (size_t i = 0; i < kSeqLen; ++i) {
+            seq += "ACGT"[base(gen)];
+            moves.push_back(1);
+            moves.insert(moves.end(), stay_blocks(gen), 0);
+        }
+
+        EncoderInputs result;
+        const auto seq_to_sig_map = dorado::utils::moves_to_map(
+                moves, kStride, moves.size() * kStride, std::nullopt);
+        result.encoder.init(dorado::utils::sequence_to_ints(seq), seq_to_sig_map);
+        result.positions = dorado::modbase::MotifMatcher("CG", 0).get_motif_hits(seq);
+        return result;
+    }();
+    return inputs;
+}
+
+size_t run_get_context() {
+    const auto& inputs = get_inputs();
+    for (auto pos : inputs.positions) {
+        inputs.encoder.get_context(pos);
+    }
+    return inputs.positions.size();
+}
+
+size_t run_get_contexts() {
+    const auto& inputs = get_inputs();
+    std::vector<int8_t> encoded_data(inputs.positions.size() *
+                                     inputs.encoder.encoded_context_size());
+    inputs.encoder.get_contexts(inputs.positions, encoded_data.data());
+    return inputs.positions.size();
+}
+
+void register_modbase_encoder_benchmarks() {
+    using dorado::benchmarks::add_benchmark;
+
+    add_benchmark("ModBaseEncoder/get_context", [] { return run_get_context(); });
+    add_benchmark("ModBaseEncoder/get_contexts", [] { return run_get_contexts(); });
+}
+
+}  // namespace
+
+DORADO_REGISTER_BENCHMARKS(register_modbase_encoder_benchmarks);
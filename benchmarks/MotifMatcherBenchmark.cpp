@@ -0,0 +1,69 @@
+#include "Benchmark.h"
+#include "modbase/MotifMatcher.h"
+
+#include <random>
+#include <regex>
+#include <string>
+#include <vector>
+
+namespace {
+
+using dorado::modbase::MotifMatcher;
+
+// An ultra-long read's worth of bases.
+constexpr size_t kSeqLen = 1000000;
+
+const std::string& get_sequence() {
+    static const std::string seq = [] {
+        std::mt19937 gen(42);
+        std::uniform_int_distribution<int> dist(0, 3);
+        std::string s(kSeqLen, 'A');
+        for (auto& base : s) {
+            base = "ACGT"[dist(gen)];
+        }
+        return s;
+    }();
+    return seq;
+}
+
+size_t run_motif_matcher(const MotifMatcher& matcher) {
+    const auto& seq = get_sequence();
+    matcher.get_motif_hits(seq);
+    return seq.size();
+}
+
+// The std::regex search which MotifMatcher used to do, for comparison.
+size_t run_regex(const std::string& motif_regex) {
+    const auto& seq = get_sequence();
+    std::regex regex(motif_regex);
+    std::vector<size_t> hits;
+    auto pos = seq.cbegin();
+    std::smatch motif_match;
+    while (std::regex_search(pos, seq.cend(), motif_match, regex)) {
+        hits.push_back(std::distance(seq.cbegin(), pos) + motif_match.position(0));
+        pos += motif_match.position(0) + 1;
+    }
+    return seq.size();
+}
+
+void register_motif_matcher_benchmarks() {
+    using dorado::benchmarks::add_benchmark;
+    using Motif = MotifMatcher::Motif;
+
+    add_benchmark("MotifMatcher/CG", [matcher = MotifMatcher("CG", 0)] {
+        return run_motif_matcher(matcher);
+    });
+    add_benchmark("MotifMatcher/DRACH", [matcher = MotifMatcher("DRACH", 2)] {
+        return run_motif_matcher(matcher);
+    });
+    add_benchmark("MotifMatcher/CG+DRACH+GATC",
+                  [matcher = MotifMatcher({Motif{"CG", 0}, Motif{"DRACH", 2}, Motif{"GATC", 1}})] {
+                      return run_motif_matcher(matcher);
+                  });
+    add_benchmark("MotifMatcher/regex_CG", [] { return run_regex("(CG)"); });
+    add_benchmark("MotifMatcher/regex_DRACH", [] { return run_regex("([AGT][AG]AC[ACT])"); });
+}
+
+}  // namespace
+
+DORADO_REGISTER_BENCHMARKS(register_motif_matcher_benchmarks);
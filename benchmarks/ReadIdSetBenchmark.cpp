@@ -0,0 +1,190 @@
+#include "Benchmark.h"
+#include "utils/ReadIdSet.h"
+
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <random>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+namespace {
+
+using dorado::utils::ReadIdSet;
+
+// A large run's worth of read ids.
+constexpr size_t kNumReadIds = 1000000;
+
+std::vector<std::string> random_uuids(size_t count, uint32_t seed) {
+    std::mt19937 gen(seed);
+    std::vector<std::string> uuids;
+    uuids.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        char uuid[37];
+        std::snprintf(uuid, sizeof(uuid), "%08x-%04x-%04x-%04x-%04x%08x", uint32_t(gen()),
+                      uint32_t(gen() & 0xffff), uint32_t(gen() & 0xffff), uint32_t(gen() & 0xffff),
+                      uint32_t(gen() & 0xffff), uint32_t(gen()));
+        uuids.emplace_back(uuid);
+    }
+    return uuids;
+}
+
+// Ids inserted into the sets.
+const std::vector<std::string>& get_read_ids() {
+    static const auto read_ids = random_uuids(kNumReadIds, 42);
+    return read_ids;
+}
+
+// Ids looked up in the sets, which are mostly absent, as when filtering reads against a
+// --read-ids or resume list.  Lookups are of binary ids, as DataLoader does for POD5 reads.
+const std::vector<ReadIdSet::Uuid>& get_query_ids() {
+    static const auto query_ids = [] {
+        std::vector<ReadIdSet::Uuid> uuids;
+        for (const auto& read_id : random_uuids(kNumReadIds, 43)) {
+            uuids.emplace_back();
+            ReadIdSet::parse_uuid(read_id, uuids.back());
+        }
+        // Every tenth lookup is of an id in the set.
+        const auto& read_ids = get_read_ids();
+        for (size_t i = 0; i < uuids.size(); i += 10) {
+            ReadIdSet::parse_uuid(read_ids[i], uuids[i]);
+        }
+        return uuids;
+    }();
+    return query_ids;
+}
+
+// Counts the bytes allocated through it, so the memory used by a std::unordered_set of
+// strings can be compared with ReadIdSet::memory_bytes().
+size_t g_allocated_bytes = 0;
+
+template <typename T>
+struct CountingAllocator {
+    using value_type = T;
+
+    CountingAllocator() = default;
+    template <typename U>
+    CountingAllocator(const CountingAllocator<U>&) {}
+
+    T* allocate(size_t n) {
+        g_allocated_bytes += n * sizeof(T);
+        return std::allocator<T>().allocate(n);
+    }
+    void deallocate(T* p, size_t n) {
+        g_allocated_bytes -= n * sizeof(T);
+        std::allocator<T>().deallocate(p, n);
+    }
+
+    template <typename U>
+    bool operator==(const CountingAllocator<U>&) const {
+        return true;
+    }
+    template <typename U>
+    bool operator!=(const CountingAllocator<U>&) const {
+        return false;
+    }
+};
+
+using CountedString = std::basic_string<char, std::char_traits<char>, CountingAllocator<char>>;
+
+struct CountedStringHash {
+    size_t operator()(const CountedString& s) const {
+        return std::hash<std::string_view>()(std::string_view(s.data(), s.size()));
+    }
+};
+
+// How read ids were tracked before ReadIdSet.
+using StringSet = std::unordered_set<CountedString,
+                                     CountedStringHash,
+                                     std::equal_to<CountedString>,
+                                     CountingAllocator<CountedString>>;
+
+StringSet make_string_set() {
+    StringSet set;
+    for (const auto& read_id : get_read_ids()) {
+        set.emplace(read_id.data(), read_id.size());
+    }
+    return set;
+}
+
+ReadIdSet make_read_id_set(bool bloom_filter) {
+    ReadIdSet set;
+    if (bloom_filter) {
+        set.enable_bloom_filter();
+    }
+    for (const auto& read_id : get_read_ids()) {
+        set.insert(read_id);
+    }
+    return set;
+}
+
+size_t run_string_set_insert() {
+    g_allocated_bytes = 0;
+    const auto set = make_string_set();
+    dorado::benchmarks::set_counter("bytes_per_id", double(g_allocated_bytes) / set.size());
+    return set.size();
+}
+
+size_t run_read_id_set_insert(bool bloom_filter) {
+    const auto set = make_read_id_set(bloom_filter);
+    dorado::benchmarks::set_counter("bytes_per_id", double(set.memory_bytes()) / set.size());
+    return set.size();
+}
+
+size_t run_string_set_lookup(const StringSet& set) {
+    // The string set needs each binary id formatted as text, as it was before.
+    size_t num_found = 0;
+    CountedString read_id(36, '\0');
+    for (const auto& uuid : get_query_ids()) {
+        char* out = read_id.data();
+        for (size_t i = 0; i < uuid.size(); ++i) {
+            if (i == 4 || i == 6 || i == 8 || i == 10) {
+                *out++ = '-';
+            }
+            *out++ = "0123456789abcdef"[uuid[i] >> 4];
+            *out++ = "0123456789abcdef"[uuid[i] & 0xf];
+        }
+        num_found += set.count(read_id);
+    }
+    dorado::benchmarks::set_counter("found", double(num_found));
+    return get_query_ids().size();
+}
+
+size_t run_read_id_set_lookup(const ReadIdSet& set) {
+    size_t num_found = 0;
+    for (const auto& uuid : get_query_ids()) {
+        num_found += set.contains(uuid) ? 1 : 0;
+    }
+    dorado::benchmarks::set_counter("found", double(num_found));
+    return get_query_ids().size();
+}
+
+void register_read_id_set_benchmarks() {
+    using dorado::benchmarks::add_benchmark;
+
+    add_benchmark("ReadIdSet/insert_1M/unordered_set", [] { return run_string_set_insert(); });
+    add_benchmark("ReadIdSet/insert_1M/ReadIdSet", [] { return run_read_id_set_insert(false); });
+    add_benchmark("ReadIdSet/insert_1M/ReadIdSet_bloom",
+                  [] { return run_read_id_set_insert(true); });
+
+    // The sets are built on first use rather than at registration, so that listing or
+    // filtering benchmarks stays quick.
+    add_benchmark("ReadIdSet/lookup_1M/unordered_set", [] {
+        static const auto set = make_string_set();
+        return run_string_set_lookup(set);
+    });
+    add_benchmark("ReadIdSet/lookup_1M/ReadIdSet", [] {
+        static const auto set = make_read_id_set(false);
+        return run_read_id_set_lookup(set);
+    });
+    add_benchmark("ReadIdSet/lookup_1M/ReadIdSet_bloom", [] {
+        static const auto set = make_read_id_set(true);
+        return run_read_id_set_lookup(set);
+    });
+}
+
+}  // namespace
+
+DORADO_REGISTER_BENCHMARKS(register_read_id_set_benchmarks);
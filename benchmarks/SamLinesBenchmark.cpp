@@ -0,0 +1,36 @@
+#include "Benchmark.h"
+#include "SyntheticReads.h"
+
+#include <random>
+
+namespace {
+
+// A 20 kb read called with moves and 5mCG.
+const dorado::ReadCommon& get_read() {
+    return dorado::benchmarks::lazy_input([] {
+        std::mt19937 gen(42);
+        return dorado::benchmarks::make_5mc_read("00a2dd45-f6a9-49ba-86ee-5d2a37b861cb", 20000,
+                                                 gen);
+    });
+}
+
+size_t run_extract_sam_lines(bool emit_moves) {
+    constexpr size_t kNumCalls = 10;
+    const auto& read = get_read();
+    for (size_t i = 0; i < kNumCalls; ++i) {
+        read.extract_sam_lines(emit_moves, 0, false);
+    }
+    return kNumCalls;
+}
+
+void register_sam_lines_benchmarks() {
+    using dorado::benchmarks::add_benchmark;
+
+    add_benchmark("ReadCommon/extract_sam_lines", [] { return run_extract_sam_lines(false); });
+    add_benchmark("ReadCommon/extract_sam_lines_moves",
+                  [] { return run_extract_sam_lines(true); });
+}
+
+}  // namespace
+
+DORADO_REGISTER_BENCHMARKS(register_sam_lines_benchmarks);
@@ -0,0 +1,89 @@
+#include "Benchmark.h"
+#include "read_pipeline/ReadPipeline.h"
+#include "read_pipeline/stitch.h"
+
+#include <ATen/Functions.h>
+
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+using dorado::utils::Chunk;
+
+// A 100 s read at 5 kHz, in the default chunks of a stride 6 model.
+constexpr size_t kNumSamples = 500000;
+constexpr size_t kChunkSize = 9996;
+constexpr size_t kOverlap = 498;
+constexpr size_t kStride = 6;
+
+std::vector<std::unique_ptr<Chunk>> make_chunks() {
+    std::mt19937 gen(42);
+    // Roughly one base per 10 samples.
+    std::bernoulli_distribution is_move(0.6);
+    std::uniform_int_distribution<int> base(0, 3);
+    std::uniform_int_distribution<int> qscore('!' + 5, '!' + 30);
+
+    std::vector<std::unique_ptr<Chunk>> chunks;
+    size_t offset = 0;
+    while (chunks.empty() || offset + kChunkSize < kNumSamples) {
+        if (!chunks.empty()) {
+            offset = std::min(offset + kChunkSize - kOverlap, kNumSamples - kChunkSize);
+        }
+        auto chunk = std::make_unique<Chunk>(offset, kChunkSize);
+        chunk->moves.resize(kChunkSize / kStride);
+        for (auto& move : chunk->moves) {
+            move = is_move(gen) ? 1 : 0;
+            if (move) {
+                chunk->seq += "ACGT"[base(gen)];
+                chunk->qstring += char(qscore(gen));
+            }
+        }
+        chunks.push_back(std::move(chunk));
+    }
+    return chunks;
+}
+
+const std::vector<std::unique_ptr<Chunk>>& get_chunks() {
+    static const auto chunks = make_chunks();
+    return chunks;
+}
+
+// Stitching overwrites the read's results, so one read can be reused for every run.
+dorado::ReadCommon& get_read() {
+    return dorado::benchmarks::lazy_input([] {
+        dorado::ReadCommon read;
+        read.raw_data = at::zeros(kNumSamples);
+        return read;
+    });
+}
+
+size_t run_stitch_chunks() {
+    const auto& chunks = get_chunks();
+    dorado::utils::stitch_chunks(get_read(), chunks);
+    return chunks.size();
+}
+
+// Stitching as chunks arrive, which also pays for copying the chunks since ChunkStitcher
+// takes ownership of them.
+size_t run_chunk_stitcher() {
+    const auto& chunks = get_chunks();
+    dorado::utils::ChunkStitcher stitcher(chunks.size());
+    for (size_t i = 0; i < chunks.size(); ++i) {
+        stitcher.add_chunk(get_read(), i, std::make_unique<Chunk>(*chunks[i]));
+    }
+    return chunks.size();
+}
+
+void register_stitch_benchmarks() {
+    using dorado::benchmarks::add_benchmark;
+
+    add_benchmark("Stitch/stitch_chunks", [] { return run_stitch_chunks(); });
+    add_benchmark("Stitch/ChunkStitcher", [] { return run_chunk_stitcher(); });
+}
+
+}  // namespace
+
+DORADO_REGISTER_BENCHMARKS(register_stitch_benchmarks);
@@ -0,0 +1,53 @@
+#include "SyntheticReads.h"
+
+#include <ATen/Functions.h>
+
+#include <memory>
+#include <vector>
+
+namespace dorado::benchmarks {
+
+ReadCommon make_5mc_read(const std::string& read_id, size_t seq_len, std::mt19937& gen) {
+    constexpr size_t kStride = 6;
+    std::uniform_int_distribution<int> base(0, 3);
+    std::uniform_int_distribution<int> qscore('!' + 5, '!' + 30);
+    std::uniform_int_distribution<int> stay_blocks(0, 2);
+    std::uniform_int_distribution<int> prob(0, 255);
+
+    ReadCommon read;
+    read.read_id = read_id;
+    read.run_id = "test_run";
+    read.model_name = "dna_r10.4.1_e8.2_400bps_hac@v4.3.0";
+    read.attributes.start_time = "2023-02-21T12:46:01.526+00:00";
+    read.attributes.fast5_filename = "batch_0.pod5";
+    read.sample_rate = 5000;
+    read.shift = 94.7f;
+    read.scale = 26.9f;
+    read.scaling_method = "med_mad";
+    read.model_stride = kStride;
+    read.num_trimmed_samples = 0;
+    read.start_time_ms = 0;
+
+    // Channels A, C, 5mC, G, T.
+    read.mod_base_info = std::make_shared<ModBaseInfo>(
+            std::vector<std::string>{"A", "C", "m", "G", "T"}, "5mC", "_:XG:_:_");
+    for (size_t i = 0; i < seq_len; ++i) {
+        const int b = base(gen);
+        read.seq += "ACGT"[b];
+        read.qstring += char(qscore(gen));
+        read.moves.push_back(1);
+        read.moves.insert(read.moves.end(), stay_blocks(gen), 0);
+        std::vector<uint8_t> probs(5, 0);
+        if (b == 1) {
+            probs[2] = uint8_t(prob(gen));
+            probs[1] = uint8_t(255 - probs[2]);
+        } else {
+            probs[b < 1 ? b : b + 1] = 255;
+        }
+        read.base_mod_probs.insert(read.base_mod_probs.end(), probs.begin(), probs.end());
+    }
+    read.raw_data = at::zeros({int64_t(read.moves.size() * kStride)}, at::kHalf);
+    return read;
+}
+
+}  // namespace dorado::benchmarks
@@ -0,0 +1,15 @@
+#pragma once
+
+#include "read_pipeline/ReadPipeline.h"
+
+#include <cstddef>
+#include <random>
+#include <string>
+
+namespace dorado::benchmarks {
+
+// A read of random bases called with moves and 5mCG, at 5 kHz with a stride 6 model, as the
+// basecaller hands it on.  Each base has up to 2 stays, and each C a random 5mC probability.
+ReadCommon make_5mc_read(const std::string& read_id, size_t seq_len, std::mt19937& gen);
+
+}  // namespace dorado::benchmarks
@@ -0,0 +1,110 @@
+#include "Benchmark.h"
+#include "SyntheticReads.h"
+#include "demux/Trimmer.h"
+#include "read_pipeline/ReadPipeline.h"
+#include "utils/bam_utils.h"
+#include "utils/trim.h"
+
+#include <htslib/sam.h>
+
+#include <cstring>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+
+// Records of 5 kb reads called with moves and 5mCG, as the demux nodes see them.
+constexpr size_t kNumRecords = 100;
+constexpr size_t kSeqLen = 5000;
+// An odd start, as adapter and barcode trimming usually leave.
+constexpr std::pair<int, int> kTrimInterval = {91, int(kSeqLen) - 40};
+
+const std::vector<dorado::BamPtr>& get_records() {
+    return dorado::benchmarks::lazy_input([] {
+        std::mt19937 gen(42);
+        std::vector<dorado::BamPtr> records;
+        for (size_t r = 0; r < kNumRecords; ++r) {
+            const auto read = dorado::benchmarks::make_5mc_read(
+                    "00a2dd45-f6a9-49ba-86ee-" + std::to_string(100000000000 + r), kSeqLen, gen);
+            auto lines = read.extract_sam_lines(true, 0, false);
+            records.push_back(std::move(lines.at(0)));
+        }
+        return records;
+    });
+}
+
+// The previous implementation of Trimmer::trim_sequence, which decodes every field, trims the
+// copies and builds a new record from them.
+dorado::BamPtr trim_by_copy(bam1_t* input_record, std::pair<int, int> trim_interval) {
+    using namespace dorado;
+    std::string seq = utils::extract_sequence(input_record);
+    std::vector<uint8_t> qual = utils::extract_quality(input_record);
+    auto [stride, move_vals] = utils::extract_move_table(input_record);
+    int ts = bam_aux_get(input_record, "ts") ? int(bam_aux2i(bam_aux_get(input_record, "ts"))) : 0;
+    auto [modbase_str, modbase_probs] = utils::extract_modbase_info(input_record);
+
+    auto trimmed_seq = utils::trim_sequence(seq, trim_interval);
+    auto trimmed_qual = utils::trim_quality(qual, trim_interval);
+    auto [positions_trimmed, trimmed_moves] = utils::trim_move_table(move_vals, trim_interval);
+    ts += positions_trimmed * stride;
+    int ns = int(trimmed_moves.size() * stride) + ts;
+    auto [trimmed_modbase_str, trimmed_modbase_probs] =
+            utils::trim_modbase_info(seq, modbase_str, modbase_probs, trim_interval);
+
+    bam1_t* out_record = bam_init1();
+    bam_set1(out_record, input_record->core.l_qname - input_record->core.l_extranul - 1,
+             bam_get_qname(input_record), input_record->core.flag, input_record->core.tid,
+             input_record->core.pos, input_record->core.qual, 0, nullptr,
+             input_record->core.mtid, input_record->core.mpos, input_record->core.isize,
+             trimmed_seq.size(), trimmed_seq.data(), (char*)trimmed_qual.data(),
+             bam_get_l_aux(input_record));
+    std::memcpy(bam_get_aux(out_record), bam_get_aux(input_record), bam_get_l_aux(input_record));
+    out_record->l_data += bam_get_l_aux(input_record);
+
+    if (!trimmed_moves.empty()) {
+        bam_aux_del(out_record, bam_aux_get(out_record, "mv"));
+        trimmed_moves.insert(trimmed_moves.begin(), uint8_t(stride));
+        bam_aux_update_array(out_record, "mv", 'c', int(trimmed_moves.size()),
+                             trimmed_moves.data());
+    }
+    if (!trimmed_modbase_str.empty()) {
+        bam_aux_del(out_record, bam_aux_get(out_record, "MM"));
+        bam_aux_append(out_record, "MM", 'Z', int(trimmed_modbase_str.length() + 1),
+                       (uint8_t*)trimmed_modbase_str.c_str());
+        bam_aux_del(out_record, bam_aux_get(out_record, "ML"));
+        bam_aux_update_array(out_record, "ML", 'C', int(trimmed_modbase_probs.size()),
+                             trimmed_modbase_probs.data());
+    }
+    bam_aux_update_int(out_record, "ts", ts);
+    bam_aux_update_int(out_record, "ns", ns);
+    return BamPtr(out_record);
+}
+
+// Both trim a copy of each record, since trimming in place consumes its input.
+size_t run_trim_in_place() {
+    for (const auto& record : get_records()) {
+        dorado::Trimmer::trim_sequence(dorado::BamPtr(bam_dup1(record.get())), kTrimInterval);
+    }
+    return kNumRecords;
+}
+
+size_t run_trim_by_copy() {
+    for (const auto& record : get_records()) {
+        dorado::BamPtr copy(bam_dup1(record.get()));
+        trim_by_copy(copy.get(), kTrimInterval);
+    }
+    return kNumRecords;
+}
+
+void register_trimmer_benchmarks() {
+    using dorado::benchmarks::add_benchmark;
+
+    add_benchmark("Trimmer/trim_bam_in_place", run_trim_in_place);
+    add_benchmark("Trimmer/trim_bam_by_copy", run_trim_by_copy);
+}
+
+}  // namespace
+
+DORADO_REGISTER_BENCHMARKS(register_trimmer_benchmarks);
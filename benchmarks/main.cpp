@@ -0,0 +1,223 @@
+#include "Benchmark.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <regex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace dorado::benchmarks {
+
+std::vector<Benchmark>& registry() {
+    static std::vector<Benchmark> benchmarks;
+    return benchmarks;
+}
+
+void add_benchmark(std::string name, BenchmarkFn fn) {
+    registry().push_back({std::move(name), std::move(fn)});
+}
+
+// Counters set by the running benchmark.
+std::map<std::string, double>& counters() {
+    static std::map<std::string, double> values;
+    return values;
+}
+
+void set_counter(const std::string& name, double value) { counters()[name] = value; }
+
+std::filesystem::path get_test_data_path(const std::string& sub_path) {
+    return std::filesystem::path(DORADO_BENCHMARK_DATA_DIR) / sub_path;
+}
+
+}  // namespace dorado::benchmarks
+
+namespace {
+
+struct Result {
+    std::string name;
+    double median_ms;
+    double items_per_sec;
+    std::map<std::string, double> counters;
+};
+
+void usage() {
+    std::cerr << "Usage: dorado_benchmarks [--repetitions N] [--list] [--json FILE]\n"
+                 "                         [--baseline FILE [--tolerance PERCENT]] "
+                 "[filter_regex]\n\n"
+                 "  --json FILE      Write the results to FILE as JSON.\n"
+                 "  --baseline FILE  Compare throughput with a JSON file written by --json, and\n"
+                 "                   exit with an error if any benchmark has regressed by more\n"
+                 "                   than the tolerance (default 10%)."
+              << std::endl;
+}
+
+std::string json_escape(const std::string& s) {
+    std::string escaped;
+    for (char c : s) {
+        if (c == '"' || c == '\\') {
+            escaped += '\\';
+        }
+        escaped += c;
+    }
+    return escaped;
+}
+
+// Writes one benchmark per line, which read_baseline relies on.
+void write_json(const std::string& path, const std::vector<Result>& results, int repetitions) {
+    std::ofstream out(path);
+    if (!out) {
+        throw std::runtime_error("Unable to open " + path + " for writing");
+    }
+    out << std::setprecision(10) << "{\n  \"repetitions\": " << repetitions
+        << ",\n  \"benchmarks\": [\n";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const auto& result = results[i];
+        out << "    {\"name\": \"" << json_escape(result.name)
+            << "\", \"median_ms\": " << result.median_ms
+            << ", \"items_per_second\": " << result.items_per_sec << ", \"counters\": {";
+        bool first = true;
+        for (const auto& [name, value] : result.counters) {
+            out << (first ? "" : ", ") << '"' << json_escape(name) << "\": " << value;
+            first = false;
+        }
+        out << "}}" << (i + 1 < results.size() ? "," : "") << '\n';
+    }
+    out << "  ]\n}\n";
+}
+
+// Reads the throughput of each benchmark from a file written by write_json.
+std::map<std::string, double> read_baseline(const std::string& path) {
+    std::ifstream in(path);
+    if (!in) {
+        throw std::runtime_error("Unable to open baseline " + path);
+    }
+    const std::regex entry(
+            R"re("name": "((?:[^"\\]|\\.)*)".*"items_per_second": ([-+.0-9eE]+|inf|nan))re");
+    std::map<std::string, double> baseline;
+    std::string line;
+    while (std::getline(in, line)) {
+        std::smatch match;
+        if (std::regex_search(line, match, entry)) {
+            const auto name = std::regex_replace(match[1].str(), std::regex(R"(\\(.))"), "$1");
+            baseline[name] = std::strtod(match[2].str().c_str(), nullptr);
+        }
+    }
+    return baseline;
+}
+
+// Prints the change in throughput from the baseline, and returns the number of benchmarks
+// which have regressed by more than tolerance_pct.
+int compare_with_baseline(const std::vector<Result>& results,
+                          const std::map<std::string, double>& baseline,
+                          double tolerance_pct) {
+    int num_regressions = 0;
+    std::cout << "\nComparison with baseline (tolerance " << std::setprecision(1) << tolerance_pct
+              << "%):" << std::endl;
+    for (const auto& result : results) {
+        const auto it = baseline.find(result.name);
+        std::cout << std::left << std::setw(56) << result.name << std::right;
+        if (it == baseline.end() || !(it->second > 0)) {
+            std::cout << "  not in baseline" << std::endl;
+            continue;
+        }
+        const double change_pct = (result.items_per_sec / it->second - 1.0) * 100.0;
+        const bool regressed = change_pct < -tolerance_pct;
+        num_regressions += regressed ? 1 : 0;
+        std::cout << std::showpos << std::setw(13) << change_pct << std::noshowpos << "%"
+                  << (regressed ? "  REGRESSED" : "") << std::endl;
+    }
+    return num_regressions;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    using namespace dorado::benchmarks;
+
+    int repetitions = 5;
+    bool list_only = false;
+    std::string json_path;
+    std::string baseline_path;
+    double tolerance_pct = 10.0;
+    std::regex filter(".*");
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--repetitions" && i + 1 < argc) {
+            repetitions = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--list") {
+            list_only = true;
+        } else if (arg == "--json" && i + 1 < argc) {
+            json_path = argv[++i];
+        } else if (arg == "--baseline" && i + 1 < argc) {
+            baseline_path = argv[++i];
+        } else if (arg == "--tolerance" && i + 1 < argc) {
+            tolerance_pct = std::max(0.0, std::atof(argv[++i]));
+        } else if (arg == "-h" || arg == "--help") {
+            usage();
+            return 0;
+        } else {
+            filter = std::regex(arg);
+        }
+    }
+
+    // Read the baseline up front, so that a bad path fails before any benchmarks are run.
+    std::map<std::string, double> baseline;
+    if (!baseline_path.empty()) {
+        baseline = read_baseline(baseline_path);
+    }
+
+    std::vector<Result> results;
+    for (const auto& benchmark : registry()) {
+        if (!std::regex_search(benchmark.name, filter)) {
+            continue;
+        }
+        if (list_only) {
+            std::cout << benchmark.name << std::endl;
+            continue;
+        }
+
+        // An untimed warm-up run builds any inputs which are created on first use, and warms
+        // the caches and allocator.
+        benchmark.fn();
+
+        // Report the median repetition, which is robust to the odd noisy run.
+        counters().clear();
+        std::vector<double> items_per_sec;
+        std::vector<double> durations_ms;
+        for (int rep = 0; rep < repetitions; ++rep) {
+            const auto start = std::chrono::steady_clock::now();
+            const size_t num_items = benchmark.fn();
+            const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+            items_per_sec.push_back(num_items / elapsed.count());
+            durations_ms.push_back(elapsed.count() * 1000.0);
+        }
+        std::sort(items_per_sec.begin(), items_per_sec.end());
+        std::sort(durations_ms.begin(), durations_ms.end());
+        results.push_back({benchmark.name, durations_ms[repetitions / 2],
+                           items_per_sec[repetitions / 2], counters()});
+
+        std::cout << std::left << std::setw(56) << benchmark.name << std::right << std::fixed
+                  << std::setprecision(3) << std::setw(14) << results.back().median_ms << " ms"
+                  << std::setprecision(0) << std::setw(16) << results.back().items_per_sec
+                  << " items/s";
+        for (const auto& [name, value] : counters()) {
+            std::cout << std::setprecision(2) << "  " << name << "=" << value;
+        }
+        std::cout << std::endl;
+    }
+
+    if (!json_path.empty()) {
+        write_json(json_path, results, repetitions);
+    }
+    if (!baseline_path.empty() && compare_with_baseline(results, baseline, tolerance_pct) > 0) {
+        return 1;
+    }
+    return 0;
+}
@@ -21,6 +21,7 @@ void create_simplex_pipeline(PipelineDescriptor& pipeline_desc,
                              std::vector<modbase::RunnerPtr>&& modbase_runners,
                              size_t overlap,
                              uint32_t mean_qscore_start_pos,
+                             int basecall_latency_target_ms,
                              bool trim_adapter,
                              int scaler_node_threads,
                              bool enable_read_splitter,
@@ -69,7 +70,7 @@ void create_simplex_pipeline(PipelineDescriptor& pipeline_desc,
     current_node_handle = scaler_node;
     auto basecaller_node = pipeline_desc.add_node<BasecallerNode>(
             {}, std::move(runners), overlap, kBatchTimeoutMS, model_name, 1000, "BasecallerNode",
-            mean_qscore_start_pos);
+            mean_qscore_start_pos, basecall_latency_target_ms);
     pipeline_desc.add_node_sink(current_node_handle, basecaller_node);
     current_node_handle = basecaller_node;
     last_node_handle = basecaller_node;
@@ -131,7 +132,7 @@ void create_stereo_duplex_pipeline(PipelineDescriptor& pipeline_desc,
 
     auto stereo_basecaller_node = pipeline_desc.add_node<BasecallerNode>(
             {}, std::move(stereo_runners), adjusted_stereo_overlap, kStereoBatchTimeoutMS,
-            duplex_rg_name, 1000, "StereoBasecallerNode", mean_qscore_start_pos);
+            duplex_rg_name, 1000, "StereoBasecallerNode", mean_qscore_start_pos, 0);
 
     NodeHandle last_node_handle = stereo_basecaller_node;
     if (!modbase_runners.empty()) {
@@ -172,7 +173,7 @@ void create_stereo_duplex_pipeline(PipelineDescriptor& pipeline_desc,
     const int kSimplexBatchTimeoutMS = 100;
     auto basecaller_node = pipeline_desc.add_node<BasecallerNode>(
             {splitter_node}, std::move(runners), adjusted_simplex_overlap, kSimplexBatchTimeoutMS,
-            model_name, 1000, "BasecallerNode", mean_qscore_start_pos);
+            model_name, 1000, "BasecallerNode", mean_qscore_start_pos, 0);
 
     auto scaler_node = pipeline_desc.add_node<ScalerNode>(
             {basecaller_node}, model_config.signal_norm_params, basecall::SampleType::DNA, false,
@@ -28,11 +28,13 @@ namespace pipelines {
 /// Create a simplex basecall pipeline description
 /// If source_node_handle is valid, set this to be the source of the simplex pipeline
 /// If sink_node_handle is valid, set this to be the sink of the simplex pipeline
+/// If basecall_latency_target_ms is positive, basecall in latency mode with that target
 void create_simplex_pipeline(PipelineDescriptor& pipeline_desc,
                              std::vector<basecall::RunnerPtr>&& runners,
                              std::vector<modbase::RunnerPtr>&& modbase_runners,
                              size_t overlap,
                              uint32_t mean_qscore_start_pos,
+                             int basecall_latency_target_ms,
                              bool trim_adapter,
                              int scaler_node_threads,
                              bool enable_read_splitter,
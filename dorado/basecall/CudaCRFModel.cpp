@@ -4,6 +4,7 @@
 #include "decode/Decoder.h"
 #include "utils/cuda_utils.h"
 #include "utils/math_utils.h"
+#include "utils/tensor_utils.h"
 
 #include <ATen/cuda/CUDAContext.h>
 #include <c10/cuda/CUDAGuard.h>
@@ -404,29 +405,35 @@ CudaModelRunner::CudaModelRunner(std::shared_ptr<CudaCaller> caller)
         : m_caller(caller),
           m_stream(c10::cuda::getStreamFromPool(false, m_caller->m_options.device().index())) {
     auto opts = at::TensorOptions().device(torch::kCPU).pinned_memory(true);
-    m_input = torch::empty(
-            {caller->m_batch_size, caller->m_num_input_features, caller->m_in_chunk_size},
-            opts.dtype(m_caller->m_options.dtype()));
+    for (auto &input : m_inputs) {
+        input = torch::empty(
+                {caller->m_batch_size, caller->m_num_input_features, caller->m_in_chunk_size},
+                opts.dtype(m_caller->m_options.dtype()));
+    }
 
     m_output = torch::empty({3, caller->m_batch_size, caller->m_out_chunk_size},
                             opts.dtype(torch::kInt8));
 }
 
-void CudaModelRunner::accept_chunk(int chunk_idx, const at::Tensor &chunk) {
-    m_input.index_put_({chunk_idx, torch::indexing::Ellipsis}, chunk);
+void CudaModelRunner::accept_chunk(int buffer_idx, int chunk_idx, const at::Tensor &chunk) {
+    utils::copy_repeat_padded(m_inputs.at(buffer_idx)[chunk_idx], chunk);
 }
 
-std::vector<decode::DecodedChunk> CudaModelRunner::call_chunks(int num_chunks) {
+std::vector<decode::DecodedChunk> CudaModelRunner::call_chunks(int buffer_idx,
+                                                               int num_chunks,
+                                                               size_t /*chunk_size*/) {
+    // Only the full chunk size is supported, for which working memory was sized.
     ++m_num_batches_called;
     stats::Timer timer;
-    auto decoded_chunks = m_caller->call_chunks(m_input, m_output, num_chunks, m_stream);
+    auto decoded_chunks =
+            m_caller->call_chunks(m_inputs.at(buffer_idx), m_output, num_chunks, m_stream);
     return decoded_chunks;
 }
 
 const CRFModelConfig &CudaModelRunner::config() const { return m_caller->m_config; }
 size_t CudaModelRunner::model_stride() const { return m_caller->m_config.stride; }
-size_t CudaModelRunner::chunk_size() const { return m_input.size(2); }
-size_t CudaModelRunner::batch_size() const { return m_input.size(0); }
+size_t CudaModelRunner::chunk_size() const { return m_inputs[0].size(2); }
+size_t CudaModelRunner::batch_size() const { return m_inputs[0].size(0); }
 void CudaModelRunner::terminate() { m_caller->terminate(); }
 void CudaModelRunner::restart() { m_caller->restart(); }
 
@@ -6,6 +6,7 @@
 #include <ATen/core/TensorBody.h>
 #include <c10/cuda/CUDAStream.h>
 
+#include <array>
 #include <atomic>
 #include <filesystem>
 #include <memory>
@@ -26,8 +27,10 @@ std::shared_ptr<CudaCaller> create_cuda_caller(const CRFModelConfig& model_confi
 class CudaModelRunner final : public ModelRunnerBase {
 public:
     explicit CudaModelRunner(std::shared_ptr<CudaCaller> caller);
-    void accept_chunk(int chunk_idx, const at::Tensor& chunk) final;
-    std::vector<decode::DecodedChunk> call_chunks(int num_chunks) final;
+    void accept_chunk(int buffer_idx, int chunk_idx, const at::Tensor& chunk) final;
+    std::vector<decode::DecodedChunk> call_chunks(int buffer_idx,
+                                                  int num_chunks,
+                                                  size_t chunk_size) final;
     const CRFModelConfig& config() const final;
     size_t model_stride() const final;
     size_t chunk_size() const final;
@@ -40,7 +43,7 @@ public:
 private:
     std::shared_ptr<CudaCaller> m_caller;
     c10::cuda::CUDAStream m_stream;
-    at::Tensor m_input;
+    std::array<at::Tensor, NUM_INPUT_BUFFERS> m_inputs;
     at::Tensor m_output;
 
     // Performance monitoring stats.
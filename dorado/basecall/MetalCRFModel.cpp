@@ -1065,39 +1065,45 @@ std::shared_ptr<MetalCaller> create_metal_caller(const CRFModelConfig &model_con
 }
 
 MetalModelRunner::MetalModelRunner(std::shared_ptr<MetalCaller> caller) : m_caller(caller) {
-    // Metal convolution kernels operate with channel ordering (N, T, C).  If m_input
-    // is to be submitted directly then it must also have this arrangement.
+    // Metal convolution kernels operate with channel ordering (N, T, C).  If the inputs
+    // are to be submitted directly then they must also have this arrangement.
     // Note that this is not the same as other caller implementations, which
     // have T innermost.
-    m_input = torch::empty(
-            {caller->m_batch_size, caller->m_in_chunk_size, caller->m_num_input_features},
-            torch::kF16);
+    for (auto &input : m_inputs) {
+        input = torch::empty(
+                {caller->m_batch_size, caller->m_in_chunk_size, caller->m_num_input_features},
+                torch::kF16);
+    }
 }
 
-void MetalModelRunner::accept_chunk(int chunk_idx, const at::Tensor &chunk) {
+void MetalModelRunner::accept_chunk(int buffer_idx, int chunk_idx, const at::Tensor &chunk) {
+    auto &input = m_inputs.at(buffer_idx);
     if (chunk.dim() == 1) {
         // Input has single feature dimension.
         assert(m_caller->m_num_input_features == 1);
-        m_input.index_put_({chunk_idx, Ellipsis, 0}, chunk);
+        utils::copy_repeat_padded(input.index({chunk_idx, Ellipsis, 0}), chunk);
     } else {
         // Chunks are passed with timestep the innermost dimension, whereas we need
-        // channels innermost.
+        // channels innermost, so copy into a transposed view of the slot.
         assert(m_caller->m_num_input_features == chunk.size(0));
-        m_input.index_put_({chunk_idx, Ellipsis, Ellipsis}, chunk.transpose(0, 1));
+        utils::copy_repeat_padded(input[chunk_idx].transpose(0, 1), chunk);
     }
 }
 
-std::vector<decode::DecodedChunk> MetalModelRunner::call_chunks(int num_chunks) {
+std::vector<decode::DecodedChunk> MetalModelRunner::call_chunks(int buffer_idx,
+                                                                int num_chunks,
+                                                                size_t /*chunk_size*/) {
+    // Only the full chunk size is supported, for which the kernels were built.
     ++m_num_batches_called;
     std::vector<decode::DecodedChunk> out_chunks(num_chunks);
-    m_caller->call_chunks(m_input, num_chunks, out_chunks);
+    m_caller->call_chunks(m_inputs.at(buffer_idx), num_chunks, out_chunks);
     return out_chunks;
 }
 
 const CRFModelConfig &MetalModelRunner::config() const { return m_caller->m_config; }
 size_t MetalModelRunner::model_stride() const { return m_caller->m_config.stride; }
-size_t MetalModelRunner::chunk_size() const { return m_input.size(1); }
-size_t MetalModelRunner::batch_size() const { return m_input.size(0); }
+size_t MetalModelRunner::chunk_size() const { return m_inputs[0].size(1); }
+size_t MetalModelRunner::batch_size() const { return m_inputs[0].size(0); }
 
 void MetalModelRunner::terminate() { m_caller->terminate(); }
 void MetalModelRunner::restart() { m_caller->restart(); }
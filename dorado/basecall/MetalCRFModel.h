@@ -4,6 +4,7 @@
 
 #include <ATen/core/TensorBody.h>
 
+#include <array>
 #include <atomic>
 #include <cstdint>
 #include <filesystem>
@@ -22,8 +23,10 @@ std::shared_ptr<MetalCaller> create_metal_caller(const CRFModelConfig& model_con
 class MetalModelRunner final : public ModelRunnerBase {
 public:
     explicit MetalModelRunner(std::shared_ptr<MetalCaller> caller);
-    void accept_chunk(int chunk_idx, const at::Tensor& chunk) final;
-    std::vector<decode::DecodedChunk> call_chunks(int num_chunks) final;
+    void accept_chunk(int buffer_idx, int chunk_idx, const at::Tensor& chunk) final;
+    std::vector<decode::DecodedChunk> call_chunks(int buffer_idx,
+                                                  int num_chunks,
+                                                  size_t chunk_size) final;
     const CRFModelConfig& config() const final;
     size_t model_stride() const final;
     size_t chunk_size() const final;
@@ -35,7 +38,7 @@ public:
 
 private:
     std::shared_ptr<MetalCaller> m_caller;
-    at::Tensor m_input;
+    std::array<at::Tensor, NUM_INPUT_BUFFERS> m_inputs;
 
     // Performance monitoring stats.
     std::atomic<int64_t> m_num_batches_called = 0;
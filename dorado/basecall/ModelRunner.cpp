@@ -2,6 +2,7 @@
 
 #include "CRFModel.h"
 #include "decode/Decoder.h"
+#include "utils/tensor_utils.h"
 
 namespace dorado::basecall {
 
@@ -19,14 +20,31 @@ ModelRunner::ModelRunner(const CRFModelConfig &model_config,
     // adjust chunk size to be a multiple of the stride
     chunk_size -= chunk_size % model_config.stride;
 
-    m_input = at::zeros({batch_size, model_config.num_features, chunk_size},
-                        at::TensorOptions().dtype(m_decoder->dtype()).device(at::kCPU));
+    for (auto &input : m_inputs) {
+        input = at::zeros({batch_size, model_config.num_features, chunk_size},
+                          at::TensorOptions().dtype(m_decoder->dtype()).device(at::kCPU));
+    }
+
+    // The model runs at any multiple of the stride, so short reads can be called at a quarter
+    // or half of the full chunk size rather than mostly on padding.
+    for (int divisor : {4, 2}) {
+        const int size = chunk_size / divisor - (chunk_size / divisor) % model_config.stride;
+        if (size >= model_config.stride &&
+            (m_chunk_sizes.empty() || size_t(size) > m_chunk_sizes.back())) {
+            m_chunk_sizes.push_back(size);
+        }
+    }
+    m_chunk_sizes.push_back(chunk_size);
 }
 
-std::vector<decode::DecodedChunk> ModelRunner::call_chunks(int num_chunks) {
+std::vector<decode::DecodedChunk> ModelRunner::call_chunks(int buffer_idx,
+                                                           int num_chunks,
+                                                           size_t chunk_size) {
     at::InferenceMode guard;
     dorado::stats::Timer timer;
-    auto scores = m_module->forward(m_input.to(m_options.device()));
+    // Unlike the GPU runners, this can skip both empty slots and padding beyond chunk_size.
+    auto input = m_inputs.at(buffer_idx).narrow(0, 0, num_chunks).narrow(2, 0, chunk_size);
+    auto scores = m_module->forward(input.to(m_options.device()));
     const auto forward_ms = timer.GetElapsedMS();
     auto decoded_chunks = m_decoder->beam_search_part_2(
             m_decoder->beam_search_part_1({scores, num_chunks, m_decoder_options}));
@@ -37,8 +55,8 @@ std::vector<decode::DecodedChunk> ModelRunner::call_chunks(int num_chunks) {
     return decoded_chunks;
 }
 
-void ModelRunner::accept_chunk(int chunk_idx, const at::Tensor &chunk) {
-    m_input.index_put_({chunk_idx, at::indexing::Ellipsis}, chunk);
+void ModelRunner::accept_chunk(int buffer_idx, int chunk_idx, const at::Tensor &chunk) {
+    utils::copy_repeat_padded(m_inputs.at(buffer_idx)[chunk_idx], chunk);
 }
 
 stats::NamedStats ModelRunner::sample_stats() const {
@@ -7,8 +7,10 @@
 
 #include <torch/nn.h>
 
+#include <array>
 #include <atomic>
 #include <string>
+#include <vector>
 
 namespace dorado::basecall {
 
@@ -18,12 +20,15 @@ public:
                 const std::string &device,
                 int chunk_size,
                 int batch_size);
-    void accept_chunk(int chunk_idx, const at::Tensor &chunk) final;
-    std::vector<decode::DecodedChunk> call_chunks(int num_chunks) final;
+    void accept_chunk(int buffer_idx, int chunk_idx, const at::Tensor &chunk) final;
+    std::vector<decode::DecodedChunk> call_chunks(int buffer_idx,
+                                                  int num_chunks,
+                                                  size_t chunk_size) final;
     const CRFModelConfig &config() const final { return m_config; };
     size_t model_stride() const final { return m_config.stride; }
-    size_t chunk_size() const final { return m_input.size(2); }
-    size_t batch_size() const final { return m_input.size(0); }
+    size_t chunk_size() const final { return m_inputs[0].size(2); }
+    size_t batch_size() const final { return m_inputs[0].size(0); }
+    std::vector<size_t> supported_chunk_sizes() const final { return m_chunk_sizes; }
     void terminate() final {}
     void restart() final {}
     std::string get_name() const final { return "ModelRunner"; }
@@ -35,7 +40,8 @@ private:
     at::TensorOptions m_options;
     decode::DecoderOptions m_decoder_options;
     torch::nn::ModuleHolder<torch::nn::AnyModule> m_module{nullptr};
-    at::Tensor m_input;
+    std::array<at::Tensor, NUM_INPUT_BUFFERS> m_inputs;
+    std::vector<size_t> m_chunk_sizes;
 
     // Performance monitoring stats.
     std::atomic<int64_t> m_num_batches_called = 0;
@@ -16,12 +16,26 @@ struct CRFModelConfig;
 
 class ModelRunnerBase {
 public:
+    // Runners stage chunks into one of several preallocated input batches, so that one batch
+    // can be filled while another is being called.
+    static constexpr int NUM_INPUT_BUFFERS = 2;
+
     virtual ~ModelRunnerBase() = default;
-    virtual void accept_chunk(int chunk_idx, const at::Tensor &chunk) = 0;
-    virtual std::vector<decode::DecodedChunk> call_chunks(int num_chunks) = 0;
+    // Copies chunk into slot chunk_idx of the given input buffer.  Chunks shorter than
+    // chunk_size() are repeat-padded in place.
+    virtual void accept_chunk(int buffer_idx, int chunk_idx, const at::Tensor &chunk) = 0;
+    // Calls the first num_chunks chunks of the given input buffer, over their first chunk_size
+    // samples, which must be one of supported_chunk_sizes().  Chunks may be accepted into other
+    // buffers while this is running.
+    virtual std::vector<decode::DecodedChunk> call_chunks(int buffer_idx,
+                                                          int num_chunks,
+                                                          size_t chunk_size) = 0;
     virtual const CRFModelConfig &config() const = 0;
     virtual size_t model_stride() const = 0;
     virtual size_t chunk_size() const = 0;
+    // Sizes at which batches can be called, in increasing order and ending with chunk_size().
+    // Batches of short chunks can be called at a smaller size to avoid computing on padding.
+    virtual std::vector<size_t> supported_chunk_sizes() const { return {chunk_size()}; }
     virtual size_t batch_size() const = 0;
     virtual void terminate() = 0;
     virtual void restart() = 0;
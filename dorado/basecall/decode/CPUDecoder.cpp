@@ -1,149 +1,116 @@
 #include "CPUDecoder.h"
 
 #include "beam_search.h"
+#include "forward_backward.h"
+#include "utils/WorkStealingExecutor.h"
 
 #include <ATen/ATen.h>
-#include <math.h>
-#include <spdlog/spdlog.h>
 
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <memory>
+#include <mutex>
 #include <vector>
 
-namespace {
-
-at::Tensor scan(const at::Tensor& Ms,
-                const float fixed_stay_score,
-                const at::Tensor& idx,
-                const at::Tensor& v0) {
-    const int T = int(Ms.size(0));
-    const int N = int(Ms.size(1));
-    const int C = int(Ms.size(2));
-
-    at::Tensor alpha = Ms.new_full({T + 1, N, C}, -1E38);
-    alpha[0] = v0;
-
-    for (int t = 0; t < T; t++) {
-        auto scored_steps = at::add(alpha.index({t, at::indexing::Slice(), idx}), Ms[t]);
-        auto scored_stay =
-                at::add(alpha.index({t, at::indexing::Slice()}), fixed_stay_score).unsqueeze(-1);
-        auto scored_transitions = at::cat({scored_stay, scored_steps}, -1);
-
-        alpha[t + 1] = at::logsumexp(scored_transitions, -1);
-    }
-
-    return alpha;
-}
-
-at::Tensor forward_scores(const at::Tensor& scores, const float fixed_stay_score) {
-    const int T = int(scores.size(0));  // Signal len
-    const int N = int(scores.size(1));  // Num batches
-    const int C = int(scores.size(2));  // 4^state_len * 4 = 4^(state_len + 1)
-
-    const int n_base = 4;
-    const int state_len = int(std::log(C) / std::log(n_base) - 1);
-
-    // Transition scores reshaped so that the 4 scores for each predecessor state are arranged along the
-    // innermost dimension.
-    const at::Tensor Ms = scores.reshape({T, N, -1, n_base});
-
-    // Number of states per timestep.
-    const int num_states = int(pow(n_base, state_len));
-
-    // Guide values at first timestep.
-    const auto v0 = Ms.new_full({{N, num_states}}, 0.0f);
-
-    // For each state, the indices of the 4 states that could precede it via a step transition.
-    const auto idx =
-            at::arange(num_states).repeat_interleave(n_base).reshape({n_base, -1}).t().contiguous();
-
-    return scan(Ms, fixed_stay_score, idx, v0);
-}
-
-at::Tensor backward_scores(const at::Tensor& scores, const float fixed_stay_score) {
-    const int N = int(scores.size(1));  // Num batches
-    const int C = int(scores.size(2));  // 4^state_len * 4 = 4^(state_len + 1)
-
-    const int n_base = 4;
-
-    const int state_len = int(std::log(C) / std::log(n_base) - 1);
-
-    // Number of states per timestep.
-    const int num_states = int(pow(n_base, state_len));
-
-    // Guide values at last timestep.
-    const at::Tensor vT = scores.new_full({N, num_states}, 0.0f);
-
-    const auto idx =
-            at::arange(num_states).repeat_interleave(n_base).reshape({n_base, -1}).t().contiguous();
-    auto idx_T = idx.flatten().argsort().reshape(idx.sizes());
-
-    const auto Ms_T = scores.index({at::indexing::Slice(), at::indexing::Slice(), idx_T});
-
-    // For each state, the indices of the 4 states that could succeed it via a step transition.
-    idx_T = at::bitwise_right_shift(idx_T, 2);
-
-    return scan(Ms_T.flip(0), fixed_stay_score, idx_T.to(at::kLong), vT).flip(0);
-}
+namespace dorado::basecall::decode {
 
-}  // namespace
+// The decode threads come from the process-wide executor, so that they're shared with the
+// rest of the pipeline rather than added on top of it.
+CPUDecoder::CPUDecoder() : m_executor(utils::WorkStealingExecutor::instance()) {}
 
-namespace dorado::basecall::decode {
+CPUDecoder::CPUDecoder(utils::WorkStealingExecutor& executor) : m_executor(executor) {}
 
 DecodeData CPUDecoder::beam_search_part_1(DecodeData data) const { return data; }
 
 std::vector<DecodedChunk> CPUDecoder::beam_search_part_2(DecodeData data) const {
-    const auto scores_cpu = data.data.to(at::kCPU);
     const auto num_chunks = data.num_chunks;
-    const auto& options = data.options;
-    int num_threads = std::min(num_chunks, 4);
-    int chunks_per_thread = num_chunks / num_threads;
-    int num_threads_with_one_more_chunk = num_chunks % num_threads;
-
-    std::vector<DecodedChunk> chunk_results(num_chunks);
-
-    std::vector<std::unique_ptr<std::thread>> threads;
-    threads.reserve(num_threads);
-    for (int i = 0; i < num_threads; ++i) {
-        threads.emplace_back(new std::thread(
-                [&](int i) {
-                    at::InferenceMode inference_mode_guard;
-
-                    int t_first_chunk =
-                            i * chunks_per_thread + std::min(i, num_threads_with_one_more_chunk);
-                    int t_num_chunks = chunks_per_thread + int(i < num_threads_with_one_more_chunk);
-
-                    using Slice = at::indexing::Slice;
-                    auto t_scores = scores_cpu.index(
-                            {Slice(), Slice(t_first_chunk, t_first_chunk + t_num_chunks)});
-
-                    at::Tensor fwd = forward_scores(t_scores, options.blank_score);
-                    at::Tensor bwd = backward_scores(t_scores, options.blank_score);
-
-                    at::Tensor posts = at::softmax(fwd + bwd, -1);
-
-                    t_scores = t_scores.transpose(0, 1);
-                    bwd = bwd.transpose(0, 1).contiguous();
-                    posts = posts.transpose(0, 1).contiguous();
-
-                    for (int chunk_idx = 0; chunk_idx < t_num_chunks; chunk_idx++) {
-                        auto decode_result = beam_search_decode(
-                                t_scores[chunk_idx], bwd[chunk_idx], posts[chunk_idx],
-                                options.beam_width, options.beam_cut, options.blank_score,
-                                options.q_shift, options.q_scale, 1.0f);
-                        chunk_results[t_first_chunk + chunk_idx] = DecodedChunk{
-                                std::get<0>(decode_result),
-                                std::get<1>(decode_result),
-                                std::get<2>(decode_result),
-                        };
-                    }
-                },
-                i));
+    if (num_chunks == 0) {
+        return {};
     }
 
-    for (auto& thread : threads) {
-        thread->join();
+    // Chunks are handed out one at a time from a shared counter, so workers that get easy
+    // chunks go on to take more, rather than each worker getting a fixed share.  The state is
+    // shared with the pool tasks, so that tasks which only start once every chunk has been
+    // taken find nothing to do and the caller doesn't have to wait for them.
+    struct DecodeState {
+        at::Tensor scores;
+        DecoderOptions options;
+        int num_chunks = 0;
+        std::vector<DecodedChunk> chunk_results;
+        std::atomic<int> next_chunk{0};
+        std::mutex mutex;
+        std::condition_variable done_cv;
+        // Chunks decoded, or given up on after an error.
+        int num_chunks_finished = 0;
+        std::exception_ptr error;
+    };
+    auto state = std::make_shared<DecodeState>();
+    state->scores = data.data.to(at::kCPU);
+    state->options = data.options;
+    state->num_chunks = num_chunks;
+    state->chunk_results.resize(num_chunks);
+
+    auto decode_chunks = [](DecodeState& state) {
+        at::InferenceMode inference_mode_guard;
+        const auto& options = state.options;
+        for (int chunk_idx = state.next_chunk++; chunk_idx < state.num_chunks;
+             chunk_idx = state.next_chunk++) {
+            int num_chunks_finished = 1;
+            try {
+                const auto chunk_scores = state.scores.select(1, chunk_idx);
+                const auto batch_scores = chunk_scores.unsqueeze(1);
+
+                at::Tensor fwd = forward_scores(batch_scores, options.blank_score).squeeze(1);
+                at::Tensor bwd = backward_scores(batch_scores, options.blank_score).squeeze(1);
+
+                at::Tensor posts = at::softmax(fwd + bwd, -1);
+
+                auto decode_result = beam_search_decode(
+                        chunk_scores, bwd, posts, options.beam_width, options.beam_cut,
+                        options.blank_score, options.q_shift, options.q_scale, 1.0f);
+                state.chunk_results[chunk_idx] = DecodedChunk{
+                        std::get<0>(decode_result),
+                        std::get<1>(decode_result),
+                        std::get<2>(decode_result),
+                };
+            } catch (...) {
+                std::lock_guard lock(state.mutex);
+                if (!state.error) {
+                    state.error = std::current_exception();
+                }
+                // Stop the other workers picking up more chunks, and give up on the rest.
+                num_chunks_finished +=
+                        std::max(state.num_chunks - state.next_chunk.exchange(state.num_chunks), 0);
+            }
+            std::lock_guard lock(state.mutex);
+            state.num_chunks_finished += num_chunks_finished;
+            if (state.num_chunks_finished == state.num_chunks) {
+                state.done_cv.notify_all();
+            }
+        }
+    };
+
+    // The calling thread decodes too, so this batch makes progress even if the pool is
+    // busy with other runners' batches.
+    const int num_pool_workers = std::min(num_chunks - 1, int(m_executor.num_threads()));
+    for (int i = 0; i < num_pool_workers; ++i) {
+        m_executor.submit([state, decode_chunks] { decode_chunks(*state); });
+    }
+    decode_chunks(*state);
+
+    {
+        // Only wait for chunks other workers are still decoding.
+        std::unique_lock lock(state->mutex);
+        state->done_cv.wait(lock,
+                            [&state] { return state->num_chunks_finished == state->num_chunks; });
+    }
+    if (state->error) {
+        std::rethrow_exception(state->error);
     }
 
-    return chunk_results;
+    return std::move(state->chunk_results);
 }
 
 }  // namespace dorado::basecall::decode
@@ -4,14 +4,26 @@
 
 #include <ATen/core/TensorBody.h>
 
+namespace dorado::utils {
+class WorkStealingExecutor;
+}
+
 namespace dorado::basecall::decode {
 
 class CPUDecoder final : public Decoder {
 public:
+    // Decodes on the process-wide executor.
+    CPUDecoder();
+    // Decodes on the given pool, which must outlive the decoder.
+    explicit CPUDecoder(utils::WorkStealingExecutor& executor);
+
     DecodeData beam_search_part_1(DecodeData data) const;
     std::vector<DecodedChunk> beam_search_part_2(DecodeData data) const;
 
     at::ScalarType dtype() const { return at::ScalarType::Float; };
+
+private:
+    utils::WorkStealingExecutor& m_executor;
 };
 
 }  // namespace dorado::basecall::decode
@@ -7,11 +7,11 @@
 
 #include <algorithm>
 #include <array>
-#include <bitset>
 #include <cstring>
 #include <iostream>
 #include <limits>
 #include <numeric>
+#include <vector>
 
 namespace {
 
@@ -29,12 +29,26 @@ struct BeamElement {
 };
 
 // This is the data we need to retain for only the previous timestep (block) in the beam
-// (and what we construct for the new timestep)
-struct BeamFrontElement {
-    uint32_t hash;
-    state_t state;
-    uint8_t prev_element_index;
-    bool stay;
+// (and what we construct for the new timestep).
+// Stored as parallel arrays, so that the expansion, merging and selection loops only stream
+// through the fields they use.
+struct BeamFront {
+    explicit BeamFront(size_t size)
+            : hashes(size), states(size), prev_element_indices(size), stays(size), scores(size) {}
+
+    void swap_elements(size_t a, size_t b) {
+        std::swap(hashes[a], hashes[b]);
+        std::swap(states[a], states[b]);
+        std::swap(prev_element_indices[a], prev_element_indices[b]);
+        std::swap(stays[a], stays[b]);
+        std::swap(scores[a], scores[b]);
+    }
+
+    std::vector<uint32_t> hashes;
+    std::vector<state_t> states;
+    std::vector<uint8_t> prev_element_indices;
+    std::vector<uint8_t> stays;
+    std::vector<float> scores;
 };
 
 float log_sum_exp(float x, float y) {
@@ -102,7 +116,7 @@ std::tuple<std::string, std::string> generate_sequence(const std::vector<uint8_t
 // Incorporates NUM_NEW_BITS into a Castagnoli CRC32, aka CRC32C
 // (not the same polynomial as CRC32 as used in zip/ethernet).
 template <int NUM_NEW_BITS>
-uint32_t crc32c(uint32_t crc, uint32_t new_bits) {
+constexpr uint32_t crc32c(uint32_t crc, uint32_t new_bits) {
     // Note that this is the reversed polynomial.
     constexpr uint32_t POLYNOMIAL = 0x82f63b78u;
     for (int i = 0; i < NUM_NEW_BITS; ++i) {
@@ -115,6 +129,92 @@ uint32_t crc32c(uint32_t crc, uint32_t new_bits) {
     return crc;
 }
 
+constexpr std::array<uint32_t, NUM_BASES> make_base_crc_table() {
+    std::array<uint32_t, NUM_BASES> table{};
+    for (uint32_t i = 0; i < NUM_BASES; ++i) {
+        table[i] = crc32c<NUM_BASE_BITS>(i, 0);
+    }
+    return table;
+}
+
+// Equivalent to crc32c<NUM_BASE_BITS>(crc, base), using a table lookup rather than
+// a branch per bit.  This relies on the CRC being linear in both crc and new_bits.
+// (Hardware CRC32C instructions consume at least 8 bits at a time, so using them would
+// change the hash of every path.)
+inline uint32_t crc32c_base(uint32_t crc, uint32_t base) {
+    static constexpr auto BASE_CRC_TABLE = make_base_crc_table();
+    return (crc >> NUM_BASE_BITS) ^ BASE_CRC_TABLE[(crc ^ base) & (NUM_BASES - 1)];
+}
+
+// Counts the scores which are >= cutoff.
+#if ENABLE_AVX2_IMPL
+__attribute__((target("default")))
+#endif
+size_t count_scores_at_least(const float* score_ptr, size_t num_scores, float cutoff) {
+    size_t elem_count = 0;
+#if !ENABLE_NEON_IMPL
+    for (size_t i = num_scores; i; --i) {
+        if (*score_ptr >= cutoff) {
+            ++elem_count;
+        }
+        ++score_ptr;
+    }
+#else
+    uint32x4_t counts_x4_a = vdupq_n_u32(0u);
+    uint32x4_t counts_x4_b = vdupq_n_u32(0u);
+    const float32x4_t cutoff_x4 = vdupq_n_f32(cutoff);
+
+    // 8 fold unrolled version has the small upside that both loads
+    // can be done with a single ldp instruction.
+    const size_t kUnroll = 8;
+    for (size_t i = num_scores / kUnroll; i; --i) {
+        // True comparison sets lane bits to 0xffffffff, or -1 in two's complement,
+        // which we subtract to increment our counts.
+        float32x4_t scores_x4_a = vld1q_f32(score_ptr);
+        uint32x4_t comparisons_x4_a = vcgeq_f32(scores_x4_a, cutoff_x4);
+        counts_x4_a = vsubq_u32(counts_x4_a, comparisons_x4_a);
+
+        float32x4_t scores_x4_b = vld1q_f32(score_ptr + 4);
+        uint32x4_t comparisons_x4_b = vcgeq_f32(scores_x4_b, cutoff_x4);
+        counts_x4_b = vsubq_u32(counts_x4_b, comparisons_x4_b);
+
+        score_ptr += 8;
+    }
+    // Add together the result of 2 horizontal adds.
+    elem_count = vaddvq_u32(counts_x4_a) + vaddvq_u32(counts_x4_b);
+    for (size_t i = num_scores % kUnroll; i; --i) {
+        if (*score_ptr >= cutoff) {
+            ++elem_count;
+        }
+        ++score_ptr;
+    }
+#endif
+    return elem_count;
+}
+
+#if ENABLE_AVX2_IMPL
+__attribute__((target("avx2"))) size_t count_scores_at_least(const float* score_ptr,
+                                                             size_t num_scores,
+                                                             float cutoff) {
+    size_t elem_count = 0;
+    const __m256 cutoff_x8 = _mm256_set1_ps(cutoff);
+    // Ordered comparison, so NaNs aren't counted, as in the scalar version.
+    for (size_t i = num_scores / 8; i; --i) {
+        const __m256 comparisons_x8 =
+                _mm256_cmp_ps(_mm256_loadu_ps(score_ptr), cutoff_x8, _CMP_GE_OQ);
+        elem_count += __builtin_popcount(_mm256_movemask_ps(comparisons_x8));
+        score_ptr += 8;
+    }
+    for (size_t i = num_scores % 8; i; --i) {
+        if (*score_ptr >= cutoff) {
+            ++elem_count;
+        }
+        ++score_ptr;
+    }
+    return elem_count;
+}
+#endif
+
 }  // anonymous namespace
 
 namespace dorado::basecall::decode {
@@ -153,11 +253,13 @@ float beam_search(const T* const scores,
     // Each existing element can be extended by one of NUM_BASES, or be a stay.
     size_t max_beam_candidates = (NUM_BASES + 1) * max_beam_width;
 
-    std::vector<BeamFrontElement> current_beam_front(max_beam_candidates);
-    std::vector<BeamFrontElement> prev_beam_front(max_beam_candidates);
+    BeamFront current_beam_front(max_beam_candidates);
+    BeamFront prev_beam_front(max_beam_width);
 
-    std::vector<float> current_scores(max_beam_candidates);
-    std::vector<float> prev_scores(max_beam_candidates);
+    // Chained hash table over the step candidates, keyed by sequence hash, used to find
+    // steps that duplicate a stay.  Each chain is in increasing candidate index order.
+    std::vector<int> step_hash_heads;
+    std::vector<int> step_hash_next(NUM_BASES * max_beam_width);
 
     // Find the score an initial element needs in order to make it into the beam
     T beam_init_threshold = std::numeric_limits<T>::lowest();
@@ -178,9 +280,11 @@ float beam_search(const T* const scores,
          state++) {
         if (back_guide[state] >= beam_init_threshold) {
             // Note that this first element has a prev_element_index of 0
-            prev_beam_front[beam_element] = {crc32c<32>(CRC_SEED, uint32_t(state)),
-                                             static_cast<state_t>(state), 0, false};
-            prev_scores[beam_element] = 0.0f;
+            prev_beam_front.hashes[beam_element] = crc32c<32>(CRC_SEED, uint32_t(state));
+            prev_beam_front.states[beam_element] = static_cast<state_t>(state);
+            prev_beam_front.prev_element_indices[beam_element] = 0;
+            prev_beam_front.stays[beam_element] = false;
+            prev_beam_front.scores[beam_element] = 0.0f;
             ++beam_element;
         }
     }
@@ -188,10 +292,10 @@ float beam_search(const T* const scores,
     // Copy this initial beam front into the beam persistent state
     size_t current_beam_width = std::min(max_beam_width, num_states);
     for (size_t element_idx = 0; element_idx < current_beam_width; ++element_idx) {
-        beam_vector[element_idx].state = prev_beam_front[element_idx].state;
+        beam_vector[element_idx].state = prev_beam_front.states[element_idx];
         beam_vector[element_idx].prev_element_index =
-                (prev_beam_front)[element_idx].prev_element_index;
-        beam_vector[element_idx].stay = prev_beam_front[element_idx].stay;
+                prev_beam_front.prev_element_indices[element_idx];
+        beam_vector[element_idx].stay = prev_beam_front.stays[element_idx];
     }
 
     // Iterate through blocks, extending beam
@@ -220,84 +324,96 @@ float beam_search(const T* const scores,
 
         float max_score = std::numeric_limits<float>::lowest();
 
-        // Essentially a k=1 Bloom filter, indicating the presence of steps with particular
-        // sequence hashes.  Avoids comparing stay hashes against all possible progenitor
-        // states where none of them has the requisite sequence hash.
-        const uint32_t HASH_PRESENT_BITS = 4096;
-        const uint32_t HASH_PRESENT_MASK = HASH_PRESENT_BITS - 1;
-        std::bitset<HASH_PRESENT_BITS> step_hash_present;  // Default constructor zeros content.
-
         // Generate list of candidate elements for this timestep (block).
         // As we do so, update the maximum score.
-        size_t new_elem_count = 0;
+        // Step candidates come first, at index (prev_elem_idx << NUM_BASE_BITS) | new_base.
+        const size_t num_steps = current_beam_width << NUM_BASE_BITS;
         for (size_t prev_elem_idx = 0; prev_elem_idx < current_beam_width; ++prev_elem_idx) {
-            const auto& previous_element = prev_beam_front[prev_elem_idx];
+            const state_t prev_state = prev_beam_front.states[prev_elem_idx];
+            const uint32_t prev_hash = prev_beam_front.hashes[prev_elem_idx];
+            const float prev_score = prev_beam_front.scores[prev_elem_idx];
+            const auto shifted_state = state_t((prev_state << NUM_BASE_BITS) & states_mask);
+            const int removed_base = (prev_state << NUM_BASE_BITS) >> num_state_bits;
 
             // Expand all the possible steps
             for (int new_base = 0; new_base < NUM_BASES; new_base++) {
-                state_t new_state =
-                        (state_t((previous_element.state << NUM_BASE_BITS) & states_mask) |
-                         state_t(new_base));
-                const auto move_idx = static_cast<state_t>(
-                        (new_state << NUM_BASE_BITS) +
-                        (((previous_element.state << NUM_BASE_BITS) >> num_state_bits)));
-                float new_score = prev_scores[prev_elem_idx] + fetch_block_score(move_idx) +
+                const auto new_state = state_t(shifted_state | state_t(new_base));
+                const auto move_idx =
+                        static_cast<state_t>((new_state << NUM_BASE_BITS) + removed_base);
+                float new_score = prev_score + fetch_block_score(move_idx) +
                                   static_cast<float>(block_back_scores[new_state]);
-                uint32_t new_hash = crc32c<NUM_BASE_BITS>(previous_element.hash, new_base);
-
-                step_hash_present[new_hash & HASH_PRESENT_MASK] = true;
 
                 // Add new element to the candidate list
-                current_beam_front[new_elem_count] = {new_hash, new_state, (uint8_t)prev_elem_idx,
-                                                      false};
-                current_scores[new_elem_count] = new_score;
+                const size_t new_elem_idx = (prev_elem_idx << NUM_BASE_BITS) | new_base;
+                current_beam_front.hashes[new_elem_idx] = crc32c_base(prev_hash, new_base);
+                current_beam_front.states[new_elem_idx] = new_state;
+                current_beam_front.prev_element_indices[new_elem_idx] = uint8_t(prev_elem_idx);
+                current_beam_front.stays[new_elem_idx] = false;
+                current_beam_front.scores[new_elem_idx] = new_score;
                 max_score = std::max(max_score, new_score);
-                ++new_elem_count;
             }
         }
 
+        // Index the steps by hash.  Using at least twice as many buckets as steps keeps
+        // chains short, so a stay with no duplicate step usually finds an empty bucket.
+        size_t num_hash_buckets = 2;
+        while (num_hash_buckets < 2 * num_steps) {
+            num_hash_buckets *= 2;
+        }
+        const uint32_t hash_bucket_mask = uint32_t(num_hash_buckets - 1);
+        step_hash_heads.assign(num_hash_buckets, -1);
+        for (size_t step_elem_idx = num_steps; step_elem_idx != 0; --step_elem_idx) {
+            const uint32_t bucket =
+                    current_beam_front.hashes[step_elem_idx - 1] & hash_bucket_mask;
+            step_hash_next[step_elem_idx - 1] = step_hash_heads[bucket];
+            step_hash_heads[bucket] = int(step_elem_idx - 1);
+        }
+
+        size_t new_elem_count = num_steps;
+        auto& current_scores = current_beam_front.scores;
         for (size_t prev_elem_idx = 0; prev_elem_idx < current_beam_width; ++prev_elem_idx) {
-            const auto& previous_element = prev_beam_front[prev_elem_idx];
+            const state_t prev_state = prev_beam_front.states[prev_elem_idx];
+            const uint32_t prev_hash = prev_beam_front.hashes[prev_elem_idx];
             // Add the possible stay.
-            const float stay_score = prev_scores[prev_elem_idx] + fixed_stay_score +
-                                     static_cast<float>(block_back_scores[previous_element.state]);
-            current_beam_front[new_elem_count] = {previous_element.hash, previous_element.state,
-                                                  (uint8_t)prev_elem_idx, true};
-            current_scores[new_elem_count] = stay_score;
+            const float stay_score = prev_beam_front.scores[prev_elem_idx] + fixed_stay_score +
+                                     static_cast<float>(block_back_scores[prev_state]);
+            const size_t stay_elem_idx = new_elem_count;
+            current_beam_front.hashes[stay_elem_idx] = prev_hash;
+            current_beam_front.states[stay_elem_idx] = prev_state;
+            current_beam_front.prev_element_indices[stay_elem_idx] = uint8_t(prev_elem_idx);
+            current_beam_front.stays[stay_elem_idx] = true;
+            current_scores[stay_elem_idx] = stay_score;
             max_score = std::max(max_score, stay_score);
 
             // Determine whether the path including this stay duplicates another sequence ending in
             // a step.
-            if (step_hash_present[previous_element.hash & HASH_PRESENT_MASK]) {
-                size_t stay_elem_idx = (current_beam_width << NUM_BASE_BITS) + prev_elem_idx;
-                // latest base is in smallest bits
-                int stay_latest_base = int(previous_element.state & 3);
-
-                // Go through all the possible step extensions that match this destination base with the stay and compare
-                // their hashes, merging if we find any.
-                for (size_t prev_elem_comp_idx = 0; prev_elem_comp_idx < current_beam_width;
-                     prev_elem_comp_idx++) {
-                    size_t step_elem_idx = (prev_elem_comp_idx << NUM_BASE_BITS) | stay_latest_base;
-                    if (current_beam_front[stay_elem_idx].hash ==
-                        current_beam_front[step_elem_idx].hash) {
-                        if (current_scores[stay_elem_idx] > current_scores[step_elem_idx]) {
-                            // Fold the step into the stay
-                            const float folded_score = log_sum_exp(current_scores[stay_elem_idx],
-                                                                   current_scores[step_elem_idx]);
-                            current_scores[stay_elem_idx] = folded_score;
-                            max_score = std::max(max_score, folded_score);
-                            // The step element will end up last, sorted by score
-                            current_scores[step_elem_idx] = std::numeric_limits<float>::lowest();
-                        } else {
-                            // Fold the stay into the step
-                            const float folded_score = log_sum_exp(current_scores[stay_elem_idx],
-                                                                   current_scores[step_elem_idx]);
-                            current_scores[step_elem_idx] = folded_score;
-                            max_score = std::max(max_score, folded_score);
-                            // The stay element will end up last, sorted by score
-                            current_scores[stay_elem_idx] = std::numeric_limits<float>::lowest();
-                        }
-                    }
+            // latest base is in smallest bits
+            const size_t stay_latest_base = prev_state & 3;
+
+            // Go through the step extensions with a matching hash, in candidate order, and merge
+            // those that have the same destination base as the stay.
+            for (int step_elem_idx = step_hash_heads[prev_hash & hash_bucket_mask];
+                 step_elem_idx >= 0; step_elem_idx = step_hash_next[step_elem_idx]) {
+                if ((size_t(step_elem_idx) & (NUM_BASES - 1)) != stay_latest_base ||
+                    current_beam_front.hashes[step_elem_idx] != prev_hash) {
+                    continue;
+                }
+                if (current_scores[stay_elem_idx] > current_scores[step_elem_idx]) {
+                    // Fold the step into the stay
+                    const float folded_score = log_sum_exp(current_scores[stay_elem_idx],
+                                                           current_scores[step_elem_idx]);
+                    current_scores[stay_elem_idx] = folded_score;
+                    max_score = std::max(max_score, folded_score);
+                    // The step element will end up last, sorted by score
+                    current_scores[step_elem_idx] = std::numeric_limits<float>::lowest();
+                } else {
+                    // Fold the stay into the step
+                    const float folded_score = log_sum_exp(current_scores[stay_elem_idx],
+                                                           current_scores[step_elem_idx]);
+                    current_scores[step_elem_idx] = folded_score;
+                    max_score = std::max(max_score, folded_score);
+                    // The stay element will end up last, sorted by score
+                    current_scores[stay_elem_idx] = std::numeric_limits<float>::lowest();
                 }
             }
 
@@ -309,46 +425,8 @@ float beam_search(const T* const scores,
 
         auto get_elem_count = [new_elem_count, &beam_cutoff_score, &current_scores]() {
             // Count the elements which meet the beam cutoff.
-            size_t elem_count = 0;
-            const float* score_ptr = current_scores.data();
-#if !ENABLE_NEON_IMPL
-            for (int i = int(new_elem_count); i; --i) {
-                if (*score_ptr >= beam_cutoff_score) {
-                    ++elem_count;
-                }
-                ++score_ptr;
-            }
-#else
-            uint32x4_t counts_x4_a = vdupq_n_u32(0u);
-            uint32x4_t counts_x4_b = vdupq_n_u32(0u);
-            const float32x4_t cutoff_x4 = vdupq_n_f32(beam_cutoff_score);
-
-            // 8 fold unrolled version has the small upside that both loads
-            // can be done with a single ldp instruction.
-            const int kUnroll = 8;
-            for (int i = int(new_elem_count) / kUnroll; i; --i) {
-                // True comparison sets lane bits to 0xffffffff, or -1 in two's complement,
-                // which we subtract to increment our counts.
-                float32x4_t scores_x4_a = vld1q_f32(score_ptr);
-                uint32x4_t comparisons_x4_a = vcgeq_f32(scores_x4_a, cutoff_x4);
-                counts_x4_a = vsubq_u32(counts_x4_a, comparisons_x4_a);
-
-                float32x4_t scores_x4_b = vld1q_f32(score_ptr + 4);
-                uint32x4_t comparisons_x4_b = vcgeq_f32(scores_x4_b, cutoff_x4);
-                counts_x4_b = vsubq_u32(counts_x4_b, comparisons_x4_b);
-
-                score_ptr += 8;
-            }
-            // Add together the result of 2 horizontal adds.
-            elem_count = vaddvq_u32(counts_x4_a) + vaddvq_u32(counts_x4_b);
-            for (int i = new_elem_count % kUnroll; i; --i) {
-                if (*score_ptr >= beam_cutoff_score) {
-                    ++elem_count;
-                }
-                ++score_ptr;
-            }
-#endif
-            return elem_count;
+            return count_scores_at_least(current_scores.data(), new_elem_count,
+                                         beam_cutoff_score);
         };
 
         // Count the elements which meet the min score
@@ -392,16 +470,18 @@ float beam_search(const T* const scores,
             elem_count = std::min(elem_count, max_beam_width);
         }
 
+        // Keep the first candidates which meet the cutoff, up to max_beam_width of them.
         size_t write_idx = 0;
-        for (size_t read_idx = 0; read_idx < new_elem_count; ++read_idx) {
+        for (size_t read_idx = 0; read_idx < new_elem_count && write_idx < max_beam_width;
+             ++read_idx) {
             if (current_scores[read_idx] >= beam_cutoff_score) {
-                if (write_idx < max_beam_width) {
-                    prev_beam_front[write_idx] = current_beam_front[read_idx];
-                    prev_scores[write_idx] = current_scores[read_idx];
-                    ++write_idx;
-                } else {
-                    break;
-                }
+                prev_beam_front.hashes[write_idx] = current_beam_front.hashes[read_idx];
+                prev_beam_front.states[write_idx] = current_beam_front.states[read_idx];
+                prev_beam_front.prev_element_indices[write_idx] =
+                        current_beam_front.prev_element_indices[read_idx];
+                prev_beam_front.stays[write_idx] = current_beam_front.stays[read_idx];
+                prev_beam_front.scores[write_idx] = current_scores[read_idx];
+                ++write_idx;
             }
         }
 
@@ -411,31 +491,31 @@ float beam_search(const T* const scores,
             float best_score = std::numeric_limits<float>::lowest();
             size_t best_score_index = 0;
             for (size_t i = 0; i < elem_count; i++) {
-                if (prev_scores[i] > best_score) {
-                    best_score = prev_scores[i];
+                if (prev_beam_front.scores[i] > best_score) {
+                    best_score = prev_beam_front.scores[i];
                     best_score_index = i;
                 }
             }
-            std::swap(prev_beam_front[0], prev_beam_front[best_score_index]);
-            std::swap(prev_scores[0], prev_scores[best_score_index]);
+            prev_beam_front.swap_elements(0, best_score_index);
         }
 
         size_t beam_offset = (block_idx + 1) * max_beam_width;
         for (size_t i = 0; i < elem_count; ++i) {
             // Remove backwards contribution from score
-            prev_scores[i] -= float(block_back_scores[prev_beam_front[i].state]);
+            prev_beam_front.scores[i] -= float(block_back_scores[prev_beam_front.states[i]]);
 
             // Copy this new beam front into the beam persistent state
-            beam_vector[beam_offset + i].state = prev_beam_front[i].state;
-            beam_vector[beam_offset + i].prev_element_index = prev_beam_front[i].prev_element_index;
-            beam_vector[beam_offset + i].stay = prev_beam_front[i].stay;
+            beam_vector[beam_offset + i].state = prev_beam_front.states[i];
+            beam_vector[beam_offset + i].prev_element_index =
+                    prev_beam_front.prev_element_indices[i];
+            beam_vector[beam_offset + i].stay = prev_beam_front.stays[i];
         }
 
         current_beam_width = elem_count;
     }
 
     // Extract final score
-    const float final_score = prev_scores[0];
+    const float final_score = prev_beam_front.scores[0];
 
     // Write out sequence bases and move table
     moves.resize(num_blocks);
@@ -0,0 +1,450 @@
+#include "forward_backward.h"
+
+#include "utils/simd.h"
+
+#include <ATen/ATen.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+namespace {
+
+constexpr int kNumBases = 4;
+
+// Matches at::logsumexp, which substitutes 0 for an infinite maximum.
+inline float logsumexp5(float x0, float x1, float x2, float x3, float x4) {
+    float max_val = std::max({x0, x1, x2, x3, x4});
+    if (std::isinf(max_val)) {
+        max_val = 0.0f;
+    }
+    const float sum = std::exp(x0 - max_val) + std::exp(x1 - max_val) + std::exp(x2 - max_val) +
+                      std::exp(x3 - max_val) + std::exp(x4 - max_val);
+    return std::log(sum) + max_val;
+}
+
+// One forward timestep for states [state_begin, num_states).
+// State s can be reached by staying in s, or by stepping from any of the 4 states
+// (s >> 2) + k * num_states / 4, with transition score m[s * 4 + k].
+inline void forward_step_scalar(const float* prev,
+                                const float* m,
+                                float* next,
+                                int state_begin,
+                                int num_states,
+                                float fixed_stay_score) {
+    const int quarter = num_states / kNumBases;
+    for (int s = state_begin; s < num_states; ++s) {
+        const int base = s >> 2;
+        next[s] = logsumexp5(prev[s] + fixed_stay_score, prev[base] + m[s * 4],
+                             prev[base + quarter] + m[s * 4 + 1],
+                             prev[base + 2 * quarter] + m[s * 4 + 2],
+                             prev[base + 3 * quarter] + m[s * 4 + 3]);
+    }
+}
+
+// One backward timestep for states [state_begin, num_states).
+// State v steps to the 4 states 4 * (v % (num_states / 4)) + j, via the transition with
+// index v / (num_states / 4) among each successor's 4 incoming transitions.
+inline void backward_step_scalar(const float* next,
+                                 const float* m,
+                                 float* prev,
+                                 int state_begin,
+                                 int num_states,
+                                 float fixed_stay_score) {
+    const int quarter = num_states / kNumBases;
+    for (int v = state_begin; v < num_states; ++v) {
+        const int k = v / quarter;
+        const int succ = (v % quarter) * 4;
+        prev[v] = logsumexp5(next[v] + fixed_stay_score, next[succ] + m[succ * 4 + k],
+                             next[succ + 1] + m[(succ + 1) * 4 + k],
+                             next[succ + 2] + m[(succ + 2) * 4 + k],
+                             next[succ + 3] + m[(succ + 3) * 4 + k]);
+    }
+}
+
+#if ENABLE_AVX2_IMPL
+__attribute__((target("default")))
+#endif
+void forward_scan_impl(const float* scores,
+                       size_t score_stride,
+                       int T,
+                       int num_states,
+                       float fixed_stay_score,
+                       float* out,
+                       size_t out_stride) {
+    for (int t = 0; t < T; ++t) {
+        forward_step_scalar(out + t * out_stride, scores + t * score_stride,
+                            out + (t + 1) * out_stride, 0, num_states, fixed_stay_score);
+    }
+}
+
+#if ENABLE_AVX2_IMPL
+__attribute__((target("default")))
+#endif
+void backward_scan_impl(const float* scores,
+                        size_t score_stride,
+                        int T,
+                        int num_states,
+                        float fixed_stay_score,
+                        float* out,
+                        size_t out_stride) {
+    for (int t = T - 1; t >= 0; --t) {
+        backward_step_scalar(out + (t + 1) * out_stride, scores + t * score_stride,
+                             out + t * out_stride, 0, num_states, fixed_stay_score);
+    }
+}
+
+#if ENABLE_AVX2_IMPL
+
+// exp and log after Cephes, as used in avx_mathfun.  Relative error is around 1e-7,
+// comparable to std::exp/std::log in single precision.
+__attribute__((target("avx2"))) inline __m256 exp_avx2(__m256 x) {
+    const __m256 kOne = _mm256_set1_ps(1.0f);
+    x = _mm256_min_ps(x, _mm256_set1_ps(88.3762626647949f));
+    x = _mm256_max_ps(x, _mm256_set1_ps(-87.3365478515625f));
+
+    // exp(x) = 2^n * exp(r), with n = round(x / ln(2)).
+    __m256 n = _mm256_round_ps(_mm256_mul_ps(x, _mm256_set1_ps(1.44269504088896341f)),
+                               _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+    x = _mm256_sub_ps(x, _mm256_mul_ps(n, _mm256_set1_ps(0.693359375f)));
+    x = _mm256_sub_ps(x, _mm256_mul_ps(n, _mm256_set1_ps(-2.12194440e-4f)));
+
+    __m256 y = _mm256_set1_ps(1.9875691500E-4f);
+    y = _mm256_add_ps(_mm256_mul_ps(y, x), _mm256_set1_ps(1.3981999507E-3f));
+    y = _mm256_add_ps(_mm256_mul_ps(y, x), _mm256_set1_ps(8.3334519073E-3f));
+    y = _mm256_add_ps(_mm256_mul_ps(y, x), _mm256_set1_ps(4.1665795894E-2f));
+    y = _mm256_add_ps(_mm256_mul_ps(y, x), _mm256_set1_ps(1.6666665459E-1f));
+    y = _mm256_add_ps(_mm256_mul_ps(y, x), _mm256_set1_ps(5.0000001201E-1f));
+    y = _mm256_add_ps(_mm256_mul_ps(y, _mm256_mul_ps(x, x)), _mm256_add_ps(x, kOne));
+
+    // Build 2^n directly in the exponent bits.
+    const __m256i pow2n = _mm256_slli_epi32(
+            _mm256_add_epi32(_mm256_cvtps_epi32(n), _mm256_set1_epi32(0x7f)), 23);
+    return _mm256_mul_ps(y, _mm256_castsi256_ps(pow2n));
+}
+
+// Only valid for finite x > 0, which holds for the sums of exponentials we take logs of.
+__attribute__((target("avx2"))) inline __m256 log_avx2(__m256 x) {
+    const __m256 kOne = _mm256_set1_ps(1.0f);
+    const __m256i exponent_bits = _mm256_srli_epi32(_mm256_castps_si256(x), 23);
+    __m256 e = _mm256_cvtepi32_ps(_mm256_sub_epi32(exponent_bits, _mm256_set1_epi32(0x7f)));
+    e = _mm256_add_ps(e, kOne);
+
+    // Mantissa in [0.5, 1).
+    x = _mm256_and_ps(x, _mm256_castsi256_ps(_mm256_set1_epi32(~0x7f800000)));
+    x = _mm256_or_ps(x, _mm256_set1_ps(0.5f));
+
+    // Shift the mantissa to [sqrt(0.5), sqrt(2)) for better polynomial accuracy.
+    const __m256 mask = _mm256_cmp_ps(x, _mm256_set1_ps(0.707106781186547524f), _CMP_LT_OS);
+    const __m256 tmp = _mm256_and_ps(x, mask);
+    x = _mm256_sub_ps(x, kOne);
+    e = _mm256_sub_ps(e, _mm256_and_ps(kOne, mask));
+    x = _mm256_add_ps(x, tmp);
+
+    const __m256 z = _mm256_mul_ps(x, x);
+    __m256 y = _mm256_set1_ps(7.0376836292E-2f);
+    y = _mm256_add_ps(_mm256_mul_ps(y, x), _mm256_set1_ps(-1.1514610310E-1f));
+    y = _mm256_add_ps(_mm256_mul_ps(y, x), _mm256_set1_ps(1.1676998740E-1f));
+    y = _mm256_add_ps(_mm256_mul_ps(y, x), _mm256_set1_ps(-1.2420140846E-1f));
+    y = _mm256_add_ps(_mm256_mul_ps(y, x), _mm256_set1_ps(1.4249322787E-1f));
+    y = _mm256_add_ps(_mm256_mul_ps(y, x), _mm256_set1_ps(-1.6668057665E-1f));
+    y = _mm256_add_ps(_mm256_mul_ps(y, x), _mm256_set1_ps(2.0000714765E-1f));
+    y = _mm256_add_ps(_mm256_mul_ps(y, x), _mm256_set1_ps(-2.4999993993E-1f));
+    y = _mm256_add_ps(_mm256_mul_ps(y, x), _mm256_set1_ps(3.3333331174E-1f));
+    y = _mm256_mul_ps(_mm256_mul_ps(y, x), z);
+
+    y = _mm256_add_ps(y, _mm256_mul_ps(e, _mm256_set1_ps(-2.12194440e-4f)));
+    y = _mm256_sub_ps(y, _mm256_mul_ps(z, _mm256_set1_ps(0.5f)));
+    x = _mm256_add_ps(x, y);
+    return _mm256_add_ps(x, _mm256_mul_ps(e, _mm256_set1_ps(0.693359375f)));
+}
+
+__attribute__((target("avx2"))) inline __m256 logsumexp5_avx2(__m256 x0,
+                                                              __m256 x1,
+                                                              __m256 x2,
+                                                              __m256 x3,
+                                                              __m256 x4) {
+    __m256 max_val = _mm256_max_ps(_mm256_max_ps(x0, x1), _mm256_max_ps(x2, x3));
+    max_val = _mm256_max_ps(max_val, x4);
+    // As in the scalar version, replace infinite maxima with 0.
+    const __m256 abs_max = _mm256_andnot_ps(_mm256_set1_ps(-0.0f), max_val);
+    const __m256 is_inf = _mm256_cmp_ps(abs_max, _mm256_set1_ps(INFINITY), _CMP_EQ_OQ);
+    max_val = _mm256_andnot_ps(is_inf, max_val);
+
+    __m256 sum = exp_avx2(_mm256_sub_ps(x0, max_val));
+    sum = _mm256_add_ps(sum, exp_avx2(_mm256_sub_ps(x1, max_val)));
+    sum = _mm256_add_ps(sum, exp_avx2(_mm256_sub_ps(x2, max_val)));
+    sum = _mm256_add_ps(sum, exp_avx2(_mm256_sub_ps(x3, max_val)));
+    sum = _mm256_add_ps(sum, exp_avx2(_mm256_sub_ps(x4, max_val)));
+    return _mm256_add_ps(log_avx2(sum), max_val);
+}
+
+// Loads 32 floats holding 4 values for each of 8 consecutive states, and transposes them
+// so that out[k] holds value k for each state.  The lanes of out are in state order
+// 0, 2, 4, 6, 1, 3, 5, 7, which is what falls out of the in-lane shuffles.
+__attribute__((target("avx2"))) inline void load_transpose_8x4(const float* src, __m256 out[4]) {
+    const __m256 v0 = _mm256_loadu_ps(src);
+    const __m256 v1 = _mm256_loadu_ps(src + 8);
+    const __m256 v2 = _mm256_loadu_ps(src + 16);
+    const __m256 v3 = _mm256_loadu_ps(src + 24);
+    const __m256 t0 = _mm256_unpacklo_ps(v0, v1);
+    const __m256 t1 = _mm256_unpacklo_ps(v2, v3);
+    const __m256 t2 = _mm256_unpackhi_ps(v0, v1);
+    const __m256 t3 = _mm256_unpackhi_ps(v2, v3);
+    out[0] = _mm256_shuffle_ps(t0, t1, 0x44);
+    out[1] = _mm256_shuffle_ps(t0, t1, 0xEE);
+    out[2] = _mm256_shuffle_ps(t2, t3, 0x44);
+    out[3] = _mm256_shuffle_ps(t2, t3, 0xEE);
+}
+
+// Permutations between natural state order and the order produced by load_transpose_8x4.
+__attribute__((target("avx2"))) inline __m256i transposed_lane_order() {
+    return _mm256_setr_epi32(0, 2, 4, 6, 1, 3, 5, 7);
+}
+__attribute__((target("avx2"))) inline __m256i natural_lane_order() {
+    return _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+}
+
+// Processes 8 states per iteration.  Each timestep's input row and transition scores are
+// only num_states and 4 * num_states floats, so for each chunk the whole scan runs out
+// of L1/L2 cache; chunks are scanned one at a time to keep it that way.
+__attribute__((target("avx2"))) void forward_scan_impl(const float* scores,
+                                                       size_t score_stride,
+                                                       int T,
+                                                       int num_states,
+                                                       float fixed_stay_score,
+                                                       float* out,
+                                                       size_t out_stride) {
+    const int quarter = num_states / kNumBases;
+    const int vector_states = num_states - num_states % 8;
+    const __m256 stay = _mm256_set1_ps(fixed_stay_score);
+    const __m256i to_transposed = transposed_lane_order();
+    const __m256i to_natural = natural_lane_order();
+    // For states s0 + {0, 2, 4, 6, 1, 3, 5, 7}, (s >> 2) - (s0 >> 2).
+    const __m256i pred_offsets = _mm256_setr_epi32(0, 0, 1, 1, 0, 0, 1, 1);
+
+    for (int t = 0; t < T; ++t) {
+        const float* prev = out + t * out_stride;
+        const float* m = scores + t * score_stride;
+        float* next = out + (t + 1) * out_stride;
+
+        for (int s0 = 0; s0 < vector_states; s0 += 8) {
+            __m256 steps[4];
+            load_transpose_8x4(m + s0 * 4, steps);
+            const __m256 stay_score = _mm256_add_ps(
+                    _mm256_permutevar8x32_ps(_mm256_loadu_ps(prev + s0), to_transposed), stay);
+            for (int k = 0; k < kNumBases; ++k) {
+                // The 8 states share 2 predecessors for each k.
+                const float* pred = prev + (s0 >> 2) + k * quarter;
+                const __m256 pred_pair = _mm256_castps128_ps256(
+                        _mm_castsi128_ps(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(pred))));
+                steps[k] = _mm256_add_ps(steps[k],
+                                         _mm256_permutevar8x32_ps(pred_pair, pred_offsets));
+            }
+            const __m256 result =
+                    logsumexp5_avx2(stay_score, steps[0], steps[1], steps[2], steps[3]);
+            _mm256_storeu_ps(next + s0, _mm256_permutevar8x32_ps(result, to_natural));
+        }
+        forward_step_scalar(prev, m, next, vector_states, num_states, fixed_stay_score);
+    }
+}
+
+__attribute__((target("avx2"))) void backward_scan_impl(const float* scores,
+                                                        size_t score_stride,
+                                                        int T,
+                                                        int num_states,
+                                                        float fixed_stay_score,
+                                                        float* out,
+                                                        size_t out_stride) {
+    const int quarter = num_states / kNumBases;
+    // Groups of 8 states must share a transition index k, so quarter must be a multiple
+    // of 8.  This holds for all state lengths >= 3.
+    const int vector_states = (quarter % 8 == 0) ? num_states : 0;
+    const __m256 stay = _mm256_set1_ps(fixed_stay_score);
+    const __m256i to_transposed = transposed_lane_order();
+    const __m256i to_natural = natural_lane_order();
+    // Offsets of successor transition scores for states v0 + {0, 2, 4, 6, 1, 3, 5, 7}:
+    // each state's successors are 4 states (16 scores) further on.
+    const __m256i succ_score_offsets = _mm256_setr_epi32(0, 32, 64, 96, 16, 48, 80, 112);
+
+    for (int t = T - 1; t >= 0; --t) {
+        const float* next = out + (t + 1) * out_stride;
+        const float* m = scores + t * score_stride;
+        float* prev = out + t * out_stride;
+
+        for (int v0 = 0; v0 < vector_states; v0 += 8) {
+            const int k = v0 / quarter;
+            const int succ0 = (v0 % quarter) * 4;
+            __m256 steps[4];
+            load_transpose_8x4(next + succ0, steps);
+            const float* succ_scores = m + succ0 * 4 + k;
+            for (int j = 0; j < kNumBases; ++j) {
+                const __m256 transition = _mm256_i32gather_ps(succ_scores + j * 4,
+                                                              succ_score_offsets, sizeof(float));
+                steps[j] = _mm256_add_ps(steps[j], transition);
+            }
+            const __m256 stay_score = _mm256_add_ps(
+                    _mm256_permutevar8x32_ps(_mm256_loadu_ps(next + v0), to_transposed), stay);
+            const __m256 result =
+                    logsumexp5_avx2(stay_score, steps[0], steps[1], steps[2], steps[3]);
+            _mm256_storeu_ps(prev + v0, _mm256_permutevar8x32_ps(result, to_natural));
+        }
+        backward_step_scalar(next, m, prev, vector_states, num_states, fixed_stay_score);
+    }
+}
+
+#endif
+
+int num_states_from_scores(const at::Tensor& scores) {
+    const int C = int(scores.size(2));  // 4^state_len * 4 = 4^(state_len + 1)
+    assert(C % kNumBases == 0);
+    return C / kNumBases;
+}
+
+enum class ScanDirection { Forward, Backward };
+
+at::Tensor scan_scores(const at::Tensor& scores_in,
+                       float fixed_stay_score,
+                       ScanDirection direction) {
+    // The kernels need unit stride along C, but chunk and time strides are free.
+    auto scores = scores_in.to(at::kFloat);
+    if (scores.stride(2) != 1) {
+        scores = scores.contiguous();
+    }
+    const int T = int(scores.size(0));
+    const int N = int(scores.size(1));
+    const int num_states = num_states_from_scores(scores);
+
+    auto result = at::empty({T + 1, N, num_states}, scores.options());
+    const float* scores_ptr = scores.data_ptr<float>();
+    float* result_ptr = result.data_ptr<float>();
+    const size_t score_stride = scores.stride(0);
+    const size_t result_stride = size_t(N) * num_states;
+
+    for (int n = 0; n < N; ++n) {
+        const float* chunk_scores = scores_ptr + n * scores.stride(1);
+        float* chunk_result = result_ptr + size_t(n) * num_states;
+        if (direction == ScanDirection::Forward) {
+            // Guide values at first timestep.
+            std::fill_n(chunk_result, num_states, 0.0f);
+            forward_scan_impl(chunk_scores, score_stride, T, num_states, fixed_stay_score,
+                              chunk_result, result_stride);
+        } else {
+            // Guide values at last timestep.
+            std::fill_n(chunk_result + T * result_stride, num_states, 0.0f);
+            backward_scan_impl(chunk_scores, score_stride, T, num_states, fixed_stay_score,
+                               chunk_result, result_stride);
+        }
+    }
+    return result;
+}
+
+at::Tensor scan_aten(const at::Tensor& Ms,
+                     const float fixed_stay_score,
+                     const at::Tensor& idx,
+                     const at::Tensor& v0) {
+    const int T = int(Ms.size(0));
+    const int N = int(Ms.size(1));
+    const int C = int(Ms.size(2));
+
+    at::Tensor alpha = Ms.new_full({T + 1, N, C}, -1E38);
+    alpha[0] = v0;
+
+    for (int t = 0; t < T; t++) {
+        auto scored_steps = at::add(alpha.index({t, at::indexing::Slice(), idx}), Ms[t]);
+        auto scored_stay =
+                at::add(alpha.index({t, at::indexing::Slice()}), fixed_stay_score).unsqueeze(-1);
+        auto scored_transitions = at::cat({scored_stay, scored_steps}, -1);
+
+        alpha[t + 1] = at::logsumexp(scored_transitions, -1);
+    }
+
+    return alpha;
+}
+
+}  // namespace
+
+namespace dorado::basecall::decode {
+
+void forward_scan(const float* scores,
+                  size_t score_stride,
+                  int T,
+                  int num_states,
+                  float fixed_stay_score,
+                  float* out,
+                  size_t out_stride) {
+    std::fill_n(out, num_states, 0.0f);
+    forward_scan_impl(scores, score_stride, T, num_states, fixed_stay_score, out, out_stride);
+}
+
+void backward_scan(const float* scores,
+                   size_t score_stride,
+                   int T,
+                   int num_states,
+                   float fixed_stay_score,
+                   float* out,
+                   size_t out_stride) {
+    std::fill_n(out + T * out_stride, num_states, 0.0f);
+    backward_scan_impl(scores, score_stride, T, num_states, fixed_stay_score, out, out_stride);
+}
+
+at::Tensor forward_scores(const at::Tensor& scores, const float fixed_stay_score) {
+    return scan_scores(scores, fixed_stay_score, ScanDirection::Forward);
+}
+
+at::Tensor backward_scores(const at::Tensor& scores, const float fixed_stay_score) {
+    return scan_scores(scores, fixed_stay_score, ScanDirection::Backward);
+}
+
+at::Tensor forward_scores_aten(const at::Tensor& scores, const float fixed_stay_score) {
+    const int T = int(scores.size(0));  // Signal len
+    const int N = int(scores.size(1));  // Num batches
+    const int C = int(scores.size(2));  // 4^state_len * 4 = 4^(state_len + 1)
+
+    const int n_base = 4;
+    const int state_len = int(std::log(C) / std::log(n_base) - 1);
+
+    // Transition scores reshaped so that the 4 scores for each predecessor state are arranged along the
+    // innermost dimension.
+    const at::Tensor Ms = scores.reshape({T, N, -1, n_base});
+
+    // Number of states per timestep.
+    const int num_states = int(pow(n_base, state_len));
+
+    // Guide values at first timestep.
+    const auto v0 = Ms.new_full({{N, num_states}}, 0.0f);
+
+    // For each state, the indices of the 4 states that could precede it via a step transition.
+    const auto idx =
+            at::arange(num_states).repeat_interleave(n_base).reshape({n_base, -1}).t().contiguous();
+
+    return scan_aten(Ms, fixed_stay_score, idx, v0);
+}
+
+at::Tensor backward_scores_aten(const at::Tensor& scores, const float fixed_stay_score) {
+    const int N = int(scores.size(1));  // Num batches
+    const int C = int(scores.size(2));  // 4^state_len * 4 = 4^(state_len + 1)
+
+    const int n_base = 4;
+
+    const int state_len = int(std::log(C) / std::log(n_base) - 1);
+
+    // Number of states per timestep.
+    const int num_states = int(pow(n_base, state_len));
+
+    // Guide values at last timestep.
+    const at::Tensor vT = scores.new_full({N, num_states}, 0.0f);
+
+    const auto idx =
+            at::arange(num_states).repeat_interleave(n_base).reshape({n_base, -1}).t().contiguous();
+    auto idx_T = idx.flatten().argsort().reshape(idx.sizes());
+
+    const auto Ms_T = scores.index({at::indexing::Slice(), at::indexing::Slice(), idx_T});
+
+    // For each state, the indices of the 4 states that could succeed it via a step transition.
+    idx_T = at::bitwise_right_shift(idx_T, 2);
+
+    return scan_aten(Ms_T.flip(0), fixed_stay_score, idx_T.to(at::kLong), vT).flip(0);
+}
+
+}  // namespace dorado::basecall::decode
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <ATen/core/TensorBody.h>
+
+#include <cstddef>
+
+namespace dorado::basecall::decode {
+
+// Forward and backward scans over CRF transition scores for CPU decoding.
+// scores is a [T, N, C] float tensor, where C = num_states * 4, and the result is a
+// [T + 1, N, num_states] tensor of forward (alpha) or backward (beta) log-space scores.
+at::Tensor forward_scores(const at::Tensor& scores, float fixed_stay_score);
+at::Tensor backward_scores(const at::Tensor& scores, float fixed_stay_score);
+
+// Equivalent implementations built from ATen ops, one set of ops per timestep.
+// These are much slower, and are kept as a reference for testing and benchmarking.
+at::Tensor forward_scores_aten(const at::Tensor& scores, float fixed_stay_score);
+at::Tensor backward_scores_aten(const at::Tensor& scores, float fixed_stay_score);
+
+// Kernels for a single chunk, operating on raw buffers.
+// scores points to the chunk's C scores for timestep 0, with successive timesteps
+// score_stride floats apart.  T + 1 rows of num_states results are written to out, with
+// successive rows out_stride floats apart.
+void forward_scan(const float* scores,
+                  size_t score_stride,
+                  int T,
+                  int num_states,
+                  float fixed_stay_score,
+                  float* out,
+                  size_t out_stride);
+void backward_scan(const float* scores,
+                   size_t score_stride,
+                   int T,
+                   int num_states,
+                   float fixed_stay_score,
+                   float* out,
+                   size_t out_stride);
+
+}  // namespace dorado::basecall::decode
@@ -14,6 +14,7 @@
 #include "read_pipeline/HtsWriter.h"
 #include "read_pipeline/PolyACalculator.h"
 #include "read_pipeline/ProgressTracker.h"
+#include "read_pipeline/ReadEndAnnotatorNode.h"
 #include "read_pipeline/ReadFilterNode.h"
 #include "read_pipeline/ReadToBamTypeNode.h"
 #include "read_pipeline/ResumeLoaderNode.h"
@@ -84,7 +85,11 @@ void setup(std::vector<std::string> args,
            const std::optional<std::string>& custom_seqs,
            argparse::ArgumentParser& resume_parser,
            bool estimate_poly_a,
-           const ModelSelection& model_selection) {
+           const ModelSelection& model_selection,
+           int barcode_prefilter_kmer_length,
+           int latency_target_ms,
+           size_t max_open_pod5_files,
+           size_t max_pod5_signal_bytes) {
     const auto model_config = basecall::load_crf_model_config(model_path);
     const std::string model_name = models::extract_model_name_from_path(model_path);
     const std::string modbase_model_names = models::extract_model_names_from_paths(remora_models);
@@ -165,13 +170,20 @@ void setup(std::vector<std::string> args,
                 {current_sink_node}, std::thread::hardware_concurrency(),
                 is_rna_model(model_config), 1000);
     }
-    if (barcode_enabled) {
+    if (barcode_enabled && adapter_trimming_enabled) {
+        // Look for adapters, primers and barcodes in one node, so reads are only trimmed once.
+        current_sink_node = pipeline_desc.add_node<ReadEndAnnotatorNode>(
+                {current_sink_node},
+                thread_allocations.barcoder_threads + thread_allocations.adapter_threads,
+                !adapter_no_trim, !primer_no_trim, barcode_kits, barcode_both_ends,
+                barcode_no_trim, std::move(allowed_barcodes), std::move(custom_kit),
+                std::move(custom_seqs), barcode_prefilter_kmer_length);
+    } else if (barcode_enabled) {
         current_sink_node = pipeline_desc.add_node<BarcodeClassifierNode>(
                 {current_sink_node}, thread_allocations.barcoder_threads, barcode_kits,
                 barcode_both_ends, barcode_no_trim, std::move(allowed_barcodes),
-                std::move(custom_kit), std::move(custom_seqs));
-    }
-    if (adapter_trimming_enabled) {
+                std::move(custom_kit), std::move(custom_seqs), barcode_prefilter_kmer_length);
+    } else if (adapter_trimming_enabled) {
         current_sink_node = pipeline_desc.add_node<AdapterDetectorNode>(
                 {current_sink_node}, thread_allocations.adapter_threads, !adapter_no_trim,
                 !primer_no_trim);
@@ -184,10 +196,10 @@ void setup(std::vector<std::string> args,
 
     pipelines::create_simplex_pipeline(
             pipeline_desc, std::move(runners), std::move(remora_runners), overlap,
-            mean_qscore_start_pos, !adapter_no_trim, thread_allocations.scaler_node_threads,
-            true /* Enable read splitting */, thread_allocations.splitter_node_threads,
-            thread_allocations.remora_threads, current_sink_node,
-            PipelineDescriptor::InvalidNodeHandle);
+            mean_qscore_start_pos, latency_target_ms, !adapter_no_trim,
+            thread_allocations.scaler_node_threads, true /* Enable read splitting */,
+            thread_allocations.splitter_node_threads, thread_allocations.remora_threads,
+            current_sink_node, PipelineDescriptor::InvalidNodeHandle);
 
     // Create the Pipeline from our description.
     std::vector<dorado::stats::StatsReporter> stats_reporters{dorado::stats::sys_stats_report};
@@ -206,7 +218,7 @@ void setup(std::vector<std::string> args,
     }
     hts_writer_ref.set_and_write_header(hdr.get());
 
-    std::unordered_set<std::string> reads_already_processed;
+    utils::ReadIdSet reads_already_processed;
     if (!resume_from_file.empty()) {
         spdlog::info("> Inspecting resume file...");
         // Turn off warning logging as header info is fetched.
@@ -255,7 +267,8 @@ void setup(std::vector<std::string> args,
             kStatsPeriod, stats_reporters, stats_callables, max_stats_records);
 
     DataLoader loader(*pipeline, "cpu", thread_allocations.loader_threads, max_reads, read_list,
-                      reads_already_processed);
+                      std::move(reads_already_processed), max_open_pod5_files,
+                      max_pod5_signal_bytes);
 
     // Run pipeline.
     loader.load_reads(data_path, recursive_file_loading, ReadOrder::UNRESTRICTED);
@@ -419,8 +432,15 @@ int basecaller(int argc, char* argv[]) {
             .default_value(false)
             .implicit_value(true);
 
+    cli::add_barcode_prefilter_argument(parser.visible);
+
     cli::add_minimap2_arguments(parser, alignment::dflt_options);
     cli::add_internal_arguments(parser);
+    parser.hidden.add_argument("--latency-target-ms")
+            .help("Target read latency in milliseconds. If set, reads closest to completion are "
+                  "basecalled first, and partial batches are called sooner.")
+            .default_value(0)
+            .scan<'i', int>();
 
     // Create a copy of the parser to use if the resume feature is enabled. Needed
     // to parse the model used for the file being resumed from. Note that this copy
@@ -597,7 +617,11 @@ int basecaller(int argc, char* argv[]) {
               parser.visible.get<bool>("--barcode-both-ends"), no_trim_barcodes, no_trim_adapters,
               no_trim_primers, parser.visible.get<std::string>("--sample-sheet"),
               std::move(custom_kit), std::move(custom_seqs), resume_parser,
-              parser.visible.get<bool>("--estimate-poly-a"), model_selection);
+              parser.visible.get<bool>("--estimate-poly-a"), model_selection,
+              cli::get_barcode_prefilter_kmer_length(parser.visible),
+              cli::get_int_in_range(parser.hidden, "--latency-target-ms", 0),
+              cli::get_int_in_range(parser.hidden, "--pod5-open-files", 1),
+              size_t(cli::get_int_in_range(parser.hidden, "--pod5-signal-budget-mb", 1)) << 20);
     } catch (const std::exception& e) {
         spdlog::error("{}", e.what());
         utils::clean_temporary_models(temp_download_paths);
@@ -2,6 +2,8 @@
 #pragma once
 
 #include "Version.h"
+#include "data_loader/DataLoader.h"
+#include "demux/KmerPrefilter.h"
 #include "models/kits.h"
 #include "utils/dev_utils.h"
 
@@ -27,6 +29,7 @@
 #include <cctype>
 #include <cmath>
 #include <iostream>
+#include <limits>
 #include <sstream>
 #include <string>
 #include <utility>
@@ -166,6 +169,43 @@ inline void add_internal_arguments(ArgParser& parser) {
     parser.hidden.add_argument("--dump_stats_filter")
             .help("Internal processing stats. name filter regex.")
             .default_value(std::string(""));
+    parser.hidden.add_argument("--pod5-open-files")
+            .help("Number of POD5 files read concurrently.")
+            .default_value(int(DEFAULT_MAX_OPEN_POD5_FILES))
+            .scan<'i', int>();
+    parser.hidden.add_argument("--pod5-signal-budget-mb")
+            .help("Decompressed POD5 signal in MB that may be held before it's passed on.")
+            .default_value(int(DEFAULT_POD5_SIGNAL_BUDGET_MB))
+            .scan<'i', int>();
+}
+
+inline void add_barcode_prefilter_argument(argparse::ArgumentParser& parser) {
+    parser.add_argument("--barcode-prefilter-kmer")
+            .help("Screen reads with k-mers of this length before barcode scoring, or 0 to score "
+                  "every read. Screening is faster, but can miss very noisy barcodes.")
+            .default_value(0)
+            .scan<'i', int>();
+}
+
+// Gets an integer argument, throwing if it's outside [min_value, max_value].
+inline int get_int_in_range(const argparse::ArgumentParser& parser,
+                            const std::string& name,
+                            int min_value,
+                            int max_value = std::numeric_limits<int>::max()) {
+    const int value = parser.get<int>(name);
+    if (value < min_value || value > max_value) {
+        const auto range = max_value == std::numeric_limits<int>::max()
+                                   ? "at least " + std::to_string(min_value)
+                                   : "between " + std::to_string(min_value) + " and " +
+                                             std::to_string(max_value);
+        throw std::runtime_error(name + " must be " + range + ".");
+    }
+    return value;
+}
+
+inline int get_barcode_prefilter_kmer_length(const argparse::ArgumentParser& parser) {
+    return get_int_in_range(parser, "--barcode-prefilter-kmer", 0,
+                            demux::KmerPrefilter::MAX_KMER_LENGTH);
 }
 
 template <class Options>
@@ -90,6 +90,7 @@ int demuxer(int argc, char* argv[]) {
     parser.add_argument("--barcode-arrangement")
             .help("Path to file with custom barcode arrangement.");
     parser.add_argument("--barcode-sequences").help("Path to file with custom barcode sequences.");
+    cli::add_barcode_prefilter_argument(parser);
 
     try {
         parser.parse_args(argc, argv);
@@ -136,6 +137,14 @@ int demuxer(int argc, char* argv[]) {
         custom_seqs = parser.get<std::string>("--barcode-sequences");
     }
 
+    int prefilter_kmer_length = 0;
+    try {
+        prefilter_kmer_length = cli::get_barcode_prefilter_kmer_length(parser);
+    } catch (const std::exception& e) {
+        spdlog::error(e.what());
+        std::exit(1);
+    }
+
     auto read_list = utils::load_read_list(parser.get<std::string>("--read-ids"));
 
     if (reads.empty()) {
@@ -176,7 +185,7 @@ int demuxer(int argc, char* argv[]) {
         pipeline_desc.add_node<BarcodeClassifierNode>(
                 {demux_writer}, demux_threads, kit_names, parser.get<bool>("--barcode-both-ends"),
                 parser.get<bool>("--no-trim"), std::move(allowed_barcodes), std::move(custom_kit),
-                std::move(custom_seqs));
+                std::move(custom_seqs), prefilter_kmer_length);
     }
 
     // Create the Pipeline from our description.
@@ -277,6 +277,14 @@ int duplex(int argc, char* argv[]) {
 
     cli::add_minimap2_arguments(parser, alignment::dflt_options);
     cli::add_internal_arguments(parser);
+    parser.hidden.add_argument("--pairing-signal-budget-mb")
+            .help("Signal in MB the pairing cache holds in memory before spilling it to disk. "
+                  "0 for no limit.")
+            .default_value(0)
+            .scan<'i', int>();
+    parser.hidden.add_argument("--spill-dir")
+            .help("Directory to spill cached signal to. Defaults to the system temp directory.")
+            .default_value(std::string(""));
 
     std::set<fs::path> temp_model_paths;
     try {
@@ -344,6 +352,13 @@ int duplex(int argc, char* argv[]) {
         const std::string dump_stats_file = parser.hidden.get<std::string>("--dump_stats_file");
         const std::string dump_stats_filter = parser.hidden.get<std::string>("--dump_stats_filter");
         const size_t max_stats_records = static_cast<size_t>(dump_stats_file.empty() ? 0 : 100000);
+        const auto max_open_pod5_files =
+                size_t(cli::get_int_in_range(parser.hidden, "--pod5-open-files", 1));
+        const auto max_pod5_signal_bytes =
+                size_t(cli::get_int_in_range(parser.hidden, "--pod5-signal-budget-mb", 1)) << 20;
+        const auto max_pairing_signal_bytes =
+                size_t(cli::get_int_in_range(parser.hidden, "--pairing-signal-budget-mb", 0))
+                << 20;
 
         bool recursive_file_loading = parser.visible.get<bool>("--recursive");
 
@@ -505,8 +520,9 @@ int duplex(int argc, char* argv[]) {
 
             PairingParameters pairing_parameters;
             if (template_complement_map.empty()) {
-                pairing_parameters =
-                        DuplexPairingParameters{ReadOrder::BY_CHANNEL, DEFAULT_DUPLEX_CACHE_DEPTH};
+                pairing_parameters = DuplexPairingParameters{
+                        ReadOrder::BY_CHANNEL, DEFAULT_DUPLEX_CACHE_DEPTH, max_pairing_signal_bytes,
+                        parser.hidden.get<std::string>("--spill-dir")};
             } else {
                 pairing_parameters = std::move(template_complement_map);
             }
@@ -537,7 +553,8 @@ int duplex(int argc, char* argv[]) {
             }
             hts_writer_ref.set_and_write_header(hdr.get());
 
-            DataLoader loader(*pipeline, "cpu", num_devices, 0, std::move(read_list), {});
+            DataLoader loader(*pipeline, "cpu", num_devices, 0, std::move(read_list), {},
+                              max_open_pod5_files, max_pod5_signal_bytes);
 
             stats_sampler = std::make_unique<dorado::stats::StatsSampler>(
                     kStatsPeriod, stats_reporters, stats_callables, max_stats_records);
@@ -16,11 +16,17 @@
 
 #include <algorithm>
 #include <cctype>
+#include <condition_variable>
 #include <ctime>
+#include <deque>
+#include <exception>
 #include <filesystem>
+#include <future>
+#include <memory>
 #include <mutex>
 #include <optional>
 #include <stdexcept>
+#include <thread>
 #include <vector>
 
 /**
@@ -189,7 +195,7 @@ SimplexReadPtr process_pod5_read(
         spdlog::error("Failed to get read {} signal: {}", row, pod5_get_error_string());
     }
 
-    auto new_read = std::make_unique<SimplexRead>();
+    auto new_read = make_simplex_read();
     new_read->read_common.raw_data = samples;
     new_read->read_common.sample_rate = run_sample_rate;
 
@@ -242,8 +248,8 @@ SimplexReadPtr process_pod5_read(
 
 bool can_process_pod5_row(Pod5ReadRecordBatch_t* batch,
                           int row,
-                          const std::optional<std::unordered_set<std::string>>& allowed_read_ids,
-                          const std::unordered_set<std::string>& ignored_read_ids) {
+                          const std::optional<utils::ReadIdSet>& allowed_read_ids,
+                          const utils::ReadIdSet& ignored_read_ids) {
     uint16_t read_table_version = 0;
     ReadBatchRowInfo_t read_data;
     if (pod5_get_read_batch_row_info_data(batch, row, READ_BATCH_ROW_INFO_VERSION, &read_data,
@@ -252,21 +258,154 @@ bool can_process_pod5_row(Pod5ReadRecordBatch_t* batch,
         return false;
     }
 
-    char read_id_tmp[POD5_READ_ID_LEN];
-    if (pod5_format_read_id(read_data.read_id, read_id_tmp) != POD5_OK) {
-        spdlog::error("Failed to format read id");
-    }
-
-    std::string read_id_str(read_id_tmp);
-    bool read_in_ignore_list = ignored_read_ids.find(read_id_str) != ignored_read_ids.end();
-    bool read_in_read_list =
-            !allowed_read_ids || (allowed_read_ids->find(read_id_str) != allowed_read_ids->end());
+    // The sets hold POD5 read ids in binary form, so there's no need to format them.
+    utils::ReadIdSet::Uuid read_id;
+    std::copy(std::begin(read_data.read_id), std::end(read_data.read_id), read_id.begin());
+    bool read_in_ignore_list = ignored_read_ids.contains(read_id);
+    bool read_in_read_list = !allowed_read_ids || allowed_read_ids->contains(read_id);
     if (!read_in_ignore_list && read_in_read_list) {
         return true;
     }
     return false;
 }
 
+namespace {
+
+size_t get_pod5_row_signal_bytes(Pod5ReadRecordBatch_t* batch, size_t row) {
+    uint16_t read_table_version = 0;
+    ReadBatchRowInfo_t read_data;
+    if (pod5_get_read_batch_row_info_data(batch, row, READ_BATCH_ROW_INFO_VERSION, &read_data,
+                                          &read_table_version) != POD5_OK) {
+        return 0;
+    }
+    return read_data.num_samples * sizeof(int16_t);
+}
+
+// Bounds the decompressed signal held by POD5 file workers.  A request that doesn't fit waits
+// for others to be released, unless nothing is held, so a single oversized batch can't stall.
+class Pod5SignalBudget {
+public:
+    Pod5SignalBudget(size_t max_bytes,
+                     std::atomic<size_t>& bytes_in_flight,
+                     std::atomic<size_t>& peak_bytes_in_flight,
+                     std::atomic<size_t>& num_waits)
+            : m_max_bytes(max_bytes),
+              m_bytes_in_flight(bytes_in_flight),
+              m_peak_bytes_in_flight(peak_bytes_in_flight),
+              m_num_waits(num_waits) {}
+
+    bool try_acquire(size_t bytes) {
+        std::lock_guard lock(m_mutex);
+        if (m_aborted || !fits(bytes)) {
+            return false;
+        }
+        add(bytes);
+        return true;
+    }
+
+    // Returns false without acquiring anything if abort() is called first.
+    bool acquire(size_t bytes) {
+        std::unique_lock lock(m_mutex);
+        if (!m_aborted && !fits(bytes)) {
+            ++m_num_waits;
+            m_cv.wait(lock, [this, bytes] { return m_aborted || fits(bytes); });
+        }
+        if (m_aborted) {
+            return false;
+        }
+        add(bytes);
+        return true;
+    }
+
+    void release(size_t bytes) {
+        {
+            std::lock_guard lock(m_mutex);
+            m_bytes_in_flight -= bytes;
+        }
+        m_cv.notify_all();
+    }
+
+    // Wakes any waiting workers and fails all further requests, so that workers stop once one
+    // of them has failed.
+    void abort() {
+        {
+            std::lock_guard lock(m_mutex);
+            m_aborted = true;
+        }
+        m_cv.notify_all();
+    }
+
+    bool aborted() const {
+        std::lock_guard lock(m_mutex);
+        return m_aborted;
+    }
+
+private:
+    bool fits(size_t bytes) const {
+        return m_bytes_in_flight == 0 || m_bytes_in_flight + bytes <= m_max_bytes;
+    }
+
+    void add(size_t bytes) {
+        m_bytes_in_flight += bytes;
+        if (m_bytes_in_flight > m_peak_bytes_in_flight) {
+            m_peak_bytes_in_flight = m_bytes_in_flight.load();
+        }
+    }
+
+    const size_t m_max_bytes;
+    std::atomic<size_t>& m_bytes_in_flight;
+    std::atomic<size_t>& m_peak_bytes_in_flight;
+    std::atomic<size_t>& m_num_waits;
+    bool m_aborted{false};
+    mutable std::mutex m_mutex;
+    std::condition_variable m_cv;
+};
+
+struct Pod5BatchDestructor {
+    void operator()(Pod5ReadRecordBatch_t* batch) {
+        if (pod5_free_read_batch(batch) != POD5_OK) {
+            spdlog::error("Failed to release batch");
+        }
+    }
+};
+using Pod5BatchPtr = std::unique_ptr<Pod5ReadRecordBatch_t, Pod5BatchDestructor>;
+
+// A record batch whose reads are being decompressed, and the signal budget it holds.  Destroying
+// it waits for any reads still being decompressed, since they use the batch, then frees the batch
+// and releases its signal.  So if pushing a read throws, nothing is leaked and no other worker is
+// left waiting for the signal.
+class Pod5PendingBatch {
+public:
+    Pod5PendingBatch(Pod5BatchPtr batch, size_t signal_bytes, Pod5SignalBudget& budget)
+            : m_batch(std::move(batch)), m_signal_bytes(signal_bytes), m_budget(budget) {}
+    ~Pod5PendingBatch() {
+        for (auto& read : reads) {
+            if (read.valid()) {
+                read.wait();
+            }
+        }
+        m_batch.reset();
+        m_budget.release(m_signal_bytes);
+    }
+    Pod5PendingBatch(const Pod5PendingBatch&) = delete;
+    Pod5PendingBatch& operator=(const Pod5PendingBatch&) = delete;
+
+    Pod5ReadRecordBatch_t* batch() const { return m_batch.get(); }
+
+    std::vector<std::future<SimplexReadPtr>> reads;
+
+private:
+    Pod5BatchPtr m_batch;
+    const size_t m_signal_bytes;
+    Pod5SignalBudget& m_budget;
+};
+
+// Number of record batches each POD5 file worker keeps decompressing ahead of the one it's
+// pushing to the pipeline.
+constexpr size_t POD5_PREFETCH_BATCHES = 2;
+
+}  // namespace
+
 void Pod5Destructor::operator()(Pod5FileReader_t* pod5) { pod5_close_and_free_reader(pod5); }
 
 void DataLoader::load_reads(const std::string& path,
@@ -337,7 +476,9 @@ void DataLoader::load_reads(const std::string& path,
                 m_reads_by_channel.erase(channel);
             }
             break;
-        case ReadOrder::UNRESTRICTED:
+        case ReadOrder::UNRESTRICTED: {
+            // POD5 files are loaded together at the end, so that they can be read concurrently.
+            std::vector<std::string> pod5_paths;
             for (const auto& entry : iterator) {
                 if (m_loaded_read_count == m_max_reads) {
                     break;
@@ -348,10 +489,12 @@ void DataLoader::load_reads(const std::string& path,
                 if (ext == ".fast5") {
                     load_fast5_reads_from_file(entry.path().string());
                 } else if (ext == ".pod5") {
-                    load_pod5_reads_from_file(entry.path().string());
+                    pod5_paths.push_back(entry.path().string());
                 }
             }
+            load_pod5_reads_from_files(pod5_paths);
             break;
+        }
         default:
             throw std::runtime_error("Unsupported traversal order detected: " +
                                      dorado::to_string(traversal_order));
@@ -364,8 +507,8 @@ void DataLoader::load_reads(const std::string& path,
 }
 
 int DataLoader::get_num_reads(std::string data_path,
-                              std::optional<std::unordered_set<std::string>> read_list,
-                              const std::unordered_set<std::string>& ignore_read_list,
+                              std::optional<utils::ReadIdSet> read_list,
+                              const utils::ReadIdSet& ignore_read_list,
                               bool recursive_file_loading) {
     size_t num_reads = 0;
 
@@ -405,13 +548,11 @@ int DataLoader::get_num_reads(std::string data_path,
     num_reads -= ignore_read_list.size();
 
     if (read_list) {
-        // Get the unique read ids in the read list, since everything in the ignore
-        // list will be skipped over.
-        std::vector<std::string> final_read_list;
-        std::set_difference(read_list->begin(), read_list->end(), ignore_read_list.begin(),
-                            ignore_read_list.end(),
-                            std::inserter(final_read_list, final_read_list.begin()));
-        num_reads = std::min(num_reads, final_read_list.size());
+        // Count the read ids in the read list which aren't in the ignore list, since
+        // everything in the ignore list will be skipped over.
+        const size_t num_listed_reads =
+                read_list->size() - read_list->count_shared(ignore_read_list);
+        num_reads = std::min(num_reads, num_listed_reads);
     }
 
     return int(num_reads);
@@ -841,61 +982,144 @@ void DataLoader::load_pod5_reads_from_file_by_read_ids(const std::string& path,
     }
 }
 
-void DataLoader::load_pod5_reads_from_file(const std::string& path) {
+void DataLoader::load_pod5_reads_from_files(const std::vector<std::string>& paths) {
+    if (paths.empty() || m_loaded_read_count >= m_max_reads) {
+        return;
+    }
     pod5_init();
 
-    // Open the file ready for walking:
-    Pod5FileReader_t* file = pod5_open_file(path.c_str());
+    // Decompression tasks from all files share one pool.
+    cxxpool::thread_pool pool{m_num_worker_threads};
+    Pod5SignalBudget signal_budget(m_max_pod5_signal_bytes, m_pod5_signal_bytes_in_flight,
+                                   m_pod5_peak_signal_bytes_in_flight,
+                                   m_pod5_signal_budget_waits);
+    // Reads are claimed before they're decompressed, so that concurrent files together stop
+    // at m_max_reads.
+    std::atomic<size_t> num_reads_claimed{m_loaded_read_count.load()};
+
+    auto load_file = [&](const std::string& path) {
+        // Open the file ready for walking:
+        Pod5Ptr file(pod5_open_file(path.c_str()));
+        if (!file) {
+            spdlog::error("Failed to open file {}: {}", path, pod5_get_error_string());
+            return;
+        }
 
-    if (!file) {
-        spdlog::error("Failed to open file {}: {}", path, pod5_get_error_string());
-    }
+        std::size_t batch_count = 0;
+        if (pod5_get_read_batch_count(&batch_count, file.get()) != POD5_OK) {
+            spdlog::error("Failed to query batch count: {}", pod5_get_error_string());
+        }
 
-    std::size_t batch_count = 0;
-    if (pod5_get_read_batch_count(&batch_count, file) != POD5_OK) {
-        spdlog::error("Failed to query batch count: {}", pod5_get_error_string());
-    }
+        // Batches whose reads are being decompressed, in file order.  Declared after the file so
+        // that they're freed before it's closed.
+        std::deque<Pod5PendingBatch> pending_batches;
+        auto push_oldest_batch = [&] {
+            for (auto& v : pending_batches.front().reads) {
+                auto read = v.get();
+                m_pipeline.push_message(std::move(read));
+                m_loaded_read_count++;
+            }
+            pending_batches.pop_front();
+        };
 
-    cxxpool::thread_pool pool{m_num_worker_threads};
+        for (std::size_t batch_index = 0; batch_index < batch_count; ++batch_index) {
+            if (num_reads_claimed >= m_max_reads || signal_budget.aborted()) {
+                break;
+            }
+            Pod5ReadRecordBatch_t* raw_batch = nullptr;
+            if (pod5_get_read_batch(&raw_batch, file.get(), batch_index) != POD5_OK) {
+                spdlog::error("Failed to get batch: {}", pod5_get_error_string());
+                continue;
+            }
+            Pod5BatchPtr batch(raw_batch);
 
-    for (std::size_t batch_index = 0; batch_index < batch_count; ++batch_index) {
-        if (m_loaded_read_count == m_max_reads) {
-            break;
-        }
-        Pod5ReadRecordBatch_t* batch = nullptr;
-        if (pod5_get_read_batch(&batch, file, batch_index) != POD5_OK) {
-            spdlog::error("Failed to get batch: {}", pod5_get_error_string());
-        }
+            std::size_t batch_row_count = 0;
+            if (pod5_get_read_batch_row_count(&batch_row_count, batch.get()) != POD5_OK) {
+                spdlog::error("Failed to get batch row count");
+            }
 
-        std::size_t batch_row_count = 0;
-        if (pod5_get_read_batch_row_count(&batch_row_count, batch) != POD5_OK) {
-            spdlog::error("Failed to get batch row count");
-        }
-        batch_row_count = std::min(batch_row_count, m_max_reads - m_loaded_read_count);
+            std::vector<std::size_t> rows;
+            size_t signal_bytes = 0;
+            for (std::size_t row = 0; row < batch_row_count; ++row) {
+                if (!can_process_pod5_row(batch.get(), int(row), m_allowed_read_ids,
+                                          m_ignored_read_ids)) {
+                    continue;
+                }
+                if (num_reads_claimed++ >= m_max_reads) {
+                    break;
+                }
+                rows.push_back(row);
+                signal_bytes += get_pod5_row_signal_bytes(batch.get(), row);
+            }
 
-        std::vector<std::future<SimplexReadPtr>> futures;
+            // Make room for this batch's signal, pushing this file's own pending batches first
+            // so that workers never wait on each other while holding signal.
+            while (!signal_budget.try_acquire(signal_bytes)) {
+                if (pending_batches.empty()) {
+                    if (!signal_budget.acquire(signal_bytes)) {
+                        // Another worker failed.
+                        return;
+                    }
+                    break;
+                }
+                push_oldest_batch();
+            }
 
-        for (std::size_t row = 0; row < batch_row_count; ++row) {
-            // TODO - check the read ID here, for each one, only send the row if it is in the list of ones we care about
+            auto& pending =
+                    pending_batches.emplace_back(std::move(batch), signal_bytes, signal_budget);
+            pending.reads.reserve(rows.size());
+            for (auto row : rows) {
+                pending.reads.push_back(pool.push(process_pod5_read, row, pending.batch(),
+                                                  file.get(), path, &m_reads_by_channel,
+                                                  &m_read_id_to_index));
+            }
+            ++m_pod5_batches_prefetched;
 
-            if (can_process_pod5_row(batch, int(row), m_allowed_read_ids, m_ignored_read_ids)) {
-                futures.push_back(pool.push(process_pod5_read, row, batch, file, path,
-                                            &m_reads_by_channel, &m_read_id_to_index));
+            // Push the oldest batch while the newer ones are still being decompressed.
+            if (pending_batches.size() > POD5_PREFETCH_BATCHES) {
+                push_oldest_batch();
             }
         }
+        while (!pending_batches.empty()) {
+            push_oldest_batch();
+        }
 
-        for (auto& v : futures) {
-            auto read = v.get();
-            m_pipeline.push_message(std::move(read));
-            m_loaded_read_count++;
+        if (pod5_close_and_free_reader(file.release()) != POD5_OK) {
+            spdlog::error("Failed to close and free POD5 reader");
         }
+    };
 
-        if (pod5_free_read_batch(batch) != POD5_OK) {
-            spdlog::error("Failed to release batch");
+    // Each file worker takes the next unopened file when it finishes one.
+    std::atomic<size_t> next_file{0};
+    std::mutex error_mutex;
+    std::exception_ptr error;
+    auto file_worker = [&] {
+        try {
+            for (size_t i = next_file++; i < paths.size(); i = next_file++) {
+                load_file(paths[i]);
+            }
+        } catch (...) {
+            std::lock_guard lock(error_mutex);
+            if (!error) {
+                error = std::current_exception();
+            }
+            // Stop the other workers opening further files, and wake any waiting for signal.
+            next_file = paths.size();
+            signal_budget.abort();
         }
+    };
+
+    const size_t num_file_workers = std::min(paths.size(), m_max_open_pod5_files);
+    std::vector<std::thread> file_workers;
+    for (size_t i = 1; i < num_file_workers; ++i) {
+        file_workers.emplace_back(file_worker);
     }
-    if (pod5_close_and_free_reader(file) != POD5_OK) {
-        spdlog::error("Failed to close and free POD5 reader");
+    file_worker();
+    for (auto& worker : file_workers) {
+        worker.join();
+    }
+    if (error) {
+        std::rethrow_exception(error);
     }
 }
 
@@ -970,7 +1194,7 @@ void DataLoader::load_fast5_reads_from_file(const std::string& path) {
         auto start_time_str = utils::adjust_time(exp_start_time,
                                                  static_cast<uint32_t>(start_time / sampling_rate));
 
-        auto new_read = std::make_unique<SimplexRead>();
+        auto new_read = make_simplex_read();
         new_read->read_common.sample_rate = uint64_t(sampling_rate);
         new_read->read_common.raw_data = samples;
         new_read->digitisation = digitisation;
@@ -989,8 +1213,7 @@ void DataLoader::load_fast5_reads_from_file(const std::string& path) {
         new_read->read_common.experiment_id = group_protocol_id;
         new_read->read_common.is_duplex = false;
 
-        if (!m_allowed_read_ids || (m_allowed_read_ids->find(new_read->read_common.read_id) !=
-                                    m_allowed_read_ids->end())) {
+        if (!m_allowed_read_ids || m_allowed_read_ids->contains(new_read->read_common.read_id)) {
             m_pipeline.push_message(std::move(new_read));
             m_loaded_read_count++;
         }
@@ -1001,20 +1224,38 @@ DataLoader::DataLoader(Pipeline& pipeline,
                        const std::string& device,
                        size_t num_worker_threads,
                        size_t max_reads,
-                       std::optional<std::unordered_set<std::string>> read_list,
-                       std::unordered_set<std::string> read_ignore_list)
+                       std::optional<utils::ReadIdSet> read_list,
+                       utils::ReadIdSet read_ignore_list,
+                       size_t max_open_pod5_files,
+                       size_t max_pod5_signal_bytes)
         : m_pipeline(pipeline),
           m_device(device),
           m_num_worker_threads(num_worker_threads),
+          m_max_open_pod5_files(max_open_pod5_files),
+          m_max_pod5_signal_bytes(max_pod5_signal_bytes),
           m_allowed_read_ids(std::move(read_list)),
           m_ignored_read_ids(std::move(read_ignore_list)) {
     m_max_reads = max_reads == 0 ? std::numeric_limits<decltype(m_max_reads)>::max() : max_reads;
     assert(m_num_worker_threads > 0);
+    // Every read is looked up in these, and most lookups miss.
+    if (m_allowed_read_ids) {
+        m_allowed_read_ids->enable_bloom_filter();
+    }
+    m_ignored_read_ids.enable_bloom_filter();
+    assert(m_max_open_pod5_files > 0);
     static std::once_flag vbz_init_flag;
     std::call_once(vbz_init_flag, vbz_register);
 }
 
 stats::NamedStats DataLoader::sample_stats() const {
-    return stats::NamedStats{{"loaded_read_count", static_cast<double>(m_loaded_read_count)}};
+    return stats::NamedStats{
+            {"loaded_read_count", static_cast<double>(m_loaded_read_count)},
+            {"pod5_batches_prefetched", static_cast<double>(m_pod5_batches_prefetched)},
+            {"pod5_signal_mb_in_flight",
+             static_cast<double>(m_pod5_signal_bytes_in_flight) / (1024 * 1024)},
+            {"pod5_peak_signal_mb_in_flight",
+             static_cast<double>(m_pod5_peak_signal_bytes_in_flight) / (1024 * 1024)},
+            {"pod5_signal_budget_waits", static_cast<double>(m_pod5_signal_budget_waits)},
+    };
 }
 }  // namespace dorado
@@ -1,9 +1,11 @@
 #pragma once
 #include "models/models.h"
+#include "utils/ReadIdSet.h"
 #include "utils/stats.h"
 #include "utils/types.h"
 
 #include <array>
+#include <atomic>
 #include <map>
 #include <memory>
 #include <optional>
@@ -20,6 +22,10 @@ class Pipeline;
 struct ReadGroup;
 
 constexpr size_t POD5_READ_ID_SIZE = 16;
+/// Default number of POD5 files read concurrently.
+constexpr size_t DEFAULT_MAX_OPEN_POD5_FILES = 4;
+/// Default limit on the decompressed POD5 signal held before being pushed to the pipeline.
+constexpr size_t DEFAULT_POD5_SIGNAL_BUDGET_MB = 1024;
 using ReadID = std::array<uint8_t, POD5_READ_ID_SIZE>;
 typedef std::map<int, std::vector<ReadID>> channel_to_read_id_t;
 
@@ -34,8 +40,10 @@ public:
                const std::string& device,
                size_t num_worker_threads,
                size_t max_reads,
-               std::optional<std::unordered_set<std::string>> read_list,
-               std::unordered_set<std::string> read_ignore_list);
+               std::optional<utils::ReadIdSet> read_list,
+               utils::ReadIdSet read_ignore_list,
+               size_t max_open_pod5_files = DEFAULT_MAX_OPEN_POD5_FILES,
+               size_t max_pod5_signal_bytes = DEFAULT_POD5_SIGNAL_BUDGET_MB << 20);
     ~DataLoader() = default;
     void load_reads(const std::string& path,
                     bool recursive_file_loading,
@@ -48,8 +56,8 @@ public:
             bool recursive_file_loading);
 
     static int get_num_reads(std::string data_path,
-                             std::optional<std::unordered_set<std::string>> read_list,
-                             const std::unordered_set<std::string>& ignore_read_list,
+                             std::optional<utils::ReadIdSet> read_list,
+                             const utils::ReadIdSet& ignore_read_list,
                              bool recursive_file_loading);
 
     static bool is_read_data_present(std::string data_path, bool recursive_file_loading);
@@ -70,7 +78,9 @@ public:
 
 private:
     void load_fast5_reads_from_file(const std::string& path);
-    void load_pod5_reads_from_file(const std::string& path);
+    // Loads reads from several POD5 files at once, prefetching record batches from each file and
+    // decompressing their signal in parallel, within a budget for signal held by the loader.
+    void load_pod5_reads_from_files(const std::vector<std::string>& paths);
     void load_pod5_reads_from_file_by_read_ids(const std::string& path,
                                                const std::vector<ReadID>& read_ids);
     void load_read_channels(std::string data_path, bool recursive_file_loading);
@@ -79,13 +89,23 @@ private:
     std::string m_device;
     size_t m_num_worker_threads{1};
     size_t m_max_reads{0};
-    std::optional<std::unordered_set<std::string>> m_allowed_read_ids;
-    std::unordered_set<std::string> m_ignored_read_ids;
+    // Number of POD5 files read concurrently, and the most decompressed signal, in bytes, that
+    // may be held before being pushed to the pipeline.
+    size_t m_max_open_pod5_files;
+    size_t m_max_pod5_signal_bytes;
+    std::optional<utils::ReadIdSet> m_allowed_read_ids;
+    utils::ReadIdSet m_ignored_read_ids;
 
     std::unordered_map<std::string, channel_to_read_id_t> m_file_channel_read_order_map;
     std::unordered_map<int, std::vector<ReadSortInfo>> m_reads_by_channel;
     std::unordered_map<std::string, size_t> m_read_id_to_index;
     int m_max_channel{0};
+
+    // POD5 prefetching stats.
+    std::atomic<size_t> m_pod5_signal_bytes_in_flight{0};
+    std::atomic<size_t> m_pod5_peak_signal_bytes_in_flight{0};
+    std::atomic<size_t> m_pod5_batches_prefetched{0};
+    std::atomic<size_t> m_pod5_signal_budget_waits{0};
 };
 
 }  // namespace dorado
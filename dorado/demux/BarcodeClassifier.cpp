@@ -1,5 +1,7 @@
 #include "BarcodeClassifier.h"
 
+#include "KmerPrefilter.h"
+#include "MultiPatternAligner.h"
 #include "parse_custom_kit.h"
 #include "utils/alignment_utils.h"
 #include "utils/barcode_kits.h"
@@ -11,6 +13,8 @@
 #include <spdlog/spdlog.h>
 
 #include <algorithm>
+#include <chrono>
+#include <optional>
 #include <sstream>
 #include <string>
 #include <string_view>
@@ -101,6 +105,43 @@ float extract_mask_score(std::string_view barcode,
     return score;
 }
 
+// Scores every barcode against a region within the read in one pass, giving the same scores as
+// extract_mask_score.  Returns nothing if the barcodes are to be aligned one at a time instead,
+// which is when they're unsuitable for MultiPatternAligner, or when tracing the alignments.
+std::vector<float> extract_mask_scores(const std::optional<demux::MultiPatternAligner>& aligner,
+                                       std::string_view read) {
+    if (!aligner || spdlog::get_level() == spdlog::level::trace) {
+        return {};
+    }
+    const auto distances = aligner->edit_distances(read);
+    std::vector<float> scores(distances.size());
+    for (size_t i = 0; i < distances.size(); ++i) {
+        scores[i] = 1.f - static_cast<float>(distances[i]) / aligner->pattern_length();
+    }
+    return scores;
+}
+
+// Returns the score of the barcode at barcode_idx from scores if there are any, otherwise aligns
+// the barcode.
+float get_mask_score(const std::vector<float>& scores,
+                     size_t barcode_idx,
+                     std::string_view barcode,
+                     std::string_view read,
+                     const EdlibAlignConfig& config,
+                     const char* debug_prefix) {
+    if (scores.empty()) {
+        return extract_mask_score(barcode, read, config, debug_prefix);
+    }
+    return scores[barcode_idx];
+}
+
+std::optional<demux::MultiPatternAligner> make_aligner(const std::vector<std::string>& barcodes) {
+    if (!demux::MultiPatternAligner::supports(barcodes)) {
+        return std::nullopt;
+    }
+    return demux::MultiPatternAligner(barcodes);
+}
+
 bool barcode_is_permitted(const BarcodingInfo::FilterSet& allowed_barcodes,
                           const std::string& barcode_name) {
     if (!allowed_barcodes.has_value()) {
@@ -146,17 +187,25 @@ struct BarcodeClassifier::BarcodeCandidateKit {
     int bottom_context_rear_flank_len;
     std::vector<std::string> barcode_names;
     std::string kit;
+    // For scoring all of the barcodes (or their reverse complements) against a window at once.
+    std::optional<MultiPatternAligner> barcodes1_aligner;
+    std::optional<MultiPatternAligner> barcodes1_rev_aligner;
+    std::optional<MultiPatternAligner> barcodes2_aligner;
+    std::optional<MultiPatternAligner> barcodes2_rev_aligner;
+    // Reads whose end windows share no k-mer with the flanks or barcodes aren't scored.
+    std::optional<KmerPrefilter> prefilter;
 };
 
 BarcodeClassifier::BarcodeClassifier(const std::vector<std::string>& kit_names,
                                      const std::optional<std::string>& custom_kit,
-                                     const std::optional<std::string>& custom_barcodes)
+                                     const std::optional<std::string>& custom_barcodes,
+                                     int prefilter_kmer_length)
         : m_custom_kit(process_custom_kit(custom_kit)),
           m_custom_seqs(custom_barcodes ? parse_custom_barcode_sequences(*custom_barcodes)
                                         : std::unordered_map<std::string, std::string>{}),
           m_scoring_params(custom_kit ? parse_scoring_params(*custom_kit)
                                       : BarcodeKitScoringParams{}),
-          m_barcode_candidates(generate_candidates(kit_names)) {}
+          m_barcode_candidates(generate_candidates(kit_names, prefilter_kmer_length)) {}
 
 BarcodeClassifier::~BarcodeClassifier() = default;
 
@@ -169,6 +218,15 @@ BarcodeScoreResult BarcodeClassifier::barcode(
     return best_barcode;
 }
 
+stats::NamedStats BarcodeClassifier::sample_stats() const {
+    stats::NamedStats stats;
+    stats["prefilter_reads_checked"] = double(m_num_prefilter_checked.load());
+    stats["prefilter_reads_rejected"] = double(m_num_prefilter_rejected.load());
+    stats["barcode_reads_scored"] = double(m_num_scored.load());
+    stats["barcode_scoring_ms"] = double(m_scoring_time_ns.load()) / 1e6;
+    return stats;
+}
+
 const dorado::barcode_kits::KitInfo& BarcodeClassifier::get_kit_info(
         const std::string& kit_name) const {
     auto custom_kit_iter = m_custom_kit.find(kit_name);
@@ -205,7 +263,12 @@ const std::string& BarcodeClassifier::get_barcode_sequence(const std::string& ba
 // Returns a vector all barcode candidates to test the
 // input read sequence against.
 std::vector<BarcodeClassifier::BarcodeCandidateKit> BarcodeClassifier::generate_candidates(
-        const std::vector<std::string>& kit_names) {
+        const std::vector<std::string>& kit_names,
+        int prefilter_kmer_length) {
+    if (prefilter_kmer_length < 0 || prefilter_kmer_length > KmerPrefilter::MAX_KMER_LENGTH) {
+        throw std::runtime_error("Invalid barcode prefilter k-mer length " +
+                                 std::to_string(prefilter_kmer_length));
+    }
     std::vector<BarcodeCandidateKit> candidates_list;
 
     const auto& kit_info_map = barcode_kits::get_kit_infos();
@@ -288,6 +351,29 @@ std::vector<BarcodeClassifier::BarcodeCandidateKit> BarcodeClassifier::generate_
             candidate.barcode_names.push_back(bc_name);
         }
 
+        candidate.barcodes1_aligner = make_aligner(candidate.barcodes1);
+        candidate.barcodes1_rev_aligner = make_aligner(candidate.barcodes1_rev);
+        if (!candidate.barcodes2.empty()) {
+            candidate.barcodes2_aligner = make_aligner(candidate.barcodes2);
+            candidate.barcodes2_rev_aligner = make_aligner(candidate.barcodes2_rev);
+        }
+
+        if (prefilter_kmer_length > 0) {
+            // Seed from everything the scoring looks for in the read's end windows.  The Ns
+            // masking the barcodes in the contexts break up their k-mers.
+            std::vector<std::string> seeds = candidate.barcodes1;
+            seeds.push_back(candidate.top_context);
+            if (kit_info.double_ends) {
+                for (const auto* barcodes :
+                     {&candidate.barcodes1_rev, &candidate.barcodes2, &candidate.barcodes2_rev}) {
+                    seeds.insert(seeds.end(), barcodes->begin(), barcodes->end());
+                }
+                seeds.insert(seeds.end(), {candidate.top_context_rev, candidate.bottom_context,
+                                           candidate.bottom_context_rev});
+            }
+            candidate.prefilter.emplace(seeds, prefilter_kmer_length);
+        }
+
         candidates_list.push_back(std::move(candidate));
     }
     spdlog::debug("> Kits to evaluate: {}", candidates_list.size());
@@ -360,6 +446,13 @@ std::vector<BarcodeScoreResult> BarcodeClassifier::calculate_barcode_score_diffe
         spdlog::trace("best variant v2");
     }
 
+    const auto top_scores_v1 = extract_mask_scores(candidate.barcodes1_aligner, top_mask_v1);
+    const auto bottom_scores_v1 =
+            extract_mask_scores(candidate.barcodes2_rev_aligner, bottom_mask_v1);
+    const auto top_scores_v2 = extract_mask_scores(candidate.barcodes2_aligner, top_mask_v2);
+    const auto bottom_scores_v2 =
+            extract_mask_scores(candidate.barcodes1_rev_aligner, bottom_mask_v2);
+
     std::vector<BarcodeScoreResult> results;
     for (size_t i = 0; i < candidate.barcodes1.size(); i++) {
         auto& barcode1 = candidate.barcodes1[i];
@@ -375,11 +468,11 @@ std::vector<BarcodeScoreResult> BarcodeClassifier::calculate_barcode_score_diffe
         spdlog::trace("Checking barcode {}", barcode_name);
 
         // Calculate barcode scores for v1.
-        auto top_mask_result_score_v1 =
-                extract_mask_score(barcode1, top_mask_v1, mask_config, "top window v1");
+        auto top_mask_result_score_v1 = get_mask_score(top_scores_v1, i, barcode1, top_mask_v1,
+                                                       mask_config, "top window v1");
 
-        auto bottom_mask_result_score_v1 =
-                extract_mask_score(barcode2_rev, bottom_mask_v1, mask_config, "bottom window v1");
+        auto bottom_mask_result_score_v1 = get_mask_score(
+                bottom_scores_v1, i, barcode2_rev, bottom_mask_v1, mask_config, "bottom window v1");
 
         BarcodeScoreResult v1;
         v1.top_score = top_mask_result_score_v1;
@@ -394,11 +487,11 @@ std::vector<BarcodeScoreResult> BarcodeClassifier::calculate_barcode_score_diffe
                                  bottom_start + bottom_result_v1.endLocations[0]};
 
         // Calculate barcode scores for v2.
-        auto top_mask_result_score_v2 =
-                extract_mask_score(barcode2, top_mask_v2, mask_config, "top window v2");
+        auto top_mask_result_score_v2 = get_mask_score(top_scores_v2, i, barcode2, top_mask_v2,
+                                                       mask_config, "top window v2");
 
-        auto bottom_mask_result_score_v2 =
-                extract_mask_score(barcode1_rev, bottom_mask_v2, mask_config, "bottom window v2");
+        auto bottom_mask_result_score_v2 = get_mask_score(
+                bottom_scores_v2, i, barcode1_rev, bottom_mask_v2, mask_config, "bottom window v2");
 
         BarcodeScoreResult v2;
         v2.top_score = top_mask_result_score_v2;
@@ -465,6 +558,9 @@ std::vector<BarcodeScoreResult> BarcodeClassifier::calculate_barcode_score_doubl
             bottom_strand, read_bottom, barcode_len, placement_config, "bottom score");
     std::string_view bottom_mask = read_bottom.substr(bottom_bc_loc, barcode_len);
 
+    const auto top_scores = extract_mask_scores(candidate.barcodes1_aligner, top_mask);
+    const auto bottom_scores = extract_mask_scores(candidate.barcodes1_rev_aligner, bottom_mask);
+
     std::vector<BarcodeScoreResult> results;
     for (size_t i = 0; i < candidate.barcodes1.size(); i++) {
         auto& barcode = candidate.barcodes1[i];
@@ -476,10 +572,11 @@ std::vector<BarcodeScoreResult> BarcodeClassifier::calculate_barcode_score_doubl
         }
         spdlog::trace("Checking barcode {}", barcode_name);
 
-        auto top_mask_score = extract_mask_score(barcode, top_mask, mask_config, "top window");
+        auto top_mask_score =
+                get_mask_score(top_scores, i, barcode, top_mask, mask_config, "top window");
 
-        auto bottom_mask_score =
-                extract_mask_score(barcode_rev, bottom_mask, mask_config, "bottom window");
+        auto bottom_mask_score = get_mask_score(bottom_scores, i, barcode_rev, bottom_mask,
+                                                mask_config, "bottom window");
 
         BarcodeScoreResult res;
         res.barcode_name = barcode_name;
@@ -527,6 +624,7 @@ std::vector<BarcodeScoreResult> BarcodeClassifier::calculate_barcode_score(
             extract_flank_fit(top_context, read_top, barcode_len, placement_config, "top score");
     std::string_view top_mask = read_top.substr(top_bc_loc, barcode_len);
     spdlog::trace("BC location {}", top_bc_loc);
+    const auto top_scores = extract_mask_scores(candidate.barcodes1_aligner, top_mask);
 
     std::vector<BarcodeScoreResult> results;
     for (size_t i = 0; i < candidate.barcodes1.size(); i++) {
@@ -539,7 +637,8 @@ std::vector<BarcodeScoreResult> BarcodeClassifier::calculate_barcode_score(
 
         spdlog::trace("Checking barcode {}", barcode_name);
 
-        auto top_mask_score = extract_mask_score(barcode, top_mask, mask_config, "top window");
+        auto top_mask_score =
+                get_mask_score(top_scores, i, barcode, top_mask, mask_config, "top window");
 
         BarcodeScoreResult res;
         res.barcode_name = barcode_name;
@@ -581,9 +680,26 @@ BarcodeScoreResult BarcodeClassifier::find_best_barcode(
         throw std::runtime_error("Unimplemented: multiple barcoding kits");
     }
 
-    // Then find the best barcode hit within that kit.
-    std::vector<BarcodeScoreResult> scores;
     const auto& kit = get_kit_info(candidate->kit);
+    if (candidate->prefilter) {
+        ++m_num_prefilter_checked;
+        // Only double ended kits are looked for in the rear window.
+        if (!candidate->prefilter->has_seed(fwd.substr(0, TRIM_LENGTH)) &&
+            !(kit.double_ends &&
+              candidate->prefilter->has_seed(fwd.substr(fwd.length() - TRIM_LENGTH)))) {
+            spdlog::trace("No flank or barcode k-mers in read ends");
+            ++m_num_prefilter_rejected;
+            return UNCLASSIFIED;
+        }
+    }
+
+    // Then find the best barcode hit within that kit.  Scoring is only counted and timed when
+    // the prefilter is on, since the stats are only used to estimate what it saves.
+    std::optional<std::chrono::steady_clock::time_point> scoring_start;
+    if (candidate->prefilter) {
+        scoring_start = std::chrono::steady_clock::now();
+    }
+    std::vector<BarcodeScoreResult> scores;
     if (kit.double_ends) {
         if (kit.ends_different) {
             auto out = calculate_barcode_score_different_double_ends(fwd, *candidate,
@@ -597,6 +713,12 @@ BarcodeScoreResult BarcodeClassifier::find_best_barcode(
         auto out = calculate_barcode_score(fwd, *candidate, allowed_barcodes);
         scores.insert(scores.end(), out.begin(), out.end());
     }
+    if (scoring_start) {
+        ++m_num_scored;
+        m_scoring_time_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                     std::chrono::steady_clock::now() - *scoring_start)
+                                     .count();
+    }
 
     if (scores.empty()) {
         return UNCLASSIFIED;
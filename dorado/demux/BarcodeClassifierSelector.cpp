@@ -17,9 +17,34 @@ std::shared_ptr<const BarcodeClassifier> BarcodeClassifierSelector::get_barcoder
         m_barcoder_lut.emplace(barcode_kit_info.kit_name,
                                std::make_shared<const BarcodeClassifier>(
                                        std::vector<std::string>{barcode_kit_info.kit_name},
-                                       barcode_kit_info.custom_kit, barcode_kit_info.custom_seqs));
+                                       barcode_kit_info.custom_kit, barcode_kit_info.custom_seqs,
+                                       m_prefilter_kmer_length));
     }
     return m_barcoder_lut.at(barcode_kit_info.kit_name);
 }
 
+stats::NamedStats BarcodeClassifierSelector::sample_stats() const {
+    stats::NamedStats stats;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (const auto& [_, barcoder] : m_barcoder_lut) {
+            for (const auto& [name, value] : barcoder->sample_stats()) {
+                stats[name] += value;
+            }
+        }
+    }
+
+    const double num_checked = stats["prefilter_reads_checked"];
+    const double num_rejected = stats["prefilter_reads_rejected"];
+    const double num_scored = stats["barcode_reads_scored"];
+    if (num_checked > 0) {
+        stats["prefilter_hit_rate"] = (num_checked - num_rejected) / num_checked;
+    }
+    if (num_scored > 0) {
+        // Assumes rejected reads would have taken as long to score as the reads which were.
+        stats["prefilter_time_saved_ms"] = num_rejected * stats["barcode_scoring_ms"] / num_scored;
+    }
+    return stats;
+}
+
 }  // namespace dorado::demux
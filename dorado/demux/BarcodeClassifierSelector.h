@@ -1,4 +1,5 @@
 #pragma once
+#include "utils/stats.h"
 #include "utils/types.h"
 
 #include <memory>
@@ -11,11 +12,20 @@ namespace dorado::demux {
 class BarcodeClassifier;
 
 class BarcodeClassifierSelector final {
-    std::mutex m_mutex{};
+    const int m_prefilter_kmer_length;
+    mutable std::mutex m_mutex{};
     std::unordered_map<std::string, std::shared_ptr<const BarcodeClassifier>> m_barcoder_lut{};
 
 public:
+    // The barcoders screen reads with k-mers of prefilter_kmer_length, if it's positive.
+    explicit BarcodeClassifierSelector(int prefilter_kmer_length = 0)
+            : m_prefilter_kmer_length(prefilter_kmer_length) {}
+
     std::shared_ptr<const BarcodeClassifier> get_barcoder(const BarcodingInfo& barcode_kit_info);
+
+    // Prefilter and scoring stats summed over all the barcoders, with the fraction of reads passing
+    // the prefilter and an estimate of the scoring time it saved.
+    stats::NamedStats sample_stats() const;
 };
 
 }  // namespace dorado::demux
@@ -0,0 +1,71 @@
+#include "KmerPrefilter.h"
+
+#include <algorithm>
+#include <array>
+#include <stdexcept>
+
+namespace {
+
+// 2 bit code of each base, or -1 for anything else.
+const std::array<int8_t, 256> kBaseCodes = [] {
+    std::array<int8_t, 256> codes;
+    codes.fill(-1);
+    codes['A'] = 0;
+    codes['C'] = 1;
+    codes['G'] = 2;
+    codes['T'] = 3;
+    return codes;
+}();
+
+// Calls fn with each k-mer of seq, 2 bits per base, skipping any containing other characters.
+// fn returns true to stop early.
+template <typename Fn>
+void for_each_kmer(std::string_view seq, int kmer_length, Fn&& fn) {
+    const uint32_t mask = ~uint32_t(0) >> (32 - 2 * kmer_length);
+    uint32_t kmer = 0;
+    // Number of valid bases ending at the current position, up to the k-mer length.
+    int num_bases = 0;
+    for (char c : seq) {
+        const int code = kBaseCodes[uint8_t(c)];
+        if (code < 0) {
+            num_bases = 0;
+            continue;
+        }
+        kmer = ((kmer << 2) | uint32_t(code)) & mask;
+        num_bases = std::min(num_bases + 1, kmer_length);
+        if (num_bases == kmer_length && fn(kmer)) {
+            return;
+        }
+    }
+}
+
+}  // namespace
+
+namespace dorado::demux {
+
+KmerPrefilter::KmerPrefilter(const std::vector<std::string>& sequences, int kmer_length)
+        : m_kmer_length(kmer_length) {
+    if (kmer_length < 1 || kmer_length > MAX_KMER_LENGTH) {
+        throw std::invalid_argument("KmerPrefilter k-mer length must be between 1 and " +
+                                    std::to_string(MAX_KMER_LENGTH));
+    }
+    for (const auto& seq : sequences) {
+        for_each_kmer(seq, m_kmer_length, [this](uint32_t kmer) {
+            m_kmers.push_back(kmer);
+            return false;
+        });
+    }
+    std::sort(m_kmers.begin(), m_kmers.end());
+    m_kmers.erase(std::unique(m_kmers.begin(), m_kmers.end()), m_kmers.end());
+}
+
+bool KmerPrefilter::has_seed(std::string_view window) const {
+    bool found = false;
+    for_each_kmer(window, m_kmer_length, [this, &found](uint32_t kmer) {
+        found = std::binary_search(m_kmers.begin(), m_kmers.end(), kmer);
+        return found;
+    });
+    return found;
+}
+
+}  // namespace dorado::demux
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace dorado::demux {
+
+// Cheap test of whether a window of a read could contain any of a set of sequences, such as a
+// barcoding kit's flanks and barcodes: it can if the two share an exact k-mer.  Windows which
+// share no k-mer with the sequences needn't be aligned against them.
+// Only k-mers of the bases ACGT are considered.
+class KmerPrefilter {
+public:
+    static constexpr int MAX_KMER_LENGTH = 16;
+
+    KmerPrefilter(const std::vector<std::string>& sequences, int kmer_length);
+
+    // Whether window shares a k-mer with any of the sequences.
+    bool has_seed(std::string_view window) const;
+
+    size_t num_kmers() const { return m_kmers.size(); }
+
+private:
+    int m_kmer_length;
+    // Sorted and unique.
+    std::vector<uint32_t> m_kmers;
+};
+
+}  // namespace dorado::demux
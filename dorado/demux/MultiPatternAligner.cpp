@@ -0,0 +1,153 @@
+#include "MultiPatternAligner.h"
+
+#include "utils/simd.h"
+
+#include <stdexcept>
+
+namespace {
+
+// Patterns are processed in groups of this many, which is the number of 64 bit lanes in an AVX2
+// register.
+constexpr size_t kLaneGroupSize = 4;
+
+// One column of Myers' algorithm for global alignment, as in edlib's calculateBlock with a
+// horizontal input delta of +1, since the top row of the DP matrix increases by 1 per column.
+// pv and mv are the positive and negative vertical deltas down the column.  Returns the change
+// in the score of the last row of the pattern.
+inline int advance_column(uint64_t eq, uint64_t& pv, uint64_t& mv, int last_row) {
+    const uint64_t xv = eq | mv;
+    const uint64_t xh = (((eq & pv) + pv) ^ pv) | eq;
+    uint64_t ph = mv | ~(xh | pv);
+    uint64_t mh = pv & xh;
+    const int delta = int((ph >> last_row) & 1) - int((mh >> last_row) & 1);
+    ph = (ph << 1) | 1;
+    mh <<= 1;
+    pv = mh | ~(xv | ph);
+    mv = ph & xv;
+    return delta;
+}
+
+#if ENABLE_AVX2_IMPL
+__attribute__((target("default")))
+#endif
+void edit_distances_impl(const uint64_t* match_masks,
+                         const uint16_t* char_codes,
+                         size_t num_lanes,
+                         int pattern_length,
+                         std::string_view text,
+                         int* distances) {
+    const int last_row = pattern_length - 1;
+    for (size_t lane = 0; lane < num_lanes; ++lane) {
+        uint64_t pv = ~uint64_t(0);
+        uint64_t mv = 0;
+        int score = pattern_length;
+        for (char c : text) {
+            const uint64_t eq = match_masks[char_codes[uint8_t(c)] * num_lanes + lane];
+            score += advance_column(eq, pv, mv, last_row);
+        }
+        distances[lane] = score;
+    }
+}
+
+#if ENABLE_AVX2_IMPL
+// The same algorithm, with a group of 4 patterns in each AVX2 register.  All the state for a
+// group stays in registers while it runs over the text.
+__attribute__((target("avx2"))) void edit_distances_impl(const uint64_t* match_masks,
+                                                         const uint16_t* char_codes,
+                                                         size_t num_lanes,
+                                                         int pattern_length,
+                                                         std::string_view text,
+                                                         int* distances) {
+    const __m128i last_row = _mm_cvtsi32_si128(pattern_length - 1);
+    const __m256i kOnes = _mm256_set1_epi64x(1);
+    const __m256i kAllBits = _mm256_set1_epi64x(-1);
+    for (size_t lane = 0; lane < num_lanes; lane += kLaneGroupSize) {
+        __m256i pv = kAllBits;
+        __m256i mv = _mm256_setzero_si256();
+        __m256i score = _mm256_set1_epi64x(pattern_length);
+        for (char c : text) {
+            const __m256i eq = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(
+                    match_masks + char_codes[uint8_t(c)] * num_lanes + lane));
+            const __m256i xv = _mm256_or_si256(eq, mv);
+            const __m256i sum = _mm256_add_epi64(_mm256_and_si256(eq, pv), pv);
+            const __m256i xh = _mm256_or_si256(_mm256_xor_si256(sum, pv), eq);
+            const __m256i not_xh_pv = _mm256_andnot_si256(_mm256_or_si256(xh, pv), kAllBits);
+            __m256i ph = _mm256_or_si256(mv, not_xh_pv);
+            __m256i mh = _mm256_and_si256(pv, xh);
+            const __m256i ph_last = _mm256_and_si256(_mm256_srl_epi64(ph, last_row), kOnes);
+            const __m256i mh_last = _mm256_and_si256(_mm256_srl_epi64(mh, last_row), kOnes);
+            score = _mm256_sub_epi64(_mm256_add_epi64(score, ph_last), mh_last);
+            ph = _mm256_or_si256(_mm256_slli_epi64(ph, 1), kOnes);
+            mh = _mm256_slli_epi64(mh, 1);
+            pv = _mm256_or_si256(mh, _mm256_andnot_si256(_mm256_or_si256(xv, ph), kAllBits));
+            mv = _mm256_and_si256(ph, xv);
+        }
+        alignas(32) int64_t scores[kLaneGroupSize];
+        _mm256_store_si256(reinterpret_cast<__m256i*>(scores), score);
+        for (size_t i = 0; i < kLaneGroupSize; ++i) {
+            distances[lane + i] = int(scores[i]);
+        }
+    }
+}
+#endif
+
+}  // namespace
+
+namespace dorado::demux {
+
+MultiPatternAligner::MultiPatternAligner(const std::vector<std::string>& patterns)
+        : m_num_patterns(patterns.size()),
+          m_pattern_length(patterns.empty() ? 0 : patterns.front().size()),
+          m_num_lanes((patterns.size() + kLaneGroupSize - 1) / kLaneGroupSize * kLaneGroupSize) {
+    if (!supports(patterns)) {
+        throw std::invalid_argument(
+                "MultiPatternAligner patterns must have the same length, of at most " +
+                std::to_string(MAX_PATTERN_LENGTH));
+    }
+
+    // Row 0 is for characters which don't appear in any pattern.
+    size_t num_codes = 1;
+    for (const auto& pattern : patterns) {
+        for (char c : pattern) {
+            auto& code = m_char_codes[uint8_t(c)];
+            if (code == 0) {
+                code = uint16_t(num_codes++);
+            }
+        }
+    }
+
+    m_match_masks.assign(num_codes * m_num_lanes, 0);
+    for (size_t lane = 0; lane < patterns.size(); ++lane) {
+        for (size_t i = 0; i < m_pattern_length; ++i) {
+            const auto code = m_char_codes[uint8_t(patterns[lane][i])];
+            m_match_masks[code * m_num_lanes + lane] |= uint64_t(1) << i;
+        }
+    }
+}
+
+bool MultiPatternAligner::supports(const std::vector<std::string>& patterns) {
+    if (patterns.empty()) {
+        return false;
+    }
+    const size_t length = patterns.front().size();
+    if (length == 0 || length > MAX_PATTERN_LENGTH) {
+        return false;
+    }
+    for (const auto& pattern : patterns) {
+        if (pattern.size() != length) {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::vector<int> MultiPatternAligner::edit_distances(std::string_view text) const {
+    // Padding lanes match nothing, and their distances are dropped.
+    std::vector<int> distances(m_num_lanes);
+    edit_distances_impl(m_match_masks.data(), m_char_codes.data(), m_num_lanes,
+                        int(m_pattern_length), text, distances.data());
+    distances.resize(m_num_patterns);
+    return distances;
+}
+
+}  // namespace dorado::demux
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace dorado::demux {
+
+// Computes the global edit distance of each of a set of patterns against a text in a single pass
+// over the text, using Myers' bit-vector algorithm with one 64 bit word of state per pattern.
+// Where AVX2 is available the patterns are processed 4 at a time, one per SIMD lane.
+// The distances are the same as edlib reports for each pattern in EDLIB_MODE_NW.
+class MultiPatternAligner {
+public:
+    // Longest pattern which fits in a word of state.
+    static constexpr size_t MAX_PATTERN_LENGTH = 64;
+
+    // Patterns must all have the same length, between 1 and MAX_PATTERN_LENGTH.
+    explicit MultiPatternAligner(const std::vector<std::string>& patterns);
+
+    // Whether patterns can be aligned by a MultiPatternAligner.
+    static bool supports(const std::vector<std::string>& patterns);
+
+    size_t num_patterns() const { return m_num_patterns; }
+    size_t pattern_length() const { return m_pattern_length; }
+
+    // Returns the edit distance of each pattern, in the order given, against the whole of text.
+    std::vector<int> edit_distances(std::string_view text) const;
+
+private:
+    size_t m_num_patterns;
+    size_t m_pattern_length;
+    // Number of patterns rounded up to a whole number of SIMD registers.
+    size_t m_num_lanes;
+    // Maps each character to the row of m_match_masks for it.  Row 0, for characters which
+    // aren't in any pattern, matches nothing.
+    std::array<uint16_t, 256> m_char_codes{};
+    // For each character code, the bits of each pattern's positions which match it, with
+    // m_num_lanes words per row.
+    std::vector<uint64_t> m_match_masks;
+};
+
+}  // namespace dorado::demux
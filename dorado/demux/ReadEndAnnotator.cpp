@@ -0,0 +1,127 @@
+#include "ReadEndAnnotator.h"
+
+#include "BarcodeClassifier.h"
+#include "Trimmer.h"
+#include "utils/barcode_kits.h"
+
+#include <htslib/sam.h>
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+
+namespace {
+
+const std::string UNCLASSIFIED_BARCODE = "unclassified";
+
+}  // namespace
+
+namespace dorado::demux {
+
+bool has_barcoding_kit(const BarcodingInfo* barcoding_info) {
+    return barcoding_info &&
+           (!barcoding_info->kit_name.empty() || barcoding_info->custom_kit.has_value());
+}
+
+std::shared_ptr<const BarcodingInfo> get_barcoding_info(
+        const std::shared_ptr<const BarcodingInfo>& default_info,
+        const SimplexRead& read) {
+    if (has_barcoding_kit(default_info.get())) {
+        return default_info;
+    }
+    if (has_barcoding_kit(read.read_common.barcoding_info.get())) {
+        return read.read_common.barcoding_info;
+    }
+    return nullptr;
+}
+
+std::string generate_barcode_string(const BarcodeScoreResult& bc_res) {
+    std::string bc;
+    if (bc_res.barcode_name != UNCLASSIFIED_BARCODE) {
+        bc = barcode_kits::generate_standard_barcode_name(bc_res.kit, bc_res.barcode_name);
+    } else {
+        bc = UNCLASSIFIED_BARCODE;
+    }
+    spdlog::trace("BC: {}", bc);
+    return bc;
+}
+
+ReadEndAnnotation ReadEndAnnotator::annotate(const std::string& seq,
+                                             bool find_adapters,
+                                             bool find_primers,
+                                             const BarcodingInfo* barcoding_info) {
+    const int seqlen = int(seq.length());
+    ReadEndAnnotation annotation;
+
+    auto& adapter_interval = annotation.adapter_trim_interval;
+    adapter_interval = {0, seqlen};
+    if (find_adapters) {
+        annotation.adapters = m_detector.find_adapters(seq);
+        adapter_interval = Trimmer::determine_trim_interval(*annotation.adapters, seqlen);
+    }
+    if (find_primers) {
+        annotation.primers = m_detector.find_primers(seq);
+        const auto primer_interval = Trimmer::determine_trim_interval(*annotation.primers, seqlen);
+        adapter_interval.first = std::max(adapter_interval.first, primer_interval.first);
+        adapter_interval.second = std::min(adapter_interval.second, primer_interval.second);
+    }
+    if (find_adapters || find_primers) {
+        annotation.trim_adapters = adapter_interval.first < adapter_interval.second;
+        if (!annotation.trim_adapters) {
+            spdlog::warn("Unexpected adapter/primer trim interval {}-{} for {}",
+                         adapter_interval.first, adapter_interval.second, seq);
+            adapter_interval = {0, seqlen};
+        }
+    }
+
+    const int trimmed_len = adapter_interval.second - adapter_interval.first;
+    annotation.barcode_trim_interval = {0, trimmed_len};
+    if (has_barcoding_kit(barcoding_info)) {
+        // Barcodes are looked for in the read as it will be after adapter and primer trimming.
+        std::string trimmed_seq;
+        if (trimmed_len < seqlen) {
+            trimmed_seq = seq.substr(adapter_interval.first, trimmed_len);
+        }
+        const auto& barcode_seq = trimmed_len < seqlen ? trimmed_seq : seq;
+        auto barcoder = m_barcoder_selector.get_barcoder(*barcoding_info);
+        annotation.barcode = barcoder->barcode(barcode_seq, barcoding_info->barcode_both_ends,
+                                               barcoding_info->allowed_barcodes);
+        annotation.trim_barcode = barcoding_info->trim;
+        if (annotation.trim_barcode) {
+            annotation.barcode_trim_interval =
+                    Trimmer::determine_trim_interval(*annotation.barcode, trimmed_len);
+        }
+    }
+
+    annotation.trim_interval = {adapter_interval.first + annotation.barcode_trim_interval.first,
+                                adapter_interval.first + annotation.barcode_trim_interval.second};
+    return annotation;
+}
+
+void ReadEndAnnotator::apply(const ReadEndAnnotation& annotation, BamPtr& record) {
+    const auto& [adapter_start, adapter_end] = annotation.adapter_trim_interval;
+    const auto& [barcode_start, barcode_end] = annotation.barcode_trim_interval;
+    // The BC tag goes on before trimming, so that it comes ahead of the ts and ns tags which
+    // trimming adds, as it did when barcoding and trimming were separate steps.
+    if (annotation.barcode) {
+        const auto bc = generate_barcode_string(*annotation.barcode);
+        bam_aux_append(record.get(), "BC", 'Z', int(bc.length() + 1), (uint8_t*)bc.c_str());
+    }
+    if (annotation.trim_adapters || barcode_end - barcode_start < adapter_end - adapter_start) {
+        record = Trimmer::trim_sequence(std::move(record), annotation.trim_interval);
+    }
+}
+
+void ReadEndAnnotator::apply(const ReadEndAnnotation& annotation, SimplexRead& read) {
+    if (annotation.barcode) {
+        read.read_common.barcode = generate_barcode_string(*annotation.barcode);
+        read.read_common.barcoding_result =
+                std::make_shared<BarcodeScoreResult>(*annotation.barcode);
+        if (annotation.trim_barcode) {
+            read.read_common.barcode_trim_interval = annotation.barcode_trim_interval;
+        }
+    }
+    // Reads are left alone if the interval is the whole read.
+    Trimmer::trim_sequence(read, annotation.trim_interval);
+}
+
+}  // namespace dorado::demux
@@ -0,0 +1,77 @@
+#pragma once
+#include "AdapterDetector.h"
+#include "BarcodeClassifierSelector.h"
+#include "read_pipeline/ReadPipeline.h"
+#include "utils/stats.h"
+#include "utils/types.h"
+
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+
+namespace dorado::demux {
+
+// Everything ReadEndAnnotator found at the ends of a read.
+struct ReadEndAnnotation {
+    // Unset if they weren't looked for.
+    std::optional<AdapterScoreResult> adapters;
+    std::optional<AdapterScoreResult> primers;
+    std::optional<BarcodeScoreResult> barcode;
+    // The part of the read to keep after adapter and primer trimming.  This is the whole read if
+    // they weren't looked for, or if trimming them would leave nothing.
+    std::pair<int, int> adapter_trim_interval{};
+    // Whether the read should be adapter trimmed: adapters or primers were looked for and trimming
+    // them leaves something.
+    bool trim_adapters{false};
+    // The part of the adapter trimmed read to keep after barcode trimming.  The barcode positions
+    // are also relative to the adapter trimmed read.
+    std::pair<int, int> barcode_trim_interval{};
+    // Whether barcode_trim_interval comes from the barcode, rather than being the whole read.
+    bool trim_barcode{false};
+    // The part of the read to keep after all trimming.
+    std::pair<int, int> trim_interval{};
+};
+
+// Whether barcoding_info names a kit to barcode with.
+bool has_barcoding_kit(const BarcodingInfo* barcoding_info);
+
+// The barcoding info to use for a read: default_info if it has a kit, otherwise the read's own, or
+// null if neither has one.
+std::shared_ptr<const BarcodingInfo> get_barcoding_info(
+        const std::shared_ptr<const BarcodingInfo>& default_info,
+        const SimplexRead& read);
+
+// The name a read is labelled with for a barcoding result, in its BC tag for example.
+std::string generate_barcode_string(const BarcodeScoreResult& bc_res);
+
+// Looks for adapters, primers and barcodes at the ends of a read in one step.  The results are the
+// same as running an AdapterDetector, trimming the read, then running a BarcodeClassifier, but the
+// read only needs trimming once.  AdapterDetectorNode, BarcodeClassifierNode and
+// ReadEndAnnotatorNode all use this, with whichever searches they do.
+class ReadEndAnnotator {
+public:
+    // Barcoders screen reads with k-mers of prefilter_kmer_length, if it's positive.
+    explicit ReadEndAnnotator(int prefilter_kmer_length = 0)
+            : m_barcoder_selector(prefilter_kmer_length) {}
+
+    // Barcoding is skipped if barcoding_info is null.
+    ReadEndAnnotation annotate(const std::string& seq,
+                               bool find_adapters,
+                               bool find_primers,
+                               const BarcodingInfo* barcoding_info);
+
+    // Trims the record and adds its BC tag.  Records are always rewritten when they are adapter
+    // trimmed, so they get ts and ns tags, but otherwise only when barcode trimming shortens them.
+    static void apply(const ReadEndAnnotation& annotation, BamPtr& record);
+    // Trims the read and sets its barcoding results.
+    static void apply(const ReadEndAnnotation& annotation, SimplexRead& read);
+
+    stats::NamedStats sample_stats() const { return m_barcoder_selector.sample_stats(); }
+
+private:
+    AdapterDetector m_detector;
+    BarcodeClassifierSelector m_barcoder_selector;
+};
+
+}  // namespace dorado::demux
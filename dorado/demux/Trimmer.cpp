@@ -4,8 +4,18 @@
 #include "utils/trim.h"
 
 #include <ATen/ATen.h>
+#include <htslib/hts_endian.h>
 #include <htslib/sam.h>
 
+#include <array>
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
 using Slice = at::indexing::Slice;
 
 namespace {
@@ -30,6 +40,211 @@ void trim_torch_tensor(at::Tensor& raw_data, std::pair<uint64_t,uint64_t> sample
     raw_data = raw_data.index({Slice(sample_trim_interval.first, sample_trim_interval.second)});
 }
 
+// Size of each element of a B array aux field with the given subtype.
+size_t aux_element_size(uint8_t subtype) {
+    switch (subtype) {
+    case 'c':
+    case 'C':
+        return 1;
+    case 's':
+    case 'S':
+        return 2;
+    case 'i':
+    case 'I':
+    case 'f':
+        return 4;
+    default:
+        throw std::runtime_error("Invalid BAM aux array type " + std::string(1, char(subtype)));
+    }
+}
+
+// Size of an aux field, including its tag and type, which starts at field.
+size_t aux_field_size(const uint8_t* field, const uint8_t* aux_end) {
+    const uint8_t* value = field + 3;
+    if (value > aux_end) {
+        throw std::runtime_error("Truncated BAM aux data");
+    }
+    size_t size = 0;
+    switch (field[2]) {
+    case 'A':
+    case 'c':
+    case 'C':
+        size = 1;
+        break;
+    case 's':
+    case 'S':
+        size = 2;
+        break;
+    case 'i':
+    case 'I':
+    case 'f':
+        size = 4;
+        break;
+    case 'd':
+        size = 8;
+        break;
+    case 'Z':
+    case 'H': {
+        const void* nul = std::memchr(value, 0, aux_end - value);
+        if (!nul) {
+            throw std::runtime_error("Unterminated string in BAM aux data");
+        }
+        size = static_cast<const uint8_t*>(nul) - value + 1;
+        break;
+    }
+    case 'B':
+        if (aux_end - value < 5) {
+            throw std::runtime_error("Truncated BAM aux data");
+        }
+        size = 5 + size_t(le_to_u32(value + 1)) * aux_element_size(value[0]);
+        break;
+    default:
+        throw std::runtime_error("Invalid BAM aux type " + std::string(1, char(field[2])));
+    }
+    if (size_t(aux_end - value) < size) {
+        throw std::runtime_error("Truncated BAM aux data");
+    }
+    return 3 + size;
+}
+
+void append_bytes(std::vector<uint8_t>& out, const void* data, size_t size) {
+    if (size == 0) {
+        return;
+    }
+    const size_t offset = out.size();
+    out.resize(offset + size);
+    std::memcpy(out.data() + offset, data, size);
+}
+
+void append_array_header(std::vector<uint8_t>& out, const char* tag, char subtype, size_t count) {
+    uint8_t header[8] = {uint8_t(tag[0]), uint8_t(tag[1]), 'B', uint8_t(subtype)};
+    u32_to_le(uint32_t(count), header + 4);
+    append_bytes(out, header, sizeof(header));
+}
+
+// Appends an integer tag using the smallest type which holds value, as bam_aux_update_int does.
+void append_int_tag(std::vector<uint8_t>& out, const char* tag, int64_t value) {
+    uint8_t field[7] = {uint8_t(tag[0]), uint8_t(tag[1])};
+    size_t size = 0;
+    if (value >= 0 && value <= UINT8_MAX) {
+        field[2] = 'C';
+        field[3] = uint8_t(value);
+        size = 4;
+    } else if (value >= 0 && value <= UINT16_MAX) {
+        field[2] = 'S';
+        u16_to_le(uint16_t(value), field + 3);
+        size = 5;
+    } else if (value >= 0 && value <= UINT32_MAX) {
+        field[2] = 'I';
+        u32_to_le(uint32_t(value), field + 3);
+        size = 7;
+    } else {
+        field[2] = 'i';
+        i32_to_le(int32_t(value), field + 3);
+        size = 7;
+    }
+    append_bytes(out, field, size);
+}
+
+// The part of a move table which is kept by a trim, found as by utils::trim_move_table.
+struct MoveTrim {
+    size_t first = 0;
+    size_t count = 0;
+    // Number of moves before the kept part.
+    int positions_trimmed = 0;
+};
+
+MoveTrim trim_moves(const uint8_t* moves, size_t num_moves, std::pair<int, int> trim_interval) {
+    MoveTrim trim;
+    if (num_moves == 0 || trim_interval.second <= trim_interval.first) {
+        return trim;
+    }
+    int seq_base_pos = -1;
+    size_t i = 0;
+    for (; i < num_moves; ++i) {
+        if (moves[i] == 1) {
+            seq_base_pos++;
+        }
+        if (seq_base_pos >= trim_interval.second) {
+            break;
+        } else if (seq_base_pos < trim_interval.first) {
+            trim.positions_trimmed++;
+        }
+    }
+    trim.first = size_t(trim.positions_trimmed);
+    trim.count = i - trim.first;
+    return trim;
+}
+
+// Writes the MM tag value and ML probabilities of the trimmed read to mm_out and ml_out, as
+// utils::trim_modbase_info does, but counting bases in the packed sequence.  ml is the ML aux
+// field, or null.
+void trim_modbase_tags(std::string_view mm,
+                       const uint8_t* ml,
+                       const uint8_t* packed_seq,
+                       std::pair<int, int> trim_interval,
+                       std::string& mm_out,
+                       std::vector<uint8_t>& ml_out) {
+    // Counts of each 4 bit base code before the start and end of the trimmed read.
+    std::array<int, 16> bases_skipped_at_start{};
+    std::array<int, 16> bases_skipped_at_end{};
+    for (int i = 0; i < trim_interval.second; i++) {
+        if (i == trim_interval.first) {
+            bases_skipped_at_start = bases_skipped_at_end;
+        }
+        bases_skipped_at_end[bam_seqi(packed_seq, i)]++;
+    }
+    if (trim_interval.first >= trim_interval.second) {
+        bases_skipped_at_start = bases_skipped_at_end;
+    }
+
+    const uint32_t num_probs = ml ? bam_auxB_len(ml) : 0;
+    uint32_t prob_pos = 0;
+    while (!mm.empty()) {
+        auto mod = mm.substr(0, mm.find(';'));
+        mm.remove_prefix(std::min(mod.length() + 1, mm.length()));
+
+        // Each modification starts with a prefix such as C+m?, followed by the skip counts.
+        const auto prefix = mod.substr(0, mod.find(','));
+        mod.remove_prefix(std::min(prefix.length() + 1, mod.length()));
+        const auto base_code = prefix.empty() ? 0 : seq_nt16_table[uint8_t(prefix[0])];
+        const int cardinal_count_at_start = bases_skipped_at_start[base_code];
+        const int cardinal_count_at_end = bases_skipped_at_end[base_code];
+
+        const size_t mod_start = mm_out.size();
+        mm_out += prefix;
+        bool found_start = false;
+        int cardinal_bases_seen = 0;
+        while (!mod.empty()) {
+            const auto count = mod.substr(0, mod.find(','));
+            mod.remove_prefix(std::min(count.length() + 1, mod.length()));
+            int num_skips = 0;
+            std::from_chars(count.data(), count.data() + count.length(), num_skips);
+            cardinal_bases_seen += num_skips;
+            if (cardinal_bases_seen < cardinal_count_at_end &&
+                cardinal_bases_seen >= cardinal_count_at_start) {
+                // The first kept modified base's skip count starts from the trim start.
+                const int skips =
+                        found_start ? num_skips : cardinal_bases_seen - cardinal_count_at_start;
+                found_start = true;
+                mm_out += ',';
+                mm_out += std::to_string(skips);
+                if (prob_pos < num_probs) {
+                    ml_out.push_back(uint8_t(bam_auxB2i(ml, prob_pos)));
+                }
+            }
+            prob_pos++;
+            cardinal_bases_seen++;
+        }
+        if (found_start) {
+            mm_out += ';';
+        } else {
+            // Modifications with no modified bases left are dropped.
+            mm_out.resize(mod_start);
+        }
+    }
+}
+
 }  // namespace
 
 namespace dorado {
@@ -119,73 +334,152 @@ std::pair<int, int> Trimmer::determine_trim_interval(const AdapterScoreResult& r
     return trim_interval;
 }
 
+// The record is trimmed without unpacking its sequence or tags into separate containers: the new
+// data block is assembled in a reused per-thread buffer, then copied over the record's own.
 BamPtr Trimmer::trim_sequence(BamPtr input, std::pair<int, int> trim_interval) {
-    bam1_t* input_record = input.get();
-
-    // Fetch components that need to be trimmed.
-    std::string seq = utils::extract_sequence(input_record);
-    std::vector<uint8_t> qual = utils::extract_quality(input_record);
-    auto [stride, move_vals] = utils::extract_move_table(input_record);
-    int ts = bam_aux_get(input_record, "ts") ? int(bam_aux2i(bam_aux_get(input_record, "ts"))) : 0;
-    int ns = bam_aux_get(input_record, "ns") ? int(bam_aux2i(bam_aux_get(input_record, "ns"))) : 0;
-    auto [modbase_str, modbase_probs] = utils::extract_modbase_info(input_record);
-
-    // Actually trim components.
-    auto trimmed_seq = utils::trim_sequence(seq, trim_interval);
-    auto trimmed_qual = utils::trim_quality(qual, trim_interval);
-    auto [positions_trimmed, trimmed_moves] = utils::trim_move_table(move_vals, trim_interval);
-    ts += positions_trimmed * stride;
+    bam1_t* record = input.get();
+    const int seqlen = record->core.l_qseq;
+    const auto [start, end] = trim_interval;
+    if (start >= seqlen || end > seqlen || end < start) {
+        throw std::invalid_argument("Trim interval " + std::to_string(start) + "-" +
+                                    std::to_string(end) + " is invalid for sequence " +
+                                    utils::extract_sequence(record));
+    }
+    const int trimmed_len = end - start;
+
+    // Find the tags which change.
+    const uint8_t* mv = bam_aux_get(record, "mv");
+    const uint8_t* mm = bam_aux_get(record, "MM");
+    const uint8_t* ml = mm ? bam_aux_get(record, "ML") : nullptr;
+    const uint8_t* ts_tag = bam_aux_get(record, "ts");
+    const uint8_t* ns_tag = bam_aux_get(record, "ns");
+
+    // Move table format is stride followed by moves.
+    thread_local std::vector<uint8_t> unpacked_moves;
+    int stride = 0;
+    const uint8_t* moves = nullptr;
+    size_t num_moves = 0;
+    if (mv) {
+        const uint32_t len = bam_auxB_len(mv);
+        stride = int(bam_auxB2i(mv, 0));
+        num_moves = len > 0 ? len - 1 : 0;
+        if (aux_element_size(mv[1]) == 1) {
+            moves = mv + 6 + 1;
+        } else {
+            unpacked_moves.resize(num_moves);
+            for (size_t i = 0; i < num_moves; ++i) {
+                unpacked_moves[i] = uint8_t(bam_auxB2i(mv, uint32_t(i + 1)));
+            }
+            moves = unpacked_moves.data();
+        }
+    }
+    const auto move_trim = trim_moves(moves, num_moves, trim_interval);
+    int ts = ts_tag ? int(bam_aux2i(ts_tag)) : 0;
+    ts += move_trim.positions_trimmed * stride;
     // After sequence trimming, the number of samples corresponding to the sequence is the size of
     // the new move table * stride. However, the ns tag includes the number of samples trimmed from the
     // front of the read as well.
     // |---------------------- ns ------------------|
     // |----ts----|--------moves signal-------------|
-    ns = int(trimmed_moves.size() * stride) + ts;
-    auto [trimmed_modbase_str, trimmed_modbase_probs] =
-            utils::trim_modbase_info(seq, modbase_str, modbase_probs, trim_interval);
-    auto n_cigar = input_record->core.n_cigar;
+    const int ns = int(move_trim.count) * stride + ts;
+
+    thread_local std::string trimmed_mm;
+    thread_local std::vector<uint8_t> trimmed_ml;
+    trimmed_mm.clear();
+    trimmed_ml.clear();
+    if (mm) {
+        trim_modbase_tags(bam_aux2Z(mm), ml, bam_get_seq(record), trim_interval, trimmed_mm,
+                          trimmed_ml);
+    }
+
     std::vector<uint32_t> ops;
     uint32_t ref_pos_consumed = 0;
+    const auto n_cigar = record->core.n_cigar;
     if (n_cigar > 0) {
-        auto cigar_arr = bam_get_cigar(input_record);
+        auto cigar_arr = bam_get_cigar(record);
         ops = utils::trim_cigar(n_cigar, cigar_arr, trim_interval);
-        ref_pos_consumed =
-                ops.empty() ? 0 : utils::ref_pos_consumed(n_cigar, cigar_arr, trim_interval.first);
-    }
-
-    // Create a new bam record to hold the trimmed read.
-    bam1_t* out_record = bam_init1();
-    bam_set1(out_record, input_record->core.l_qname - input_record->core.l_extranul - 1,
-             bam_get_qname(input_record), input_record->core.flag, input_record->core.tid,
-             input_record->core.pos + ref_pos_consumed, input_record->core.qual, ops.size(),
-             ops.empty() ? NULL : ops.data(), input_record->core.mtid, input_record->core.mpos,
-             input_record->core.isize, trimmed_seq.size(), trimmed_seq.data(),
-             trimmed_qual.empty() ? NULL : (char*)trimmed_qual.data(), bam_get_l_aux(input_record));
-    memcpy(bam_get_aux(out_record), bam_get_aux(input_record), bam_get_l_aux(input_record));
-    out_record->l_data += bam_get_l_aux(input_record);
-
-    // Insert the new tags and delete the old ones.
-    if (!trimmed_moves.empty()) {
-        bam_aux_del(out_record, bam_aux_get(out_record, "mv"));
-        // Move table format is stride followed by moves.
-        trimmed_moves.insert(trimmed_moves.begin(), uint8_t(stride));
-        bam_aux_update_array(out_record, "mv", 'c', int(trimmed_moves.size()),
-                             (uint8_t*)trimmed_moves.data());
-    }
-
-    if (!trimmed_modbase_str.empty()) {
-        bam_aux_del(out_record, bam_aux_get(out_record, "MM"));
-        bam_aux_append(out_record, "MM", 'Z', int(trimmed_modbase_str.length() + 1),
-                       (uint8_t*)trimmed_modbase_str.c_str());
-        bam_aux_del(out_record, bam_aux_get(out_record, "ML"));
-        bam_aux_update_array(out_record, "ML", 'C', int(trimmed_modbase_probs.size()),
-                             (uint8_t*)trimmed_modbase_probs.data());
-    }
-
-    bam_aux_update_int(out_record, "ts", ts);
-    bam_aux_update_int(out_record, "ns", ns);
-
-    return BamPtr(out_record);
+        ref_pos_consumed = ops.empty() ? 0 : utils::ref_pos_consumed(n_cigar, cigar_arr, start);
+    }
+
+    // Assemble the new data block: query name, CIGAR, sequence, qualities, then aux fields.
+    thread_local std::vector<uint8_t> data;
+    data.clear();
+    data.reserve(record->l_data + 16);
+    append_bytes(data, bam_get_qname(record), record->core.l_qname);
+    append_bytes(data, ops.data(), ops.size() * sizeof(uint32_t));
+
+    const uint8_t* seq = bam_get_seq(record);
+    const size_t seq_offset = data.size();
+    data.resize(seq_offset + (trimmed_len + 1) / 2);
+    uint8_t* trimmed_seq = data.data() + seq_offset;
+    if (start % 2 == 0) {
+        std::memcpy(trimmed_seq, seq + start / 2, (trimmed_len + 1) / 2);
+    } else {
+        for (int i = 0; i < trimmed_len; i += 2) {
+            const int low = i + 1 < trimmed_len ? bam_seqi(seq, start + i + 1) : 0;
+            trimmed_seq[i / 2] = uint8_t((bam_seqi(seq, start + i) << 4) | low);
+        }
+    }
+    if (trimmed_len % 2 == 1) {
+        // The unused low bits of the last byte are zero.
+        trimmed_seq[trimmed_len / 2] &= 0xf0;
+    }
+    append_bytes(data, bam_get_qual(record) + start, trimmed_len);
+
+    // Rewritten tags stay where they were.  As before, the move table and modified base tags are
+    // only replaced if something of them is left.
+    const uint8_t* aux = bam_get_aux(record);
+    const uint8_t* aux_end = aux + bam_get_l_aux(record);
+    while (aux < aux_end) {
+        const size_t field_size = aux_field_size(aux, aux_end);
+        const uint8_t* value = aux + 2;
+        if (value == mv && move_trim.count > 0) {
+            append_array_header(data, "mv", 'c', move_trim.count + 1);
+            data.push_back(uint8_t(stride));
+            append_bytes(data, moves + move_trim.first, move_trim.count);
+        } else if (value == mm && !trimmed_mm.empty()) {
+            const uint8_t header[3] = {'M', 'M', 'Z'};
+            append_bytes(data, header, sizeof(header));
+            append_bytes(data, trimmed_mm.c_str(), trimmed_mm.length() + 1);
+        } else if (value == ml && !trimmed_mm.empty()) {
+            append_array_header(data, "ML", 'C', trimmed_ml.size());
+            append_bytes(data, trimmed_ml.data(), trimmed_ml.size());
+        } else if (value == ts_tag) {
+            append_int_tag(data, "ts", ts);
+        } else if (value == ns_tag) {
+            append_int_tag(data, "ns", ns);
+        } else {
+            append_bytes(data, aux, field_size);
+        }
+        aux += field_size;
+    }
+    if (!ts_tag) {
+        append_int_tag(data, "ts", ts);
+    }
+    if (!ns_tag) {
+        append_int_tag(data, "ns", ns);
+    }
+
+    // Copy the new data over the old, and update the core fields to match.
+    if (data.size() > record->m_data && sam_realloc_bam_data(record, data.size()) < 0) {
+        throw std::bad_alloc();
+    }
+    std::memcpy(record->data, data.data(), data.size());
+    record->l_data = int(data.size());
+    record->core.n_cigar = uint32_t(ops.size());
+    record->core.l_qseq = trimmed_len;
+    record->core.pos += ref_pos_consumed;
+    // As bam_set1 does.
+    hts_pos_t rlen = 0;
+    if (!(record->core.flag & BAM_FUNMAP)) {
+        rlen = bam_cigar2rlen(int(ops.size()), ops.data());
+    }
+    if (rlen == 0) {
+        rlen = 1;
+    }
+    record->core.bin = uint16_t(hts_reg2bin(record->core.pos, record->core.pos + rlen, 14, 5));
+
+    return input;
 }
 
 void Trimmer::trim_sequence(SimplexRead& read, std::pair<int, int> trim_interval) {
@@ -23,9 +23,9 @@ void ModBaseContext::set_context(std::string motif, size_t offset) {
     }
     char base = motif.at(offset);
     auto index = utils::base_to_int(base);
-    m_motif_matchers[index] = std::make_unique<MotifMatcher>(motif, offset);
     m_motifs[index] = std::move(motif);
     m_offsets[index] = offset;
+    update_motif_matcher();
 }
 
 bool ModBaseContext::decode(const std::string& context_string) {
@@ -41,7 +41,6 @@ bool ModBaseContext::decode(const std::string& context_string) {
     auto canonical = "ACGT";
     for (size_t i = 0; i < 4; ++i) {
         if (tokens[i] == "_") {
-            m_motif_matchers[i].reset();
             m_motifs[i].clear();
             m_offsets[i] = 0;
         } else {
@@ -52,12 +51,26 @@ bool ModBaseContext::decode(const std::string& context_string) {
             m_motifs[i] = tokens[i];
             m_motifs[i][x] = canonical[i];
             m_offsets[i] = x;
-            m_motif_matchers[i] = std::make_unique<MotifMatcher>(m_motifs[i], m_offsets[i]);
         }
     }
+    update_motif_matcher();
     return true;
 }
 
+void ModBaseContext::update_motif_matcher() {
+    std::vector<MotifMatcher::Motif> motifs;
+    for (size_t i = 0; i < 4; ++i) {
+        if (!m_motifs[i].empty()) {
+            motifs.push_back({m_motifs[i], m_offsets[i]});
+        }
+    }
+    if (motifs.empty()) {
+        m_motif_matcher.reset();
+    } else {
+        m_motif_matcher = std::make_unique<MotifMatcher>(motifs);
+    }
+}
+
 std::string ModBaseContext::encode() const {
     std::ostringstream s;
     for (size_t i = 0; i < 4; ++i) {
@@ -76,12 +89,10 @@ std::string ModBaseContext::encode() const {
 
 std::vector<bool> ModBaseContext::get_sequence_mask(std::string_view sequence) const {
     std::vector<bool> mask(sequence.size(), false);
-    for (auto& matcher : m_motif_matchers) {
-        if (matcher) {
-            auto hits = matcher->get_motif_hits(sequence);
-            for (auto hit : hits) {
-                mask[hit] = true;
-            }
+    if (m_motif_matcher) {
+        auto hits = m_motif_matcher->get_motif_hits(sequence);
+        for (auto hit : hits) {
+            mask[hit] = true;
         }
     }
     return mask;
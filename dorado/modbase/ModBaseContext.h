@@ -89,9 +89,13 @@ public:
                      uint8_t threshold) const;
 
 private:
+    /// Rebuild the matcher for all the motifs which are set.
+    void update_motif_matcher();
+
     std::array<std::string, 4> m_motifs;
     std::array<size_t, 4> m_offsets = {0, 0, 0, 0};
-    std::array<std::unique_ptr<MotifMatcher>, 4> m_motif_matchers;
+    /// Finds hits of every motif in a single pass over a sequence.
+    std::unique_ptr<MotifMatcher> m_motif_matcher;
 };
 
 }  // namespace dorado::modbase
@@ -292,8 +292,9 @@ ModBaseRunner::ModBaseRunner(std::shared_ptr<ModBaseCaller> caller) : m_caller(s
 
 void ModBaseRunner::accept_chunk(int model_id,
                                  int chunk_idx,
-                                 const at::Tensor& signal,
-                                 const std::vector<int8_t>& kmers) {
+                                 const at::Tensor& signals,
+                                 int64_t signal_idx,
+                                 const int8_t* kmers) {
     // As usual, avoid torch indexing because it is glacially slow.
     // GPU base calling uses float16 signals and input tensors.
     // CPU base calling uses float16 signals, float32 input tensors.
@@ -301,10 +302,11 @@ void ModBaseRunner::accept_chunk(int model_id,
 
     auto& input_sigs = m_input_sigs[model_id];
     auto& input_seqs = m_input_seqs[model_id];
-    assert(signal.size(0) == input_sigs.size(2));
+    assert(signals.size(1) == input_sigs.size(2));
 
-    const auto sig_len = signal.size(0);
-    dorado::utils::copy_tensor_elems(input_sigs, chunk_idx * sig_len, signal, 0, sig_len);
+    const auto sig_len = signals.size(1);
+    dorado::utils::copy_tensor_elems(input_sigs, chunk_idx * sig_len, signals,
+                                     signal_idx * sig_len, sig_len);
 
     const auto kmer_elem_count = input_seqs.size(1) * input_seqs.size(2);
     if (input_seqs.dtype() != torch::kInt8) {
@@ -312,7 +314,7 @@ void ModBaseRunner::accept_chunk(int model_id,
     }
     using SeqInputType = int8_t;
     SeqInputType* const input_seqs_ptr = input_seqs.data_ptr<SeqInputType>();
-    std::memcpy(&input_seqs_ptr[chunk_idx * kmer_elem_count], kmers.data(),
+    std::memcpy(&input_seqs_ptr[chunk_idx * kmer_elem_count], kmers,
                 kmer_elem_count * sizeof(SeqInputType));
 }
 
@@ -24,10 +24,13 @@ std::shared_ptr<ModBaseCaller> create_modbase_caller(
 class ModBaseRunner {
 public:
     explicit ModBaseRunner(std::shared_ptr<ModBaseCaller> caller);
+    // Stages a chunk in the model's input buffers.  The chunk's signal is row signal_idx of
+    // signals, and kmers points to its encoded kmers, one chunk of the model's input in size.
     void accept_chunk(int model_id,
                       int chunk_idx,
-                      const at::Tensor& signal,
-                      const std::vector<int8_t>& kmers);
+                      const at::Tensor& signals,
+                      int64_t signal_idx,
+                      const int8_t* kmers);
     at::Tensor call_chunks(int model_id, int num_chunks);
     at::Tensor scale_signal(size_t caller_id,
                             at::Tensor signal,
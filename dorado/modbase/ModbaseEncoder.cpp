@@ -8,6 +8,7 @@
 #include <algorithm>
 #include <cstring>
 #include <stdexcept>
+#include <utility>
 
 namespace dorado::modbase {
 
@@ -26,7 +27,10 @@ ModBaseEncoder::ModBaseEncoder(size_t block_stride,
 void ModBaseEncoder::init(const std::vector<int>& sequence_ints,
                           const std::vector<uint64_t>& seq_to_sig_map) {
     // gcc9 doesn't support <ranges>, which would be useful here
-    m_sequence_ints = sequence_ints;
+    m_padded_sequence_ints.assign(m_bases_before, -1);
+    m_padded_sequence_ints.insert(m_padded_sequence_ints.end(), sequence_ints.begin(),
+                                  sequence_ints.end());
+    m_padded_sequence_ints.insert(m_padded_sequence_ints.end(), m_bases_after, -1);
     m_sample_offsets.resize(seq_to_sig_map.size());
     for (size_t i = 0; i < seq_to_sig_map.size(); i++) {
         m_sample_offsets[i] = int(seq_to_sig_map[i]);
@@ -41,74 +45,26 @@ void ModBaseEncoder::init(const std::vector<int>& sequence_ints,
 
 ModBaseEncoder::Context ModBaseEncoder::get_context(size_t seq_pos) const {
     NVTX3_FUNC_RANGE();
-    if (seq_pos >= size_t(m_seq_len)) {
-        throw std::out_of_range("Sequence position out of range.");
-    }
-
     Context context{};
-    int base_sample_pos =
-            (compute_sample_pos(int(seq_pos)) + compute_sample_pos(int(seq_pos) + 1)) / 2;
-    int samples_before = (m_context_samples / 2);
-    int first_sample = base_sample_pos - samples_before;
-    if (first_sample >= 0) {
-        context.first_sample = size_t(first_sample);
-        context.lead_samples_needed = 0;
-    } else {
-        context.first_sample = 0;
-        context.lead_samples_needed = size_t(-first_sample);
-    }
-    int last_sample = first_sample + m_context_samples;
-    if (last_sample > m_signal_len) {
-        context.num_samples = size_t(m_signal_len) - context.first_sample;
-        context.tail_samples_needed = last_sample - m_signal_len;
-    } else {
-        context.num_samples = size_t(last_sample) - context.first_sample;
-        context.tail_samples_needed = 0;
-    }
-
-    // find base position for first and last sample
-    auto start_it = std::upper_bound(m_sample_offsets.begin(), m_sample_offsets.end(),
-                                     context.first_sample);
-    auto end_it = std::lower_bound(m_sample_offsets.begin(), m_sample_offsets.end(),
-                                   context.first_sample + context.num_samples);
-
-    auto seq_start = std::distance(m_sample_offsets.begin(), start_it) - 1;
-    auto seq_end = std::distance(m_sample_offsets.begin(), end_it);
+    context.data.resize(encoded_context_size());
+    encode_context(seq_pos, context, context.data.data());
+    return context;
+}
 
-    std::vector<int> seq_ints;
+size_t ModBaseEncoder::encoded_context_size() const {
+    return size_t(m_kmer_len) * utils::BaseInfo::NUM_BASES * m_context_samples;
+}
 
-    if (seq_start >= m_bases_before &&
-        seq_end + m_bases_after < static_cast<int>(m_sequence_ints.size())) {
-        seq_ints = {m_sequence_ints.begin() + seq_start - m_bases_before,
-                    m_sequence_ints.begin() + seq_end + m_bases_after};
-    } else {
-        seq_ints.insert(seq_ints.end(), seq_end - seq_start + m_bases_before + m_bases_after, -1);
-        auto fill_st = 0;
-        auto chunk_seq_st = seq_start - m_bases_before;
-        auto chunk_seq_en = seq_end + m_bases_after;
-        if (seq_start < m_bases_before) {
-            fill_st = m_bases_before - int(seq_start);
-            chunk_seq_st = 0;
-        }
-        if (seq_end + m_bases_after > static_cast<int>(m_sequence_ints.size())) {
-            chunk_seq_en = m_sequence_ints.size();
-        }
-        std::copy(m_sequence_ints.begin() + chunk_seq_st, m_sequence_ints.begin() + chunk_seq_en,
-                  seq_ints.begin() + fill_st);
+std::vector<ModBaseEncoder::Context> ModBaseEncoder::get_contexts(
+        const std::vector<size_t>& seq_positions,
+        int8_t* encoded_data) const {
+    NVTX3_FUNC_RANGE();
+    std::vector<Context> contexts(seq_positions.size());
+    const size_t context_size = encoded_context_size();
+    for (size_t i = 0; i < seq_positions.size(); ++i) {
+        encode_context(seq_positions[i], contexts[i], encoded_data + i * context_size);
     }
-
-    std::vector<int> chunk_seq_to_sig = {m_sample_offsets.begin() + seq_start,
-                                         m_sample_offsets.begin() + seq_end + 1};
-    std::transform(
-            chunk_seq_to_sig.begin(), chunk_seq_to_sig.end(), chunk_seq_to_sig.begin(),
-            [sig_start = context.first_sample, seq_to_sig_offset = context.lead_samples_needed](
-                    auto val) { return val -= int(sig_start - seq_to_sig_offset); });
-    chunk_seq_to_sig.front() = 0;
-    chunk_seq_to_sig.back() = m_context_samples;
-
-    context.data = encode_kmer(seq_ints, chunk_seq_to_sig);
-
-    return context;
+    return contexts;
 }
 
 int ModBaseEncoder::compute_sample_pos(int base_pos) const {
@@ -128,54 +84,65 @@ int ModBaseEncoder::compute_sample_pos(int base_pos) const {
 
 namespace {
 
-// Fallback path for non-AVX / kmer lengths not specifically optimised.
-std::vector<int8_t> encode_kmer_generic(const std::vector<int>& seq,
-                                        const std::vector<int>& seq_mappings,
-                                        int bases_before,
-                                        int bases_after,
-                                        int context_samples,
-                                        int kmer_len) {
-    const size_t seq_len = seq.size() - bases_before - bases_after;
-    std::vector<int8_t> output(kmer_len * utils::BaseInfo::NUM_BASES * context_samples);
-
-    int8_t* output_ptr = &output[0];
-    for (size_t seq_pos = 0; seq_pos < seq_len; ++seq_pos) {
-        auto base_st = seq_mappings[seq_pos];
-        auto base_en = seq_mappings[seq_pos + 1];
-
-        for (int i = base_st; i < base_en; ++i) {
-            for (size_t kmer_pos = 0; kmer_pos < size_t(kmer_len); ++kmer_pos) {
-                auto base = seq[seq_pos + kmer_pos];
-                uint32_t base_oh = (base == -1) ? uint32_t{} : (uint32_t{1} << (base << 3));
-                // memcpy will be translated to a single 32 bit write.
-                std::memcpy(output_ptr, &base_oh, sizeof(base_oh));
-                output_ptr += 4;
-            }
+// Arguments of the kmer encoders.  The samples of the context are covered by num_bases bases,
+// the first of which is the primary base of the kmer at seq.  Base i covers samples
+// [sample_offsets[i] - sample_shift, sample_offsets[i + 1] - sample_shift), except that the
+// first base starts at sample 0 and the last ends at context_samples.
+struct KmerEncoderArgs {
+    const int* seq;
+    const int* sample_offsets;
+    int num_bases;
+    int sample_shift;
+    int context_samples;
+};
+
+std::pair<int, int> base_samples(const KmerEncoderArgs& args, int base) {
+    const int base_st = (base == 0) ? 0 : args.sample_offsets[base] - args.sample_shift;
+    const int base_en = (base == args.num_bases - 1)
+                                ? args.context_samples
+                                : args.sample_offsets[base + 1] - args.sample_shift;
+    return {base_st, base_en};
+}
+
+// Fallback path for non-AVX / kmer lengths not specifically optimised.  Each row is encoded
+// once per base, and then repeated with block copies which double in size, so that the
+// bulk of the work is done by memcpy's vectorised implementation on all architectures.
+void encode_kmer_generic(const KmerEncoderArgs& args, int kmer_len, int8_t* output) {
+    const size_t row_size = size_t(kmer_len) * utils::BaseInfo::NUM_BASES;
+    int8_t* output_ptr = output;
+    for (int seq_pos = 0; seq_pos < args.num_bases; ++seq_pos) {
+        const auto [base_st, base_en] = base_samples(args, seq_pos);
+        const int count = base_en - base_st;
+        if (count <= 0) {
+            continue;
+        }
+
+        for (int kmer_pos = 0; kmer_pos < kmer_len; ++kmer_pos) {
+            auto base = args.seq[seq_pos + kmer_pos];
+            uint32_t base_oh = (base == -1) ? uint32_t{} : (uint32_t{1} << (base << 3));
+            // memcpy will be translated to a single 32 bit write.
+            std::memcpy(output_ptr + 4 * kmer_pos, &base_oh, sizeof(base_oh));
+        }
+        for (int rows_filled = 1; rows_filled < count;) {
+            const int rows_to_copy = std::min(rows_filled, count - rows_filled);
+            std::memcpy(output_ptr + rows_filled * row_size, output_ptr, rows_to_copy * row_size);
+            rows_filled += rows_to_copy;
         }
+        output_ptr += count * row_size;
     }
-    return output;
 }
 
 // For non-AVX we use the generic path that handles any kmer length.
 #if ENABLE_AVX2_IMPL
 __attribute__((target("default")))
 #endif
-std::vector<int8_t>
-encode_kmer_len9(const std::vector<int>& seq,
-                 const std::vector<int>& seq_mappings,
-                 int bases_before,
-                 int bases_after,
-                 int context_samples) {
-    return encode_kmer_generic(seq, seq_mappings, bases_before, bases_after, context_samples, 9);
+void encode_kmer_len9(const KmerEncoderArgs& args, int8_t* output) {
+    encode_kmer_generic(args, 9, output);
 }
 
 #if ENABLE_AVX2_IMPL
-__attribute__((target("avx2"))) std::vector<int8_t> encode_kmer_len9(
-        const std::vector<int>& seq,
-        const std::vector<int>& seq_mappings,
-        int bases_before,
-        int bases_after,
-        int context_samples) {
+__attribute__((target("avx2"))) void encode_kmer_len9(const KmerEncoderArgs& args,
+                                                       int8_t* output) {
     // These cannot change without a rewrite.
     constexpr int kKmerLen = 9;
     constexpr int kNumBases = 4;
@@ -187,12 +154,12 @@ __attribute__((target("avx2"))) std::vector<int8_t> encode_kmer_len9(
     const __m256i kRotate2 = _mm256_setr_epi32(6, 7, 0, 1, 2, 3, 4, 5);
     const __m256i kRotate3 = _mm256_setr_epi32(5, 6, 7, 0, 1, 2, 3, 4);
 
-    const size_t seq_len = seq.size() - bases_before - bases_after;
-    std::vector<int8_t> output_t(kKmerLen * kNumBases * context_samples);
-    std::byte* output_t_ptr = reinterpret_cast<std::byte*>(&output_t[0]);
-    for (size_t seq_pos = 0; seq_pos < seq_len; ++seq_pos) {
-        const auto base_st = seq_mappings[seq_pos];
-        const auto base_en = seq_mappings[seq_pos + 1];
+    static_assert(kKmerLen * kNumBases == 36);
+
+    const int* const seq = args.seq;
+    std::byte* output_t_ptr = reinterpret_cast<std::byte*>(output);
+    for (int seq_pos = 0; seq_pos < args.num_bases; ++seq_pos) {
+        const auto [base_st, base_en] = base_samples(args, seq_pos);
 
         // Load the 9 base indices with 2 overlapping 256 bit loads.
         const __m256i bases_01234567 =
@@ -257,22 +224,61 @@ __attribute__((target("avx2"))) std::vector<int8_t> encode_kmer_len9(
             output_t_ptr += 36;
         }
     }
-
-    return output_t;
 }
 #endif
 
 }  // namespace
 
-std::vector<int8_t> ModBaseEncoder::encode_kmer(const std::vector<int>& seq,
-                                                const std::vector<int>& seq_mappings) const {
-    // Specialised version for the case of kmer_len 9 that can be faster.
-    if (m_kmer_len == 9)
-        return encode_kmer_len9(seq, seq_mappings, m_bases_before, m_bases_after,
-                                m_context_samples);
+void ModBaseEncoder::encode_context(size_t seq_pos, Context& context, int8_t* output) const {
+    if (seq_pos >= size_t(m_seq_len)) {
+        throw std::out_of_range("Sequence position out of range.");
+    }
+
+    int base_sample_pos =
+            (compute_sample_pos(int(seq_pos)) + compute_sample_pos(int(seq_pos) + 1)) / 2;
+    int samples_before = (m_context_samples / 2);
+    int first_sample = base_sample_pos - samples_before;
+    if (first_sample >= 0) {
+        context.first_sample = size_t(first_sample);
+        context.lead_samples_needed = 0;
+    } else {
+        context.first_sample = 0;
+        context.lead_samples_needed = size_t(-first_sample);
+    }
+    int last_sample = first_sample + m_context_samples;
+    if (last_sample > m_signal_len) {
+        context.num_samples = size_t(m_signal_len) - context.first_sample;
+        context.tail_samples_needed = last_sample - m_signal_len;
+    } else {
+        context.num_samples = size_t(last_sample) - context.first_sample;
+        context.tail_samples_needed = 0;
+    }
+
+    // find base position for first and last sample
+    auto start_it = std::upper_bound(m_sample_offsets.begin(), m_sample_offsets.end(),
+                                     context.first_sample);
+    auto end_it = std::lower_bound(m_sample_offsets.begin(), m_sample_offsets.end(),
+                                   context.first_sample + context.num_samples);
 
-    return encode_kmer_generic(seq, seq_mappings, m_bases_before, m_bases_after, m_context_samples,
-                               m_kmer_len);
+    auto seq_start = std::distance(m_sample_offsets.begin(), start_it) - 1;
+    auto seq_end = std::distance(m_sample_offsets.begin(), end_it);
+
+    // The kmer of the base at seq_start begins bases_before entries earlier, which is
+    // seq_start in the padded sequence.
+    const KmerEncoderArgs args{
+            &m_padded_sequence_ints[seq_start],
+            &m_sample_offsets[seq_start],
+            int(seq_end - seq_start),
+            int(context.first_sample - context.lead_samples_needed),
+            m_context_samples,
+    };
+
+    // Specialised version for the case of kmer_len 9 that can be faster.
+    if (m_kmer_len == 9) {
+        encode_kmer_len9(args, output);
+    } else {
+        encode_kmer_generic(args, m_kmer_len, output);
+    }
 }
 
 }  // namespace dorado::modbase
@@ -16,14 +16,13 @@ private:
 
     int m_seq_len;
     int m_signal_len;
-    std::vector<int> m_sequence_ints;
+    // Sequence ints with bases_before and bases_after -1 entries either side, so that kmers
+    // which overhang the ends of the sequence can be read without copying.
+    std::vector<int> m_padded_sequence_ints;
     std::vector<int> m_sample_offsets;
 
     int compute_sample_pos(int base_pos) const;
 
-    std::vector<int8_t> encode_kmer(const std::vector<int>& seq,
-                                    const std::vector<int>& seq_mappings) const;
-
 public:
     /** Encoder for Remora-style modified base detection.
      *  @param block_stride The number of samples corresponding to a single entry in the movement vector.
@@ -59,6 +58,26 @@ public:
      *  The data is arranged in Feature-Time order i.e each column corresponds to the kmer at a given sample.
      */
     Context get_context(size_t seq_pos) const;
+
+    /// Number of entries in the encoded data of each context.
+    size_t encoded_context_size() const;
+
+    /** Get the encoded data of the contexts centered on each of a set of sequence positions.
+     *  @param seq_positions The positions of the bases to center the encoded data on.
+     *  @param encoded_data Destination for seq_positions.size() * encoded_context_size() entries,
+     *  with the data for each context following that of the previous one.
+     *  @return The signal slice of each context.  The data fields are left empty.
+     *
+     *  This is equivalent to calling get_context for each position, but the encodings are
+     *  written straight to the caller's buffer without any allocations per context.
+     */
+    std::vector<Context> get_contexts(const std::vector<size_t>& seq_positions,
+                                      int8_t* encoded_data) const;
+
+private:
+    // Fills in the signal slice of the context centered on seq_pos, and writes its encoded data
+    // to the encoded_context_size() entries pointed to by output.
+    void encode_context(size_t seq_pos, Context& context, int8_t* output) const;
 };
 
 }  // namespace dorado::modbase
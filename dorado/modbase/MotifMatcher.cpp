@@ -4,41 +4,52 @@
 
 #include <nvtx3/nvtx3.hpp>
 
-#include <iterator>
-#include <regex>
-#include <unordered_map>
+#include <algorithm>
+#include <stdexcept>
+#include <string>
 
 namespace {
-const std::unordered_map<char, std::string> IUPAC_CODES = {
-        // clang-format off
-        {'A', "A"},
-        {'C', "C"},
-        {'G', "G"},
-        {'T', "T"},
-        {'U', "T"},  // basecalls will have "T"s instead of "U"s
-        {'R', "[AG]"},
-        {'Y', "[CT]"}, 
-        {'S', "[GC]"}, 
-        {'W', "[AT]"},
-        {'K', "[GT]"}, 
-        {'M', "[AC]"}, 
-        {'B', "[CGT]"},
-        {'D', "[AGT]"},
-        {'H', "[ACT]"},
-        {'V', "[ACG]"},
-        {'N', "[ACGT]"},
-        // clang-format on
-};
-
-std::string expand_motif_regex(const std::string& motif) {
-    std::string motif_regex = "(";
-    for (auto base : motif) {
-        motif_regex += IUPAC_CODES.at(base);
+// Returns the bases matched by an IUPAC code, or nullptr if the code is invalid.
+const char* iupac_bases(char code) {
+    switch (code) {
+    case 'A':
+        return "A";
+    case 'C':
+        return "C";
+    case 'G':
+        return "G";
+    case 'T':
+    case 'U':  // basecalls will have "T"s instead of "U"s
+        return "T";
+    case 'R':
+        return "AG";
+    case 'Y':
+        return "CT";
+    case 'S':
+        return "GC";
+    case 'W':
+        return "AT";
+    case 'K':
+        return "GT";
+    case 'M':
+        return "AC";
+    case 'B':
+        return "CGT";
+    case 'D':
+        return "AGT";
+    case 'H':
+        return "ACT";
+    case 'V':
+        return "ACG";
+    case 'N':
+        return "ACGT";
+    default:
+        return nullptr;
     }
-    motif_regex += ")";
-    return motif_regex;
 }
 
+constexpr size_t MAX_AUTOMATON_BITS = 64;
+
 }  // namespace
 
 namespace dorado::modbase {
@@ -46,24 +57,73 @@ namespace dorado::modbase {
 MotifMatcher::MotifMatcher(const ModBaseModelConfig& model_config)
         : MotifMatcher(model_config.motif, model_config.motif_offset) {}
 
-MotifMatcher::MotifMatcher(const std::string& motif, size_t offset)
-        : m_motif(expand_motif_regex(motif)), m_motif_offset(offset) {}
+MotifMatcher::MotifMatcher(const std::string& motif, size_t offset) { add_motif(motif, offset); }
+
+MotifMatcher::MotifMatcher(const std::vector<Motif>& motifs) {
+    for (const auto& motif : motifs) {
+        add_motif(motif.motif, motif.offset);
+    }
+    m_multiple_motifs = motifs.size() > 1;
+}
+
+void MotifMatcher::add_motif(const std::string& motif, size_t offset) {
+    if (motif.empty() || motif.size() > MAX_AUTOMATON_BITS) {
+        throw std::runtime_error("Unsupported motif length " + std::to_string(motif.size()) +
+                                 " for motif '" + motif + "'");
+    }
+    if (offset >= motif.size()) {
+        throw std::runtime_error("Motif offset " + std::to_string(offset) +
+                                 " is outside motif '" + motif + "'");
+    }
+
+    // Start a new automaton if the motif's bits don't fit after those already in use.
+    if (m_automata.empty() || m_automata.back().num_bits + motif.size() > MAX_AUTOMATON_BITS) {
+        m_automata.emplace_back();
+    }
+    auto& automaton = m_automata.back();
+    const size_t first_bit = automaton.num_bits;
+
+    for (size_t i = 0; i < motif.size(); ++i) {
+        const char* bases = iupac_bases(motif[i]);
+        if (!bases) {
+            throw std::runtime_error("Invalid IUPAC code '" + std::string(1, motif[i]) +
+                                     "' in motif '" + motif + "'");
+        }
+        for (; *bases; ++bases) {
+            automaton.base_masks[uint8_t(*bases)] |= uint64_t(1) << (first_bit + i);
+        }
+    }
+    const uint64_t end_bit = uint64_t(1) << (first_bit + motif.size() - 1);
+    automaton.start_bits |= uint64_t(1) << first_bit;
+    automaton.end_bits |= end_bit;
+    automaton.hit_offsets.emplace_back(end_bit, motif.size() - 1 - offset);
+    automaton.num_bits += motif.size();
+}
 
 std::vector<size_t> MotifMatcher::get_motif_hits(std::string_view seq) const {
     NVTX3_FUNC_RANGE();
     std::vector<size_t> context_hits;
 
-    std::regex regex(m_motif);
-    auto start = std::cbegin(seq);
-    auto end = std::cend(seq);
-    auto pos = start;
-    // string_view on linux uses `const_iterator=const char*`,
-    // but on Windows it's a `std::_String_view_iterator<_Traits>`
-    std::match_results<decltype(pos)> motif_match;
-    while (std::regex_search(pos, end, motif_match, regex)) {
-        auto hit = std::distance(start, pos) + motif_match.position(0) + m_motif_offset;
-        context_hits.push_back(hit);
-        pos += motif_match.position(0) + 1;
+    for (const auto& automaton : m_automata) {
+        // Shifting the last bit of one motif into the first bit of the next is harmless, as
+        // every motif's first bit is set before masking anyway.
+        uint64_t state = 0;
+        for (size_t i = 0; i < seq.size(); ++i) {
+            state = ((state << 1) | automaton.start_bits) & automaton.base_masks[uint8_t(seq[i])];
+            if (state & automaton.end_bits) {
+                for (const auto& [end_bit, hit_offset] : automaton.hit_offsets) {
+                    if (state & end_bit) {
+                        context_hits.push_back(i - hit_offset);
+                    }
+                }
+            }
+        }
+    }
+
+    if (m_multiple_motifs) {
+        std::sort(context_hits.begin(), context_hits.end());
+        context_hits.erase(std::unique(context_hits.begin(), context_hits.end()),
+                           context_hits.end());
     }
     return context_hits;
 }
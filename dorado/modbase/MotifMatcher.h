@@ -1,7 +1,10 @@
 #pragma once
 
+#include <array>
+#include <cstdint>
 #include <string>
 #include <string_view>
+#include <utility>
 #include <vector>
 
 namespace dorado::modbase {
@@ -9,14 +12,43 @@ namespace dorado::modbase {
 struct ModBaseModelConfig;
 class MotifMatcher {
 public:
+    // An IUPAC motif, and the position within it of the base to report for each hit.
+    struct Motif {
+        std::string motif;
+        size_t offset;
+    };
+
     MotifMatcher(const ModBaseModelConfig& model_config);
     MotifMatcher(const std::string& motif, size_t offset);
+    // Finds hits of all the motifs in a single pass over the sequence.
+    explicit MotifMatcher(const std::vector<Motif>& motifs);
 
+    // Returns the sorted positions of the reported base for all (possibly overlapping) motif
+    // hits.  A position hit by more than one motif is reported once.
     std::vector<size_t> get_motif_hits(std::string_view seq) const;
 
 private:
-    const std::string m_motif;
-    const size_t m_motif_offset;
+    // Shift-and automaton for a group of motifs whose lengths total at most 64.  Each motif
+    // occupies a contiguous run of bits in the state, and bit i of a motif's run is set after
+    // reading a base if the motif's first i+1 codes match the sequence ending at that base.
+    struct Automaton {
+        // For each sequence character, the state bits of the codes which match it.
+        std::array<uint64_t, 256> base_masks{};
+        // The first and last bit of each motif's run.
+        uint64_t start_bits = 0;
+        uint64_t end_bits = 0;
+        // Number of bits used by the motifs.
+        size_t num_bits = 0;
+        // For each motif, its last bit and the distance back from the end of a hit to the base
+        // which is reported.
+        std::vector<std::pair<uint64_t, size_t>> hit_offsets;
+    };
+
+    void add_motif(const std::string& motif, size_t offset);
+
+    std::vector<Automaton> m_automata;
+    // Whether hits of different motifs might need to be merged.
+    bool m_multiple_motifs = false;
 };
 
 }  // namespace dorado::modbase
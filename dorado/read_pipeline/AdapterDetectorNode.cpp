@@ -1,19 +1,10 @@
 #include "AdapterDetectorNode.h"
 
-#include "demux/Trimmer.h"
 #include "utils/bam_utils.h"
-#include "utils/barcode_kits.h"
-#include "utils/trim.h"
 #include "utils/types.h"
 
-#include <htslib/sam.h>
-#include <spdlog/spdlog.h>
-
-#include <algorithm>
 #include <memory>
 #include <string>
-#include <string_view>
-#include <tuple>
 #include <vector>
 
 namespace dorado {
@@ -33,21 +24,11 @@ AdapterDetectorNode::AdapterDetectorNode(int threads)
 }
 
 void AdapterDetectorNode::start_threads() {
-    for (size_t i = 0; i < m_threads; i++) {
-        m_workers.push_back(std::make_unique<std::thread>(
-                std::thread(&AdapterDetectorNode::worker_thread, this)));
-    }
+    start_input_processing([this](std::vector<Message>& messages) { process_messages(messages); },
+                           m_threads);
 }
 
-void AdapterDetectorNode::terminate_impl() {
-    terminate_input_queue();
-    for (auto& m : m_workers) {
-        if (m->joinable()) {
-            m->join();
-        }
-    }
-    m_workers.clear();
-}
+void AdapterDetectorNode::terminate_impl() { stop_input_processing(); }
 
 void AdapterDetectorNode::restart() {
     restart_input_queue();
@@ -56,9 +37,8 @@ void AdapterDetectorNode::restart() {
 
 AdapterDetectorNode::~AdapterDetectorNode() { terminate_impl(); }
 
-void AdapterDetectorNode::worker_thread() {
-    Message message;
-    while (get_input_message(message)) {
+void AdapterDetectorNode::process_messages(std::vector<Message>& messages) {
+    for (auto& message : messages) {
         if (std::holds_alternative<BamPtr>(message)) {
             auto read = std::get<BamPtr>(std::move(message));
             process_read(read);
@@ -74,42 +54,17 @@ void AdapterDetectorNode::worker_thread() {
 }
 
 void AdapterDetectorNode::process_read(BamPtr& read) {
-    bam1_t* irecord = read.get();
-    std::string seq = utils::extract_sequence(irecord);
-    int seqlen = irecord->core.l_qseq;
-
-    std::pair<int, int> adapter_trim_interval = {0, seqlen};
-    std::pair<int, int> primer_trim_interval = {0, seqlen};
-    if (m_trim_adapters) {
-        auto adapter_res = m_detector.find_adapters(seq);
-        adapter_trim_interval = Trimmer::determine_trim_interval(adapter_res, seqlen);
-    }
-    if (m_trim_primers) {
-        auto primer_res = m_detector.find_primers(seq);
-        primer_trim_interval = Trimmer::determine_trim_interval(primer_res, seqlen);
-    }
     m_num_records++;
-
-    if (m_trim_adapters || m_trim_primers) {
-        std::pair<int, int> trim_interval = adapter_trim_interval;
-        trim_interval.first = std::max(trim_interval.first, primer_trim_interval.first);
-        trim_interval.second = std::min(trim_interval.second, primer_trim_interval.second);
-        if (trim_interval.first >= trim_interval.second) {
-            spdlog::warn("Unexpected adapter/primer trim interval {}-{} for {}",
-                         trim_interval.first, trim_interval.second, seq);
-            return;
-        }
-        read = Trimmer::trim_sequence(std::move(read), trim_interval);
+    if (!m_trim_adapters && !m_trim_primers) {
+        return;
     }
+    auto annotation = m_annotator.annotate(utils::extract_sequence(read.get()), m_trim_adapters,
+                                           m_trim_primers, nullptr);
+    // Records are left alone if trimming would leave nothing.
+    demux::ReadEndAnnotator::apply(annotation, read);
 }
 
 void AdapterDetectorNode::process_read(SimplexRead& read) {
-    // get the sequence to map from the record
-    auto seqlen = int(read.read_common.seq.length());
-
-    std::pair<int, int> adapter_trim_interval = {0, seqlen};
-    std::pair<int, int> primer_trim_interval = {0, seqlen};
-
     // Check read for instruction on what to trim.
     bool trim_adapters = m_trim_adapters;
     bool trim_primers = m_trim_primers;
@@ -118,24 +73,13 @@ void AdapterDetectorNode::process_read(SimplexRead& read) {
         trim_adapters = read.read_common.adapter_info->trim_adapters;
         trim_primers = read.read_common.adapter_info->trim_primers;
     }
-    if (trim_adapters) {
-        auto adapter_res = m_detector.find_adapters(read.read_common.seq);
-        adapter_trim_interval = Trimmer::determine_trim_interval(adapter_res, seqlen);
-    }
-    if (trim_primers) {
-        auto primer_res = m_detector.find_primers(read.read_common.seq);
-        primer_trim_interval = Trimmer::determine_trim_interval(primer_res, seqlen);
-    }
     if (trim_adapters || trim_primers) {
-        std::pair<int, int> trim_interval = adapter_trim_interval;
-        trim_interval.first = std::max(trim_interval.first, primer_trim_interval.first);
-        trim_interval.second = std::min(trim_interval.second, primer_trim_interval.second);
-        if (trim_interval.first >= trim_interval.second) {
-            spdlog::warn("Unexpected adapter/primer trim interval {}-{} for {}",
-                         trim_interval.first, trim_interval.second, read.read_common.seq);
+        auto annotation =
+                m_annotator.annotate(read.read_common.seq, trim_adapters, trim_primers, nullptr);
+        if (!annotation.trim_adapters) {
             return;
         }
-        Trimmer::trim_sequence(read, trim_interval);
+        demux::ReadEndAnnotator::apply(annotation, read);
     }
     m_num_records++;
 }
@@ -143,6 +87,7 @@ void AdapterDetectorNode::process_read(SimplexRead& read) {
 stats::NamedStats AdapterDetectorNode::sample_stats() const {
     auto stats = stats::from_obj(m_work_queue);
     stats["num_reads_trimmed"] = m_num_records.load();
+    stats.merge(sample_input_processing_stats());
     return stats;
 }
 
@@ -1,5 +1,5 @@
 #pragma once
-#include "demux/AdapterDetector.h"
+#include "demux/ReadEndAnnotator.h"
 #include "read_pipeline/ReadPipeline.h"
 #include "utils/stats.h"
 #include "utils/types.h"
@@ -28,11 +28,10 @@ private:
     size_t m_threads{1};
     bool m_trim_adapters;
     bool m_trim_primers;
-    std::vector<std::unique_ptr<std::thread>> m_workers;
     std::atomic<int> m_num_records{0};
-    demux::AdapterDetector m_detector;
+    demux::ReadEndAnnotator m_annotator;
 
-    void worker_thread();
+    void process_messages(std::vector<Message>& messages);
     void process_read(BamPtr& read);
     void process_read(SimplexRead& read);
 
@@ -123,28 +123,31 @@ void AlignerNode::align_read_common(ReadCommon& read_common, mm_tbuf_t* tbuf) {
 }
 
 void AlignerNode::worker_thread() {
-    Message message;
+    std::vector<Message> messages;
+    std::vector<Message> messages_to_send;
     mm_tbuf_t* tbuf = mm_tbuf_init();
-    auto align_read = [this, tbuf](auto&& read) {
+    auto align_read = [this, tbuf, &messages_to_send](auto&& read) {
         align_read_common(read->read_common, tbuf);
-        send_message_to_sink(std::move(read));
+        messages_to_send.push_back(std::move(read));
     };
-    while (get_input_message(message)) {
-        if (std::holds_alternative<BamPtr>(message)) {
-            auto read = std::get<BamPtr>(std::move(message));
-            auto records =
-                    alignment::Minimap2Aligner(m_index_for_bam_messages).align(read.get(), tbuf);
-            for (auto& record : records) {
-                send_message_to_sink(std::move(record));
+    while (get_input_messages(messages)) {
+        for (auto& message : messages) {
+            if (std::holds_alternative<BamPtr>(message)) {
+                auto read = std::get<BamPtr>(std::move(message));
+                auto records = alignment::Minimap2Aligner(m_index_for_bam_messages)
+                                       .align(read.get(), tbuf);
+                for (auto& record : records) {
+                    messages_to_send.push_back(std::move(record));
+                }
+            } else if (std::holds_alternative<SimplexReadPtr>(message)) {
+                align_read(std::get<SimplexReadPtr>(std::move(message)));
+            } else if (std::holds_alternative<DuplexReadPtr>(message)) {
+                align_read(std::get<DuplexReadPtr>(std::move(message)));
+            } else {
+                messages_to_send.push_back(std::move(message));
             }
-        } else if (std::holds_alternative<SimplexReadPtr>(message)) {
-            align_read(std::get<SimplexReadPtr>(std::move(message)));
-        } else if (std::holds_alternative<DuplexReadPtr>(message)) {
-            align_read(std::get<DuplexReadPtr>(std::move(message)));
-        } else {
-            send_message_to_sink(std::move(message));
-            continue;
         }
+        send_messages_to_sink(messages_to_send);
     }
     mm_tbuf_destroy(tbuf);
 }
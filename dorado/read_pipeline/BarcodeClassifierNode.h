@@ -1,5 +1,5 @@
 #pragma once
-#include "demux/BarcodeClassifierSelector.h"
+#include "demux/ReadEndAnnotator.h"
 #include "read_pipeline/ReadPipeline.h"
 #include "utils/stats.h"
 #include "utils/types.h"
@@ -21,7 +21,8 @@ public:
                           bool no_trim,
                           BarcodingInfo::FilterSet allowed_barcodes,
                           const std::optional<std::string>& custom_kit,
-                          const std::optional<std::string>& custom_seqs);
+                          const std::optional<std::string>& custom_seqs,
+                          int prefilter_kmer_length);
     BarcodeClassifierNode(int threads);
     ~BarcodeClassifierNode();
     std::string get_name() const override { return "BarcodeClassifierNode"; }
@@ -34,14 +35,11 @@ private:
 
     size_t m_threads{1};
     std::atomic<size_t> m_active{0};
-    std::vector<std::unique_ptr<std::thread>> m_workers;
     std::atomic<int> m_num_records{0};
     std::shared_ptr<const BarcodingInfo> m_default_barcoding_info;
-    demux::BarcodeClassifierSelector m_barcoder_selector{};
+    demux::ReadEndAnnotator m_annotator;
 
-    std::shared_ptr<const BarcodingInfo> get_barcoding_info(const SimplexRead& read) const;
-
-    void worker_thread();
+    void process_messages(std::vector<Message>& messages);
     void barcode(BamPtr& read);
     void barcode(SimplexRead& read);
 
@@ -7,9 +7,15 @@
 
 #include <ATen/ATen.h>
 #include <nvtx3/nvtx3.hpp>
+#include <spdlog/spdlog.h>
 
 #include <algorithm>
+#include <array>
+#include <condition_variable>
 #include <cstdlib>
+#include <mutex>
+#include <thread>
+#include <tuple>
 
 #if defined(__APPLE__) && DORADO_GPU_BUILD
 #include "utils/metal_utils.h"
@@ -34,9 +40,28 @@ struct BasecallerNode::BasecallingChunk : utils::Chunk {
 };
 
 struct BasecallerNode::BasecallingRead {
-    Message read;                                              // The read itself.
-    std::vector<std::unique_ptr<utils::Chunk>> called_chunks;  // Vector of basecalled chunks.
-    std::atomic_size_t num_chunks_called;  // Number of chunks which have been basecalled.
+    Message read;  // The read itself.
+    std::mutex stitch_mutex;
+    utils::ChunkStitcher stitcher;  // Stitches called chunks into the read as they arrive.
+    std::chrono::steady_clock::time_point start_time;  // When the read was taken for calling.
+    std::atomic_size_t num_chunks_unstaged{0};  // Chunks not yet staged into a batch.
+};
+
+// Calls batches for one model runner on a dedicated thread, so that the basecall worker can
+// stage the next batch into another of the runner's input buffers while this one is in flight.
+struct BasecallerNode::BatchCaller {
+    // Chunks staged into each of the runner's input buffers.
+    std::array<std::vector<std::unique_ptr<BasecallingChunk>>,
+               basecall::ModelRunnerBase::NUM_INPUT_BUFFERS>
+            batches;
+    // Size at which each staged batch is to be called.
+    std::array<size_t, basecall::ModelRunnerBase::NUM_INPUT_BUFFERS> chunk_sizes{};
+    std::mutex mutex;
+    std::condition_variable cv;
+    // Input buffer whose batch is being called, or -1 if there is none.
+    int calling_buffer = -1;
+    bool terminate = false;
+    std::thread thread;
 };
 
 void BasecallerNode::input_worker_thread() {
@@ -62,6 +87,8 @@ void BasecallerNode::input_worker_thread() {
             continue;
         }
 
+        const auto start_time = std::chrono::steady_clock::now();
+
         // If this is a duplex read, raw_data won't have been generated yet.
         materialise_read_raw_data(message);
 
@@ -76,8 +103,14 @@ void BasecallerNode::input_worker_thread() {
         size_t signal_chunk_step = m_chunk_size - m_overlap;
         auto working_read = std::make_shared<BasecallingRead>();
         std::vector<std::unique_ptr<BasecallingChunk>> read_chunks;
+        // Reads shorter than a chunk get a single chunk of the smallest size that holds them,
+        // so they're batched with reads of similar length rather than padded to a full chunk.
+        const size_t first_chunk_size =
+                raw_size < m_chunk_size ? *std::lower_bound(m_call_chunk_sizes.begin(),
+                                                            m_call_chunk_sizes.end(), raw_size)
+                                        : m_chunk_size;
         read_chunks.emplace_back(std::make_unique<BasecallingChunk>(
-                working_read, offset, chunk_in_read_idx++, m_chunk_size));
+                working_read, offset, chunk_in_read_idx++, first_chunk_size));
         size_t num_chunks = 1;
         auto last_chunk_offset = raw_size - m_chunk_size;
         auto misalignment = last_chunk_offset % m_model_stride;
@@ -91,8 +124,9 @@ void BasecallerNode::input_worker_thread() {
                     working_read, offset, chunk_in_read_idx++, m_chunk_size));
             ++num_chunks;
         }
-        working_read->called_chunks.resize(num_chunks);
-        working_read->num_chunks_called.store(0);
+        working_read->stitcher = utils::ChunkStitcher(num_chunks);
+        working_read->start_time = start_time;
+        working_read->num_chunks_unstaged = num_chunks;
         working_read->read = std::move(message);
 
         // Put the read in the working list
@@ -116,27 +150,69 @@ void BasecallerNode::input_worker_thread() {
     m_chunks_in.terminate();
 }
 
-void BasecallerNode::basecall_current_batch(int worker_id) {
+void BasecallerNode::basecall_current_batch(int worker_id, int buffer_idx) {
     NVTX3_FUNC_RANGE();
     auto &model_runner = m_model_runners[worker_id];
+    auto &batch = m_batch_callers[worker_id]->batches[buffer_idx];
+    const size_t chunk_size = m_batch_callers[worker_id]->chunk_sizes[buffer_idx];
     dorado::stats::Timer timer;
-    auto decode_results = model_runner->call_chunks(int(m_batched_chunks[worker_id].size()));
+    auto decode_results = model_runner->call_chunks(buffer_idx, int(batch.size()), chunk_size);
     m_call_chunks_ms += timer.GetElapsedMS();
 
-    for (size_t i = 0; i < m_batched_chunks[worker_id].size(); i++) {
-        m_batched_chunks[worker_id][i]->seq = decode_results[i].sequence;
-        m_batched_chunks[worker_id][i]->qstring = decode_results[i].qstring;
-        m_batched_chunks[worker_id][i]->moves = decode_results[i].moves;
+    for (size_t i = 0; i < batch.size(); i++) {
+        batch[i]->seq = decode_results[i].sequence;
+        batch[i]->qstring = decode_results[i].qstring;
+        batch[i]->moves = decode_results[i].moves;
     }
 
-    for (auto &complete_chunk : m_batched_chunks[worker_id]) {
+    for (auto &complete_chunk : batch) {
         m_processed_chunks.try_push(std::move(complete_chunk));
     }
 
-    m_batched_chunks[worker_id].clear();
+    m_num_called_samples += int64_t(batch.size() * chunk_size);
+    if (batch.size() < model_runner->batch_size()) {
+        ++m_num_partial_batches_called;
+    }
+    if (chunk_size < m_chunk_size) {
+        ++m_num_short_batches_called;
+    }
+    batch.clear();
     ++m_num_batches_called;
 }
 
+void BasecallerNode::batch_caller_thread(int worker_id) {
+#if defined(__APPLE__) && DORADO_GPU_BUILD
+    // Model execution creates GPU-related autorelease objects.
+    utils::ScopedAutoReleasePool autorelease_pool;
+#endif
+    at::InferenceMode inference_mode_guard;
+
+    auto &caller = *m_batch_callers[worker_id];
+    std::unique_lock lock(caller.mutex);
+    while (true) {
+        caller.cv.wait(lock, [&caller] { return caller.calling_buffer >= 0 || caller.terminate; });
+        if (caller.calling_buffer < 0) {
+            // Terminated, and every dispatched batch has been called.
+            break;
+        }
+        const int buffer_idx = caller.calling_buffer;
+        lock.unlock();
+        basecall_current_batch(worker_id, buffer_idx);
+        lock.lock();
+        caller.calling_buffer = -1;
+        caller.cv.notify_all();
+    }
+}
+
+void BasecallerNode::dispatch_batch(int worker_id, int buffer_idx) {
+    auto &caller = *m_batch_callers[worker_id];
+    std::unique_lock lock(caller.mutex);
+    // Only one batch is called at a time, which leaves the other buffers free for staging.
+    caller.cv.wait(lock, [&caller] { return caller.calling_buffer < 0; });
+    caller.calling_buffer = buffer_idx;
+    caller.cv.notify_all();
+}
+
 void BasecallerNode::working_reads_manager() {
     at::InferenceMode inference_mode_guard;
 
@@ -146,15 +222,20 @@ void BasecallerNode::working_reads_manager() {
 
         auto working_read = chunk->owning_read;
         auto idx_in_read = chunk->idx_in_read;
-        working_read->called_chunks[idx_in_read] = std::move(chunk);
-        auto num_chunks_called = ++working_read->num_chunks_called;
-        if (num_chunks_called == working_read->called_chunks.size()) {
+        bool read_complete = false;
+        {
+            // Chunks which can be stitched are appended to the read and freed straight away.
+            // Once the last one has been, no other thread refers to the read.
+            std::lock_guard stitch_lock(working_read->stitch_mutex);
+            read_complete = working_read->stitcher.add_chunk(
+                    get_read_common_data(working_read->read), idx_in_read, std::move(chunk));
+        }
+        if (read_complete) {
             // Finalise the read.
             auto source_read = std::move(working_read->read);
 
             ReadCommon &read_common_data = get_read_common_data(source_read);
 
-            utils::stitch_chunks(read_common_data, working_read->called_chunks);
             read_common_data.model_name = m_model_name;
             read_common_data.mean_qscore_start_pos = m_mean_qscore_start_pos;
             read_common_data.pre_trim_seq_length = read_common_data.seq.length();
@@ -165,13 +246,11 @@ void BasecallerNode::working_reads_manager() {
             }
 
             // Update stats.
+            record_read_latency(*working_read);
             ++m_called_reads_pushed;
             m_num_bases_processed += read_common_data.seq.length();
             m_num_samples_processed += read_common_data.get_raw_data_samples();
 
-            // Chunks have ownership of the working read, so destroy them to avoid a leak.
-            working_read->called_chunks.clear();
-
             // Cleanup the working read.
             {
                 std::unique_lock<std::mutex> working_reads_lock(m_working_reads_mutex);
@@ -193,84 +272,206 @@ void BasecallerNode::working_reads_manager() {
     }
 }
 
+void BasecallerNode::record_read_latency(const BasecallingRead &read) {
+    const auto latency = std::chrono::steady_clock::now() - read.start_time;
+    m_read_latencies.record(latency);
+    if (m_latency_target_ms <= 0) {
+        return;
+    }
+
+    // Back off quickly when a read misses the target, and creep back towards the largest
+    // timeout (and so the fullest batches) while reads are meeting it.
+    int flush_timeout_ms = m_flush_timeout_ms.load();
+    int new_flush_timeout_ms = flush_timeout_ms;
+    if (latency > std::chrono::milliseconds(m_latency_target_ms)) {
+        new_flush_timeout_ms = std::max(1, flush_timeout_ms - (flush_timeout_ms + 3) / 4);
+    } else if (++m_num_reads_within_latency_target % 100 == 0) {
+        new_flush_timeout_ms =
+                std::min(flush_timeout_ms + 1, std::min(m_batch_timeout_ms, m_latency_target_ms));
+    }
+    // If another thread has adapted the timeout in the meantime, its update stands.
+    m_flush_timeout_ms.compare_exchange_strong(flush_timeout_ms, new_flush_timeout_ms);
+}
+
 void BasecallerNode::basecall_worker_thread(int worker_id) {
 #if defined(__APPLE__) && DORADO_GPU_BUILD
-    // Model execution creates GPU-related autorelease objects.
     utils::ScopedAutoReleasePool autorelease_pool;
 #endif
     at::InferenceMode inference_mode_guard;
 
-    auto last_chunk_reserve_time = std::chrono::system_clock::now();
-    int batch_size = int(m_model_runners[worker_id]->batch_size());
+    auto &caller = *m_batch_callers[worker_id];
+    caller.thread = std::thread([this, worker_id] { batch_caller_thread(worker_id); });
+
+    // Input buffer currently being filled.
+    int buffer_idx = 0;
+    size_t batch_size = m_model_runners[worker_id]->batch_size();
+    const bool latency_mode = m_latency_target_ms > 0;
+    // Chunks waiting to be staged, bucketed by the size they'll be called at, so that every
+    // batch is called at the size of its chunks.
+    std::vector<std::vector<std::unique_ptr<BasecallingChunk>>> pending_chunks(
+            m_call_chunk_sizes.size());
+    // Arrival time of the oldest chunk in each non-empty bucket.
+    std::vector<std::chrono::steady_clock::time_point> oldest_pending(m_call_chunk_sizes.size());
+    const auto call_pending_chunks = [this, worker_id, batch_size, &caller, &buffer_idx,
+                                      &pending_chunks](size_t bucket) {
+        auto &runner = m_model_runners[worker_id];
+        auto &batch = caller.batches[buffer_idx];
+        auto &chunks = pending_chunks[bucket];
+        const size_t chunk_size = m_call_chunk_sizes[bucket];
+        const size_t num_chunks = std::min(batch_size, chunks.size());
+        if (num_chunks < chunks.size()) {
+            // More chunks are pending than fit in the batch (only in latency mode), so call
+            // those of the reads with fewest chunks left to stage, then the oldest reads.
+            using Priority = std::tuple<size_t, std::chrono::steady_clock::time_point, size_t>;
+            std::vector<Priority> priorities(chunks.size());
+            for (size_t i = 0; i < chunks.size(); ++i) {
+                const auto &read = *chunks[i]->owning_read;
+                priorities[i] = {read.num_chunks_unstaged.load(), read.start_time, i};
+            }
+            std::partial_sort(priorities.begin(), priorities.begin() + num_chunks,
+                              priorities.end());
+            std::vector<std::unique_ptr<BasecallingChunk>> ordered_chunks;
+            ordered_chunks.reserve(chunks.size());
+            for (const auto &priority : priorities) {
+                ordered_chunks.push_back(std::move(chunks[std::get<2>(priority)]));
+            }
+            chunks = std::move(ordered_chunks);
+        }
+        for (size_t i = 0; i < num_chunks; ++i) {
+            auto &chunk = chunks[i];
+            auto &read_common = get_read_common_data(chunk->owning_read->read);
+            // This is a view of the read's signal, which the runner copies straight into its
+            // input buffer, repeat-padding non-full chunks in place.
+            auto input_slice = read_common.raw_data.index(
+                    {Ellipsis, Slice(chunk->input_offset, chunk->input_offset + chunk_size)});
+            runner->accept_chunk(buffer_idx, static_cast<int>(batch.size()), input_slice);
+            m_num_signal_samples += input_slice.size(-1);
+            --chunk->owning_read->num_chunks_unstaged;
+            batch.push_back(std::move(chunk));
+        }
+        // Any chunks left over keep the bucket's oldest arrival time, so they're flushed early
+        // rather than late.
+        chunks.erase(chunks.begin(), chunks.begin() + num_chunks);
+        caller.chunk_sizes[buffer_idx] = chunk_size;
+        dispatch_batch(worker_id, buffer_idx);
+        buffer_idx = (buffer_idx + 1) % basecall::ModelRunnerBase::NUM_INPUT_BUFFERS;
+    };
+    const auto call_all_pending_chunks = [&pending_chunks, &call_pending_chunks] {
+        for (size_t bucket = 0; bucket < pending_chunks.size(); ++bucket) {
+            while (!pending_chunks[bucket].empty()) {
+                call_pending_chunks(bucket);
+            }
+        }
+    };
+    const auto add_pending_chunk = [this, &pending_chunks, &oldest_pending](
+                                           std::unique_ptr<BasecallingChunk> chunk,
+                                           std::chrono::steady_clock::time_point now) {
+        const size_t bucket = std::lower_bound(m_call_chunk_sizes.begin(),
+                                               m_call_chunk_sizes.end(), chunk->raw_chunk_size) -
+                              m_call_chunk_sizes.begin();
+        if (pending_chunks[bucket].empty()) {
+            oldest_pending[bucket] = now;
+        }
+        pending_chunks[bucket].push_back(std::move(chunk));
+        return bucket;
+    };
+
+    // Mean interval between chunks arriving at this worker, used in latency mode to predict
+    // whether a partial batch will fill before it has to be flushed.
+    double mean_arrival_interval_ms = 0;
+    auto last_arrival_time = std::chrono::steady_clock::now();
+    // Calls the buckets that are full, or in latency mode are due to be flushed.
+    const auto call_ready_chunks = [&](std::chrono::steady_clock::time_point now) {
+        const auto flush_timeout = std::chrono::milliseconds(m_flush_timeout_ms.load());
+        for (size_t bucket = 0; bucket < pending_chunks.size(); ++bucket) {
+            while (pending_chunks[bucket].size() >= batch_size) {
+                call_pending_chunks(bucket);
+            }
+            if (!latency_mode || pending_chunks[bucket].empty()) {
+                continue;
+            }
+            const auto flush_time = oldest_pending[bucket] + flush_timeout;
+            const auto expected_fill_time =
+                    now + std::chrono::duration<double, std::milli>(
+                                  mean_arrival_interval_ms *
+                                  double(batch_size - pending_chunks[bucket].size()));
+            if (flush_time <= now) {
+                call_pending_chunks(bucket);
+            } else if (expected_fill_time > flush_time) {
+                ++m_num_early_flushes;
+                call_pending_chunks(bucket);
+            }
+        }
+    };
+
     while (true) {
         std::unique_ptr<BasecallingChunk> chunk;
-        const auto pop_status = m_chunks_in.try_pop_until(
-                chunk, last_chunk_reserve_time + std::chrono::milliseconds(m_batch_timeout_ms));
+        // Wake up when the first pending bucket is due to be flushed.  Buckets are flushed by the
+        // age of their oldest chunk rather than after a pause in input, so that buckets which
+        // fill slowly, such as those of short chunks, are still called while input is steady.
+        const auto flush_timeout = std::chrono::milliseconds(
+                latency_mode ? m_flush_timeout_ms.load() : m_batch_timeout_ms);
+        auto deadline =
+                std::chrono::steady_clock::now() + std::chrono::milliseconds(m_batch_timeout_ms);
+        for (size_t bucket = 0; bucket < pending_chunks.size(); ++bucket) {
+            if (!pending_chunks[bucket].empty()) {
+                deadline = std::min(deadline, oldest_pending[bucket] + flush_timeout);
+            }
+        }
+        const auto pop_status = m_chunks_in.try_pop_until(chunk, deadline);
 
         if (pop_status == utils::AsyncQueueStatus::Terminate) {
             break;
         }
 
-        if (pop_status == utils::AsyncQueueStatus::Timeout) {
-            // try_pop_until timed out without getting a new chunk.
-            if (!m_batched_chunks[worker_id].empty()) {
-                // get scores for whatever chunks are available.
-                basecall_current_batch(worker_id);
+        if (latency_mode) {
+            const auto now = std::chrono::steady_clock::now();
+            if (pop_status == utils::AsyncQueueStatus::Success) {
+                const std::chrono::duration<double, std::milli> interval = now - last_arrival_time;
+                mean_arrival_interval_ms += (interval.count() - mean_arrival_interval_ms) / 16;
+                last_arrival_time = now;
+                const size_t bucket = add_pending_chunk(std::move(chunk), now);
+                if (pending_chunks[bucket].size() >= batch_size) {
+                    // Take whatever else is already queued, so the batch is made up of the
+                    // highest priority chunks available rather than just the first to arrive.
+                    for (size_t i = 0; i < batch_size; ++i) {
+                        if (m_chunks_in.try_pop_until(chunk, now) !=
+                            utils::AsyncQueueStatus::Success) {
+                            break;
+                        }
+                        add_pending_chunk(std::move(chunk), now);
+                    }
+                }
             }
-
-            last_chunk_reserve_time = std::chrono::system_clock::now();
+            call_ready_chunks(now);
             continue;
         }
 
-        // There's chunks to get_scores, so let's add them to our input tensor
-        // FIXME -- it should not be possible to for this condition to be untrue.
-        if (m_batched_chunks[worker_id].size() != size_t(batch_size)) {
-            // Copy the chunk into the input tensor
-            auto &source_read = chunk->owning_read->read;
-
-            auto &read_common = get_read_common_data(source_read);
-            auto input_slice = read_common.raw_data.index(
-                    {Ellipsis, Slice(chunk->input_offset, chunk->input_offset + m_chunk_size)});
-            size_t slice_size;
-            if (input_slice.ndimension() == 1) {
-                slice_size = input_slice.size(0);
-            } else {
-                slice_size = input_slice.sizes()[1];
+        const auto now = std::chrono::steady_clock::now();
+        if (pop_status == utils::AsyncQueueStatus::Success) {
+            const size_t bucket = add_pending_chunk(std::move(chunk), now);
+            if (pending_chunks[bucket].size() == batch_size) {
+                // Batch is full, let's get_scores.
+                call_pending_chunks(bucket);
             }
-
-            // repeat-pad any non-full chunks
-            // Stereo and Simplex encoding need to be treated differently
-            if (slice_size != m_chunk_size) {
-                if (input_slice.ndimension() == 1) {
-                    auto [n, overhang] = std::div((int)m_chunk_size, (int)slice_size);
-                    input_slice = at::concat({input_slice.repeat({n}),
-                                              input_slice.index({Ellipsis, Slice(0, overhang)})});
-                } else if (input_slice.ndimension() == 2) {
-                    auto [n, overhang] = std::div((int)m_chunk_size, (int)slice_size);
-                    input_slice = at::concat({input_slice.repeat({1, n}),
-                                              input_slice.index({Ellipsis, Slice(0, overhang)})},
-                                             1);
-                }
-            }
-
-            // Insert the chunk in the input tensor
-            m_model_runners[worker_id]->accept_chunk(
-                    static_cast<int>(m_batched_chunks[worker_id].size()), input_slice);
-
-            m_batched_chunks[worker_id].push_back(std::move(chunk));
-
-            last_chunk_reserve_time = std::chrono::system_clock::now();
         }
-
-        if (m_batched_chunks[worker_id].size() == size_t(batch_size)) {
-            // Input tensor is full, let's get_scores.
-            basecall_current_batch(worker_id);
+        // Get scores for whatever chunks have waited too long for their batch to fill.
+        for (size_t bucket = 0; bucket < pending_chunks.size(); ++bucket) {
+            if (!pending_chunks[bucket].empty() && oldest_pending[bucket] + flush_timeout <= now) {
+                call_pending_chunks(bucket);
+            }
         }
     }
 
-    if (!m_batched_chunks[worker_id].empty()) {
-        basecall_current_batch(worker_id);
+    call_all_pending_chunks();
+
+    // Wait for outstanding batches to be called.
+    {
+        std::lock_guard lock(caller.mutex);
+        caller.terminate = true;
     }
+    caller.cv.notify_all();
+    caller.thread.join();
 
     // Reduce the count of active runner threads.  If this was the last active
     // thread also send termination signal to sink
@@ -306,25 +507,32 @@ BasecallerNode::BasecallerNode(std::vector<basecall::RunnerPtr> model_runners,
                                std::string model_name,
                                size_t max_reads,
                                const std::string &node_name,
-                               uint32_t read_mean_qscore_start_pos)
+                               uint32_t read_mean_qscore_start_pos,
+                               int latency_target_ms)
         : MessageSink(max_reads),
           m_model_runners(std::move(model_runners)),
           m_chunk_size(m_model_runners.front()->chunk_size()),
           m_overlap(overlap),
           m_model_stride(m_model_runners.front()->model_stride()),
+          m_call_chunk_sizes(m_model_runners.front()->supported_chunk_sizes()),
           m_rna(is_rna_model(m_model_runners.front()->config())),
           m_batch_timeout_ms(batch_timeout_ms),
+          m_latency_target_ms(latency_target_ms),
           m_model_name(std::move(model_name)),
           m_mean_qscore_start_pos(read_mean_qscore_start_pos),
           m_chunks_in(CalcMaxChunksIn(m_model_runners)),
           m_processed_chunks(CalcMaxChunksIn(m_model_runners)),
           m_node_name(node_name) {
-    // Setup worker state
-    const size_t num_workers = m_model_runners.size();
-    m_batched_chunks.resize(num_workers);
-
     initialization_time = std::chrono::system_clock::now();
 
+    if (m_latency_target_ms > 0) {
+        // Leave most of the target for calling and stitching.
+        m_flush_timeout_ms = std::min(m_batch_timeout_ms, std::max(1, m_latency_target_ms / 4));
+        spdlog::debug("{} targeting {} ms read latency", m_node_name, m_latency_target_ms);
+    } else {
+        m_flush_timeout_ms = m_batch_timeout_ms;
+    }
+
     // Spin up any workers last so that we're not mutating |this| underneath them
     start_threads();
 }
@@ -338,6 +546,10 @@ void BasecallerNode::start_threads() {
     for (size_t i = 0; i < m_working_reads_managers.size(); i++) {
         m_working_reads_managers[i] = std::thread([this] { working_reads_manager(); });
     }
+    m_batch_callers.resize(num_workers);
+    for (auto &caller : m_batch_callers) {
+        caller = std::make_unique<BatchCaller>();
+    }
     m_basecall_workers.resize(num_workers);
     for (int i = 0; i < static_cast<int>(num_workers); i++) {
         m_basecall_workers[i] = std::thread([this, i] { basecall_worker_thread(i); });
@@ -388,8 +600,21 @@ stats::NamedStats BasecallerNode::sample_stats() const {
     stats["called_reads_pushed"] = double(m_called_reads_pushed);
     stats["working_reads_items"] = double(m_working_reads_size);
     stats["working_reads_signal_mb"] = double(m_working_reads_signal_bytes) / double((1024 * 1024));
+    stats["short_batches_called"] = double(m_num_short_batches_called);
+    stats["signal_samples_called"] = double(m_num_signal_samples);
+    stats["padded_samples_called"] = double(m_num_called_samples - m_num_signal_samples);
+    if (m_num_called_samples > 0) {
+        stats["padding_efficiency"] = double(m_num_signal_samples) / double(m_num_called_samples);
+    }
     stats["bases_processed"] = double(m_num_bases_processed);
     stats["samples_processed"] = double(m_num_samples_processed);
+    m_read_latencies.add_to_stats(stats, "read_latency_ms");
+    if (m_latency_target_ms > 0) {
+        stats["latency_target_ms"] = double(m_latency_target_ms);
+        stats["flush_timeout_ms"] = double(m_flush_timeout_ms);
+        stats["early_flushes"] = double(m_num_early_flushes);
+        stats["reads_within_latency_target"] = double(m_num_reads_within_latency_target);
+    }
     return stats;
 }
 
@@ -2,6 +2,7 @@
 
 #include "ReadPipeline.h"
 #include "utils/AsyncQueue.h"
+#include "utils/InternedString.h"
 #include "utils/stats.h"
 
 #include <atomic>
@@ -21,6 +22,7 @@ using RunnerPtr = std::unique_ptr<ModelRunnerBase>;
 class BasecallerNode : public MessageSink {
     struct BasecallingRead;
     struct BasecallingChunk;
+    struct BatchCaller;
 
 public:
     // Chunk size and overlap are in raw samples
@@ -30,7 +32,8 @@ public:
                    std::string model_name,
                    size_t max_reads,
                    const std::string& node_name,
-                   uint32_t read_mean_qscore_start_pos);
+                   uint32_t read_mean_qscore_start_pos,
+                   int latency_target_ms);
     ~BasecallerNode();
     std::string get_name() const override { return m_node_name; }
     stats::NamedStats sample_stats() const override;
@@ -44,10 +47,16 @@ private:
     void input_worker_thread();
     // Basecall reads
     void basecall_worker_thread(int worker_id);
-    // Basecall batch of chunks
-    void basecall_current_batch(int worker_id);
+    // Basecall the batch of chunks staged in one of the runner's input buffers
+    void basecall_current_batch(int worker_id, int buffer_idx);
+    // Calls batches handed over by a basecall worker
+    void batch_caller_thread(int worker_id);
+    // Hands a staged batch to the worker's batch caller, once any previous batch has been called
+    void dispatch_batch(int worker_id, int buffer_idx);
     // Construct complete reads
     void working_reads_manager();
+    // Records the latency of a completed read, and in latency mode adapts the flush timeout
+    void record_read_latency(const BasecallingRead& read);
 
     // Vector of model runners (each with their own GPU access etc)
     std::vector<basecall::RunnerPtr> m_model_runners;
@@ -57,12 +66,21 @@ private:
     size_t m_overlap;
     // Stride of the model in the runners
     size_t m_model_stride;
+    // Sizes at which the runners can call batches, in increasing order and ending with m_chunk_size
+    std::vector<size_t> m_call_chunk_sizes;
     // Whether the model is for rna
     bool m_rna;
-    // Time in milliseconds before partial batches are called.
+    // Time in milliseconds a partial batch's oldest chunk waits before the batch is called.
     int m_batch_timeout_ms;
+    // Target read latency in milliseconds, or 0 for none.  If set, the node runs in latency
+    // mode: chunks of reads closest to completion are called first, and partial batches are
+    // flushed once their oldest chunk has waited m_flush_timeout_ms, or earlier if the batch
+    // isn't expected to fill by then.
+    int m_latency_target_ms;
+    // Adapted from completed read latencies, and at most m_batch_timeout_ms.
+    std::atomic<int> m_flush_timeout_ms{0};
     // model_name
-    std::string m_model_name;
+    utils::InternedString m_model_name;
     // Mean Q-score start position from model properties.
     uint32_t m_mean_qscore_start_pos;
 
@@ -80,8 +98,8 @@ private:
     // Reads removed from input queue and being basecalled.
     std::unordered_set<std::shared_ptr<BasecallingRead>> m_working_reads;
 
-    // If we go multi-threaded, there will be one of these batches per thread
-    std::vector<std::vector<std::unique_ptr<BasecallingChunk>>> m_batched_chunks;
+    // Staged batches and the thread which calls them, one per model runner.
+    std::vector<std::unique_ptr<BatchCaller>> m_batch_callers;
 
     utils::AsyncQueue<std::unique_ptr<BasecallingChunk>> m_processed_chunks;
 
@@ -100,12 +118,20 @@ private:
     std::string m_node_name;
     std::atomic<int64_t> m_num_batches_called = 0;
     std::atomic<int64_t> m_num_partial_batches_called = 0;
+    std::atomic<int64_t> m_num_short_batches_called = 0;
+    // Samples of signal staged into called batches, and of all chunks called including padding.
+    std::atomic<int64_t> m_num_signal_samples = 0;
+    std::atomic<int64_t> m_num_called_samples = 0;
     std::atomic<int64_t> m_call_chunks_ms = 0;
     std::atomic<int64_t> m_called_reads_pushed = 0;
     std::atomic<int64_t> m_working_reads_size = 0;
     std::atomic<int64_t> m_num_bases_processed = 0;
     std::atomic<int64_t> m_num_samples_processed = 0;
     std::atomic<int64_t> m_working_reads_signal_bytes = 0;
+    std::atomic<int64_t> m_num_early_flushes = 0;
+    std::atomic<int64_t> m_num_reads_within_latency_target = 0;
+    // Time from a read being taken off the input queue to it being sent on.
+    stats::LatencyHistogram m_read_latencies;
 };
 
 }  // namespace dorado
@@ -15,8 +15,7 @@
 
 namespace dorado {
 
-HtsReader::HtsReader(const std::string& filename,
-                     std::optional<std::unordered_set<std::string>> read_list)
+HtsReader::HtsReader(const std::string& filename, std::optional<utils::ReadIdSet> read_list)
         : m_read_list(std::move(read_list)) {
     m_file = hts_open(filename.c_str(), "r");
     if (!m_file) {
@@ -49,8 +48,7 @@ void HtsReader::read(Pipeline& pipeline, int max_reads) {
     int num_reads = 0;
     while (this->read()) {
         if (m_read_list) {
-            std::string read_id = bam_get_qname(record.get());
-            if (m_read_list->find(read_id) == m_read_list->end()) {
+            if (!m_read_list->contains(bam_get_qname(record.get()))) {
                 continue;
             }
         }
@@ -90,10 +88,10 @@ ReadMap read_bam(const std::string& filename, const std::unordered_set<std::stri
             nucleotides[i] = seq_nt16_str[bam_seqi(sequence, i)];
         }
 
-        auto tmp_read = std::make_unique<SimplexRead>();
+        auto tmp_read = make_simplex_read();
         tmp_read->read_common.read_id = read_id;
-        tmp_read->read_common.seq = std::string(nucleotides.begin(), nucleotides.end());
-        tmp_read->read_common.qstring = std::string(qualities.begin(), qualities.end());
+        tmp_read->read_common.seq.assign(nucleotides.begin(), nucleotides.end());
+        tmp_read->read_common.qstring.assign(qualities.begin(), qualities.end());
         reads[read_id] = std::move(tmp_read);
     }
 
@@ -1,5 +1,6 @@
 #pragma once
 #include "read_pipeline/ReadPipeline.h"
+#include "utils/ReadIdSet.h"
 #include "utils/stats.h"
 #include "utils/types.h"
 
@@ -20,8 +21,7 @@ class Pipeline;
 
 class HtsReader {
 public:
-    HtsReader(const std::string& filename,
-              std::optional<std::unordered_set<std::string>> read_list);
+    HtsReader(const std::string& filename, std::optional<utils::ReadIdSet> read_list);
     ~HtsReader();
     bool read();
     void read(Pipeline& pipeline, int max_reads);
@@ -37,7 +37,7 @@ public:
 private:
     htsFile* m_file{nullptr};
 
-    std::optional<std::unordered_set<std::string>> m_read_list;
+    std::optional<utils::ReadIdSet> m_read_list;
 };
 
 template <typename T>
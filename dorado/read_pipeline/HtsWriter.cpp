@@ -1,6 +1,9 @@
 #include "HtsWriter.h"
 
 #include "read_pipeline/ReadPipeline.h"
+#include "utils/AsyncQueue.h"
+#include "utils/WorkStealingExecutor.h"
+#include "utils/bam_utils.h"
 #include "utils/sequence_utils.h"
 
 #include <htslib/bgzf.h>
@@ -9,44 +12,97 @@
 #include <indicators/progress_bar.hpp>
 #include <spdlog/spdlog.h>
 
+#include <algorithm>
+#include <exception>
+#include <filesystem>
+#include <future>
+#include <iomanip>
+#include <sstream>
 #include <stdexcept>
 #include <string>
-#include <unordered_set>
+#include <string_view>
+
+namespace {
+
+// Records are serialised in batches of about this many bytes, which is enough for the
+// partial block at the end of each batch to make little difference to compression.
+constexpr size_t kMaxBatchBytes = 16 * BGZF_BLOCK_SIZE;
+
+}  // namespace
 
 namespace dorado {
 
-HtsWriter::HtsWriter(const std::string& filename, OutputMode mode, size_t threads)
-        : MessageSink(10000) {
+struct HtsWriter::SerialisedBatch {
+    // Compressed BGZF blocks.
+    std::vector<uint8_t> blocks;
+};
+
+struct HtsWriter::Shard {
+    explicit Shard(size_t max_batches) : batches(max_batches) {}
+    ~Shard() {
+        if (file) {
+            hts_close(file);
+        }
+    }
+
+    std::string filename;
+    htsFile* file{nullptr};
+    // Batches being serialised for this shard, in the order they're to be written.
+    utils::AsyncQueue<std::future<SerialisedBatch>> batches;
+    std::thread writer;
+};
+
+HtsWriter::HtsWriter(const std::string& filename,
+                     OutputMode mode,
+                     size_t threads,
+                     size_t num_shards)
+        : MessageSink(10000), m_max_batches_in_flight(std::max(threads, size_t(1))) {
+    const char* open_mode = nullptr;
     switch (mode) {
     case OutputMode::FASTQ:
-        m_file = hts_open(filename.c_str(), "wf");
+        open_mode = "wf";
         break;
     case OutputMode::BAM:
-        m_file = hts_open(filename.c_str(), "wb");
+        open_mode = "wb";
         break;
     case OutputMode::SAM:
-        m_file = hts_open(filename.c_str(), "w");
+        open_mode = "w";
         break;
     case OutputMode::UBAM:
-        m_file = hts_open(filename.c_str(), "wb0");
+        open_mode = "wb0";
         break;
     default:
         throw std::runtime_error("Unknown output mode selected: " +
                                  std::to_string(static_cast<int>(mode)));
     }
-    if (!m_file) {
-        throw std::runtime_error("Could not open file: " + filename);
+    if (num_shards > 1 && filename == "-") {
+        throw std::runtime_error("Sharded output must be written to a file.");
     }
-    if (m_file->format.compression == bgzf) {
-        auto res = bgzf_mt(m_file->fp.bgzf, int(threads), 128);
-        if (res < 0) {
-            throw std::runtime_error("Could not enable multi threading for BAM generation.");
+    num_shards = std::max(num_shards, size_t(1));
+    for (size_t shard_idx = 0; shard_idx < num_shards; ++shard_idx) {
+        auto& shard = *m_shards.emplace_back(std::make_unique<Shard>(m_max_batches_in_flight));
+        shard.filename = num_shards > 1 ? get_shard_filename(filename, shard_idx) : filename;
+        shard.file = hts_open(shard.filename.c_str(), open_mode);
+        if (!shard.file) {
+            throw std::runtime_error("Could not open file: " + shard.filename);
         }
     }
+    // BGZF output is serialised and compressed on the executor, and the blocks are written
+    // straight to the file, so htslib's own compression threads aren't used.
+    const auto* file = m_shards.front()->file;
+    m_parallel_bgzf = file->format.compression == bgzf;
+    if (m_parallel_bgzf) {
+        m_compression_level = file->fp.bgzf->compress_level;
+    }
     start_threads();
 }
 
 void HtsWriter::start_threads() {
+    if (m_parallel_bgzf) {
+        for (auto& shard : m_shards) {
+            shard->writer = std::thread([this, &shard = *shard] { shard_writer_thread(shard); });
+        }
+    }
     m_worker = std::make_unique<std::thread>(std::thread(&HtsWriter::worker_thread, this));
 }
 
@@ -56,17 +112,34 @@ void HtsWriter::terminate_impl() {
         m_worker->join();
     }
     m_worker.reset();
+    // The worker terminates the shard queues once everything has been dispatched.
+    for (auto& shard : m_shards) {
+        if (shard->writer.joinable()) {
+            shard->writer.join();
+        }
+    }
 }
 
 void HtsWriter::restart() {
     restart_input_queue();
+    for (auto& shard : m_shards) {
+        shard->batches.restart();
+    }
     start_threads();
 }
 
 HtsWriter::~HtsWriter() {
     terminate_impl();
     sam_hdr_destroy(m_header);
-    hts_close(m_file);
+    m_shards.clear();
+}
+
+std::string HtsWriter::get_shard_filename(const std::string& filename, size_t shard_idx) {
+    const std::filesystem::path path(filename);
+    std::ostringstream shard_name;
+    shard_name << path.stem().string() << '_' << std::setfill('0') << std::setw(3) << shard_idx
+               << path.extension().string();
+    return (path.parent_path() / shard_name.str()).string();
 }
 
 HtsWriter::OutputMode HtsWriter::get_output_mode(const std::string& mode) {
@@ -81,19 +154,127 @@ HtsWriter::OutputMode HtsWriter::get_output_mode(const std::string& mode) {
 }
 
 void HtsWriter::worker_thread() {
-    Message message;
-    while (get_input_message(message)) {
-        // If this message isn't a BamPtr, ignore it.
-        if (!std::holds_alternative<BamPtr>(message)) {
+    // This is the only consumer, so drain as much as possible at once.
+    std::vector<Message> messages;
+    size_t shard_idx = 0;
+    while (get_input_messages(messages, m_work_queue.capacity())) {
+        std::vector<BamPtr> records;
+        records.reserve(messages.size());
+        for (auto& message : messages) {
+            // If this message isn't a BamPtr, ignore it.
+            if (std::holds_alternative<BamPtr>(message)) {
+                records.push_back(std::move(std::get<BamPtr>(message)));
+            }
+        }
+        if (records.empty()) {
+            continue;
+        }
+
+        if (!m_parallel_bgzf) {
+            for (auto& record : records) {
+                write(shard_idx, record.get());
+            }
+            count_records(records);
+            shard_idx = (shard_idx + 1) % m_shards.size();
             continue;
         }
 
-        auto aln = std::move(std::get<BamPtr>(message));
-        write(aln.get());
+        // As in write(), the header has to have been written first, or the records would be
+        // written ahead of it.
+        assert(m_header);
+
+        // Split the records into batches to serialise in parallel.  Each batch's future is
+        // queued for the shard's writer before the batch is submitted, so the writer sees
+        // batches in order, and a full queue holds back the number in flight.
+        size_t batch_start = 0;
+        size_t batch_bytes = 0;
+        for (size_t i = 0; i < records.size(); ++i) {
+            batch_bytes += records[i]->l_data;
+            if (batch_bytes < kMaxBatchBytes && i + 1 < records.size()) {
+                continue;
+            }
+            auto batch = std::make_shared<std::vector<BamPtr>>(
+                    std::make_move_iterator(records.begin() + batch_start),
+                    std::make_move_iterator(records.begin() + i + 1));
+            auto promise = std::make_shared<std::promise<SerialisedBatch>>();
+            m_shards[shard_idx]->batches.try_push(promise->get_future());
+            utils::WorkStealingExecutor::instance().submit([this, batch, promise] {
+                try {
+                    promise->set_value(serialise_batch(*batch));
+                } catch (...) {
+                    promise->set_exception(std::current_exception());
+                }
+            });
+            shard_idx = (shard_idx + 1) % m_shards.size();
+            batch_start = i + 1;
+            batch_bytes = 0;
+        }
+    }
+
+    for (auto& shard : m_shards) {
+        shard->batches.terminate();
+    }
+}
+
+void HtsWriter::shard_writer_thread(Shard& shard) {
+    std::future<SerialisedBatch> future;
+    while (shard.batches.try_pop(future) == utils::AsyncQueueStatus::Success) {
+        const auto batch = future.get();
+        if (!batch.blocks.empty() &&
+            bgzf_raw_write(shard.file->fp.bgzf, batch.blocks.data(), batch.blocks.size()) < 0) {
+            throw std::runtime_error("Failed to write BAM records to " + shard.filename);
+        }
+    }
+}
+
+HtsWriter::SerialisedBatch HtsWriter::serialise_batch(const std::vector<BamPtr>& records) {
+    std::vector<uint8_t> data;
+    for (const auto& record : records) {
+        utils::append_bam_record(record.get(), data);
+    }
+    SerialisedBatch batch;
+    batch.blocks = utils::compress_bgzf_blocks(data.data(), data.size(), m_compression_level);
+
+    count_records(records);
+    ++m_num_batches_serialised;
+    m_num_bytes_serialised += data.size();
+    m_num_bytes_compressed += batch.blocks.size();
+    return batch;
+}
+
+void HtsWriter::write(size_t shard_idx, bam1_t* const record) {
+    // FIXME -- HtsWriter is constructed in a state where attempting to write
+    // will segfault, since set_and_write_header has to have been called
+    // in order to set m_header.
+    assert(m_header);
+    auto res = sam_write1(m_shards[shard_idx]->file, m_header, record);
+    if (res < 0) {
+        throw std::runtime_error("Failed to write SAM record, error code " + std::to_string(res));
+    }
+}
+
+void HtsWriter::count_records(const std::vector<BamPtr>& records) {
+    size_t num_unmapped = 0;
+    size_t num_secondary = 0;
+    size_t num_supplementary = 0;
+    // The records outlive this call, so their ids needn't be copied.
+    std::vector<std::string_view> read_ids;
+    read_ids.reserve(records.size());
+    for (const auto& record : records) {
+        auto* const aln = record.get();
+        if (aln->core.flag & BAM_FUNMAP) {
+            ++num_unmapped;
+        }
+        if (aln->core.flag & BAM_FSECONDARY) {
+            ++num_secondary;
+        }
+        if (aln->core.flag & BAM_FSUPPLEMENTARY) {
+            ++num_supplementary;
+        }
 
         // For the purpose of estimating write count, we ignore duplex reads
         int64_t dx_tag = 0;
-        auto tag_str = bam_aux_get(aln.get(), "dx");
+        auto tag_str = bam_aux_get(aln, "dx");
         if (tag_str) {
             dx_tag = bam_aux2i(tag_str);
         }
@@ -104,47 +285,28 @@ void HtsWriter::worker_thread() {
             // Read is a duplex read.
             m_duplex_reads_written++;
         } else {
-            std::string read_id;
-
             // If read is a split read, use the parent read id
             // to track write count since we don't know a priori
             // how many split reads will be generated.
-            auto pid_tag = bam_aux_get(aln.get(), "pi");
+            auto pid_tag = bam_aux_get(aln, "pi");
             if (pid_tag) {
-                read_id = std::string(bam_aux2Z(pid_tag));
+                read_ids.emplace_back(bam_aux2Z(pid_tag));
                 m_split_reads_written++;
             } else {
-                read_id = bam_get_qname(aln.get());
+                read_ids.emplace_back(bam_get_qname(aln));
             }
-
-            m_processed_read_ids.insert(std::move(read_id));
         }
     }
-}
 
-int HtsWriter::write(bam1_t* const record) {
-    // track stats
-    m_total++;
-    if (record->core.flag & BAM_FUNMAP) {
-        m_unmapped++;
-    }
-    if (record->core.flag & BAM_FSECONDARY) {
-        m_secondary++;
-    }
-    if (record->core.flag & BAM_FSUPPLEMENTARY) {
-        m_supplementary++;
-    }
-    m_primary = m_total - m_secondary - m_supplementary - m_unmapped;
+    m_unmapped += num_unmapped;
+    m_secondary += num_secondary;
+    m_supplementary += num_supplementary;
+    m_total += records.size();
 
-    // FIXME -- HtsWriter is constructed in a state where attempting to write
-    // will segfault, since set_and_write_header has to have been called
-    // in order to set m_header.
-    assert(m_header);
-    auto res = sam_write1(m_file, m_header, record);
-    if (res < 0) {
-        throw std::runtime_error("Failed to write SAM record, error code " + std::to_string(res));
+    std::lock_guard lock(m_processed_read_ids_mutex);
+    for (const auto read_id : read_ids) {
+        m_processed_read_ids.insert(read_id);
     }
-    return res;
 }
 
 int HtsWriter::set_and_write_header(const sam_hdr_t* const header) {
@@ -154,16 +316,37 @@ int HtsWriter::set_and_write_header(const sam_hdr_t* const header) {
             sam_hdr_destroy(m_header);
         }
         m_header = sam_hdr_dup(header);
-        return sam_hdr_write(m_file, m_header);
+        for (auto& shard : m_shards) {
+            auto res = sam_hdr_write(shard->file, m_header);
+            // Records are written as raw BGZF blocks, so the header must be flushed first.
+            if (res == 0 && m_parallel_bgzf) {
+                res = bgzf_flush(shard->file->fp.bgzf);
+            }
+            if (res < 0) {
+                return res;
+            }
+        }
     }
     return 0;
 }
 
 stats::NamedStats HtsWriter::sample_stats() const {
     auto stats = stats::from_obj(m_work_queue);
-    stats["unique_simplex_reads_written"] = double(m_processed_read_ids.size());
+    {
+        std::lock_guard lock(m_processed_read_ids_mutex);
+        stats["unique_simplex_reads_written"] = double(m_processed_read_ids.size());
+    }
     stats["duplex_reads_written"] = m_duplex_reads_written.load();
     stats["split_reads_written"] = m_split_reads_written.load();
+    if (m_parallel_bgzf) {
+        stats["batches_serialised"] = double(m_num_batches_serialised);
+        stats["serialised_mb"] = double(m_num_bytes_serialised) / double(1024 * 1024);
+        stats["compressed_mb"] = double(m_num_bytes_compressed) / double(1024 * 1024);
+    }
+    // Reads are recycled once converted to records for writing, so report on the pool here.
+    for (const auto& [name, value] : sample_simplex_read_pool_stats()) {
+        stats["read_pool_" + name] = value;
+    }
     return stats;
 }
 
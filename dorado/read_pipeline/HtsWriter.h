@@ -1,5 +1,6 @@
 #pragma once
 #include "read_pipeline/ReadPipeline.h"
+#include "utils/ReadIdSet.h"
 #include "utils/stats.h"
 
 #include <htslib/sam.h>
@@ -7,13 +8,17 @@
 #include <atomic>
 #include <cstdint>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <thread>
-#include <unordered_set>
+#include <vector>
 
 namespace dorado {
 
 class HtsWriter : public MessageSink {
+    struct Shard;
+    struct SerialisedBatch;
+
 public:
     enum class OutputMode {
         UBAM,
@@ -22,7 +27,13 @@ public:
         FASTQ,
     };
 
-    HtsWriter(const std::string& filename, OutputMode mode, size_t threads);
+    // For BAM output, up to threads batches of records are serialised and compressed at once
+    // on the shared executor.  If num_shards > 1, batches are written to that many files in
+    // turn, named after filename with a shard index appended, e.g. calls_000.bam.
+    HtsWriter(const std::string& filename,
+              OutputMode mode,
+              size_t threads,
+              size_t num_shards = 1);
     ~HtsWriter();
     std::string get_name() const override { return "HtsWriter"; }
     stats::NamedStats sample_stats() const override;
@@ -31,27 +42,44 @@ public:
 
     int set_and_write_header(const sam_hdr_t* header);
     static OutputMode get_output_mode(const std::string& mode);
+    // Path of one shard of sharded output.
+    static std::string get_shard_filename(const std::string& filename, size_t shard_idx);
     size_t get_total() const { return m_total; }
-    size_t get_primary() const { return m_primary; }
+    size_t get_primary() const { return m_total - m_secondary - m_supplementary - m_unmapped; }
     size_t get_unmapped() const { return m_unmapped; }
 
 private:
     void start_threads();
     void terminate_impl();
-    size_t m_total{0};
-    size_t m_primary{0};
-    size_t m_unmapped{0};
-    size_t m_secondary{0};
-    size_t m_supplementary{0};
+    std::atomic<size_t> m_total{0};
+    std::atomic<size_t> m_unmapped{0};
+    std::atomic<size_t> m_secondary{0};
+    std::atomic<size_t> m_supplementary{0};
     sam_hdr_t* m_header{nullptr};
 
-    htsFile* m_file{nullptr};
+    std::vector<std::unique_ptr<Shard>> m_shards;
+    // Whether records are serialised into BGZF blocks on the executor.
+    bool m_parallel_bgzf{false};
+    // Compression level of BGZF blocks.
+    int m_compression_level{-1};
+    // Maximum number of batches being serialised at once.
+    size_t m_max_batches_in_flight;
     std::unique_ptr<std::thread> m_worker;
     void worker_thread();
-    int write(bam1_t* record);
-    std::unordered_set<std::string> m_processed_read_ids;
+    // Writes serialised batches to a shard, in the order they were dispatched.
+    void shard_writer_thread(Shard& shard);
+    // Serialises and compresses a batch of records into BGZF blocks.
+    SerialisedBatch serialise_batch(const std::vector<BamPtr>& records);
+    void write(size_t shard_idx, bam1_t* record);
+    // Updates the written record and read counts for a batch of records.
+    void count_records(const std::vector<BamPtr>& records);
+    mutable std::mutex m_processed_read_ids_mutex;
+    utils::ReadIdSet m_processed_read_ids;
     std::atomic<int> m_duplex_reads_written{0};
     std::atomic<int> m_split_reads_written{0};
+    std::atomic<int64_t> m_num_batches_serialised{0};
+    std::atomic<int64_t> m_num_bytes_serialised{0};
+    std::atomic<int64_t> m_num_bytes_compressed{0};
 };
 
 }  // namespace dorado
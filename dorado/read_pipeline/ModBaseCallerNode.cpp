@@ -23,21 +23,79 @@ namespace dorado {
 
 constexpr auto FORCE_TIMEOUT = 100ms;
 
+namespace {
+
+// Signal windows and encoded kmers of all the context hits of a read for one caller, written
+// into two buffers which the read's chunks share.
+struct EncodedContexts {
+    // One row of context samples per hit.
+    at::Tensor signals;
+    // encoded_context_size entries per hit.
+    std::vector<int8_t> kmers;
+    size_t encoded_context_size;
+};
+
+std::shared_ptr<const EncodedContexts> encode_contexts(const modbase::ModBaseEncoder& encoder,
+                                                       const std::vector<size_t>& context_hits,
+                                                       const at::Tensor& scaled_signal,
+                                                       size_t context_samples) {
+    if (context_hits.empty()) {
+        return nullptr;
+    }
+
+    nvtx3::scoped_range range{"encode_contexts"};
+    auto contexts = std::make_shared<EncodedContexts>();
+    contexts->encoded_context_size = encoder.encoded_context_size();
+    contexts->kmers.resize(context_hits.size() * contexts->encoded_context_size);
+    const auto slices = encoder.get_contexts(context_hits, contexts->kmers.data());
+
+    // Windows which overhang the ends of the signal are padded with zeros.
+    const auto signal = scaled_signal.contiguous();
+    contexts->signals = at::zeros({int64_t(context_hits.size()), int64_t(context_samples)},
+                                  signal.options());
+    for (size_t i = 0; i < slices.size(); ++i) {
+        const auto& slice = slices[i];
+        utils::copy_tensor_elems(contexts->signals,
+                                 i * context_samples + slice.lead_samples_needed, signal,
+                                 slice.first_sample, slice.num_samples);
+    }
+    return contexts;
+}
+
+// Whether two callers reverse and scale a read's signal in the same way.
+bool same_signal_config(const modbase::ModBaseModelConfig& a,
+                        const modbase::ModBaseModelConfig& b) {
+    if (a.reverse_signal != b.reverse_signal ||
+        a.refine_do_rough_rescale != b.refine_do_rough_rescale) {
+        return false;
+    }
+    return !a.refine_do_rough_rescale || (a.refine_kmer_levels == b.refine_kmer_levels &&
+                                          a.refine_kmer_len == b.refine_kmer_len &&
+                                          a.refine_kmer_center_idx == b.refine_kmer_center_idx);
+}
+
+}  // namespace
+
 struct ModBaseCallerNode::RemoraChunk {
     RemoraChunk(std::shared_ptr<WorkingRead> read,
-                at::Tensor input_signal,
-                std::vector<int8_t> kmer_data,
+                std::shared_ptr<const EncodedContexts> encoded_contexts,
+                size_t index,
                 size_t position,
                 bool is_template_direction)
             : working_read(std::move(read)),
-              signal(std::move(input_signal)),
-              encoded_kmers(std::move(kmer_data)),
+              contexts(std::move(encoded_contexts)),
+              context_idx(index),
               context_hit(position),
               is_template_direction(is_template_direction) {}
 
+    const int8_t* encoded_kmers() const {
+        return contexts->kmers.data() + context_idx * contexts->encoded_context_size;
+    }
+
     std::shared_ptr<WorkingRead> working_read;
-    at::Tensor signal;
-    std::vector<int8_t> encoded_kmers;
+    // The chunk's signal and encoded kmers are entry context_idx of contexts.
+    std::shared_ptr<const EncodedContexts> contexts;
+    size_t context_idx;
     size_t context_hit;
     std::vector<float> scores;
     bool is_template_direction;
@@ -135,6 +193,19 @@ void ModBaseCallerNode::init_modbase_info() {
         }
         base_mod_params.emplace_back(runner->caller_params(caller_id));
         m_num_states += params.base_mod_count;
+
+        // Callers whose signals are prepared the same way share a signal config.
+        size_t config_id = 0;
+        while (config_id < caller_id &&
+               !same_signal_config(runner->caller_params(config_id), params)) {
+            ++config_id;
+        }
+        if (config_id == caller_id) {
+            config_id = m_num_signal_configs++;
+        } else {
+            config_id = m_signal_config_ids[config_id];
+        }
+        m_signal_config_ids.push_back(config_id);
     }
 
     auto result = modbase::get_modbase_info(base_mod_params);
@@ -215,16 +286,24 @@ void ModBaseCallerNode::duplex_mod_call(Message&& message) {
             std::vector<uint64_t> seq_to_sig_map =
                     utils::moves_to_map(new_move_table, m_block_stride, signal_len, num_moves + 1);
 
+            auto signal = simplex_signal.slice(0, moves_offset * m_block_stride,
+                                               moves_offset * m_block_stride + signal_len);
+            // Scaled signals are computed once per signal config.
+            std::vector<at::Tensor> scaled_signals(m_num_signal_configs);
+
             for (size_t caller_id = 0; caller_id < runner->num_callers(); ++caller_id) {
                 nvtx3::scoped_range range{"generate_chunks"};
                 auto& chunks_to_enqueue = chunks_to_enqueue_by_caller.at(caller_id);
                 auto& params = runner->caller_params(caller_id);
-                auto signal = simplex_signal.slice(0, moves_offset * m_block_stride,
-                                                   moves_offset * m_block_stride + signal_len);
 
                 // scale signal based on model parameters
-                auto scaled_signal =
-                        runner->scale_signal(caller_id, signal, sequence_ints, seq_to_sig_map);
+                auto& scaled_signal = scaled_signals[m_signal_config_ids[caller_id]];
+                if (scaled_signal.defined()) {
+                    ++m_num_scaled_signal_reuses;
+                } else {
+                    scaled_signal =
+                            runner->scale_signal(caller_id, signal, sequence_ints, seq_to_sig_map);
+                }
 
                 auto context_samples = (params.context_before + params.context_after);
 
@@ -235,20 +314,13 @@ void ModBaseCallerNode::duplex_mod_call(Message&& message) {
 
                 auto context_hits = runner->get_motif_hits(caller_id, new_seq);
                 m_num_context_hits += static_cast<int64_t>(context_hits.size());
-                chunks_to_enqueue.reserve(context_hits.size());
+                chunks_to_enqueue.reserve(chunks_to_enqueue.size() + context_hits.size());
+                auto contexts =
+                        encode_contexts(encoder, context_hits, scaled_signal, context_samples);
 
-                for (auto context_hit : context_hits) {
+                for (size_t context_idx = 0; context_idx < context_hits.size(); ++context_idx) {
                     nvtx3::scoped_range range_create_chunk{"create_chunk"};
-                    auto slice = encoder.get_context(context_hit);
-                    // signal
-                    auto input_signal = scaled_signal.index({at::indexing::Slice(
-                            slice.first_sample, slice.first_sample + slice.num_samples)});
-                    if (slice.lead_samples_needed != 0 || slice.tail_samples_needed != 0) {
-                        input_signal = at::constant_pad_nd(input_signal,
-                                                           {(int64_t)slice.lead_samples_needed,
-                                                            (int64_t)slice.tail_samples_needed});
-                    }
-
+                    const auto context_hit = context_hits[context_idx];
                     // Update the context hit into the duplex reference context
                     unsigned long context_hit_in_duplex_space;
                     if (is_template_direction) {
@@ -260,8 +332,8 @@ void ModBaseCallerNode::duplex_mod_call(Message&& message) {
                     }
 
                     chunks_to_enqueue.push_back(std::make_unique<RemoraChunk>(
-                            working_read, input_signal, std::move(slice.data),
-                            context_hit_in_duplex_space, is_template_direction));
+                            working_read, contexts, context_idx, context_hit_in_duplex_space,
+                            is_template_direction));
 
                     all_context_hits.push_back(context_hit_in_duplex_space);
                     ++working_read->num_modbase_chunks;
@@ -330,27 +402,39 @@ void ModBaseCallerNode::simplex_mod_call(Message&& message) {
     auto& runner = m_runners[0];
     std::vector<std::vector<std::unique_ptr<RemoraChunk>>> chunks_to_enqueue_by_caller(
             runner->num_callers());
+
+    // The move map, and the signal and map reversed for callers with reverse_signal set, are
+    // computed once for all callers.  Scaled signals are computed once per signal config.
+    const auto signal_len = read->read_common.get_raw_data_samples();
+    const std::vector<uint64_t> forward_seq_to_sig_map = utils::moves_to_map(
+            read->read_common.moves, m_block_stride, signal_len, read->read_common.seq.size() + 1);
+    std::vector<uint64_t> reversed_seq_to_sig_map;
+    at::Tensor reversed_signal;
+    std::vector<at::Tensor> scaled_signals(m_num_signal_configs);
+
     for (size_t caller_id = 0; caller_id < runner->num_callers(); ++caller_id) {
         nvtx3::scoped_range range{"generate_chunks"};
 
-        auto signal_len = read->read_common.get_raw_data_samples();
-        std::vector<uint64_t> seq_to_sig_map =
-                utils::moves_to_map(read->read_common.moves, m_block_stride, signal_len,
-                                    read->read_common.seq.size() + 1);
-
         auto& chunks_to_enqueue = chunks_to_enqueue_by_caller.at(caller_id);
         auto& params = runner->caller_params(caller_id);
-        auto signal = read->read_common.raw_data;
-        if (params.reverse_signal) {
-            signal = at::flip(signal, 0);
-            std::reverse(std::begin(seq_to_sig_map), std::end(seq_to_sig_map));
-            std::transform(std::begin(seq_to_sig_map), std::end(seq_to_sig_map),
-                           std::begin(seq_to_sig_map),
+        if (params.reverse_signal && !reversed_signal.defined()) {
+            reversed_signal = at::flip(read->read_common.raw_data, 0);
+            reversed_seq_to_sig_map.resize(forward_seq_to_sig_map.size());
+            std::transform(std::rbegin(forward_seq_to_sig_map), std::rend(forward_seq_to_sig_map),
+                           std::begin(reversed_seq_to_sig_map),
                            [signal_len](auto signal_pos) { return signal_len - signal_pos; });
         }
+        const auto& signal = params.reverse_signal ? reversed_signal : read->read_common.raw_data;
+        const auto& seq_to_sig_map =
+                params.reverse_signal ? reversed_seq_to_sig_map : forward_seq_to_sig_map;
 
         // scale signal based on model parameters
-        auto scaled_signal = runner->scale_signal(caller_id, signal, sequence_ints, seq_to_sig_map);
+        auto& scaled_signal = scaled_signals[m_signal_config_ids[caller_id]];
+        if (scaled_signal.defined()) {
+            ++m_num_scaled_signal_reuses;
+        } else {
+            scaled_signal = runner->scale_signal(caller_id, signal, sequence_ints, seq_to_sig_map);
+        }
 
         auto context_samples = (params.context_before + params.context_after);
 
@@ -362,19 +446,10 @@ void ModBaseCallerNode::simplex_mod_call(Message&& message) {
         auto context_hits = runner->get_motif_hits(caller_id, read->read_common.seq);
         m_num_context_hits += static_cast<int64_t>(context_hits.size());
         chunks_to_enqueue.reserve(context_hits.size());
-        for (auto context_hit : context_hits) {
-            nvtx3::scoped_range nvtxrange{"create_chunk"};
-            auto slice = encoder.get_context(context_hit);
-            // signal
-            auto input_signal = scaled_signal.index({at::indexing::Slice(
-                    slice.first_sample, slice.first_sample + slice.num_samples)});
-            if (slice.lead_samples_needed != 0 || slice.tail_samples_needed != 0) {
-                input_signal = at::constant_pad_nd(
-                        input_signal,
-                        {(int64_t)slice.lead_samples_needed, (int64_t)slice.tail_samples_needed});
-            }
+        auto contexts = encode_contexts(encoder, context_hits, scaled_signal, context_samples);
+        for (size_t context_idx = 0; context_idx < context_hits.size(); ++context_idx) {
             chunks_to_enqueue.push_back(std::make_unique<RemoraChunk>(
-                    working_read, input_signal, std::move(slice.data), context_hit, true));
+                    working_read, contexts, context_idx, context_hits[context_idx], true));
 
             ++working_read->num_modbase_chunks;
         }
@@ -466,8 +541,8 @@ void ModBaseCallerNode::modbasecall_worker_thread(size_t worker_id, size_t calle
              ++chunk_idx) {
             assert(chunk_idx < m_batch_size);
             const auto& chunk = batched_chunks[chunk_idx];
-            runner->accept_chunk(int(caller_id), int(chunk_idx), chunk->signal,
-                                 chunk->encoded_kmers);
+            runner->accept_chunk(int(caller_id), int(chunk_idx), chunk->contexts->signals,
+                                 int64_t(chunk->context_idx), chunk->encoded_kmers());
         }
 
         // If we have a complete batch, or we have a partial batch and timed out,
@@ -606,6 +681,8 @@ std::unordered_map<std::string, double> ModBaseCallerNode::sample_stats() const
     stats["mod_base_reads_pushed"] = double(m_num_mod_base_reads_pushed);
     stats["non_mod_base_reads_pushed"] = double(m_num_non_mod_base_reads_pushed);
     stats["chunk_generation_ms"] = double(m_chunk_generation_ms);
+    stats["signal_configs"] = double(m_num_signal_configs);
+    stats["scaled_signal_reuses"] = double(m_num_scaled_signal_reuses);
     stats["working_reads_items"] = double(m_working_reads_size);
     return stats;
 }
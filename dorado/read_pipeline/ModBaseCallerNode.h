@@ -82,6 +82,10 @@ private:
     // The offsets to the canonical bases in the modbase alphabet
     std::array<size_t, 4> m_base_prob_offsets;
     size_t m_num_states{4};
+    // Callers with the same signal config share a read's scaled signal.  The config ids of the
+    // callers, and the number of distinct configs.
+    std::vector<size_t> m_signal_config_ids;
+    size_t m_num_signal_configs{0};
 
     // Performance monitoring stats.
     std::atomic<int64_t> m_num_batches_called = 0;
@@ -92,6 +96,7 @@ private:
     std::atomic<int64_t> m_num_mod_base_reads_pushed = 0;
     std::atomic<int64_t> m_num_non_mod_base_reads_pushed = 0;
     std::atomic<int64_t> m_chunk_generation_ms = 0;
+    std::atomic<int64_t> m_num_scaled_signal_reuses = 0;
     std::atomic<int64_t> m_working_reads_size = 0;
 };
 
@@ -7,8 +7,13 @@
 #include <spdlog/spdlog.h>
 
 #include <algorithm>
+#include <array>
+#include <chrono>
 #include <cstdint>
+#include <filesystem>
+#include <functional>
 #include <limits>
+#include <string>
 
 namespace {
 const int kMaxTimeDeltaMs = 10000;
@@ -51,6 +56,68 @@ bool are_reads_adjacent(const dorado::SimplexRead& temp, const dorado::SimplexRe
 
 namespace dorado {
 
+struct PairingNode::OverlapWorkspace {
+    // A template read's minimap2 index, kept so that checks of the same template against
+    // several complements only index it once.
+    struct TemplateIndex {
+        std::string read_id;
+        std::string seq;
+        mm_idx_t* index = nullptr;
+        mm_mapopt_t map_opt;
+    };
+    // Templates are tested against the reads either side of them, so only a few are needed.
+    static constexpr size_t NUM_CACHED_TEMPLATES = 4;
+
+    OverlapWorkspace() : tbuf(mm_tbuf_init()) {
+        mm_set_opt(0, &idx_opt, &map_opt);
+        mm_set_opt("map-hifi", &idx_opt, &map_opt);
+    }
+
+    ~OverlapWorkspace() {
+        for (auto& cached : templates) {
+            if (cached.index) {
+                mm_idx_destroy(cached.index);
+            }
+        }
+    }
+
+    OverlapWorkspace(const OverlapWorkspace&) = delete;
+    OverlapWorkspace& operator=(const OverlapWorkspace&) = delete;
+
+    // Returns the index of the template read, building it if it isn't cached.
+    const TemplateIndex& template_index(const SimplexRead& temp, bool& reused) {
+        const auto& seq = temp.read_common.seq;
+        const auto& read_id = temp.read_common.read_id;
+        for (const auto& cached : templates) {
+            if (cached.index && cached.read_id == read_id && cached.seq == seq) {
+                reused = true;
+                return cached;
+            }
+        }
+
+        reused = false;
+        auto& entry = templates[next_template];
+        next_template = (next_template + 1) % NUM_CACHED_TEMPLATES;
+        if (entry.index) {
+            mm_idx_destroy(entry.index);
+        }
+        entry.read_id = read_id;
+        entry.seq = seq;
+        const char* seqs[] = {entry.seq.c_str()};
+        const char* names[] = {entry.read_id.c_str()};
+        entry.index = mm_idx_str(idx_opt.w, idx_opt.k, 0, idx_opt.bucket_bits, 1, seqs, names);
+        entry.map_opt = map_opt;
+        mm_mapopt_update(&entry.map_opt, entry.index);
+        return entry;
+    }
+
+    mm_idxopt_t idx_opt;
+    mm_mapopt_t map_opt;
+    MmTbufPtr tbuf;
+    std::array<TemplateIndex, NUM_CACHED_TEMPLATES> templates;
+    size_t next_template = 0;
+};
+
 // Determine whether 2 proposed reads form a duplex pair or not.
 // The algorithm utilizes the following heuristics to make a decision -
 // 1. Reads must be within 1000ms of each other, and the ratio of their
@@ -112,25 +179,18 @@ PairingNode::PairingResult PairingNode::is_within_alignment_criteria(
     const std::string nvtx_id = "pairing_map_" + std::to_string(tid);
     nvtx3::scoped_range loop{nvtx_id};
     // Add mm2 based overlap check.
-    mm_idxopt_t m_idx_opt;
-    mm_mapopt_t m_map_opt;
-    mm_set_opt(0, &m_idx_opt, &m_map_opt);
-    mm_set_opt("map-hifi", &m_idx_opt, &m_map_opt);
-
-    std::vector<const char*> seqs = {temp.read_common.seq.c_str()};
-    std::vector<const char*> names = {temp.read_common.read_id.c_str()};
-    mm_idx_t* m_index = mm_idx_str(m_idx_opt.w, m_idx_opt.k, 0, m_idx_opt.bucket_bits, 1,
-                                   seqs.data(), names.data());
-    mm_mapopt_update(&m_map_opt, m_index);
-
-    mm_tbuf_t* tbuf = m_tbufs[tid].get();
+    const auto check_start = std::chrono::steady_clock::now();
+    auto& workspace = *m_overlap_workspaces[tid];
+    bool reused_index = false;
+    const auto& template_index = workspace.template_index(temp, reused_index);
+    if (reused_index) {
+        ++m_template_index_reuses;
+    }
 
     int hits = 0;
-    mm_reg1_t* reg =
-            mm_map(m_index, int(comp.read_common.seq.length()), comp.read_common.seq.c_str(), &hits,
-                   tbuf, &m_map_opt, comp.read_common.read_id.c_str());
-
-    mm_idx_destroy(m_index);
+    mm_reg1_t* reg = mm_map(template_index.index, int(comp.read_common.seq.length()),
+                            comp.read_common.seq.c_str(), &hits, workspace.tbuf.get(),
+                            &template_index.map_opt, comp.read_common.read_id.c_str());
 
     // When there are multiple hits, pick the primary alignment.
     if (hits > 0) {
@@ -189,6 +249,10 @@ PairingNode::PairingResult PairingNode::is_within_alignment_criteria(
     }
     free(reg);
 
+    ++m_overlap_checks;
+    m_overlap_check_us += std::chrono::duration_cast<std::chrono::microseconds>(
+                                  std::chrono::steady_clock::now() - check_start)
+                                  .count();
     return pair_result;
 }
 
@@ -266,6 +330,7 @@ void PairingNode::pair_list_worker_thread(int tid) {
                     ++template_read->num_duplex_candidate_pairs;
 
                     send_message_to_sink(std::move(read_pair));
+                    ++m_pairs_emitted;
                 } else {
                     spdlog::debug("- rejected explicitly requested read pair: {} and {}",
                                   template_read->read_common.read_id,
@@ -277,6 +342,148 @@ void PairingNode::pair_list_worker_thread(int tid) {
     --m_num_active_worker_threads;
 }
 
+std::unique_lock<std::mutex> PairingNode::CacheShard::lock() {
+    std::unique_lock<std::mutex> shard_lock(mutex, std::try_to_lock);
+    if (!shard_lock.owns_lock()) {
+        ++lock_waits;
+        shard_lock.lock();
+    }
+    ++lock_acquisitions;
+    return shard_lock;
+}
+
+PairingNode::CacheShard& PairingNode::cache_shard(const ClientPoreKey& key) {
+    const auto& [channel, run_id, flowcell_id] = key.second;
+    size_t hash = std::hash<std::string>()(run_id) ^ std::hash<std::string>()(flowcell_id);
+    hash = hash * 31 + size_t(key.first);
+    hash = hash * 31 + size_t(channel);
+    return m_cache_shards[hash % NUM_CACHE_SHARDS];
+}
+
+void PairingNode::track_new_pore(const ClientPoreKey& key) {
+    if (m_max_num_keys == std::numeric_limits<size_t>::max()) {
+        return;
+    }
+
+    ClientPoreKey oldest_key;
+    {
+        std::lock_guard<std::mutex> lock(m_working_keys_mutex);
+        auto& working_channel_keys = m_working_channel_keys[key.first];
+        working_channel_keys.push_back(key.second);
+        if (working_channel_keys.size() <= m_max_num_keys) {
+            return;
+        }
+        // Remove the oldest key (front of the list)
+        oldest_key = {key.first, std::move(working_channel_keys.front())};
+        working_channel_keys.pop_front();
+    }
+
+    auto& shard = cache_shard(oldest_key);
+    auto lock = shard.lock();
+    auto oldest_key_it = shard.pore_reads.find(oldest_key);
+    if (oldest_key_it == shard.pore_reads.end()) {
+        // The client's cache has been flushed.
+        return;
+    }
+    for (auto& read_ptr : oldest_key_it->second) {
+        shard.reads_to_clear.insert(std::move(read_ptr));
+    }
+    shard.pore_reads.erase(oldest_key_it);
+    clear_evicted_reads(shard);
+}
+
+void PairingNode::clear_evicted_reads(CacheShard& shard) {
+    for (auto to_clear_itr = shard.reads_to_clear.begin();
+         to_clear_itr != shard.reads_to_clear.end();) {
+        auto in_flight_itr = shard.reads_in_flight_ctr.find(to_clear_itr->get());
+        bool ok_to_clear = false;
+        // If a read to clear is not in-flight (not in the in-flight list
+        // or in-flight counter is 0), then clear it
+        // from the cache.
+        if (in_flight_itr == shard.reads_in_flight_ctr.end()) {
+            ok_to_clear = true;
+        } else if (in_flight_itr->second == 0) {
+            shard.reads_in_flight_ctr.erase(in_flight_itr);
+            ok_to_clear = true;
+        }
+        if (ok_to_clear) {
+            auto read_handle = shard.reads_to_clear.extract(*to_clear_itr++);
+            send_read_from_cache(shard, std::move(read_handle.value()));
+        } else {
+            ++to_clear_itr;
+        }
+    }
+}
+
+void PairingNode::send_read_from_cache(CacheShard& shard, SimplexReadPtr read) {
+    // Evicted reads keep counting towards the cached signal until they're sent on.
+    m_cache_signal_bytes -= read_signal_bytes(*read);
+    restore_signal(shard, *read, false);
+    send_message_to_sink(std::move(read));
+}
+
+void PairingNode::spill_cached_signal(CacheShard& shard, std::vector<SimplexReadPtr>& pore_reads) {
+    // The newest read is the most likely to be paired, so is never spilled.
+    for (size_t i = 0; i + 1 < pore_reads.size(); ++i) {
+        if (m_cache_signal_bytes <= m_max_cache_signal_bytes) {
+            break;
+        }
+        SimplexRead* const read = pore_reads[i].get();
+        const auto in_flight_itr = shard.reads_in_flight_ctr.find(read);
+        if ((in_flight_itr != shard.reads_in_flight_ctr.end() && in_flight_itr->second > 0) ||
+            shard.spilled_signals.count(read) != 0) {
+            continue;
+        }
+        auto& raw_data = read->read_common.raw_data;
+        const size_t signal_bytes = read_signal_bytes(*read);
+        shard.spilled_signals.emplace(read, m_signal_store->spill(raw_data));
+        raw_data = at::empty({0}, raw_data.options());
+        m_cache_signal_bytes -= signal_bytes;
+        ++m_signal_spills;
+    }
+}
+
+void PairingNode::restore_signal(CacheShard& shard, SimplexRead& read, bool still_cached) {
+    if (!m_signal_store) {
+        return;
+    }
+    auto spilled_itr = shard.spilled_signals.find(&read);
+    if (spilled_itr == shard.spilled_signals.end()) {
+        ++m_signal_hits;
+        return;
+    }
+    read.read_common.raw_data = m_signal_store->restore(spilled_itr->second);
+    shard.spilled_signals.erase(spilled_itr);
+    ++m_signal_misses;
+    if (still_cached) {
+        m_cache_signal_bytes += read_signal_bytes(read);
+    }
+}
+
+ReadPair PairingNode::make_read_pair(CacheShard& shard,
+                                     SimplexRead& temp,
+                                     SimplexRead& comp,
+                                     const PairingResult& result) {
+    const auto [is_pair, qs, qe, rs, re] = result;
+    ReadPair pair;
+    {
+        // Signal is only spilled or restored under the shard lock.
+        std::unique_lock<std::mutex> lock;
+        if (m_signal_store) {
+            lock = shard.lock();
+            restore_signal(shard, temp, true);
+            restore_signal(shard, comp, true);
+        }
+        pair.template_read = ReadPair::ReadData::from_read(temp, qs, qe);
+        pair.complement_read = ReadPair::ReadData::from_read(comp, rs, re);
+    }
+
+    temp.is_duplex_parent = true;
+    comp.is_duplex_parent = true;
+    ++temp.num_duplex_candidate_pairs;
+    return pair;
+}
+
 void PairingNode::pair_generating_worker_thread(int tid) {
     at::InferenceMode inference_mode_guard;
 
@@ -287,18 +494,23 @@ void PairingNode::pair_generating_worker_thread(int tid) {
     Message message;
     while (get_input_message(message)) {
         if (std::holds_alternative<CacheFlushMessage>(message)) {
-            std::unique_lock<std::mutex> lock(m_pairing_mtx);
             auto flush_message = std::get<CacheFlushMessage>(message);
-            auto& read_cache = m_read_caches[flush_message.client_id];
-            for (auto& [key, reads_list] : read_cache.channel_read_map) {
-                // kv is a std::pair<UniquePoreIdentifierKey, std::list<std::shared_ptr<Read>>>
-                for (auto& read_ptr : reads_list) {
-                    // Push each read message
-                    m_cache_signal_bytes -= read_signal_bytes(*read_ptr);
-                    send_message_to_sink(std::move(read_ptr));
+            for (auto& shard : m_cache_shards) {
+                auto lock = shard.lock();
+                for (auto it = shard.pore_reads.begin(); it != shard.pore_reads.end();) {
+                    if (it->first.first != flush_message.client_id) {
+                        ++it;
+                        continue;
+                    }
+                    for (auto& read_ptr : it->second) {
+                        // Push each read message
+                        send_read_from_cache(shard, std::move(read_ptr));
+                    }
+                    it = shard.pore_reads.erase(it);
                 }
             }
-            m_read_caches.erase(flush_message.client_id);
+            std::lock_guard<std::mutex> lock(m_working_keys_mutex);
+            m_working_channel_keys.erase(flush_message.client_id);
             continue;
         }
 
@@ -318,43 +530,28 @@ void PairingNode::pair_generating_worker_thread(int tid) {
         std::string flowcell_id = read->read_common.flowcell_id;
         int32_t client_id = read->read_common.client_info->client_id();
 
-        std::unique_lock<std::mutex> lock(m_pairing_mtx);
+        ClientPoreKey key{client_id, std::make_tuple(channel, run_id, flowcell_id)};
+        auto& shard = cache_shard(key);
+        auto lock = shard.lock();
 
-        auto& read_cache = m_read_caches[client_id];
-        UniquePoreIdentifierKey key = std::make_tuple(channel, run_id, flowcell_id);
-        auto read_list_iter = read_cache.channel_read_map.find(key);
+        auto read_list_iter = shard.pore_reads.find(key);
         // Check if the key is already in the list
-        if (read_list_iter == read_cache.channel_read_map.end()) {
-            // Key is not in the dequeue
-            // Add the new key to the end of the list
-            {
-                read_cache.working_channel_keys.push_back(key);
-                std::list<SimplexReadPtr> reads;
-                m_cache_signal_bytes += read_signal_bytes(*read);
-                reads.push_back(std::move(read));
-                read_cache.channel_read_map.emplace(key, std::move(reads));
+        if (read_list_iter == shard.pore_reads.end()) {
+            m_cache_signal_bytes += read_signal_bytes(*read);
+            auto& pore_reads = shard.pore_reads[key];
+            pore_reads.push_back(std::move(read));
+            if (m_signal_store) {
+                spill_cached_signal(shard, pore_reads);
             }
 
-            if (read_cache.working_channel_keys.size() > m_max_num_keys) {
-                // Remove the oldest key (front of the list)
-                auto oldest_key = read_cache.working_channel_keys.front();
-                read_cache.working_channel_keys.pop_front();
-
-                auto oldest_key_it = read_cache.channel_read_map.find(oldest_key);
-
-                // Remove the oldest key from the map
-                for (auto& read_ptr : oldest_key_it->second) {
-                    m_cache_signal_bytes -= read_signal_bytes(*read_ptr);
-                    m_reads_to_clear.insert(std::move(read_ptr));
-                }
-                read_cache.channel_read_map.erase(oldest_key);
-                assert(read_cache.channel_read_map.size() ==
-                       read_cache.working_channel_keys.size());
-            }
+            // Pores are tracked outside of the shard lock, as eviction locks another shard.
+            lock.unlock();
+            track_new_pore(key);
+            lock.lock();
         } else {
             auto& cached_read_list = read_list_iter->second;
             // It's safe to take raw pointers of these reads since their ownership isn't released from this
-            // node until their counter in |m_reads_in_flight_ctr| hits 0.
+            // node until their counter in |reads_in_flight_ctr| hits 0.
             SimplexRead* later_read = nullptr;
             SimplexRead* earlier_read = nullptr;
 
@@ -362,56 +559,48 @@ void PairingNode::pair_generating_worker_thread(int tid) {
                     cached_read_list.begin(), cached_read_list.end(), read, compare_reads_by_time);
             if (later_read_iter != cached_read_list.end()) {
                 later_read = later_read_iter->get();
-                m_reads_in_flight_ctr[later_read]++;
+                shard.reads_in_flight_ctr[later_read]++;
             }
 
             if (later_read_iter != cached_read_list.begin()) {
                 earlier_read = std::prev(later_read_iter)->get();
-                m_reads_in_flight_ctr[earlier_read]++;
+                shard.reads_in_flight_ctr[earlier_read]++;
             }
 
             SimplexRead* const read_ptr = read.get();
             m_cache_signal_bytes += read_signal_bytes(*read);
             cached_read_list.insert(later_read_iter, std::move(read));
-            m_reads_in_flight_ctr[read_ptr]++;
+            shard.reads_in_flight_ctr[read_ptr]++;
 
-            while (cached_read_list.size() > m_max_num_reads) {
-                m_cache_signal_bytes -= read_signal_bytes(*cached_read_list.front());
-                auto cached_read = std::move(cached_read_list.front());
-                cached_read_list.pop_front();
-                m_reads_to_clear.insert(std::move(cached_read));
+            if (cached_read_list.size() > m_max_num_reads) {
+                const auto num_to_evict = cached_read_list.size() - m_max_num_reads;
+                for (size_t i = 0; i < num_to_evict; ++i) {
+                    shard.reads_to_clear.insert(std::move(cached_read_list[i]));
+                }
+                cached_read_list.erase(cached_read_list.begin(),
+                                       cached_read_list.begin() + num_to_evict);
+            }
+            if (m_signal_store) {
+                spill_cached_signal(shard, cached_read_list);
             }
 
             // Release mutex around read cache to run pair evaluations.
             lock.unlock();
 
             if (later_read) {
-                auto [is_pair, qs, qe, rs, re] =
-                        is_within_time_and_length_criteria(*read_ptr, *later_read, tid);
-                if (is_pair) {
-                    ReadPair pair;
-                    pair.template_read = ReadPair::ReadData::from_read(*read_ptr, qs, qe);
-                    pair.complement_read = ReadPair::ReadData::from_read(*later_read, rs, re);
-
-                    read_ptr->is_duplex_parent = true;
-                    later_read->is_duplex_parent = true;
-                    ++read_ptr->num_duplex_candidate_pairs;
-                    send_message_to_sink(std::move(pair));
+                const auto result = is_within_time_and_length_criteria(*read_ptr, *later_read, tid);
+                if (std::get<0>(result)) {
+                    send_message_to_sink(make_read_pair(shard, *read_ptr, *later_read, result));
+                    ++m_pairs_emitted;
                 }
             }
 
             if (earlier_read) {
-                auto [is_pair, qs, qe, rs, re] =
+                const auto result =
                         is_within_time_and_length_criteria(*earlier_read, *read_ptr, tid);
-                if (is_pair) {
-                    ReadPair pair;
-                    pair.template_read = ReadPair::ReadData::from_read(*earlier_read, qs, qe);
-                    pair.complement_read = ReadPair::ReadData::from_read(*read_ptr, rs, re);
-
-                    earlier_read->is_duplex_parent = true;
-                    read_ptr->is_duplex_parent = true;
-                    ++earlier_read->num_duplex_candidate_pairs;
-                    send_message_to_sink(std::move(pair));
+                if (std::get<0>(result)) {
+                    send_message_to_sink(make_read_pair(shard, *earlier_read, *read_ptr, result));
+                    ++m_pairs_emitted;
                 }
             }
 
@@ -419,59 +608,42 @@ void PairingNode::pair_generating_worker_thread(int tid) {
             lock.lock();
 
             // Decrement in-flight counter for each read.
-            m_reads_in_flight_ctr[read_ptr]--;
+            shard.reads_in_flight_ctr[read_ptr]--;
             if (earlier_read) {
-                m_reads_in_flight_ctr[earlier_read]--;
+                shard.reads_in_flight_ctr[earlier_read]--;
             }
             if (later_read) {
-                m_reads_in_flight_ctr[later_read]--;
+                shard.reads_in_flight_ctr[later_read]--;
             }
         }
 
         // Once pairs have been evaluated, check if any of the in-flight reads
         // need to be purged from the cache.
-        for (auto to_clear_itr = m_reads_to_clear.begin();
-             to_clear_itr != m_reads_to_clear.end();) {
-            auto in_flight_itr = m_reads_in_flight_ctr.find(to_clear_itr->get());
-            bool ok_to_clear = false;
-            // If a read to clear is not in-flight (not in the in-flight list
-            // or in-flight counter is 0), then clear it
-            // from the cache.
-            if (in_flight_itr == m_reads_in_flight_ctr.end()) {
-                ok_to_clear = true;
-            } else if (in_flight_itr->second.load() == 0) {
-                m_reads_in_flight_ctr.erase(in_flight_itr);
-                ok_to_clear = true;
-            }
-            if (ok_to_clear) {
-                auto read_handle = m_reads_to_clear.extract(*to_clear_itr++);
-                send_message_to_sink(std::move(read_handle.value()));
-            } else {
-                ++to_clear_itr;
-            }
-        }
+        clear_evicted_reads(shard);
     }
 
     if (--m_num_active_worker_threads == 0) {
-        if (!m_preserve_cache_during_flush) {
-            std::unique_lock<std::mutex> lock(m_pairing_mtx);
-            // There are still reads in channel_read_map. Push them to the sink.
-            // Last thread alive is responsible for cleaning up the cache.
-            for (auto& [client_id, read_cache] : m_read_caches) {
-                for (auto& kv : read_cache.channel_read_map) {
-                    // kv is a std::pair<UniquePoreIdentifierKey, std::list<std::shared_ptr<Read>>>
-                    auto& reads_list = kv.second;
-
+        // Last thread alive is responsible for cleaning up the cache.
+        for (auto& shard : m_cache_shards) {
+            auto lock = shard.lock();
+            if (!m_preserve_cache_during_flush) {
+                // There are still reads in pore_reads. Push them to the sink.
+                for (auto& [pore_key, reads_list] : shard.pore_reads) {
                     for (auto& read_ptr : reads_list) {
-                        m_cache_signal_bytes -= read_signal_bytes(*read_ptr);
                         // Push each read message
-                        send_message_to_sink(std::move(read_ptr));
+                        send_read_from_cache(shard, std::move(read_ptr));
                     }
                 }
+                shard.pore_reads.clear();
             }
-            m_read_caches.clear();
+            // Nothing is in flight any more, so evicted reads can all go.
+            shard.reads_in_flight_ctr.clear();
+            clear_evicted_reads(shard);
+        }
+        if (!m_preserve_cache_during_flush) {
+            std::lock_guard<std::mutex> lock(m_working_keys_mutex);
+            m_working_channel_keys.clear();
         }
-        m_reads_in_flight_ctr.clear();
     }
 }
 
@@ -510,14 +682,31 @@ PairingNode::PairingNode(DuplexPairingParameters pairing_params,
         throw std::runtime_error("Unsupported read order detected: " +
                                  dorado::to_string(pairing_params.read_order));
     }
+    m_max_cache_signal_bytes = pairing_params.max_cache_signal_bytes;
+    if (m_max_cache_signal_bytes > 0) {
+        const auto spill_dir = pairing_params.spill_dir.empty()
+                                       ? std::filesystem::temp_directory_path()
+                                       : std::filesystem::path(pairing_params.spill_dir);
+        m_signal_store = std::make_unique<utils::SignalSpillStore>(spill_dir);
+        spdlog::debug("Spilling pairing cache signal beyond a soft limit of {} MB to {}",
+                      m_max_cache_signal_bytes >> 20, spill_dir.string());
+    } else {
+        m_max_cache_signal_bytes = std::numeric_limits<size_t>::max();
+    }
     m_pairing_func = &PairingNode::pair_generating_worker_thread;
     start_threads();
 }
 
+PairingNode::~PairingNode() { terminate_impl(); }
+
 void PairingNode::start_threads() {
-    m_tbufs.reserve(m_num_worker_threads);
+    if (m_start_time == std::chrono::steady_clock::time_point{}) {
+        // Rates cover the node's whole lifetime, including restarts.
+        m_start_time = std::chrono::steady_clock::now();
+    }
+    m_overlap_workspaces.reserve(m_num_worker_threads);
     for (int i = 0; i < m_num_worker_threads; i++) {
-        m_tbufs.push_back(MmTbufPtr(mm_tbuf_init()));
+        m_overlap_workspaces.push_back(std::make_unique<OverlapWorkspace>());
         m_workers.push_back(std::make_unique<std::thread>(std::thread(m_pairing_func, this, i)));
         ++m_num_active_worker_threads;
     }
@@ -538,7 +727,7 @@ void PairingNode::terminate_impl() {
     }
     m_workers.clear();
 
-    m_tbufs.clear();
+    m_overlap_workspaces.clear();
 }
 
 void PairingNode::restart() {
@@ -550,8 +739,47 @@ stats::NamedStats PairingNode::sample_stats() const {
     stats::NamedStats stats = m_work_queue.sample_stats();
     stats["early_accepted_pairs"] = m_early_accepted_pairs.load();
     stats["overlap_accepted_pairs"] = m_overlap_accepted_pairs.load();
+    const double elapsed_s = std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                                           m_start_time)
+                                     .count();
+    stats["pairs_emitted"] = double(m_pairs_emitted);
+    if (elapsed_s > 0) {
+        stats["pairs_per_sec"] = double(m_pairs_emitted) / elapsed_s;
+    }
+    stats["overlap_checks"] = double(m_overlap_checks);
+    if (m_overlap_check_us > 0) {
+        stats["overlap_checks_per_sec"] =
+                double(m_overlap_checks) * 1e6 / double(m_overlap_check_us);
+    }
+    stats["template_index_reuses"] = double(m_template_index_reuses);
+    if (m_signal_store) {
+        stats["signal_spills"] = double(m_signal_spills);
+        stats["signal_hits"] = double(m_signal_hits);
+        stats["signal_misses"] = double(m_signal_misses);
+        stats["spilled_signal_mb"] =
+                static_cast<double>(m_signal_store->spilled_bytes()) / (1024 * 1024);
+        stats["spill_file_mb"] = static_cast<double>(m_signal_store->file_bytes()) / (1024 * 1024);
+        const size_t cached_signal_bytes = m_cache_signal_bytes;
+        stats["signal_soft_budget_mb"] = static_cast<double>(m_max_cache_signal_bytes >> 20);
+        stats["signal_over_soft_budget_mb"] =
+                static_cast<double>(cached_signal_bytes > m_max_cache_signal_bytes
+                                            ? cached_signal_bytes - m_max_cache_signal_bytes
+                                            : 0) /
+                (1024 * 1024);
+    }
     stats["cached_signal_mb"] =
             static_cast<double>(m_cache_signal_bytes) / static_cast<double>(1024 * 1024);
+    int64_t total_lock_acquisitions = 0;
+    int64_t total_lock_waits = 0;
+    for (size_t i = 0; i < NUM_CACHE_SHARDS; ++i) {
+        const auto& shard = m_cache_shards[i];
+        const int64_t lock_waits = shard.lock_waits.load();
+        stats["cache_shard_" + std::to_string(i) + "_lock_waits"] = double(lock_waits);
+        total_lock_acquisitions += shard.lock_acquisitions.load();
+        total_lock_waits += lock_waits;
+    }
+    stats["cache_lock_acquisitions"] = double(total_lock_acquisitions);
+    stats["cache_lock_waits"] = double(total_lock_waits);
     return stats;
 }
 
@@ -1,13 +1,16 @@
 #pragma once
 
 #include "ReadPipeline.h"
+#include "utils/SignalSpillStore.h"
 #include "utils/stats.h"
 #include "utils/types.h"
 
+#include <array>
 #include <atomic>
+#include <chrono>
 #include <cstdint>
 #include <deque>
-#include <list>
+#include <limits>
 #include <map>
 #include <memory>
 #include <mutex>
@@ -15,6 +18,8 @@
 #include <thread>
 #include <tuple>
 #include <unordered_map>
+#include <unordered_set>
+#include <utility>
 #include <vector>
 
 namespace dorado {
@@ -23,10 +28,29 @@ class PairingNode : public MessageSink {
     // A key for a unique Pore, Duplex reads must have the same UniquePoreIdentifierKey
     // The values are channel, run_id, flowcell_id
     using UniquePoreIdentifierKey = std::tuple<int, std::string, std::string>;
+    // Pores are cached per client.
+    using ClientPoreKey = std::pair<int32_t, UniquePoreIdentifierKey>;
+    using PairingResult = std::tuple<bool, uint32_t, uint32_t, uint32_t, uint32_t>;
 
-    struct ReadCache {
-        std::map<UniquePoreIdentifierKey, std::list<SimplexReadPtr>> channel_read_map;
-        std::deque<UniquePoreIdentifierKey> working_channel_keys;
+    // The read cache is split into shards by pore, each with its own lock, so that workers
+    // handling reads from different pores don't contend.
+    static constexpr size_t NUM_CACHE_SHARDS = 16;
+    struct CacheShard {
+        std::mutex mutex;
+        // Reads from each pore, sorted by start time.
+        std::map<ClientPoreKey, std::vector<SimplexReadPtr>> pore_reads;
+        // Track reads which need to be emptied from the cache but are still being
+        // evaluated for pairs by other threads.
+        std::unordered_map<const SimplexRead*, int> reads_in_flight_ctr;
+        std::unordered_set<SimplexReadPtr> reads_to_clear;
+        // Cached reads whose signal has been spilled to m_signal_store.
+        std::unordered_map<const SimplexRead*, utils::SignalSpillStore::Handle> spilled_signals;
+
+        std::atomic<int64_t> lock_acquisitions{0};
+        std::atomic<int64_t> lock_waits{0};
+
+        // Locks the shard, counting the times the lock was already held.
+        std::unique_lock<std::mutex> lock();
     };
 
 public:
@@ -37,7 +61,7 @@ public:
 
     // No template-complement map: uses the pair_generation pairing method
     PairingNode(DuplexPairingParameters pairing_params, int num_worker_threads, size_t max_reads);
-    ~PairingNode() { terminate_impl(); }
+    ~PairingNode();
     std::string get_name() const override { return "PairingNode"; }
     stats::NamedStats sample_stats() const override;
     void terminate(const FlushOptions& flush_options) override;
@@ -64,6 +88,28 @@ private:
      */
     void pair_generating_worker_thread(int tid);
 
+    CacheShard& cache_shard(const ClientPoreKey& key);
+    // Records a newly cached pore, evicting the client's oldest pore if there are more than
+    // m_max_num_keys.  Must be called without holding any shard lock.
+    void track_new_pore(const ClientPoreKey& key);
+    // Sends on evicted reads of the shard that are no longer being evaluated for pairs.
+    // The shard must be locked.
+    void clear_evicted_reads(CacheShard& shard);
+    // Sends a read out of the cache on to the sink, with its signal.  The shard must be locked.
+    void send_read_from_cache(CacheShard& shard, SimplexReadPtr read);
+    // Spills the signal of a pore's oldest reads until the cached signal is within budget,
+    // skipping the pore's newest read and reads being evaluated for pairs.  The shard must be
+    // locked.
+    void spill_cached_signal(CacheShard& shard, std::vector<SimplexReadPtr>& pore_reads);
+    // Faults a cached read's signal back in if it was spilled, counting it as cached signal
+    // again if still_cached.  The shard must be locked.
+    void restore_signal(CacheShard& shard, SimplexRead& read, bool still_cached);
+    // Builds a pair message from two cached reads, restoring any spilled signal.
+    ReadPair make_read_pair(CacheShard& shard,
+                            SimplexRead& temp,
+                            SimplexRead& comp,
+                            const PairingResult& result);
+
     std::vector<std::unique_ptr<std::thread>> m_workers;
     int m_num_worker_threads = 0;
     std::atomic<int> m_num_active_worker_threads = 0;
@@ -84,10 +130,11 @@ private:
 
     // Members for pair_generating method
 
-    std::mutex m_pairing_mtx;
+    std::array<CacheShard, NUM_CACHE_SHARDS> m_cache_shards;
 
-    // individual read caches per client, keyed by client_id
-    std::unordered_map<int32_t, ReadCache> m_read_caches;
+    // Cached pores per client, oldest first.  Only tracked if m_max_num_keys is limited.
+    std::mutex m_working_keys_mutex;
+    std::unordered_map<int32_t, std::deque<UniquePoreIdentifierKey>> m_working_channel_keys;
 
     /**
      * The maximum number of different channels (pores) to keep in memory concurrently. 
@@ -105,7 +152,6 @@ private:
      */
     size_t m_max_num_reads;
 
-    using PairingResult = std::tuple<bool, uint32_t, uint32_t, uint32_t, uint32_t>;
     PairingResult is_within_time_and_length_criteria(const dorado::SimplexRead& read1,
                                                      const dorado::SimplexRead& read2,
                                                      int tid);
@@ -116,18 +162,30 @@ private:
                                                bool allow_rejection,
                                                int tid);
 
-    // Store the minimap2 buffers used for mapping. One buffer per thread.
-    std::vector<MmTbufPtr> m_tbufs;
-
-    // Track reads which need to be emptied from the cache but are still being
-    // evaluated for pairs by other threads.
-    std::unordered_map<const SimplexRead*, std::atomic<int>> m_reads_in_flight_ctr;
-    std::unordered_set<SimplexReadPtr> m_reads_to_clear;
+    // Minimap2 options, buffers and recently indexed templates used for overlap checks.
+    // One workspace per thread.
+    struct OverlapWorkspace;
+    std::vector<std::unique_ptr<OverlapWorkspace>> m_overlap_workspaces;
 
     // Stats tracking for pairing node.
     std::atomic<int> m_early_accepted_pairs{0};
     std::atomic<int> m_overlap_accepted_pairs{0};
+    std::atomic<int64_t> m_pairs_emitted{0};
+    std::atomic<int64_t> m_overlap_checks{0};
+    std::atomic<int64_t> m_overlap_check_us{0};
+    std::atomic<int64_t> m_template_index_reuses{0};
+    std::chrono::steady_clock::time_point m_start_time;
     std::atomic<size_t> m_cache_signal_bytes{0};
+
+    // Once the cached signal exceeds m_max_cache_signal_bytes, further signal is spilled to a
+    // scratch file.  Null if cached signal is unbounded.  The budget is soft: signal is only
+    // spilled from the pore a read is added to, so pores which get no more reads, and the newest
+    // read of each pore, can keep the cache over budget.
+    std::unique_ptr<utils::SignalSpillStore> m_signal_store;
+    size_t m_max_cache_signal_bytes = std::numeric_limits<size_t>::max();
+    std::atomic<int64_t> m_signal_spills{0};
+    std::atomic<int64_t> m_signal_hits{0};
+    std::atomic<int64_t> m_signal_misses{0};
 };
 
 }  // namespace dorado
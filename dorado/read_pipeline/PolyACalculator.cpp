@@ -286,11 +286,10 @@ SignalAnchorInfo determine_signal_anchor_and_strand_drna() { return SignalAnchor
 
 namespace dorado {
 
-void PolyACalculator::worker_thread() {
+void PolyACalculator::process_messages(std::vector<Message>& messages) {
     at::InferenceMode inference_mode_guard;
 
-    Message message;
-    while (get_input_message(message)) {
+    for (auto& message : messages) {
         // If this message isn't a read, just forward it to the sink.
         if (!std::holds_alternative<SimplexReadPtr>(message)) {
             send_message_to_sink(std::move(message));
@@ -372,20 +371,12 @@ PolyACalculator::PolyACalculator(size_t num_worker_threads, bool is_rna, size_t
 }
 
 void PolyACalculator::start_threads() {
-    for (size_t i = 0; i < m_num_worker_threads; i++) {
-        m_workers.push_back(
-                std::make_unique<std::thread>(std::thread(&PolyACalculator::worker_thread, this)));
-    }
+    start_input_processing([this](std::vector<Message>& messages) { process_messages(messages); },
+                           m_num_worker_threads);
 }
 
 void PolyACalculator::terminate_impl() {
-    terminate_input_queue();
-    for (auto& m : m_workers) {
-        if (m->joinable()) {
-            m->join();
-        }
-    }
-    m_workers.clear();
+    stop_input_processing();
 
     spdlog::debug("Total called {}, not called {}, avg tail length {}", num_called.load(),
                   num_not_called.load(),
@@ -417,6 +408,7 @@ stats::NamedStats PolyACalculator::sample_stats() const {
     stats["reads_estimated"] = num_called.load();
     stats["average_tail_length"] = double(
             num_called.load() > 0 ? total_tail_lengths_called.load() / num_called.load() : 0);
+    stats.merge(sample_input_processing_stats());
     return stats;
 }
 
@@ -25,10 +25,8 @@ public:
 private:
     void start_threads();
     void terminate_impl();
-    void worker_thread();
+    void process_messages(std::vector<Message>& messages);
 
-    // Async worker for writing.
-    std::vector<std::unique_ptr<std::thread>> m_workers;
     size_t m_num_worker_threads = 0;
     const bool m_is_rna;
     std::atomic<size_t> total_tail_lengths_called{0};
@@ -0,0 +1,106 @@
+#include "ReadEndAnnotatorNode.h"
+
+#include "utils/bam_utils.h"
+#include "utils/types.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace dorado {
+
+ReadEndAnnotatorNode::ReadEndAnnotatorNode(int threads,
+                                           bool trim_adapters,
+                                           bool trim_primers,
+                                           const std::vector<std::string>& kit_names,
+                                           bool barcode_both_ends,
+                                           bool no_trim,
+                                           BarcodingInfo::FilterSet allowed_barcodes,
+                                           const std::optional<std::string>& custom_kit,
+                                           const std::optional<std::string>& custom_seqs,
+                                           int prefilter_kmer_length)
+        : MessageSink(10000),
+          m_threads(threads),
+          m_trim_adapters(trim_adapters),
+          m_trim_primers(trim_primers),
+          m_default_barcoding_info(create_barcoding_info(kit_names,
+                                                         barcode_both_ends,
+                                                         !no_trim,
+                                                         std::move(allowed_barcodes),
+                                                         custom_kit,
+                                                         custom_seqs)),
+          m_annotator(prefilter_kmer_length) {
+    start_threads();
+}
+
+void ReadEndAnnotatorNode::start_threads() {
+    start_input_processing([this](std::vector<Message>& messages) { process_messages(messages); },
+                           m_threads);
+}
+
+void ReadEndAnnotatorNode::terminate_impl() { stop_input_processing(); }
+
+void ReadEndAnnotatorNode::restart() {
+    restart_input_queue();
+    start_threads();
+}
+
+ReadEndAnnotatorNode::~ReadEndAnnotatorNode() { terminate_impl(); }
+
+void ReadEndAnnotatorNode::process_messages(std::vector<Message>& messages) {
+    for (auto& message : messages) {
+        if (std::holds_alternative<BamPtr>(message)) {
+            auto read = std::get<BamPtr>(std::move(message));
+            process_read(read);
+            send_message_to_sink(std::move(read));
+        } else if (std::holds_alternative<SimplexReadPtr>(message)) {
+            auto read = std::get<SimplexReadPtr>(std::move(message));
+            process_read(*read);
+            send_message_to_sink(std::move(read));
+        } else {
+            send_message_to_sink(std::move(message));
+        }
+    }
+}
+
+void ReadEndAnnotatorNode::process_read(BamPtr& read) {
+    const auto* barcoding_info = m_default_barcoding_info.get();
+    auto annotation = m_annotator.annotate(utils::extract_sequence(read.get()), m_trim_adapters,
+                                           m_trim_primers, barcoding_info);
+    demux::ReadEndAnnotator::apply(annotation, read);
+    m_num_records++;
+    if (annotation.barcode) {
+        m_num_barcoded++;
+    }
+}
+
+void ReadEndAnnotatorNode::process_read(SimplexRead& read) {
+    // Check read for instruction on what to trim.
+    bool trim_adapters = m_trim_adapters;
+    bool trim_primers = m_trim_primers;
+    if (read.read_common.adapter_info) {
+        // The read contains instruction on what to trim, so ignore class defaults.
+        trim_adapters = read.read_common.adapter_info->trim_adapters;
+        trim_primers = read.read_common.adapter_info->trim_primers;
+    }
+    auto barcoding_info = demux::get_barcoding_info(m_default_barcoding_info, read);
+
+    auto annotation = m_annotator.annotate(read.read_common.seq, trim_adapters, trim_primers,
+                                           barcoding_info.get());
+    demux::ReadEndAnnotator::apply(annotation, read);
+    m_num_records++;
+    if (annotation.barcode) {
+        m_num_barcoded++;
+    }
+}
+
+stats::NamedStats ReadEndAnnotatorNode::sample_stats() const {
+    auto stats = stats::from_obj(m_work_queue);
+    stats["num_reads_trimmed"] = m_num_records.load();
+    stats["num_barcodes_demuxed"] = m_num_barcoded.load();
+    stats.merge(m_annotator.sample_stats());
+    stats.merge(sample_input_processing_stats());
+    return stats;
+}
+
+}  // namespace dorado
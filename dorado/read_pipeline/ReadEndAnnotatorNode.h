@@ -0,0 +1,53 @@
+#pragma once
+#include "demux/ReadEndAnnotator.h"
+#include "read_pipeline/ReadPipeline.h"
+#include "utils/stats.h"
+#include "utils/types.h"
+
+#include <atomic>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace dorado {
+
+// Does the work of an AdapterDetectorNode followed by a BarcodeClassifierNode, trimming each read
+// once rather than twice.
+class ReadEndAnnotatorNode : public MessageSink {
+public:
+    ReadEndAnnotatorNode(int threads,
+                         bool trim_adapters,
+                         bool trim_primers,
+                         const std::vector<std::string>& kit_names,
+                         bool barcode_both_ends,
+                         bool no_trim,
+                         BarcodingInfo::FilterSet allowed_barcodes,
+                         const std::optional<std::string>& custom_kit,
+                         const std::optional<std::string>& custom_seqs,
+                         int prefilter_kmer_length);
+    ~ReadEndAnnotatorNode() override;
+    std::string get_name() const override { return "ReadEndAnnotatorNode"; }
+    stats::NamedStats sample_stats() const override;
+    void terminate(const FlushOptions&) override { terminate_impl(); }
+    void restart() override;
+
+private:
+    void start_threads();
+
+    size_t m_threads{1};
+    bool m_trim_adapters;
+    bool m_trim_primers;
+    std::atomic<int> m_num_records{0};
+    std::atomic<int> m_num_barcoded{0};
+    std::shared_ptr<const BarcodingInfo> m_default_barcoding_info;
+    demux::ReadEndAnnotator m_annotator;
+
+    void process_messages(std::vector<Message>& messages);
+    void process_read(BamPtr& read);
+    void process_read(SimplexRead& read);
+
+    void terminate_impl();
+};
+
+}  // namespace dorado
@@ -4,14 +4,14 @@
 
 namespace dorado {
 
-void ReadFilterNode::worker_thread() {
+void ReadFilterNode::process_messages(std::vector<Message>& messages) {
     at::InferenceMode inference_mode_guard;
 
-    Message message;
-    while (get_input_message(message)) {
+    std::vector<Message> messages_to_send;
+    for (auto& message : messages) {
         // If this message isn't a read, just forward it to the sink.
         if (!is_read_message(message)) {
-            send_message_to_sink(std::move(message));
+            messages_to_send.push_back(std::move(message));
             continue;
         }
 
@@ -33,9 +33,10 @@ void ReadFilterNode::worker_thread() {
             (m_read_ids_to_filter.find(read_common.read_id) != m_read_ids_to_filter.end())) {
             log_filtering();
         } else {
-            send_message_to_sink(std::move(message));
+            messages_to_send.push_back(std::move(message));
         }
     }
+    send_messages_to_sink(messages_to_send);
 }
 
 ReadFilterNode::ReadFilterNode(size_t min_qscore,
@@ -53,21 +54,11 @@ ReadFilterNode::ReadFilterNode(size_t min_qscore,
 }
 
 void ReadFilterNode::start_threads() {
-    for (size_t i = 0; i < m_num_worker_threads; ++i) {
-        m_workers.push_back(
-                std::make_unique<std::thread>(std::thread(&ReadFilterNode::worker_thread, this)));
-    }
+    start_input_processing([this](std::vector<Message>& messages) { process_messages(messages); },
+                           m_num_worker_threads);
 }
 
-void ReadFilterNode::terminate_impl() {
-    terminate_input_queue();
-    for (auto& m : m_workers) {
-        if (m->joinable()) {
-            m->join();
-        }
-    }
-    m_workers.clear();
-}
+void ReadFilterNode::terminate_impl() { stop_input_processing(); }
 
 void ReadFilterNode::restart() {
     restart_input_queue();
@@ -78,6 +69,7 @@ stats::NamedStats ReadFilterNode::sample_stats() const {
     stats::NamedStats stats = stats::from_obj(m_work_queue);
     stats["simplex_reads_filtered"] = double(m_num_simplex_reads_filtered);
     stats["duplex_reads_filtered"] = double(m_num_duplex_reads_filtered);
+    stats.merge(sample_input_processing_stats());
     return stats;
 }
 
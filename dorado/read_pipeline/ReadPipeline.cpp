@@ -3,6 +3,7 @@
 #include "DefaultClientInfo.h"
 #include "modbase/ModBaseContext.h"
 #include "stereo_features.h"
+#include "utils/WorkStealingExecutor.h"
 #include "utils/bam_utils.h"
 #include "utils/sequence_utils.h"
 
@@ -10,10 +11,14 @@
 #include <spdlog/spdlog.h>
 
 #include <algorithm>
+#include <atomic>
 #include <cctype>
 #include <chrono>
+#include <condition_variable>
 #include <iomanip>
 #include <iostream>
+#include <mutex>
+#include <new>
 #include <sstream>
 #include <stack>
 #include <stdexcept>
@@ -23,16 +28,26 @@ using namespace std::chrono_literals;
 
 namespace dorado {
 
-ReadCommon::ReadCommon() : client_info(std::make_shared<DefaultClientInfo>()) {}
+namespace {
+
+std::shared_ptr<ClientInfo> default_client_info() {
+    // DefaultClientInfo is stateless, so one instance can be shared by every read.
+    static const auto client_info = std::make_shared<DefaultClientInfo>();
+    return client_info;
+}
+
+}  // namespace
+
+ReadCommon::ReadCommon() : client_info(default_client_info()) {}
 
 std::string ReadCommon::generate_read_group() const {
     std::string read_group;
     if (!run_id.empty()) {
-        read_group = run_id + '_';
+        read_group = run_id.str() + '_';
         if (model_name.empty()) {
             read_group += "unknown";
         } else {
-            read_group += model_name;
+            read_group += model_name.str();
         }
         if (!barcode.empty() && barcode != "unclassified") {
             read_group += '_' + barcode;
@@ -376,16 +391,294 @@ ReadPair::ReadData ReadPair::ReadData::from_read(const SimplexRead &read,
     return data;
 }
 
-MessageSink::MessageSink(size_t max_messages) : m_work_queue(max_messages) {}
+namespace {
+
+// Reads are mostly created by the loader and freed on pipeline worker threads, so a shared
+// free list is used rather than per-thread caches.
+class SimplexReadPool {
+public:
+    // Bounds the memory held by idle reads.
+    static constexpr size_t kMaxPooledReads = 1024;
+    // Buffers larger than this are freed rather than kept with a pooled read, so that one
+    // very long read doesn't pin memory for the rest of the run.
+    static constexpr size_t kMaxRetainedBufferBytes = 1 << 20;
+
+    static SimplexReadPool &instance() {
+        // Deliberately leaked, so reads freed during static destruction are still safe.
+        static auto *pool = new SimplexReadPool();
+        return *pool;
+    }
+
+    SimplexRead *acquire() {
+        {
+            std::lock_guard lock(m_mutex);
+            if (!m_reads.empty()) {
+                auto *read = m_reads.back();
+                m_reads.pop_back();
+                ++m_num_reused;
+                return read;
+            }
+        }
+        ++m_num_allocated;
+        return new SimplexRead();
+    }
+
+    void release(SimplexRead *read) {
+        // Resetting is done outside the lock, so the size is checked again before pooling.
+        if (is_full()) {
+            delete read;
+            return;
+        }
+        reset(*read);
+        {
+            std::lock_guard lock(m_mutex);
+            if (m_reads.size() < kMaxPooledReads) {
+                m_reads.push_back(read);
+                return;
+            }
+            ++m_num_discarded;
+        }
+        delete read;
+    }
+
+    stats::NamedStats sample_stats() {
+        stats::NamedStats stats;
+        std::lock_guard lock(m_mutex);
+        stats["pooled_reads"] = double(m_reads.size());
+        stats["reads_allocated"] = double(m_num_allocated.load());
+        stats["reads_reused"] = double(m_num_reused);
+        stats["reads_discarded"] = double(m_num_discarded);
+        return stats;
+    }
+
+private:
+    bool is_full() {
+        std::lock_guard lock(m_mutex);
+        if (m_reads.size() < kMaxPooledReads) {
+            return false;
+        }
+        ++m_num_discarded;
+        return true;
+    }
+
+    template <typename Buffer>
+    static Buffer take_buffer(Buffer &buffer) {
+        Buffer taken;
+        if (buffer.capacity() * sizeof(typename Buffer::value_type) <= kMaxRetainedBufferBytes) {
+            taken = std::move(buffer);
+            taken.clear();
+        }
+        return taken;
+    }
+
+    // Returns read to its default-constructed state, other than keeping the capacity of its
+    // largest per-read buffers.  Re-constructing in place means fields added to SimplexRead
+    // in the future are reset without needing to be listed here.
+    static void reset(SimplexRead &read) {
+        auto &read_common = read.read_common;
+        auto read_id = take_buffer(read_common.read_id);
+        auto seq = take_buffer(read_common.seq);
+        auto qstring = take_buffer(read_common.qstring);
+        auto moves = take_buffer(read_common.moves);
+        auto base_mod_probs = take_buffer(read_common.base_mod_probs);
+
+        read.~SimplexRead();
+        new (&read) SimplexRead();
+
+        read_common.read_id = std::move(read_id);
+        read_common.seq = std::move(seq);
+        read_common.qstring = std::move(qstring);
+        read_common.moves = std::move(moves);
+        read_common.base_mod_probs = std::move(base_mod_probs);
+    }
+
+    std::mutex m_mutex;
+    std::vector<SimplexRead *> m_reads;
+    std::atomic<int64_t> m_num_allocated{0};
+    int64_t m_num_reused = 0;
+    int64_t m_num_discarded = 0;
+};
+
+}  // namespace
+
+void SimplexReadDeleter::operator()(SimplexRead *read) const {
+    if (read) {
+        SimplexReadPool::instance().release(read);
+    }
+}
+
+SimplexReadPtr make_simplex_read() { return SimplexReadPtr(SimplexReadPool::instance().acquire()); }
+
+stats::NamedStats sample_simplex_read_pool_stats() {
+    return SimplexReadPool::instance().sample_stats();
+}
+
+namespace {
+
+// How long a push from an executor worker waits on a full queue before looking for other
+// work to run.
+constexpr auto kExecutorPushInterval = std::chrono::milliseconds(1);
+
+}  // namespace
+
+struct MessageSink::InputProcessor {
+    ProcessMessagesFn process_fn;
+    size_t max_concurrency = 1;
+
+    // Number of processing tasks submitted to the executor and not yet finished.
+    std::atomic<size_t> num_active{0};
+    // Set by pushes, so a task that found the queue empty can tell that it raced with one.
+    std::atomic<bool> pushed{false};
+
+    // Guards retirement of tasks, so stop_input_processing can't observe the node as idle
+    // while a task is still deciding whether to retire.
+    std::mutex mutex;
+    std::condition_variable idle_cv;
+
+    // Stats.
+    std::atomic<int64_t> num_batches{0};
+    std::atomic<int64_t> num_messages{0};
+    std::atomic<int64_t> busy_time_us{0};
+};
+
+MessageSink::MessageSink(size_t max_messages, utils::AsyncQueueBackend queue_backend)
+        : m_work_queue(max_messages, queue_backend) {}
 
 void MessageSink::push_message_internal(Message &&message) {
-#ifndef NDEBUG
-    const auto status =
-#endif
-            m_work_queue.try_push(std::move(message));
+    utils::AsyncQueueStatus status;
+    if (auto *executor = utils::WorkStealingExecutor::current(); executor) {
+        // Blocking here would tie up a shared worker, and if every worker blocked the
+        // stage we're waiting on could never run.  So run other tasks while the sink is full.
+        while ((status = m_work_queue.try_push_until(
+                        std::move(message), std::chrono::steady_clock::now() +
+                                                    kExecutorPushInterval)) ==
+               utils::AsyncQueueStatus::Timeout) {
+            executor->help_while_waiting();
+        }
+    } else {
+        status = m_work_queue.try_push(std::move(message));
+    }
     // try_push will fail if the sink has been told to terminate.
     // We do not expect to be pushing reads from this source if that is the case.
     assert(status == utils::AsyncQueueStatus::Success);
+
+    if (m_input_processor) {
+        schedule_input_processing();
+    }
+}
+
+void MessageSink::push_messages(std::vector<Message> &messages) {
+    utils::AsyncQueueStatus status;
+    if (auto *executor = utils::WorkStealingExecutor::current(); executor) {
+        // As in push_message_internal, don't block a shared worker on a full queue.
+        while ((status = m_work_queue.try_push_n_until(
+                        messages, std::chrono::steady_clock::now() + kExecutorPushInterval)) ==
+               utils::AsyncQueueStatus::Timeout) {
+            if (m_input_processor) {
+                // Some messages may have gone in before the timeout.
+                schedule_input_processing();
+            }
+            executor->help_while_waiting();
+        }
+    } else {
+        status = m_work_queue.try_push_n(messages);
+    }
+    // As with push_message_internal, we do not expect to be pushing to a terminated sink.
+    assert(status == utils::AsyncQueueStatus::Success);
+
+    if (m_input_processor) {
+        schedule_input_processing();
+    }
+}
+
+void MessageSink::start_input_processing(ProcessMessagesFn process_fn, size_t max_concurrency) {
+    if (!m_input_processor) {
+        m_input_processor = std::make_shared<InputProcessor>();
+    }
+    m_input_processor->process_fn = std::move(process_fn);
+    m_input_processor->max_concurrency = std::max(max_concurrency, size_t(1));
+    // Pick up anything queued before we started.
+    schedule_input_processing();
+}
+
+void MessageSink::stop_input_processing() {
+    if (!m_input_processor) {
+        return;
+    }
+    terminate_input_queue();
+    auto &processor = *m_input_processor;
+    std::unique_lock lock(processor.mutex);
+    while (processor.num_active > 0 || m_work_queue.size() > 0) {
+        if (processor.num_active == 0) {
+            processor.pushed = true;
+            schedule_input_processing();
+        }
+        processor.idle_cv.wait_for(lock, std::chrono::milliseconds(10));
+    }
+}
+
+void MessageSink::schedule_input_processing() {
+    auto &processor = *m_input_processor;
+    processor.pushed = true;
+    size_t num_active = processor.num_active;
+    while (num_active < processor.max_concurrency) {
+        if (processor.num_active.compare_exchange_weak(num_active, num_active + 1)) {
+            utils::WorkStealingExecutor::instance().submit(
+                    [this, processor = m_input_processor] { process_input_messages(processor); });
+            return;
+        }
+    }
+}
+
+// processor is passed in, rather than read from the node, so that it stays alive until this
+// task has retired, even if stop_input_processing returns as soon as it does.
+void MessageSink::process_input_messages(std::shared_ptr<InputProcessor> processor) {
+    processor->pushed.exchange(false);
+
+    // Share queued work between the tasks that may be running, so one task doesn't take
+    // the whole queue while others sit idle.
+    const size_t batch_size = std::clamp(m_work_queue.size() / processor->max_concurrency,
+                                         size_t(1), kMaxMessageBatchSize);
+    std::vector<Message> messages;
+    const auto status = m_work_queue.process_and_pop_n_with_timeout(
+            [&messages](Message &&message) { messages.push_back(std::move(message)); },
+            batch_size, std::chrono::steady_clock::now());
+
+    if (status == utils::AsyncQueueStatus::Success) {
+        const auto start_time = std::chrono::steady_clock::now();
+        processor->num_messages += messages.size();
+        processor->process_fn(messages);
+        processor->busy_time_us += std::chrono::duration_cast<std::chrono::microseconds>(
+                                           std::chrono::steady_clock::now() - start_time)
+                                           .count();
+        ++processor->num_batches;
+        // Go back through the executor rather than looping, behind this worker's other
+        // queued tasks, so they run first and idle workers can take this one over.
+        utils::WorkStealingExecutor::instance().submit_behind(
+                [this, processor] { process_input_messages(processor); });
+        return;
+    }
+
+    // The queue is empty: retire this task unless a push raced with us finding it so.
+    std::lock_guard lock(processor->mutex);
+    --processor->num_active;
+    if (processor->pushed.exchange(false)) {
+        schedule_input_processing();
+    }
+    processor->idle_cv.notify_all();
+}
+
+stats::NamedStats MessageSink::sample_input_processing_stats() const {
+    stats::NamedStats stats;
+    if (m_input_processor) {
+        const auto &processor = *m_input_processor;
+        stats["executor_max_concurrency"] = double(processor.max_concurrency);
+        stats["executor_active_tasks"] = double(processor.num_active.load());
+        stats["executor_batches"] = double(processor.num_batches.load());
+        stats["executor_messages"] = double(processor.num_messages.load());
+        stats["executor_busy_ms"] = double(processor.busy_time_us.load()) / 1000.0;
+    }
+    return stats;
 }
 
 // Depth first search that establishes a topological ordering for node destruction.
@@ -1,5 +1,6 @@
 #pragma once
 #include "utils/AsyncQueue.h"
+#include "utils/InternedString.h"
 #include "utils/stats.h"
 #include "utils/types.h"
 
@@ -7,6 +8,7 @@
 #include <spdlog/spdlog.h>
 
 #include <cstdint>
+#include <functional>
 #include <limits>
 #include <memory>
 #include <optional>
@@ -44,11 +46,12 @@ public:
     std::string qstring;                  // Read Qstring (Phred)
     std::vector<uint8_t> moves;           // Move table
     std::vector<uint8_t> base_mod_probs;  // Modified base probabilities
-    std::string run_id;                   // Run ID - used in read group
-    std::string flowcell_id;    // Flowcell ID - used in read group and for sample sheet aliasing
-    std::string position_id;    // Position ID - used for sample sheet aliasing
-    std::string experiment_id;  // Experiment ID - used for sample sheet aliasing
-    std::string model_name;     // Read group
+    // Per-run metadata is interned, since it is identical for every read from a run.
+    utils::InternedString run_id;         // Run ID - used in read group
+    utils::InternedString flowcell_id;    // Flowcell ID - used in read group and for aliasing
+    utils::InternedString position_id;    // Position ID - used for sample sheet aliasing
+    utils::InternedString experiment_id;  // Experiment ID - used for sample sheet aliasing
+    utils::InternedString model_name;     // Read group
 
     dorado::details::Attributes attributes;
 
@@ -166,7 +169,23 @@ public:
     std::string next_read;
 };
 
-using SimplexReadPtr = std::unique_ptr<SimplexRead>;
+// Deleter for SimplexReadPtr which, rather than freeing reads, returns them to a process-wide
+// pool so that the next read can reuse their buffers (see make_simplex_read).
+struct SimplexReadDeleter {
+    SimplexReadDeleter() = default;
+    // Allows reads created with std::make_unique to be used as SimplexReadPtrs.
+    SimplexReadDeleter(const std::default_delete<SimplexRead>&) {}
+    void operator()(SimplexRead* read) const;
+};
+
+using SimplexReadPtr = std::unique_ptr<SimplexRead, SimplexReadDeleter>;
+
+// Returns a default-initialised read, recycled from the read pool when possible.
+// The string and vector members of a recycled read are empty but keep their capacity.
+SimplexReadPtr make_simplex_read();
+
+// Stats for the read pool.
+stats::NamedStats sample_simplex_read_pool_stats();
 using DuplexReadPtr = std::unique_ptr<DuplexRead>;
 
 // A pair of reads for Duplex calling
@@ -214,7 +233,9 @@ inline FlushOptions DefaultFlushOptions() { return {false}; }
 // waits on the input queue before attempting to join input worker threads.
 class MessageSink {
 public:
-    MessageSink(size_t max_messages);
+    // queue_backend selects the implementation of this node's input queue.
+    MessageSink(size_t max_messages,
+                utils::AsyncQueueBackend queue_backend = utils::AsyncQueueBackend::Mutex);
     virtual ~MessageSink() = default;
 
     // StatsSampler will ignore nodes with an empty name.
@@ -231,6 +252,12 @@ public:
         push_message_internal(Message(std::move(msg)));
     }
 
+    // Adds all of messages to the input queue, in order, with one lock acquisition and
+    // consumer notification per run of messages that fits in the queue.
+    // The sink takes ownership: messages is left empty, but keeps its capacity so the
+    // caller can reuse it.  This can block if the sink's queue is full.
+    void push_messages(std::vector<Message>& messages);
+
     // Waits until work is finished and shuts down worker threads.
     // No work can be done by the node after this returns until
     // restart is subsequently called.
@@ -260,6 +287,17 @@ protected:
         send_message_to_sink(0, std::forward<Msg>(message));
     }
 
+    // Sends all of messages to the designated sink, leaving messages empty.
+    void send_messages_to_sink(int sink_index, std::vector<Message>& messages) {
+        m_sinks.at(sink_index).get().push_messages(messages);
+    }
+
+    // Version for nodes with a single sink that is implicit.
+    void send_messages_to_sink(std::vector<Message>& messages) {
+        assert(m_sinks.size() == 1);
+        send_messages_to_sink(0, messages);
+    }
+
     // Pops the next input message, returning true on success.
     // If terminating, returns false.
     bool get_input_message(Message& message) {
@@ -267,6 +305,35 @@ protected:
         return status == utils::AsyncQueueStatus::Success;
     }
 
+    // Replaces the contents of messages with up to max_count input messages, blocking until
+    // at least one is available.  Returns true on success.
+    // If terminating, returns false once the queue is empty.
+    bool get_input_messages(std::vector<Message>& messages,
+                            size_t max_count = kMaxMessageBatchSize) {
+        messages.clear();
+        auto status = m_work_queue.process_and_pop_n(
+                [&messages](Message&& message) { messages.push_back(std::move(message)); },
+                max_count);
+        return status == utils::AsyncQueueStatus::Success;
+    }
+
+    // Default limit on the number of messages a node drains from its queue at once.
+    static constexpr size_t kMaxMessageBatchSize = 64;
+
+    using ProcessMessagesFn = std::function<void(std::vector<Message>&)>;
+
+    // Processes input messages as tasks on the shared utils::WorkStealingExecutor rather
+    // than on threads owned by the node.  process_fn is called with batches of input
+    // messages, with at most max_concurrency calls in progress at once.
+    // Call again after stop_input_processing to resume processing.
+    void start_input_processing(ProcessMessagesFn process_fn, size_t max_concurrency);
+
+    // Terminates the input queue and waits for all queued messages to be processed.
+    void stop_input_processing();
+
+    // Stats for executor-driven input processing, for merging into sample_stats().
+    stats::NamedStats sample_input_processing_stats() const;
+
     // Queue of work items for this node.
     utils::AsyncQueue<Message> m_work_queue;
 
@@ -278,6 +345,14 @@ private:
     void add_sink(MessageSink& sink);
 
     void push_message_internal(Message&& message);
+
+    // State for executor-driven input processing.  Shared with in-flight tasks so that
+    // it outlives the last of them.
+    struct InputProcessor;
+    std::shared_ptr<InputProcessor> m_input_processor;
+
+    void schedule_input_processing();
+    void process_input_messages(std::shared_ptr<InputProcessor> processor);
 };
 
 // Object from which a Pipeline is created.
@@ -9,14 +9,14 @@
 
 namespace dorado {
 
-void ReadToBamType::worker_thread() {
+void ReadToBamType::process_messages(std::vector<Message>& messages) {
     at::InferenceMode inference_mode_guard;
 
-    Message message;
-    while (get_input_message(message)) {
+    std::vector<Message> messages_to_send;
+    for (auto& message : messages) {
         // If this message isn't a read, just forward it to the sink.
         if (!is_read_message(message)) {
-            send_message_to_sink(std::move(message));
+            messages_to_send.push_back(std::move(message));
             continue;
         }
 
@@ -40,9 +40,10 @@ void ReadToBamType::worker_thread() {
         auto alns = read_common_data.extract_sam_lines(m_emit_moves, m_modbase_threshold,
                                                        is_duplex_parent);
         for (auto& aln : alns) {
-            send_message_to_sink(std::move(aln));
+            messages_to_send.push_back(std::move(aln));
         }
     }
+    send_messages_to_sink(messages_to_send);
 }
 
 ReadToBamType::ReadToBamType(bool emit_moves,
@@ -62,21 +63,11 @@ ReadToBamType::ReadToBamType(bool emit_moves,
 ReadToBamType::~ReadToBamType() { terminate_impl(); }
 
 void ReadToBamType::start_threads() {
-    for (size_t i = 0; i < m_num_worker_threads; i++) {
-        m_workers.push_back(
-                std::make_unique<std::thread>(std::thread(&ReadToBamType::worker_thread, this)));
-    }
+    start_input_processing([this](std::vector<Message>& messages) { process_messages(messages); },
+                           m_num_worker_threads);
 }
 
-void ReadToBamType::terminate_impl() {
-    terminate_input_queue();
-    for (auto& m : m_workers) {
-        if (m->joinable()) {
-            m->join();
-        }
-    }
-    m_workers.clear();
-}
+void ReadToBamType::terminate_impl() { stop_input_processing(); }
 
 void ReadToBamType::restart() {
     restart_input_queue();
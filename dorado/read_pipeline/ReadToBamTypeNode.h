@@ -30,10 +30,8 @@ public:
 private:
     void start_threads();
     void terminate_impl();
-    void worker_thread();
+    void process_messages(std::vector<Message>& messages);
 
-    // Async worker for writing.
-    std::vector<std::unique_ptr<std::thread>> m_workers;
     size_t m_num_worker_threads = 0;
 
     bool m_emit_moves;
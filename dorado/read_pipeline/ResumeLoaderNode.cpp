@@ -42,8 +42,7 @@ void ResumeLoaderNode::copy_completed_reads() {
     // Iterate over all reads and write to sink.
     try {
         while (reader.read()) {
-            std::string read_id = bam_get_qname(reader.record);
-            m_processed_read_ids.insert(read_id);
+            m_processed_read_ids.insert(bam_get_qname(reader.record));
             m_sink.push_message(BamPtr(bam_dup1(reader.record.get())));
             if (is_safe_to_log && m_processed_read_ids.size() % 100 == 0) {
                 bar.tick();
@@ -60,7 +59,7 @@ void ResumeLoaderNode::copy_completed_reads() {
     hts_set_log_level(initial_hts_log_level);
 }
 
-std::unordered_set<std::string> ResumeLoaderNode::get_processed_read_ids() const {
+const utils::ReadIdSet& ResumeLoaderNode::get_processed_read_ids() const {
     return m_processed_read_ids;
 }
 
@@ -1,9 +1,9 @@
 #pragma once
 
 #include "ReadPipeline.h"
+#include "utils/ReadIdSet.h"
 
 #include <string>
-#include <unordered_set>
 
 namespace dorado {
 
@@ -12,13 +12,13 @@ public:
     ResumeLoaderNode(MessageSink& sink, const std::string& resume_file);
     ~ResumeLoaderNode() = default;
     void copy_completed_reads();
-    std::unordered_set<std::string> get_processed_read_ids() const;
+    const utils::ReadIdSet& get_processed_read_ids() const;
 
 private:
     MessageSink& m_sink;
     std::string m_resume_file;
 
-    std::unordered_set<std::string> m_processed_read_ids;
+    utils::ReadIdSet m_processed_read_ids;
 };
 
 }  // namespace dorado
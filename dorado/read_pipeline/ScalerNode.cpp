@@ -104,11 +104,10 @@ int determine_rna_adapter_pos(const dorado::SimplexRead& read, dorado::SampleTyp
     return break_point;
 }
 
-void ScalerNode::worker_thread() {
+void ScalerNode::process_messages(std::vector<Message>& messages) {
     at::InferenceMode inference_mode_guard;
 
-    Message message;
-    while (get_input_message(message)) {
+    for (auto& message : messages) {
         // If this message isn't a Simplex read, just forward it to the sink.
         if (!std::holds_alternative<SimplexReadPtr>(message)) {
             send_message_to_sink(std::move(message));
@@ -214,30 +213,21 @@ ScalerNode::ScalerNode(const SignalNormalisationParams& config,
 }
 
 void ScalerNode::start_threads() {
-    for (int i = 0; i < m_num_worker_threads; i++) {
-        std::unique_ptr<std::thread> scaler_worker_thread =
-                std::make_unique<std::thread>(&ScalerNode::worker_thread, this);
-        m_worker_threads.push_back(std::move(scaler_worker_thread));
-    }
+    start_input_processing([this](std::vector<Message>& messages) { process_messages(messages); },
+                           size_t(m_num_worker_threads.load()));
 }
 
-void ScalerNode::terminate_impl() {
-    terminate_input_queue();
-
-    // Wait for all the Scaler Node's worker threads to terminate
-    for (auto& t : m_worker_threads) {
-        if (t->joinable()) {
-            t->join();
-        }
-    }
-    m_worker_threads.clear();
-}
+void ScalerNode::terminate_impl() { stop_input_processing(); }
 
 void ScalerNode::restart() {
     restart_input_queue();
     start_threads();
 }
 
-stats::NamedStats ScalerNode::sample_stats() const { return stats::from_obj(m_work_queue); }
+stats::NamedStats ScalerNode::sample_stats() const {
+    auto stats = stats::from_obj(m_work_queue);
+    stats.merge(sample_input_processing_stats());
+    return stats;
+}
 
 }  // namespace dorado
@@ -7,7 +7,6 @@
 
 #include <atomic>
 #include <string>
-#include <thread>
 #include <utility>
 #include <vector>
 
@@ -29,8 +28,8 @@ public:
 private:
     void start_threads();
     void terminate_impl();
-    void worker_thread();  // Worker thread performs scaling and trimming asynchronously.
-    std::vector<std::unique_ptr<std::thread>> m_worker_threads;
+    // Performs scaling and trimming, as a task on the shared executor.
+    void process_messages(std::vector<Message>& messages);
     std::atomic<int> m_num_worker_threads;
 
     basecall::SignalNormalisationParams m_scaling_params;
@@ -2,7 +2,7 @@
 
 namespace dorado::utils {
 SimplexReadPtr shallow_copy_read(const SimplexRead& read) {
-    auto copy = std::make_unique<SimplexRead>();
+    auto copy = make_simplex_read();
     copy->read_common.raw_data = read.read_common.raw_data;
     copy->digitisation = read.digitisation;
     copy->range = read.range;
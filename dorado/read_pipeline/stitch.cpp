@@ -4,74 +4,89 @@
 #include "utils/math_utils.h"
 
 #include <algorithm>
+#include <cassert>
+#include <numeric>
+
+namespace {
+
+using dorado::ReadCommon;
+using dorado::utils::Chunk;
+
+// Appends chunk's contribution to the read, trimming mid_point_front moves (and their bases)
+// from its front, and half of its overlap with next_chunk from its back.  next_chunk is
+// nullptr for the last chunk.  Returns the number of moves to trim from the front of
+// next_chunk.
+int append_chunk(ReadCommon& read_common,
+                 const Chunk& chunk,
+                 const Chunk* next_chunk,
+                 bool first_chunk,
+                 int mid_point_front) {
+    auto& moves = read_common.moves;
+    auto& seq = read_common.seq;
+    auto& qstring = read_common.qstring;
+
+    if (first_chunk) {
+        // Calculate the chunk down sampling, round to closest int.
+        read_common.model_stride =
+                int(dorado::utils::div_round_closest(chunk.raw_chunk_size, chunk.moves.size()));
+
+        // Build the results directly in the read's buffers, which may already have capacity if
+        // the read was recycled from the read pool.  Reserve enough for the whole read, assuming
+        // its base density is roughly that of the first chunk, so that long reads aren't
+        // reallocated as chunks are appended.
+        moves.clear();
+        seq.clear();
+        qstring.clear();
+        const size_t expected_moves =
+                read_common.get_raw_data_samples() / read_common.model_stride + 1;
+        const size_t expected_bases =
+                expected_moves * chunk.seq.size() / std::max<size_t>(chunk.moves.size(), 1);
+        moves.reserve(expected_moves);
+        seq.reserve(expected_bases + expected_bases / 8);
+        qstring.reserve(expected_bases + expected_bases / 8);
+    }
 
-namespace dorado::utils {
-
-void stitch_chunks(ReadCommon& read_common,
-                   const std::vector<std::unique_ptr<Chunk>>& called_chunks) {
-    // Calculate the chunk down sampling, round to closest int.
-    read_common.model_stride = int(
-            div_round_closest(called_chunks[0]->raw_chunk_size, called_chunks[0]->moves.size()));
+    int start_pos = std::accumulate(chunk.moves.begin(),
+                                    std::next(chunk.moves.begin(), mid_point_front), 0);
 
-    int start_pos = 0;
-    int mid_point_front = 0;
-    std::vector<uint8_t> moves;
-    std::vector<std::string> sequences;
-    std::vector<std::string> qstrings;
-
-    for (int i = 0; i < int(called_chunks.size() - 1); i++) {
-        auto& current_chunk = called_chunks[i];
-        auto& next_chunk = called_chunks[i + 1];
-        int overlap_size = int((current_chunk->raw_chunk_size + current_chunk->input_offset) -
-                               (next_chunk->input_offset));
+    if (next_chunk) {
+        int overlap_size =
+                int((chunk.raw_chunk_size + chunk.input_offset) - (next_chunk->input_offset));
         assert(overlap_size % read_common.model_stride == 0);
         int overlap_down_sampled = overlap_size / read_common.model_stride;
         int mid_point_rear = overlap_down_sampled / 2;
 
-        int current_chunk_bases_to_trim =
-                std::accumulate(std::prev(current_chunk->moves.end(), mid_point_rear),
-                                current_chunk->moves.end(), 0);
+        int chunk_bases_to_trim =
+                std::accumulate(std::prev(chunk.moves.end(), mid_point_rear), chunk.moves.end(), 0);
 
-        int current_chunk_seq_len = int(current_chunk->seq.size());
-        int end_pos = current_chunk_seq_len - current_chunk_bases_to_trim;
+        int chunk_seq_len = int(chunk.seq.size());
+        int end_pos = chunk_seq_len - chunk_bases_to_trim;
         int trimmed_len = end_pos - start_pos;
-        sequences.push_back(current_chunk->seq.substr(start_pos, trimmed_len));
-        qstrings.push_back(current_chunk->qstring.substr(start_pos, trimmed_len));
-        moves.insert(moves.end(), std::next(current_chunk->moves.begin(), mid_point_front),
-                     std::prev(current_chunk->moves.end(), mid_point_rear));
+        seq.append(chunk.seq, start_pos, trimmed_len);
+        qstring.append(chunk.qstring, start_pos, trimmed_len);
+        moves.insert(moves.end(), std::next(chunk.moves.begin(), mid_point_front),
+                     std::prev(chunk.moves.end(), mid_point_rear));
 
-        mid_point_front = overlap_down_sampled - mid_point_rear;
-
-        start_pos = 0;
-        for (int j = 0; j < mid_point_front; j++) {
-            start_pos += (int)next_chunk->moves[j];
-        }
+        return overlap_down_sampled - mid_point_rear;
     }
 
     // Append the final chunk
-    auto& last_chunk = called_chunks.back();
-    moves.insert(moves.end(), std::next(last_chunk->moves.begin(), mid_point_front),
-                 last_chunk->moves.end());
+    moves.insert(moves.end(), std::next(chunk.moves.begin(), mid_point_front), chunk.moves.end());
 
-    if (called_chunks.size() == 1) {
+    if (first_chunk) {
         // shorten the sequence, qstring & moves where the read is shorter than chunksize
         int last_index_in_moves_to_keep =
                 int(read_common.get_raw_data_samples() / read_common.model_stride);
-        moves = std::vector<uint8_t>(moves.begin(), moves.begin() + last_index_in_moves_to_keep);
+        moves.resize(last_index_in_moves_to_keep);
         int end = std::accumulate(moves.begin(), moves.end(), 0);
-        sequences.push_back(last_chunk->seq.substr(start_pos, end));
-        qstrings.push_back(last_chunk->qstring.substr(start_pos, end));
+        seq.append(chunk.seq, start_pos, end);
+        qstring.append(chunk.qstring, start_pos, end);
 
     } else {
-        sequences.push_back(last_chunk->seq.substr(start_pos));
-        qstrings.push_back(last_chunk->qstring.substr(start_pos));
+        seq.append(chunk.seq, start_pos);
+        qstring.append(chunk.qstring, start_pos);
     }
 
-    // Set the read seq and qstring
-    read_common.seq = std::accumulate(sequences.begin(), sequences.end(), std::string(""));
-    read_common.qstring = std::accumulate(qstrings.begin(), qstrings.end(), std::string(""));
-    read_common.moves = std::move(moves);
-
     // remove partial stride overhang
     if (static_cast<int>(read_common.moves.size()) >
         static_cast<int>(read_common.get_raw_data_samples() / read_common.model_stride)) {
@@ -83,6 +98,48 @@ void stitch_chunks(ReadCommon& read_common,
         assert(size_t(std::accumulate(read_common.moves.begin(), read_common.moves.end(), 0)) ==
                read_common.seq.size());
     }
+    return 0;
+}
+
+}  // namespace
+
+namespace dorado::utils {
+
+void stitch_chunks(ReadCommon& read_common,
+                   const std::vector<std::unique_ptr<Chunk>>& called_chunks) {
+    int mid_point_front = 0;
+    for (size_t i = 0; i < called_chunks.size(); ++i) {
+        const Chunk* next_chunk = (i + 1 < called_chunks.size()) ? called_chunks[i + 1].get()
+                                                                 : nullptr;
+        mid_point_front =
+                append_chunk(read_common, *called_chunks[i], next_chunk, i == 0, mid_point_front);
+    }
+}
+
+ChunkStitcher::ChunkStitcher(size_t num_chunks) : m_chunks(num_chunks) {}
+
+bool ChunkStitcher::add_chunk(ReadCommon& read, size_t chunk_idx, std::unique_ptr<Chunk> chunk) {
+    assert(chunk_idx >= m_next_chunk_idx && chunk_idx < m_chunks.size());
+    assert(!m_chunks[chunk_idx]);
+    m_chunks[chunk_idx] = std::move(chunk);
+    ++m_num_buffered_chunks;
+
+    // Only the next chunk's input offset is needed to stitch a chunk, but it's only known once
+    // the next chunk arrives.
+    while (m_next_chunk_idx < m_chunks.size() && m_chunks[m_next_chunk_idx]) {
+        const bool last_chunk = m_next_chunk_idx + 1 == m_chunks.size();
+        const Chunk* next_chunk = last_chunk ? nullptr : m_chunks[m_next_chunk_idx + 1].get();
+        if (!last_chunk && !next_chunk) {
+            break;
+        }
+        m_mid_point_front = append_chunk(read, *m_chunks[m_next_chunk_idx], next_chunk,
+                                         m_next_chunk_idx == 0, m_mid_point_front);
+        // The chunk's results are no longer needed.
+        m_chunks[m_next_chunk_idx].reset();
+        --m_num_buffered_chunks;
+        ++m_next_chunk_idx;
+    }
+    return m_next_chunk_idx == m_chunks.size();
 }
 
 }  // namespace dorado::utils
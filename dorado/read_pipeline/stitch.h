@@ -27,4 +27,27 @@ struct Chunk {
 // qstring to Read
 void stitch_chunks(ReadCommon& read, const std::vector<std::unique_ptr<Chunk>>& called_chunks);
 
+// Stitches a read's chunks into the read as they are called, rather than once they all have
+// been.  Chunks may be added in any order.  A chunk is appended to the read as soon as all the
+// chunks before it have been, and the chunk after it has been added (which fixes the overlap
+// to trim), and is then freed.  The result is the same as stitch_chunks.  Not thread-safe.
+class ChunkStitcher {
+public:
+    explicit ChunkStitcher(size_t num_chunks = 0);
+
+    // Adds a called chunk and stitches as many chunks as possible into read.  Returns true if
+    // that completed the read.
+    bool add_chunk(ReadCommon& read, size_t chunk_idx, std::unique_ptr<Chunk> chunk);
+
+    // Number of chunks added which are yet to be stitched.
+    size_t num_buffered_chunks() const { return m_num_buffered_chunks; }
+
+private:
+    std::vector<std::unique_ptr<Chunk>> m_chunks;
+    size_t m_next_chunk_idx = 0;
+    size_t m_num_buffered_chunks = 0;
+    // Moves to trim from the front of the next chunk, which overlap the previous chunk.
+    int m_mid_point_front = 0;
+};
+
 }  // namespace dorado::utils
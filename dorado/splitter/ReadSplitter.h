@@ -8,7 +8,8 @@
 namespace dorado {
 
 class SimplexRead;
-using SimplexReadPtr = std::unique_ptr<SimplexRead>;
+struct SimplexReadDeleter;
+using SimplexReadPtr = std::unique_ptr<SimplexRead, SimplexReadDeleter>;
 
 namespace splitter {
 
@@ -1,23 +1,221 @@
 #pragma once
 
+#include "MPMCRingBuffer.h"
+
 #include <algorithm>
 #include <atomic>
 #include <cassert>
 #include <condition_variable>
+#include <memory>
 #include <mutex>
 #include <queue>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 namespace dorado::utils {
 
 // Status return by push/pop methods.
 enum class AsyncQueueStatus { Success, Timeout, Terminate };
 
+// Implementation used to back an AsyncQueue.
+enum class AsyncQueueBackend {
+    // std::queue guarded by a mutex, with condition variable waits.
+    // Memory use scales with occupancy.
+    Mutex,
+    // Bounded lock-free ring buffer with adaptive spin-then-park waits.
+    // Avoids lock contention with many producers/consumers, but preallocates
+    // storage for capacity items.
+    LockFree,
+};
+
+// AsyncQueue semantics on top of MPMCRingBuffer.
+// Items must be movable and default constructible.
+template <class Item>
+class LockFreeAsyncQueue {
+    MPMCRingBuffer<Item> m_items;
+    // Parks consumers waiting for an item.
+    SpinParker m_not_empty_waiters;
+    // Parks producers waiting for space.
+    SpinParker m_not_full_waiters;
+    // If true, waits should terminate regardless of other state.
+    std::atomic<bool> m_terminate{false};
+
+    bool is_terminating() const { return m_terminate.load(std::memory_order_acquire); }
+
+    // Pops an item into item.  If the queue is empty, waits until an item is available,
+    // or until the queue is terminated or timeout_time is reached (if given).
+    // Does not notify producers.
+    template <class Clock, class Duration>
+    AsyncQueueStatus pop_item(Item& item,
+                              const std::chrono::time_point<Clock, Duration>* timeout_time) {
+        const auto can_pop = [this] { return m_items.has_item() || is_terminating(); };
+        for (;;) {
+            if (m_items.try_dequeue(item)) {
+                return AsyncQueueStatus::Success;
+            }
+            // Termination takes effect once all items have been popped from the queue.
+            if (is_terminating() && !m_items.has_item()) {
+                return AsyncQueueStatus::Terminate;
+            }
+            if (timeout_time) {
+                if (!m_not_empty_waiters.wait_until(can_pop, *timeout_time)) {
+                    return AsyncQueueStatus::Timeout;
+                }
+            } else {
+                m_not_empty_waiters.wait(can_pop);
+            }
+        }
+    }
+
+    // Calls process_fn on up to max_count items, waiting for the first one as per pop_item.
+    template <class ProcessFn, class Clock, class Duration>
+    AsyncQueueStatus process_items(ProcessFn& process_fn,
+                                   size_t max_count,
+                                   const std::chrono::time_point<Clock, Duration>* timeout_time) {
+        Item item;
+        const auto status = pop_item(item, timeout_time);
+        if (status != AsyncQueueStatus::Success) {
+            return status;
+        }
+        process_fn(std::move(item));
+        for (size_t i = 1; i < max_count && m_items.try_dequeue(item); ++i) {
+            process_fn(std::move(item));
+        }
+        // In general we have removed > 1 item and there can be > 1 thread waiting to push.
+        m_not_full_waiters.notify_all();
+        return AsyncQueueStatus::Success;
+    }
+
+    // Pushes count items starting at items[num_pushed], updating num_pushed as it goes.
+    // Waits for space as required, until the queue is terminated or timeout_time is
+    // reached (if given).
+    template <class Clock, class Duration>
+    AsyncQueueStatus push_items(Item* items,
+                                size_t count,
+                                size_t& num_pushed,
+                                const std::chrono::time_point<Clock, Duration>* timeout_time) {
+        const auto can_push = [this] { return m_items.has_space() || is_terminating(); };
+        while (num_pushed < count) {
+            if (is_terminating()) {
+                return AsyncQueueStatus::Terminate;
+            }
+            const size_t prev_num_pushed = num_pushed;
+            while (num_pushed < count && m_items.try_enqueue(items[num_pushed])) {
+                ++num_pushed;
+            }
+            if (num_pushed - prev_num_pushed == 1) {
+                m_not_empty_waiters.notify_one();
+            } else if (num_pushed > prev_num_pushed) {
+                m_not_empty_waiters.notify_all();
+            }
+            if (num_pushed == count) {
+                break;
+            }
+            if (timeout_time) {
+                if (!m_not_full_waiters.wait_until(can_push, *timeout_time)) {
+                    return AsyncQueueStatus::Timeout;
+                }
+            } else {
+                m_not_full_waiters.wait(can_push);
+            }
+        }
+        return AsyncQueueStatus::Success;
+    }
+
+    using NoTimeout = std::chrono::steady_clock::time_point;
+
+public:
+    explicit LockFreeAsyncQueue(size_t capacity) : m_items(capacity) {}
+    ~LockFreeAsyncQueue() { terminate(); }
+
+    LockFreeAsyncQueue(const LockFreeAsyncQueue&) = delete;
+    LockFreeAsyncQueue& operator=(const LockFreeAsyncQueue&) = delete;
+
+    AsyncQueueStatus try_push(Item&& item) {
+        size_t num_pushed = 0;
+        return push_items(&item, 1, num_pushed, static_cast<const NoTimeout*>(nullptr));
+    }
+
+    template <class Clock, class Duration>
+    AsyncQueueStatus try_push_until(Item&& item,
+                                    const std::chrono::time_point<Clock, Duration>& timeout_time) {
+        size_t num_pushed = 0;
+        return push_items(&item, 1, num_pushed, &timeout_time);
+    }
+
+    AsyncQueueStatus try_push_n(std::vector<Item>& items) {
+        size_t num_pushed = 0;
+        const auto status = push_items(items.data(), items.size(), num_pushed,
+                                       static_cast<const NoTimeout*>(nullptr));
+        items.erase(items.begin(), items.begin() + num_pushed);
+        return status;
+    }
+
+    template <class Clock, class Duration>
+    AsyncQueueStatus try_push_n_until(
+            std::vector<Item>& items,
+            const std::chrono::time_point<Clock, Duration>& timeout_time) {
+        size_t num_pushed = 0;
+        const auto status = push_items(items.data(), items.size(), num_pushed, &timeout_time);
+        items.erase(items.begin(), items.begin() + num_pushed);
+        return status;
+    }
+
+    template <class Clock, class Duration>
+    AsyncQueueStatus try_pop_until(Item& item,
+                                   const std::chrono::time_point<Clock, Duration>& timeout_time) {
+        const auto status = pop_item(item, &timeout_time);
+        if (status == AsyncQueueStatus::Success) {
+            m_not_full_waiters.notify_one();
+        }
+        return status;
+    }
+
+    AsyncQueueStatus try_pop(Item& item) {
+        const auto status = pop_item(item, static_cast<const NoTimeout*>(nullptr));
+        if (status == AsyncQueueStatus::Success) {
+            m_not_full_waiters.notify_one();
+        }
+        return status;
+    }
+
+    template <class ProcessFn>
+    AsyncQueueStatus process_and_pop_n(ProcessFn process_fn, size_t max_count) {
+        return process_items(process_fn, max_count, static_cast<const NoTimeout*>(nullptr));
+    }
+
+    template <class ProcessFn, class Clock, class Duration>
+    AsyncQueueStatus process_and_pop_n_with_timeout(
+            ProcessFn process_fn,
+            size_t max_count,
+            const std::chrono::time_point<Clock, Duration>& timeout_time) {
+        return process_items(process_fn, max_count, &timeout_time);
+    }
+
+    void terminate() {
+        m_terminate.store(true, std::memory_order_release);
+        m_not_full_waiters.notify_all();
+        m_not_empty_waiters.notify_all();
+    }
+
+    void restart() { m_terminate.store(false, std::memory_order_release); }
+
+    size_t capacity() const { return m_items.capacity(); }
+    size_t size() const { return m_items.size(); }
+    int64_t num_pushes() const { return int64_t(m_items.num_enqueued()); }
+    int64_t num_pops() const { return int64_t(m_items.num_dequeued()); }
+};
+
 // Asynchronous queue for producer/consumer use.
 // Items must be movable.
+// The LockFree backend additionally requires items to be default constructible.
 template <class Item>
 class AsyncQueue {
+    // Non-null if this queue uses AsyncQueueBackend::LockFree, in which case
+    // all operations are forwarded to it and the members below are unused.
+    std::unique_ptr<LockFreeAsyncQueue<Item>> m_lock_free_queue;
+
     // Guards the entire structure.  Should be held while adding/removing items,
     // or interacting with m_terminate.
     // Used for not-empty and not-full CV waits.
@@ -94,9 +292,55 @@ class AsyncQueue {
         return {std::move(lock), wait_status};
     }
 
+    // Pushes items from items[num_pushed] onwards, updating num_pushed as it goes.
+    // Waits for space as required, until we are asked to terminate or timeout_time is
+    // reached (if given).
+    template <class Clock, class Duration>
+    AsyncQueueStatus push_items(std::vector<Item>& items,
+                                size_t& num_pushed,
+                                const std::chrono::time_point<Clock, Duration>* timeout_time) {
+        const auto has_space = [this] { return m_items.size() < m_capacity || m_terminate; };
+        while (num_pushed < items.size()) {
+            std::unique_lock lock(m_mutex);
+            if (timeout_time) {
+                if (!m_not_full_cv.wait_until(lock, *timeout_time, has_space)) {
+                    return AsyncQueueStatus::Timeout;
+                }
+            } else {
+                m_not_full_cv.wait(lock, has_space);
+            }
+            if (m_terminate) {
+                return AsyncQueueStatus::Terminate;
+            }
+
+            const size_t num_to_push =
+                    std::min(items.size() - num_pushed, m_capacity - m_items.size());
+            for (size_t i = 0; i < num_to_push; ++i) {
+                m_items.push(std::move(items[num_pushed++]));
+            }
+            m_num_pushes += num_to_push;
+
+            // Wake as many consumers as there are new items.
+            lock.unlock();
+            if (num_to_push == 1) {
+                m_not_empty_cv.notify_one();
+            } else {
+                m_not_empty_cv.notify_all();
+            }
+        }
+        return AsyncQueueStatus::Success;
+    }
+
+    using NoTimeout = std::chrono::steady_clock::time_point;
+
 public:
     // Attempts to push items beyond capacity will block.
-    explicit AsyncQueue(size_t capacity) : m_capacity(capacity) {}
+    explicit AsyncQueue(size_t capacity, AsyncQueueBackend backend = AsyncQueueBackend::Mutex)
+            : m_capacity(capacity) {
+        if (backend == AsyncQueueBackend::LockFree) {
+            m_lock_free_queue = std::make_unique<LockFreeAsyncQueue<Item>>(capacity);
+        }
+    }
 
     ~AsyncQueue() {
         // Ensure CV waits terminate before destruction.
@@ -117,6 +361,10 @@ public:
     // is returned.
     // Items pushed must be rvalues, since we assume sole ownership.
     AsyncQueueStatus try_push(Item&& item) {
+        if (m_lock_free_queue) {
+            return m_lock_free_queue->try_push(std::move(item));
+        }
+
         std::unique_lock lock(m_mutex);
 
         // Ensure there is space for the new item, given our limit on capacity.
@@ -138,6 +386,66 @@ public:
         return AsyncQueueStatus::Success;
     }
 
+    // As try_push, but gives up and returns AsyncQueueStatus::Timeout if the queue is
+    // still full at timeout_time, in which case item is not moved from.
+    template <class Clock, class Duration>
+    AsyncQueueStatus try_push_until(Item&& item,
+                                    const std::chrono::time_point<Clock, Duration>& timeout_time) {
+        if (m_lock_free_queue) {
+            return m_lock_free_queue->try_push_until(std::move(item), timeout_time);
+        }
+
+        std::unique_lock lock(m_mutex);
+        if (!m_not_full_cv.wait_until(lock, timeout_time, [this] {
+                return m_items.size() < m_capacity || m_terminate;
+            })) {
+            return AsyncQueueStatus::Timeout;
+        }
+        if (m_terminate) {
+            return AsyncQueueStatus::Terminate;
+        }
+
+        m_items.push(std::move(item));
+        ++m_num_pushes;
+
+        lock.unlock();
+        m_not_empty_cv.notify_one();
+
+        return AsyncQueueStatus::Success;
+    }
+
+    // Adds all of items to the queue, in order, taking the lock and notifying waiting
+    // consumers once per run of items that fits, rather than once per item.
+    // If the queue fills up, blocks until there is space or terminate() is called.
+    // On AsyncQueueStatus::Success, items is left empty.
+    // On AsyncQueueStatus::Terminate, items contains those items that were not added.
+    AsyncQueueStatus try_push_n(std::vector<Item>& items) {
+        if (m_lock_free_queue) {
+            return m_lock_free_queue->try_push_n(items);
+        }
+
+        size_t num_pushed = 0;
+        const auto status = push_items(items, num_pushed, static_cast<const NoTimeout*>(nullptr));
+        items.erase(items.begin(), items.begin() + num_pushed);
+        return status;
+    }
+
+    // As try_push_n, but gives up and returns AsyncQueueStatus::Timeout if the queue is
+    // still full at timeout_time, in which case items contains those items that were not added.
+    template <class Clock, class Duration>
+    AsyncQueueStatus try_push_n_until(
+            std::vector<Item>& items,
+            const std::chrono::time_point<Clock, Duration>& timeout_time) {
+        if (m_lock_free_queue) {
+            return m_lock_free_queue->try_push_n_until(items, timeout_time);
+        }
+
+        size_t num_pushed = 0;
+        const auto status = push_items(items, num_pushed, &timeout_time);
+        items.erase(items.begin(), items.begin() + num_pushed);
+        return status;
+    }
+
     // Obtains the next item in the queue, potentially timing out.
     // If queue is empty:
     // If timeout is reached, but we are not terminating, returns AsyncQueueStatus::Timeout.
@@ -146,6 +454,10 @@ public:
     template <class Clock, class Duration>
     AsyncQueueStatus try_pop_until(Item& item,
                                    const std::chrono::time_point<Clock, Duration>& timeout_time) {
+        if (m_lock_free_queue) {
+            return m_lock_free_queue->try_pop_until(item, timeout_time);
+        }
+
         auto [lock, wait_status] = wait_for_item_or_timeout(timeout_time);
 
         if (wait_status == false) {
@@ -169,6 +481,10 @@ public:
     // Otherwise block until an item is added, upon which AsyncQueueStatus::Success
     // is returned.
     AsyncQueueStatus try_pop(Item& item) {
+        if (m_lock_free_queue) {
+            return m_lock_free_queue->try_pop(item);
+        }
+
         auto lock = wait_for_item();
 
         // Termination takes effect once all items have been popped from the queue.
@@ -190,6 +506,10 @@ public:
     // is returned.
     template <class ProcessFn>
     AsyncQueueStatus process_and_pop_n(ProcessFn process_fn, size_t max_count) {
+        if (m_lock_free_queue) {
+            return m_lock_free_queue->process_and_pop_n(process_fn, max_count);
+        }
+
         auto lock = wait_for_item();
 
         // Termination takes effect once all items have been popped from the queue.
@@ -208,6 +528,11 @@ public:
             ProcessFn process_fn,
             size_t max_count,
             const std::chrono::time_point<Clock, Duration>& timeout_time) {
+        if (m_lock_free_queue) {
+            return m_lock_free_queue->process_and_pop_n_with_timeout(process_fn, max_count,
+                                                                     timeout_time);
+        }
+
         auto [lock, wait_status] = wait_for_item_or_timeout(timeout_time);
 
         if (wait_status == false) {
@@ -229,6 +554,11 @@ public:
     // Pushes will fail and return return AsyncQueueStatus::Terminate until restart is called.
     // Pops will return AsyncQueueStatus::Terminate once the queue is empty.
     void terminate() {
+        if (m_lock_free_queue) {
+            m_lock_free_queue->terminate();
+            return;
+        }
+
         {
             std::lock_guard lock(m_mutex);
             m_terminate = true;
@@ -244,6 +574,11 @@ public:
 
     // Resets state to active following a terminate call.
     void restart() {
+        if (m_lock_free_queue) {
+            m_lock_free_queue->restart();
+            return;
+        }
+
         std::lock_guard lock(m_mutex);
         m_terminate = false;
     }
@@ -254,6 +589,10 @@ public:
     // Current number of items in the queue.  Only useful for stats sampling and
     // testing.
     size_t size() const {
+        if (m_lock_free_queue) {
+            return m_lock_free_queue->size();
+        }
+
         std::lock_guard lock(m_mutex);
         return m_items.size();
     }
@@ -262,6 +601,13 @@ public:
 
     std::unordered_map<std::string, double> sample_stats() const {
         std::unordered_map<std::string, double> stats;
+        if (m_lock_free_queue) {
+            stats["items"] = double(m_lock_free_queue->size());
+            stats["pushes"] = double(m_lock_free_queue->num_pushes());
+            stats["pops"] = double(m_lock_free_queue->num_pops());
+            return stats;
+        }
+
         std::lock_guard<std::mutex> lock(m_mutex);
         stats["items"] = double(m_items.size());
         stats["pushes"] = double(m_num_pushes);
@@ -0,0 +1,70 @@
+#include "InternedString.h"
+
+#include <array>
+#include <mutex>
+#include <ostream>
+#include <string_view>
+#include <unordered_set>
+
+namespace {
+
+class InternTable {
+public:
+    const std::string* intern(const std::string& str) {
+        std::lock_guard lock(m_mutex);
+        // Elements of an unordered_set don't move on rehash, so the pointer stays valid.
+        return &*m_strings.insert(str).first;
+    }
+
+    size_t size() {
+        std::lock_guard lock(m_mutex);
+        return m_strings.size();
+    }
+
+private:
+    std::mutex m_mutex;
+    std::unordered_set<std::string> m_strings;
+};
+
+InternTable& intern_table() {
+    // Deliberately leaked, so interned strings outlive any static objects that refer to them.
+    static auto* table = new InternTable();
+    return *table;
+}
+
+// Reads from a given run are typically created back to back on the same thread, so a small
+// per-thread cache of recent lookups avoids taking the table lock for almost all of them.
+constexpr size_t kRecentCacheSize = 8;
+thread_local std::array<const std::string*, kRecentCacheSize> t_recent{};
+thread_local size_t t_recent_next = 0;
+
+const std::string* intern(std::string_view str) {
+    for (const auto* recent : t_recent) {
+        if (recent && *recent == str) {
+            return recent;
+        }
+    }
+    const auto* interned = intern_table().intern(std::string(str));
+    t_recent[t_recent_next] = interned;
+    t_recent_next = (t_recent_next + 1) % kRecentCacheSize;
+    return interned;
+}
+
+}  // namespace
+
+namespace dorado::utils {
+
+InternedString::InternedString() {
+    static const std::string* const empty = intern_table().intern(std::string());
+    m_str = empty;
+}
+
+InternedString::InternedString(const std::string& str) : m_str(intern(str)) {}
+
+InternedString::InternedString(const char* str) : m_str(intern(str)) {}
+
+size_t InternedString::table_size() { return intern_table().size(); }
+
+std::ostream& operator<<(std::ostream& os, const InternedString& str) { return os << str.str(); }
+
+}  // namespace dorado::utils
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstddef>
+#include <iosfwd>
+#include <string>
+
+namespace dorado::utils {
+
+// Immutable string backed by a process-wide intern table, so equal strings share one copy.
+// Copying is as cheap as copying a pointer, and equality is a pointer comparison.
+// Interned strings are never freed, so this is only suitable for values with few distinct
+// instances, such as per-run metadata shared by every read from a run.
+class InternedString {
+public:
+    InternedString();
+    InternedString(const std::string& str);
+    InternedString(const char* str);
+
+    const std::string& str() const { return *m_str; }
+    operator const std::string&() const { return *m_str; }
+
+    bool empty() const { return m_str->empty(); }
+    size_t size() const { return m_str->size(); }
+    const char* c_str() const { return m_str->c_str(); }
+
+    friend bool operator==(const InternedString& a, const InternedString& b) {
+        return a.m_str == b.m_str;
+    }
+    friend bool operator!=(const InternedString& a, const InternedString& b) { return !(a == b); }
+
+    // Number of distinct strings interned so far.
+    static size_t table_size();
+
+private:
+    const std::string* m_str;
+};
+
+inline bool operator==(const InternedString& a, const std::string& b) { return a.str() == b; }
+inline bool operator==(const std::string& a, const InternedString& b) { return a == b.str(); }
+inline bool operator==(const InternedString& a, const char* b) { return a.str() == b; }
+inline bool operator==(const char* a, const InternedString& b) { return a == b.str(); }
+inline bool operator!=(const InternedString& a, const std::string& b) { return !(a == b); }
+inline bool operator!=(const std::string& a, const InternedString& b) { return !(a == b); }
+inline bool operator!=(const InternedString& a, const char* b) { return !(a == b); }
+inline bool operator!=(const char* a, const InternedString& b) { return !(a == b); }
+
+std::ostream& operator<<(std::ostream& os, const InternedString& str);
+
+}  // namespace dorado::utils
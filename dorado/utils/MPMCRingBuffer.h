@@ -0,0 +1,255 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#include <immintrin.h>
+#define DORADO_CPU_RELAX() _mm_pause()
+#elif defined(__aarch64__) || defined(__arm__)
+#define DORADO_CPU_RELAX() asm volatile("yield" ::: "memory")
+#else
+#define DORADO_CPU_RELAX() ((void)0)
+#endif
+
+namespace dorado::utils {
+
+// Bounded multi-producer/multi-consumer ring buffer, after Dmitry Vyukov's design.
+// Each cell carries a sequence number which tells producers and consumers whether
+// the cell is ready for them, so pushes and pops only contend on a single CAS of
+// the relevant position counter.
+// Storage for all cells is allocated up front, so memory use is capacity * sizeof(Item)
+// regardless of occupancy.
+// try_enqueue/try_dequeue never block: callers are responsible for waiting.
+template <class Item>
+class MPMCRingBuffer {
+    // Avoids false sharing between the producer and consumer position counters.
+    static constexpr size_t kCacheLineSize = 64;
+
+    struct Cell {
+        std::atomic<size_t> sequence;
+        alignas(Item) unsigned char storage[sizeof(Item)];
+
+        Item* item() { return std::launder(reinterpret_cast<Item*>(storage)); }
+    };
+
+    const size_t m_capacity;
+    std::unique_ptr<Cell[]> m_cells;
+    alignas(kCacheLineSize) std::atomic<size_t> m_enqueue_pos{0};
+    alignas(kCacheLineSize) std::atomic<size_t> m_dequeue_pos{0};
+
+    static std::ptrdiff_t distance(size_t a, size_t b) {
+        return static_cast<std::ptrdiff_t>(a - b);
+    }
+
+public:
+    explicit MPMCRingBuffer(size_t capacity)
+            : m_capacity(capacity), m_cells(std::make_unique<Cell[]>(capacity)) {
+        assert(capacity > 0);
+        for (size_t i = 0; i < m_capacity; ++i) {
+            m_cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    ~MPMCRingBuffer() {
+        // Destroy any items that were never consumed.  No other thread can be accessing
+        // the buffer at this point, so every cell in [dequeue, enqueue) holds an item.
+        const size_t end_pos = m_enqueue_pos.load(std::memory_order_acquire);
+        for (size_t pos = m_dequeue_pos.load(std::memory_order_acquire); pos != end_pos; ++pos) {
+            m_cells[pos % m_capacity].item()->~Item();
+        }
+    }
+
+    MPMCRingBuffer(const MPMCRingBuffer&) = delete;
+    MPMCRingBuffer& operator=(const MPMCRingBuffer&) = delete;
+
+    // Moves item into the buffer, returning true on success.
+    // Returns false, leaving item untouched, if the buffer is full.
+    bool try_enqueue(Item& item) {
+        size_t pos = m_enqueue_pos.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& cell = m_cells[pos % m_capacity];
+            const size_t seq = cell.sequence.load(std::memory_order_acquire);
+            const auto diff = distance(seq, pos);
+            if (diff == 0) {
+                if (m_enqueue_pos.compare_exchange_weak(pos, pos + 1,
+                                                        std::memory_order_relaxed)) {
+                    new (cell.storage) Item(std::move(item));
+                    cell.sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                // The consumer of the previous lap hasn't freed this cell yet.
+                return false;
+            } else {
+                // Another producer claimed this position.
+                pos = m_enqueue_pos.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // Moves the oldest item into item, returning true on success.
+    // Returns false if the buffer is empty.
+    bool try_dequeue(Item& item) {
+        size_t pos = m_dequeue_pos.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& cell = m_cells[pos % m_capacity];
+            const size_t seq = cell.sequence.load(std::memory_order_acquire);
+            const auto diff = distance(seq, pos + 1);
+            if (diff == 0) {
+                if (m_dequeue_pos.compare_exchange_weak(pos, pos + 1,
+                                                        std::memory_order_relaxed)) {
+                    Item* stored = cell.item();
+                    item = std::move(*stored);
+                    stored->~Item();
+                    // Hand the cell to the producer of the next lap.
+                    cell.sequence.store(pos + m_capacity, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                // The producer for this position hasn't published yet.
+                return false;
+            } else {
+                // Another consumer claimed this position.
+                pos = m_dequeue_pos.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // True if a consumer could currently find an item.  Advisory only.
+    bool has_item() const {
+        const size_t pos = m_dequeue_pos.load(std::memory_order_relaxed);
+        const size_t seq = m_cells[pos % m_capacity].sequence.load(std::memory_order_acquire);
+        return distance(seq, pos + 1) >= 0;
+    }
+
+    // True if a producer could currently find a free cell.  Advisory only.
+    bool has_space() const {
+        const size_t pos = m_enqueue_pos.load(std::memory_order_relaxed);
+        const size_t seq = m_cells[pos % m_capacity].sequence.load(std::memory_order_acquire);
+        return distance(seq, pos) >= 0;
+    }
+
+    size_t capacity() const { return m_capacity; }
+
+    // Approximate number of items, since producers/consumers may be mid-operation.
+    size_t size() const {
+        const size_t dequeued = m_dequeue_pos.load(std::memory_order_relaxed);
+        const size_t enqueued = m_enqueue_pos.load(std::memory_order_relaxed);
+        return static_cast<size_t>(std::clamp(distance(enqueued, dequeued), std::ptrdiff_t(0),
+                                              static_cast<std::ptrdiff_t>(m_capacity)));
+    }
+
+    // Total number of items ever claimed for enqueue/dequeue.
+    size_t num_enqueued() const { return m_enqueue_pos.load(std::memory_order_relaxed); }
+    size_t num_dequeued() const { return m_dequeue_pos.load(std::memory_order_relaxed); }
+};
+
+// Waiting strategy for lock-free structures: spins on a predicate for a while, then parks
+// on a condition variable.
+// The spin budget adapts: it grows while spinning keeps paying off and shrinks when the
+// waiter ends up parking anyway, so idle queues don't burn CPU.
+// notify_* are cheap when nobody is parked, since they only check a waiter count.
+class SpinParker {
+    static constexpr int kMinSpins = 16;
+    static constexpr int kMaxSpins = 4096;
+
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::atomic<int> m_num_parked{0};
+    std::atomic<int> m_spin_limit{256};
+
+    template <class Pred>
+    bool spin(const Pred& pred) {
+        // On a single core, spinning only delays the thread we're waiting for.
+        static const bool can_spin = std::thread::hardware_concurrency() > 1;
+        if (!can_spin) {
+            return pred();
+        }
+
+        const int spin_limit = m_spin_limit.load(std::memory_order_relaxed);
+        for (int i = 0; i < spin_limit; ++i) {
+            if (pred()) {
+                if (spin_limit < kMaxSpins) {
+                    m_spin_limit.store(std::min(kMaxSpins, spin_limit + spin_limit / 8 + 1),
+                                       std::memory_order_relaxed);
+                }
+                return true;
+            }
+            DORADO_CPU_RELAX();
+        }
+        m_spin_limit.store(std::max(kMinSpins, spin_limit / 2), std::memory_order_relaxed);
+        return false;
+    }
+
+    // Both sides use RMWs on m_num_parked, which are totally ordered: either the notifier's
+    // RMW sees us as parked, or ours synchronises with it and we see the state change it
+    // made before notifying.  (Fences would be cheaper, but TSan doesn't support them.)
+    void begin_park() { m_num_parked.fetch_add(1, std::memory_order_acq_rel); }
+
+    void end_park() { m_num_parked.fetch_sub(1, std::memory_order_relaxed); }
+
+    template <class NotifyFn>
+    void notify(NotifyFn notify_fn) {
+        if (m_num_parked.fetch_add(0, std::memory_order_acq_rel) == 0) {
+            return;
+        }
+        // Taking the mutex ensures a waiter can't be between checking its predicate
+        // and blocking on the CV.
+        { std::lock_guard lock(m_mutex); }
+        notify_fn(m_cv);
+    }
+
+public:
+    // Blocks until pred() returns true.
+    template <class Pred>
+    void wait(const Pred& pred) {
+        if (spin(pred)) {
+            return;
+        }
+        begin_park();
+        {
+            std::unique_lock lock(m_mutex);
+            m_cv.wait(lock, pred);
+        }
+        end_park();
+    }
+
+    // Blocks until pred() returns true or timeout_time is reached.
+    // Returns the final value of pred().
+    template <class Pred, class Clock, class Duration>
+    bool wait_until(const Pred& pred, const std::chrono::time_point<Clock, Duration>& timeout_time) {
+        if (spin(pred)) {
+            return true;
+        }
+        begin_park();
+        bool wait_status;
+        {
+            std::unique_lock lock(m_mutex);
+            wait_status = m_cv.wait_until(lock, timeout_time, pred);
+        }
+        end_park();
+        return wait_status;
+    }
+
+    void notify_one() {
+        notify([](std::condition_variable& cv) { cv.notify_one(); });
+    }
+
+    void notify_all() {
+        notify([](std::condition_variable& cv) { cv.notify_all(); });
+    }
+};
+
+}  // namespace dorado::utils
@@ -0,0 +1,231 @@
+#include "ReadIdSet.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+// The table grows once it's more than 3/4 full.
+constexpr size_t kMinSlots = 16;
+// Bloom filter blocks are a cache line of 512 bits, and each id sets this many bits in one.
+constexpr size_t kBloomBlockWords = 8;
+constexpr size_t kBloomHashes = 7;
+
+int hex_value(char c) {
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+    return -1;
+}
+
+size_t max_table_entries(size_t num_slots) { return num_slots / 4 * 3; }
+
+}  // namespace
+
+namespace dorado::utils {
+
+ReadIdSet::ReadIdSet(std::initializer_list<std::string_view> read_ids) {
+    for (const auto& read_id : read_ids) {
+        insert(read_id);
+    }
+}
+
+ReadIdSet::ReadIdSet(const std::unordered_set<std::string>& read_ids) {
+    for (const auto& read_id : read_ids) {
+        insert(read_id);
+    }
+}
+
+bool ReadIdSet::parse_uuid(std::string_view read_id, Uuid& uuid) {
+    if (read_id.size() != 36) {
+        return false;
+    }
+    size_t byte_idx = 0;
+    for (size_t i = 0; i < read_id.size();) {
+        if (i == 8 || i == 13 || i == 18 || i == 23) {
+            if (read_id[i] != '-') {
+                return false;
+            }
+            ++i;
+            continue;
+        }
+        // Groups of hex digits are all of even length, so a byte never spans a hyphen.
+        const int high = hex_value(read_id[i]);
+        const int low = hex_value(read_id[i + 1]);
+        if (high < 0 || low < 0) {
+            return false;
+        }
+        uuid[byte_idx++] = uint8_t((high << 4) | low);
+        i += 2;
+    }
+    return true;
+}
+
+bool ReadIdSet::insert(std::string_view read_id) {
+    Uuid uuid;
+    if (parse_uuid(read_id, uuid)) {
+        return insert(uuid);
+    }
+    return m_other_ids.emplace(read_id).second;
+}
+
+bool ReadIdSet::insert(const Uuid& uuid) {
+    if (uuid == Uuid{}) {
+        if (m_has_zero_uuid) {
+            return false;
+        }
+        m_has_zero_uuid = true;
+        ++m_num_uuids;
+        return true;
+    }
+
+    const size_t num_table_entries = m_num_uuids - (m_has_zero_uuid ? 1 : 0);
+    if (num_table_entries + 1 > max_table_entries(m_slots.size())) {
+        grow();
+    }
+    const auto uuid_hash = hash(uuid);
+    auto& slot = m_slots[find_slot(uuid, uuid_hash)];
+    if (slot == uuid) {
+        return false;
+    }
+    slot = uuid;
+    ++m_num_uuids;
+    if (!m_bloom_filter.empty()) {
+        add_to_bloom_filter(uuid_hash);
+    }
+    return true;
+}
+
+bool ReadIdSet::contains(std::string_view read_id) const {
+    Uuid uuid;
+    if (parse_uuid(read_id, uuid)) {
+        return contains(uuid);
+    }
+    return !m_other_ids.empty() && m_other_ids.find(std::string(read_id)) != m_other_ids.end();
+}
+
+bool ReadIdSet::contains(const Uuid& uuid) const {
+    if (uuid == Uuid{}) {
+        return m_has_zero_uuid;
+    }
+    if (m_slots.empty()) {
+        return false;
+    }
+    const auto uuid_hash = hash(uuid);
+    if (!m_bloom_filter.empty() && !bloom_filter_may_contain(uuid_hash)) {
+        return false;
+    }
+    return m_slots[find_slot(uuid, uuid_hash)] == uuid;
+}
+
+size_t ReadIdSet::count_shared(const ReadIdSet& other) const {
+    size_t num_shared = (m_has_zero_uuid && other.m_has_zero_uuid) ? 1 : 0;
+    for (const auto& slot : m_slots) {
+        if (slot != Uuid{} && other.contains(slot)) {
+            ++num_shared;
+        }
+    }
+    for (const auto& read_id : m_other_ids) {
+        if (other.m_other_ids.find(read_id) != other.m_other_ids.end()) {
+            ++num_shared;
+        }
+    }
+    return num_shared;
+}
+
+void ReadIdSet::enable_bloom_filter(size_t bits_per_id) {
+    m_bloom_bits_per_id = std::max(bits_per_id, size_t(1));
+    rebuild_bloom_filter();
+}
+
+size_t ReadIdSet::memory_bytes() const {
+    size_t num_bytes = m_slots.capacity() * sizeof(Uuid) +
+                       m_bloom_filter.capacity() * sizeof(uint64_t) +
+                       m_other_ids.bucket_count() * sizeof(void*);
+    for (const auto& read_id : m_other_ids) {
+        // Each node holds the string and a next pointer, and the hash is usually cached too.
+        num_bytes += sizeof(std::string) + sizeof(void*) + sizeof(size_t);
+        if (read_id.capacity() >= sizeof(std::string)) {
+            num_bytes += read_id.capacity() + 1;
+        }
+    }
+    return num_bytes;
+}
+
+uint64_t ReadIdSet::hash(const Uuid& uuid) {
+    uint64_t low = 0;
+    uint64_t high = 0;
+    std::memcpy(&low, uuid.data(), sizeof(low));
+    std::memcpy(&high, uuid.data() + sizeof(low), sizeof(high));
+    // Most read ids are random UUIDs, but derived and hand-written ones may not be, so mix
+    // every byte into the hash.
+    uint64_t h = low ^ (high * 0x9e3779b97f4a7c15ULL);
+    h ^= h >> 32;
+    h *= 0xd6e8feb86659fd93ULL;
+    h ^= h >> 32;
+    return h;
+}
+
+size_t ReadIdSet::find_slot(const Uuid& uuid, uint64_t uuid_hash) const {
+    const size_t mask = m_slots.size() - 1;
+    for (size_t i = uuid_hash & mask;; i = (i + 1) & mask) {
+        if (m_slots[i] == uuid || m_slots[i] == Uuid{}) {
+            return i;
+        }
+    }
+}
+
+void ReadIdSet::grow() {
+    std::vector<Uuid> old_slots(std::max(m_slots.size() * 2, kMinSlots));
+    old_slots.swap(m_slots);
+    for (const auto& uuid : old_slots) {
+        if (uuid != Uuid{}) {
+            m_slots[find_slot(uuid, hash(uuid))] = uuid;
+        }
+    }
+    if (m_bloom_bits_per_id > 0) {
+        rebuild_bloom_filter();
+    }
+}
+
+void ReadIdSet::rebuild_bloom_filter() {
+    // Size the filter for the most ids the table holds before it grows again, so the false
+    // positive rate never exceeds the target.
+    const size_t num_bits = max_table_entries(m_slots.size()) * m_bloom_bits_per_id;
+    const size_t num_blocks = std::max((num_bits + 511) / 512, size_t(1));
+    m_bloom_filter.assign(num_blocks * kBloomBlockWords, 0);
+    for (const auto& uuid : m_slots) {
+        if (uuid != Uuid{}) {
+            add_to_bloom_filter(hash(uuid));
+        }
+    }
+}
+
+void ReadIdSet::add_to_bloom_filter(uint64_t uuid_hash) {
+    const size_t num_blocks = m_bloom_filter.size() / kBloomBlockWords;
+    uint64_t* block = &m_bloom_filter[((uuid_hash >> 32) * num_blocks >> 32) * kBloomBlockWords];
+    const uint64_t bits = uuid_hash * 0x9e3779b97f4a7c15ULL;
+    for (size_t i = 0; i < kBloomHashes; ++i) {
+        const auto bit = (bits >> (9 * i)) & 511;
+        block[bit / 64] |= uint64_t(1) << (bit % 64);
+    }
+}
+
+bool ReadIdSet::bloom_filter_may_contain(uint64_t uuid_hash) const {
+    const size_t num_blocks = m_bloom_filter.size() / kBloomBlockWords;
+    const uint64_t* block =
+            &m_bloom_filter[((uuid_hash >> 32) * num_blocks >> 32) * kBloomBlockWords];
+    const uint64_t bits = uuid_hash * 0x9e3779b97f4a7c15ULL;
+    for (size_t i = 0; i < kBloomHashes; ++i) {
+        const auto bit = (bits >> (9 * i)) & 511;
+        if (!(block[bit / 64] & (uint64_t(1) << (bit % 64)))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+}  // namespace dorado::utils
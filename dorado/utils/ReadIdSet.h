@@ -0,0 +1,75 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+namespace dorado::utils {
+
+// Set of read ids, for tracking progress and filtering reads.
+// Ids in canonical UUID form (36 lowercase hex digits and hyphens, as POD5 read ids are
+// formatted) are stored as their 16 bytes in an open-addressing table, which takes around a
+// third of the memory of a std::unordered_set<std::string>.  Any other ids are kept in an
+// exact set of strings.  Optionally, a Bloom filter in front of the table answers most lookups
+// of ids which aren't in the set without probing the table.
+// Concurrent calls to const members are safe, but inserts must be externally synchronised.
+class ReadIdSet {
+public:
+    using Uuid = std::array<uint8_t, 16>;
+
+    ReadIdSet() = default;
+    ReadIdSet(std::initializer_list<std::string_view> read_ids);
+    ReadIdSet(const std::unordered_set<std::string>& read_ids);
+
+    // Returns true if the id wasn't already in the set.
+    bool insert(std::string_view read_id);
+    bool insert(const Uuid& uuid);
+
+    bool contains(std::string_view read_id) const;
+    bool contains(const Uuid& uuid) const;
+    size_t count(std::string_view read_id) const { return contains(read_id) ? 1 : 0; }
+
+    size_t size() const { return m_num_uuids + m_other_ids.size(); }
+    bool empty() const { return size() == 0; }
+
+    // Number of ids in this set which are also in other.
+    size_t count_shared(const ReadIdSet& other) const;
+
+    // Maintains a Bloom filter of about bits_per_id bits per id the table can hold before it
+    // next grows, which is worthwhile for large sets that are mostly queried for absent ids.
+    // 10 bits per id gives a false positive rate of about 1%.
+    void enable_bloom_filter(size_t bits_per_id = 10);
+
+    // Approximate heap memory used by the set.
+    size_t memory_bytes() const;
+
+    // Parses an id in canonical UUID form, returning false if it isn't one.
+    static bool parse_uuid(std::string_view read_id, Uuid& uuid);
+
+private:
+    static uint64_t hash(const Uuid& uuid);
+    // Index of the slot holding uuid, or of the empty slot where it would go.
+    size_t find_slot(const Uuid& uuid, uint64_t uuid_hash) const;
+    void grow();
+    void rebuild_bloom_filter();
+    void add_to_bloom_filter(uint64_t uuid_hash);
+    bool bloom_filter_may_contain(uint64_t uuid_hash) const;
+
+    // Open-addressing table with linear probing, whose size is a power of 2.  The all-zero
+    // UUID marks an empty slot, so whether that UUID is in the set is tracked separately.
+    std::vector<Uuid> m_slots;
+    size_t m_num_uuids = 0;
+    bool m_has_zero_uuid = false;
+    // Ids which aren't UUIDs.
+    std::unordered_set<std::string> m_other_ids;
+    // Blocked Bloom filter of the UUIDs in the table, in 512 bit blocks, or empty if disabled.
+    std::vector<uint64_t> m_bloom_filter;
+    size_t m_bloom_bits_per_id = 0;
+};
+
+}  // namespace dorado::utils
@@ -0,0 +1,219 @@
+#include "SignalSpillStore.h"
+
+#include <ATen/ATen.h>
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <cerrno>
+#endif
+
+namespace {
+
+// Segments are sized in multiples of the allocation granularity of every platform's
+// file mappings, so that they can be mapped at any segment boundary.
+constexpr size_t kMappingGranularity = 64 * 1024;
+constexpr size_t kMinSegmentSize = 256 * 1024 * 1024;
+// Keeps each spilled tensor suitably aligned for any element type.
+constexpr size_t kAllocAlignment = 64;
+
+size_t round_up(size_t value, size_t alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+}  // namespace
+
+namespace dorado::utils {
+
+struct SignalSpillStore::Segment {
+    size_t size = 0;
+    uint8_t* data = nullptr;
+    // Offsets and sizes of the unused ranges, with adjacent ranges merged.
+    std::map<size_t, size_t> free_ranges;
+#ifdef _WIN32
+    HANDLE mapping = nullptr;
+#endif
+};
+
+SignalSpillStore::SignalSpillStore(const std::filesystem::path& scratch_dir) {
+#ifdef _WIN32
+    const auto path = scratch_dir / ("dorado_signal_" + std::to_string(GetCurrentProcessId()) +
+                                     "_" + std::to_string(reinterpret_cast<uintptr_t>(this)));
+    HANDLE file = CreateFileW(path.wstring().c_str(), GENERIC_READ | GENERIC_WRITE, 0, nullptr,
+                              CREATE_NEW, FILE_ATTRIBUTE_TEMPORARY | FILE_FLAG_DELETE_ON_CLOSE,
+                              nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        throw std::runtime_error("Failed to create signal scratch file " + path.string());
+    }
+    m_file = reinterpret_cast<intptr_t>(file);
+#else
+    std::string path = (scratch_dir / "dorado_signal_XXXXXX").string();
+    const int fd = mkstemp(path.data());
+    if (fd < 0) {
+        throw std::runtime_error("Failed to create signal scratch file in " +
+                                 scratch_dir.string() + ": " + std::strerror(errno));
+    }
+    // The file only needs to live as long as the descriptor.
+    unlink(path.c_str());
+    m_file = fd;
+#endif
+}
+
+SignalSpillStore::~SignalSpillStore() {
+    for (auto& segment : m_segments) {
+#ifdef _WIN32
+        UnmapViewOfFile(segment->data);
+        CloseHandle(segment->mapping);
+#else
+        munmap(segment->data, segment->size);
+#endif
+    }
+#ifdef _WIN32
+    CloseHandle(reinterpret_cast<HANDLE>(m_file));
+#else
+    close(int(m_file));
+#endif
+}
+
+SignalSpillStore::Segment& SignalSpillStore::add_segment(size_t min_size) {
+    auto segment = std::make_unique<Segment>();
+    segment->size = std::max(kMinSegmentSize, round_up(min_size, kMappingGranularity));
+    const size_t file_offset = m_file_bytes;
+    const size_t new_file_bytes = file_offset + segment->size;
+
+#ifdef _WIN32
+    HANDLE file = reinterpret_cast<HANDLE>(m_file);
+    // Creating a mapping larger than the file extends the file.
+    segment->mapping = CreateFileMappingW(file, nullptr, PAGE_READWRITE,
+                                          DWORD(uint64_t(new_file_bytes) >> 32),
+                                          DWORD(new_file_bytes & 0xffffffff), nullptr);
+    if (!segment->mapping) {
+        throw std::runtime_error("Failed to grow signal scratch file");
+    }
+    segment->data = static_cast<uint8_t*>(MapViewOfFile(
+            segment->mapping, FILE_MAP_ALL_ACCESS, DWORD(uint64_t(file_offset) >> 32),
+            DWORD(file_offset & 0xffffffff), segment->size));
+    if (!segment->data) {
+        CloseHandle(segment->mapping);
+        throw std::runtime_error("Failed to map signal scratch file");
+    }
+#else
+    const int fd = int(m_file);
+    if (ftruncate(fd, off_t(new_file_bytes)) != 0) {
+        throw std::runtime_error(std::string("Failed to grow signal scratch file: ") +
+                                 std::strerror(errno));
+    }
+    void* data = mmap(nullptr, segment->size, PROT_READ | PROT_WRITE, MAP_SHARED, fd,
+                      off_t(file_offset));
+    if (data == MAP_FAILED) {
+        throw std::runtime_error(std::string("Failed to map signal scratch file: ") +
+                                 std::strerror(errno));
+    }
+    segment->data = static_cast<uint8_t*>(data);
+#endif
+
+    m_file_bytes = new_file_bytes;
+    m_segments.push_back(std::move(segment));
+    return *m_segments.back();
+}
+
+std::pair<size_t, size_t> SignalSpillStore::allocate(size_t nbytes) {
+    const size_t alloc_bytes = round_up(std::max(nbytes, size_t(1)), kAllocAlignment);
+    // Take the first range that fits, so that spilled signal packs towards the start of the file.
+    for (size_t i = 0; i < m_segments.size(); ++i) {
+        auto& free_ranges = m_segments[i]->free_ranges;
+        for (auto range = free_ranges.begin(); range != free_ranges.end(); ++range) {
+            const auto [offset, size] = *range;
+            if (size < alloc_bytes) {
+                continue;
+            }
+            auto next = free_ranges.erase(range);
+            if (size > alloc_bytes) {
+                free_ranges.emplace_hint(next, offset + alloc_bytes, size - alloc_bytes);
+            }
+            return {i, offset};
+        }
+    }
+    auto& segment = add_segment(alloc_bytes);
+    if (segment.size > alloc_bytes) {
+        segment.free_ranges.emplace(alloc_bytes, segment.size - alloc_bytes);
+    }
+    return {m_segments.size() - 1, 0};
+}
+
+void SignalSpillStore::release(size_t segment_index, size_t offset, size_t nbytes) {
+    auto& free_ranges = m_segments[segment_index]->free_ranges;
+    size_t start = offset;
+    size_t end = offset + round_up(std::max(nbytes, size_t(1)), kAllocAlignment);
+    // Merge with the free ranges either side.
+    auto next = free_ranges.lower_bound(offset);
+    if (next != free_ranges.begin()) {
+        auto prev = std::prev(next);
+        if (prev->first + prev->second == start) {
+            start = prev->first;
+            free_ranges.erase(prev);
+        }
+    }
+    if (next != free_ranges.end() && next->first == end) {
+        end += next->second;
+        next = free_ranges.erase(next);
+    }
+    free_ranges.emplace_hint(next, start, end - start);
+}
+
+SignalSpillStore::Handle SignalSpillStore::spill(const at::Tensor& signal) {
+    const auto contiguous_signal = signal.contiguous();
+    Handle handle;
+    handle.nbytes = contiguous_signal.nbytes();
+    handle.dtype = contiguous_signal.scalar_type();
+    handle.sizes = contiguous_signal.sizes().vec();
+
+    uint8_t* dest = nullptr;
+    {
+        std::lock_guard lock(m_mutex);
+        std::tie(handle.segment, handle.offset) = allocate(handle.nbytes);
+        dest = m_segments[handle.segment]->data + handle.offset;
+        m_spilled_bytes += handle.nbytes;
+    }
+    // The space is ours alone until it's restored, so the copy needs no lock.
+    std::memcpy(dest, contiguous_signal.data_ptr(), handle.nbytes);
+    return handle;
+}
+
+at::Tensor SignalSpillStore::restore(const Handle& handle) {
+    auto signal = at::empty(handle.sizes, at::TensorOptions().dtype(handle.dtype));
+    const uint8_t* src = nullptr;
+    {
+        std::lock_guard lock(m_mutex);
+        src = m_segments.at(handle.segment)->data + handle.offset;
+    }
+    std::memcpy(signal.data_ptr(), src, handle.nbytes);
+
+    std::lock_guard lock(m_mutex);
+    release(handle.segment, handle.offset, handle.nbytes);
+    m_spilled_bytes -= handle.nbytes;
+    return signal;
+}
+
+size_t SignalSpillStore::spilled_bytes() const {
+    std::lock_guard lock(m_mutex);
+    return m_spilled_bytes;
+}
+
+size_t SignalSpillStore::file_bytes() const {
+    std::lock_guard lock(m_mutex);
+    return m_file_bytes;
+}
+
+}  // namespace dorado::utils
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <ATen/core/TensorBody.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace dorado::utils {
+
+// Holds signal tensors in a memory-mapped scratch file, so that long-lived caches can drop
+// them from RAM and fault them back in when they're needed.  The scratch file is grown in
+// segments, and the space of restored tensors is reused, so the file only grows when the signal
+// spilled at once outgrows it.  The file is removed when the store is destroyed.  Thread-safe.
+class SignalSpillStore {
+public:
+    // Location and layout of a spilled tensor.
+    struct Handle {
+        size_t segment = 0;
+        size_t offset = 0;
+        size_t nbytes = 0;
+        at::ScalarType dtype = at::kShort;
+        std::vector<int64_t> sizes;
+    };
+
+    // The scratch file is created in scratch_dir, which must exist.
+    explicit SignalSpillStore(const std::filesystem::path& scratch_dir);
+    ~SignalSpillStore();
+
+    SignalSpillStore(const SignalSpillStore&) = delete;
+    SignalSpillStore& operator=(const SignalSpillStore&) = delete;
+
+    // Copies a CPU tensor into the scratch file.
+    Handle spill(const at::Tensor& signal);
+    // Copies a spilled tensor into a new CPU tensor, and releases its space in the scratch file.
+    // Each handle must be restored exactly once.
+    at::Tensor restore(const Handle& handle);
+
+    // Bytes currently spilled, and the size of the scratch file.
+    size_t spilled_bytes() const;
+    size_t file_bytes() const;
+
+private:
+    struct Segment;
+
+    // Reserves nbytes in a segment, returning the segment index and offset within it.
+    std::pair<size_t, size_t> allocate(size_t nbytes);
+    // Returns space reserved by allocate to its segment.
+    void release(size_t segment_index, size_t offset, size_t nbytes);
+    Segment& add_segment(size_t min_size);
+
+    mutable std::mutex m_mutex;
+    std::vector<std::unique_ptr<Segment>> m_segments;
+    size_t m_file_bytes = 0;
+    size_t m_spilled_bytes = 0;
+    // Native handle of the scratch file.
+    intptr_t m_file = -1;
+};
+
+}  // namespace dorado::utils
@@ -0,0 +1,224 @@
+#include "WorkStealingExecutor.h"
+
+#include <algorithm>
+#include <chrono>
+
+namespace {
+
+// Identifies the executor (if any) that owns the current thread, and its worker index.
+thread_local dorado::utils::WorkStealingExecutor* t_executor = nullptr;
+thread_local size_t t_worker_index = 0;
+
+// Tasks run by help_while_waiting can themselves end up waiting and helping, so bound the
+// nesting to keep stack use in check.  Beyond this a worker just blocks, and spare workers
+// run the queued tasks instead.
+constexpr int kMaxHelpDepth = 4;
+thread_local int t_help_depth = 0;
+
+// Spare workers exit once they've found no work for this long.  Spares can themselves end up
+// waiting too deeply to help, so several may be needed for each worker.
+constexpr auto kSpareIdleTimeout = std::chrono::milliseconds(100);
+constexpr size_t kMaxSpareWorkersPerThread = 4;
+
+}  // namespace
+
+namespace dorado::utils {
+
+WorkStealingExecutor::WorkStealingExecutor(size_t num_threads) {
+    num_threads = std::max(num_threads, size_t(1));
+    for (size_t i = 0; i < num_threads; ++i) {
+        m_queues.push_back(std::make_unique<WorkerQueue>());
+    }
+    for (size_t i = 0; i < num_threads; ++i) {
+        m_threads.emplace_back(&WorkStealingExecutor::worker_thread, this, i);
+    }
+}
+
+WorkStealingExecutor::~WorkStealingExecutor() {
+    {
+        std::lock_guard lock(m_sleep_mutex);
+        m_terminate = true;
+    }
+    m_sleep_cv.notify_all();
+    for (auto& thread : m_threads) {
+        thread.join();
+    }
+    std::lock_guard lock(m_spare_mutex);
+    for (auto& spare : m_spare_workers) {
+        spare->thread.join();
+    }
+}
+
+WorkStealingExecutor& WorkStealingExecutor::instance() {
+    static WorkStealingExecutor executor(std::thread::hardware_concurrency());
+    return executor;
+}
+
+bool WorkStealingExecutor::is_worker_thread() const { return t_executor == this; }
+
+WorkStealingExecutor* WorkStealingExecutor::current() { return t_executor; }
+
+void WorkStealingExecutor::submit(Task task) { push(std::move(task), false); }
+
+void WorkStealingExecutor::submit_behind(Task task) { push(std::move(task), true); }
+
+void WorkStealingExecutor::push(Task task, bool behind) {
+    const size_t queue_index = is_worker_thread()
+                                       ? t_worker_index
+                                       : m_next_queue.fetch_add(1, std::memory_order_relaxed) %
+                                                 m_queues.size();
+    {
+        auto& queue = *m_queues[queue_index];
+        std::lock_guard lock(queue.mutex);
+        if (behind) {
+            queue.tasks.push_front(std::move(task));
+        } else {
+            queue.tasks.push_back(std::move(task));
+        }
+    }
+    m_num_pending.fetch_add(1, std::memory_order_acq_rel);
+    // Taking the mutex ensures a worker can't be between checking m_num_pending and
+    // going to sleep.
+    { std::lock_guard lock(m_sleep_mutex); }
+    m_sleep_cv.notify_one();
+}
+
+bool WorkStealingExecutor::pop_local(size_t worker_index, Task& task) {
+    auto& queue = *m_queues[worker_index];
+    std::lock_guard lock(queue.mutex);
+    if (queue.tasks.empty()) {
+        return false;
+    }
+    task = std::move(queue.tasks.back());
+    queue.tasks.pop_back();
+    return true;
+}
+
+bool WorkStealingExecutor::steal(size_t worker_index, Task& task) {
+    const size_t num_queues = m_queues.size();
+    for (size_t i = 1; i < num_queues; ++i) {
+        auto& queue = *m_queues[(worker_index + i) % num_queues];
+        std::lock_guard lock(queue.mutex);
+        if (!queue.tasks.empty()) {
+            task = std::move(queue.tasks.front());
+            queue.tasks.pop_front();
+            ++m_num_steals;
+            return true;
+        }
+    }
+    return false;
+}
+
+void WorkStealingExecutor::run_task(Task& task) {
+    m_num_pending.fetch_sub(1, std::memory_order_acq_rel);
+    ++m_num_busy;
+    task();
+    --m_num_busy;
+    ++m_num_tasks_run;
+    // Release anything the task captured before we look for more work.
+    task = nullptr;
+}
+
+bool WorkStealingExecutor::help_while_waiting() {
+    if (!is_worker_thread()) {
+        return false;
+    }
+    if (t_help_depth >= kMaxHelpDepth) {
+        start_spare_worker();
+        return false;
+    }
+    Task task;
+    if (!pop_local(t_worker_index, task) && !steal(t_worker_index, task)) {
+        return false;
+    }
+    ++t_help_depth;
+    ++m_num_helped;
+    run_task(task);
+    --t_help_depth;
+    return true;
+}
+
+void WorkStealingExecutor::worker_thread(size_t worker_index) {
+    t_executor = this;
+    t_worker_index = worker_index;
+
+    Task task;
+    for (;;) {
+        if (pop_local(worker_index, task) || steal(worker_index, task)) {
+            run_task(task);
+            continue;
+        }
+
+        std::unique_lock lock(m_sleep_mutex);
+        m_sleep_cv.wait(lock, [this] {
+            return m_num_pending.load(std::memory_order_acquire) > 0 || m_terminate;
+        });
+        if (m_terminate && m_num_pending.load(std::memory_order_acquire) <= 0) {
+            break;
+        }
+    }
+
+    t_executor = nullptr;
+}
+
+void WorkStealingExecutor::start_spare_worker() {
+    if (m_num_pending.load(std::memory_order_acquire) <= 0) {
+        return;
+    }
+    std::lock_guard lock(m_spare_mutex);
+    // Reap spares which have exited.
+    for (auto it = m_spare_workers.begin(); it != m_spare_workers.end();) {
+        if ((*it)->done) {
+            (*it)->thread.join();
+            it = m_spare_workers.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    if (m_terminate || m_spare_workers.size() >= kMaxSpareWorkersPerThread * m_threads.size()) {
+        return;
+    }
+    auto& spare = *m_spare_workers.emplace_back(std::make_unique<SpareWorker>());
+    spare.thread = std::thread(&WorkStealingExecutor::spare_worker_thread, this, t_worker_index,
+                               std::ref(spare));
+    ++m_num_spares_started;
+}
+
+void WorkStealingExecutor::spare_worker_thread(size_t worker_index, SpareWorker& spare) {
+    t_executor = this;
+    t_worker_index = worker_index;
+
+    Task task;
+    auto idle_since = std::chrono::steady_clock::now();
+    for (;;) {
+        if (pop_local(worker_index, task) || steal(worker_index, task)) {
+            run_task(task);
+            idle_since = std::chrono::steady_clock::now();
+            continue;
+        }
+        if (m_terminate || std::chrono::steady_clock::now() - idle_since >= kSpareIdleTimeout) {
+            break;
+        }
+        std::unique_lock lock(m_sleep_mutex);
+        m_sleep_cv.wait_for(lock, kSpareIdleTimeout, [this] {
+            return m_num_pending.load(std::memory_order_acquire) > 0 || m_terminate;
+        });
+    }
+
+    t_executor = nullptr;
+    spare.done = true;
+}
+
+stats::NamedStats WorkStealingExecutor::sample_stats() const {
+    stats::NamedStats stats;
+    stats["threads"] = double(m_threads.size());
+    stats["busy_threads"] = double(m_num_busy.load());
+    stats["pending_tasks"] = double(std::max(int64_t(0), m_num_pending.load()));
+    stats["tasks_run"] = double(m_num_tasks_run.load());
+    stats["tasks_stolen"] = double(m_num_steals.load());
+    stats["tasks_helped"] = double(m_num_helped.load());
+    stats["spare_workers_started"] = double(m_num_spares_started.load());
+    return stats;
+}
+
+}  // namespace dorado::utils
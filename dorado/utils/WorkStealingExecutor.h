@@ -0,0 +1,110 @@
+#pragma once
+
+#include "stats.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace dorado::utils {
+
+// Pool of worker threads shared by all pipeline nodes.
+// Each worker owns a deque of tasks: tasks submitted from a worker go to the back of its own
+// deque and are popped LIFO, which keeps a node's follow-on work on a warm cache.  Idle
+// workers steal from the front of other workers' deques, so cores flow to whichever stage
+// has work queued.
+// Tasks should not block indefinitely; see help_while_waiting.  If waiting workers can't
+// help, because they are already nested too deeply in tasks run while waiting, spare workers
+// are started so that queued tasks still run.
+class WorkStealingExecutor {
+public:
+    using Task = std::function<void()>;
+
+    explicit WorkStealingExecutor(size_t num_threads);
+    ~WorkStealingExecutor();
+
+    WorkStealingExecutor(const WorkStealingExecutor&) = delete;
+    WorkStealingExecutor& operator=(const WorkStealingExecutor&) = delete;
+
+    // Process-wide executor, with one worker per hardware thread.
+    static WorkStealingExecutor& instance();
+
+    // Queues task for execution.
+    void submit(Task task);
+
+    // Queues task behind the calling worker's pending tasks: at the front of its deque, where
+    // the worker only gets to it once the rest are done, and other workers steal it first.
+    // Used by tasks which re-submit themselves, so that other tasks get a turn.  The same as
+    // submit when called from outside the pool.
+    void submit_behind(Task task);
+
+    // Runs one pending task on the calling thread, returning false if there was none.
+    // Only has an effect when called from one of this executor's workers.
+    // Workers that would otherwise block waiting on another stage call this so that the
+    // stage they're waiting on can make progress even if all workers are busy.
+    bool help_while_waiting();
+
+    // True if the calling thread is one of this executor's workers.
+    bool is_worker_thread() const;
+
+    // The executor whose worker is the calling thread, or nullptr.
+    static WorkStealingExecutor* current();
+
+    size_t num_threads() const { return m_threads.size(); }
+
+    std::string get_name() const { return "WorkStealingExecutor"; }
+    stats::NamedStats sample_stats() const;
+
+private:
+    struct WorkerQueue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    // A spare worker stands in for worker_index, which is waiting and can't help.  It
+    // exits once it has found no work for a while.
+    struct SpareWorker {
+        std::thread thread;
+        std::atomic<bool> done{false};
+    };
+
+    void push(Task task, bool behind);
+    void worker_thread(size_t worker_index);
+    void spare_worker_thread(size_t worker_index, SpareWorker& spare);
+    void start_spare_worker();
+    bool pop_local(size_t worker_index, Task& task);
+    bool steal(size_t worker_index, Task& task);
+    void run_task(Task& task);
+
+    std::vector<std::unique_ptr<WorkerQueue>> m_queues;
+    std::vector<std::thread> m_threads;
+
+    // Idle workers sleep here until tasks are submitted.
+    std::mutex m_sleep_mutex;
+    std::condition_variable m_sleep_cv;
+    // Signed, since a task can be taken before the submitter's increment lands.
+    std::atomic<int64_t> m_num_pending{0};
+    std::atomic<bool> m_terminate{false};
+    // Queue used for tasks submitted from outside the pool.
+    std::atomic<size_t> m_next_queue{0};
+
+    std::mutex m_spare_mutex;
+    std::vector<std::unique_ptr<SpareWorker>> m_spare_workers;
+
+    // Stats.
+    std::atomic<int64_t> m_num_tasks_run{0};
+    std::atomic<int64_t> m_num_steals{0};
+    std::atomic<int64_t> m_num_helped{0};
+    std::atomic<int> m_num_busy{0};
+    std::atomic<int64_t> m_num_spares_started{0};
+};
+
+}  // namespace dorado::utils
@@ -4,13 +4,16 @@
 #include "barcode_kits.h"
 #include "sequence_utils.h"
 
+#include <htslib/bgzf.h>
 #include <htslib/sam.h>
 
 #include <algorithm>
 #include <cctype>
 #include <iostream>
+#include <limits>
 #include <map>
 #include <sstream>
+#include <stdexcept>
 #include <string>
 #include <string_view>
 
@@ -32,6 +35,17 @@ std::string convert_nt16_to_str(uint8_t* bseq, size_t slen) {
     return seq;
 }
 
+// BAM is little-endian regardless of the host.
+void append_le(std::vector<uint8_t>& output, uint32_t value, size_t num_bytes) {
+    for (size_t i = 0; i < num_bytes; ++i) {
+        output.push_back(uint8_t(value >> (8 * i)));
+    }
+}
+
+void append_le32(std::vector<uint8_t>& output, int64_t value) {
+    append_le(output, uint32_t(value), 4);
+}
+
 }  // namespace
 
 namespace dorado::utils {
@@ -435,4 +449,90 @@ std::string cigar2str(uint32_t n_cigar, const uint32_t* cigar) {
     return cigar_str;
 }
 
+void append_bam_record(const bam1_t* record, std::vector<uint8_t>& output) {
+    const auto& core = record->core;
+    constexpr auto int32_min = std::numeric_limits<int32_t>::min();
+    constexpr auto int32_max = std::numeric_limits<int32_t>::max();
+    if (core.pos > int32_max || core.mpos > int32_max || core.isize < int32_min ||
+        core.isize > int32_max) {
+        throw std::runtime_error("Positional data is too large for BAM format for read " +
+                                 std::string(bam_get_qname(record)));
+    }
+
+    // Long CIGARs are replaced by one which soft clips the whole query and skips the reference
+    // span, and the real CIGAR goes in a CG:B,I tag after the other tags.
+    const bool long_cigar = core.n_cigar > 0xffff;
+    const uint32_t l_read_name = core.l_qname - core.l_extranul;
+    const size_t cigar_offset = core.l_qname;
+    const size_t cigar_bytes = size_t(core.n_cigar) * sizeof(uint32_t);
+    const size_t seq_offset = cigar_offset + cigar_bytes;
+    const size_t seq_bytes = record->l_data - seq_offset;
+    const size_t block_size = 32 + l_read_name + (long_cigar ? 8 : cigar_bytes) + seq_bytes +
+                              (long_cigar ? 8 + cigar_bytes : 0);
+    if (block_size > size_t(int32_max)) {
+        throw std::runtime_error("Record is too large for BAM format for read " +
+                                 std::string(bam_get_qname(record)));
+    }
+    const auto end_pos = bam_endpos(record);
+    const auto bin = hts_reg2bin(core.pos, end_pos, 14, 5);
+
+    output.reserve(output.size() + 4 + block_size);
+    append_le32(output, int64_t(block_size));
+    append_le32(output, core.tid);
+    append_le32(output, core.pos);
+    append_le(output, l_read_name, 1);
+    append_le(output, core.qual, 1);
+    append_le(output, uint32_t(bin), 2);
+    append_le(output, long_cigar ? 2 : core.n_cigar, 2);
+    append_le(output, core.flag, 2);
+    append_le32(output, core.l_qseq);
+    append_le32(output, core.mtid);
+    append_le32(output, core.mpos);
+    append_le32(output, core.isize);
+
+    // The read name is stored without the padding htslib adds to align the CIGAR.
+    output.insert(output.end(), record->data, record->data + l_read_name);
+    const auto* cigar = bam_get_cigar(record);
+    if (long_cigar) {
+        append_le(output, bam_cigar_gen(core.l_qseq, BAM_CSOFT_CLIP), 4);
+        const auto ref_length = bam_cigar2rlen(int(core.n_cigar), cigar);
+        append_le(output, bam_cigar_gen(uint32_t(ref_length), BAM_CREF_SKIP), 4);
+    } else {
+        for (uint32_t i = 0; i < core.n_cigar; ++i) {
+            append_le(output, cigar[i], 4);
+        }
+    }
+    output.insert(output.end(), record->data + seq_offset, record->data + record->l_data);
+    if (long_cigar) {
+        output.insert(output.end(), {'C', 'G', 'B', 'I'});
+        append_le(output, core.n_cigar, 4);
+        for (uint32_t i = 0; i < core.n_cigar; ++i) {
+            append_le(output, cigar[i], 4);
+        }
+    }
+}
+
+std::vector<uint8_t> compress_bgzf_blocks(const uint8_t* data, size_t size, int level) {
+    // zlib's default, which libdeflate doesn't accept as -1.
+    constexpr int kDefaultLevel = 6;
+    if (level < 0) {
+        level = kDefaultLevel;
+    }
+
+    std::vector<uint8_t> output;
+    output.reserve(size / 2);
+    for (size_t offset = 0; offset < size; offset += BGZF_BLOCK_SIZE) {
+        const size_t block_size = std::min(size - offset, size_t(BGZF_BLOCK_SIZE));
+        const size_t block_start = output.size();
+        output.resize(block_start + BGZF_MAX_BLOCK_SIZE);
+        size_t compressed_size = BGZF_MAX_BLOCK_SIZE;
+        if (bgzf_compress(output.data() + block_start, &compressed_size, data + offset,
+                          block_size, level) != 0) {
+            throw std::runtime_error("Failed to compress BGZF block");
+        }
+        output.resize(block_start + compressed_size);
+    }
+    return output;
+}
+
 }  // namespace dorado::utils
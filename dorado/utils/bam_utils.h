@@ -1,6 +1,7 @@
 #pragma once
 #include "types.h"
 
+#include <cstdint>
 #include <map>
 #include <string>
 #include <unordered_map>
@@ -170,4 +171,27 @@ std::string cigar2str(uint32_t n_cigar, const uint32_t* cigar);
  */
 kstring_t allocate_kstring();
 
+/*
+ * Append the BAM encoding of a record, as it's stored in an uncompressed BAM stream.
+ *
+ * CIGARs with more than 65535 operations are moved to a CG tag, as htslib does.
+ *
+ * @param record Record to encode.
+ * @param output Buffer to append the encoding to.
+ * @throws std::runtime_error if the record's positions don't fit in the BAM format.
+ */
+void append_bam_record(const bam1_t* record, std::vector<uint8_t>& output);
+
+/*
+ * Compress data into BGZF blocks, which can be appended to a BGZF stream with bgzf_raw_write.
+ *
+ * @param data Data to compress.
+ * @param size Size of the data in bytes.
+ * @param level zlib compression level, where 0 stores the data uncompressed and a negative
+ * level selects the default.
+ * @return The compressed blocks, or nothing if size is 0.
+ * @throws std::runtime_error if compression fails.
+ */
+std::vector<uint8_t> compress_bgzf_blocks(const uint8_t* data, size_t size, int level);
+
 }  // namespace dorado::utils
@@ -1,5 +1,7 @@
 #include "stats.h"
 
+#include <algorithm>
+#include <cmath>
 #include <ostream>
 #include <set>
 
@@ -101,4 +103,60 @@ void StatsSampler::sampling_thread_fn() {
     }
 }
 
-}  // namespace dorado::stats
\ No newline at end of file
+void LatencyHistogram::record(std::chrono::nanoseconds latency) {
+    const int64_t latency_us =
+            std::chrono::duration_cast<std::chrono::microseconds>(latency).count();
+    size_t bucket = 0;
+    while (bucket + 1 < NUM_BUCKETS && latency_us > (int64_t(1000) << bucket)) {
+        ++bucket;
+    }
+    m_buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+    m_count.fetch_add(1, std::memory_order_relaxed);
+
+    int64_t max_us = m_max_us.load(std::memory_order_relaxed);
+    while (latency_us > max_us &&
+           !m_max_us.compare_exchange_weak(max_us, latency_us, std::memory_order_relaxed)) {
+    }
+}
+
+double LatencyHistogram::quantile_ms(double q) const {
+    // The buckets may be updated while we're reading them, so count them as we go.
+    std::array<int64_t, NUM_BUCKETS> counts;
+    int64_t total = 0;
+    for (size_t i = 0; i < NUM_BUCKETS; ++i) {
+        counts[i] = m_buckets[i].load(std::memory_order_relaxed);
+        total += counts[i];
+    }
+    if (total == 0) {
+        return 0;
+    }
+
+    const auto rank = int64_t(std::ceil(std::clamp(q, 0.0, 1.0) * double(total)));
+    int64_t cumulative = 0;
+    for (size_t i = 0; i + 1 < NUM_BUCKETS; ++i) {
+        cumulative += counts[i];
+        if (cumulative >= std::max<int64_t>(rank, 1)) {
+            // Nothing recorded exceeds the maximum, which may be below the bucket's bound.
+            return std::min(double(int64_t(1) << i), max_ms());
+        }
+    }
+    return max_ms();
+}
+
+double LatencyHistogram::max_ms() const {
+    return double(m_max_us.load(std::memory_order_relaxed)) / 1000;
+}
+
+void LatencyHistogram::add_to_stats(NamedStats& stats, const std::string& prefix) const {
+    stats[prefix + "_count"] = double(count());
+    stats[prefix + "_p50"] = quantile_ms(0.5);
+    stats[prefix + "_p90"] = quantile_ms(0.9);
+    stats[prefix + "_p99"] = quantile_ms(0.99);
+    stats[prefix + "_max"] = max_ms();
+    for (size_t i = 0; i < NUM_BUCKETS; ++i) {
+        const auto bound = (i + 1 < NUM_BUCKETS) ? std::to_string(int64_t(1) << i) : "inf";
+        stats[prefix + "_le_" + bound] = double(m_buckets[i].load(std::memory_order_relaxed));
+    }
+}
+
+}  // namespace dorado::stats
@@ -1,7 +1,9 @@
 #pragma once
 
+#include <array>
 #include <atomic>
 #include <chrono>
+#include <cstdint>
 #include <functional>
 #include <iosfwd>
 #include <optional>
@@ -92,5 +94,28 @@ private:
     std::chrono::time_point<std::chrono::system_clock> m_start_time;
 };
 
+// Thread-safe histogram of latencies, in buckets whose upper bounds double from 1 ms.
+// Quantiles are reported as the upper bound of the bucket they fall in.
+class LatencyHistogram {
+public:
+    // The last bucket holds everything over 2^(NUM_BUCKETS - 2) ms.
+    static constexpr size_t NUM_BUCKETS = 24;
+
+    void record(std::chrono::nanoseconds latency);
+
+    int64_t count() const { return m_count.load(std::memory_order_relaxed); }
+    // Upper bound in ms of the bucket holding the q-th quantile, or 0 if nothing was recorded.
+    double quantile_ms(double q) const;
+    double max_ms() const;
+
+    // Adds the count, p50/p90/p99/max and bucket counts to stats, as prefix_<name>.
+    void add_to_stats(NamedStats& stats, const std::string& prefix) const;
+
+private:
+    std::array<std::atomic<int64_t>, NUM_BUCKETS> m_buckets{};
+    std::atomic<int64_t> m_count{0};
+    std::atomic<int64_t> m_max_us{0};
+};
+
 }  // namespace stats
 }  // namespace dorado
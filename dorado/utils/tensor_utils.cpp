@@ -5,9 +5,11 @@
 #include <torch/csrc/jit/serialization/pickle.h>
 #include <torch/torch.h>
 
+#include <algorithm>
 #include <cstddef>
 #include <cstring>
 #include <fstream>
+#include <stdexcept>
 #include <vector>
 
 namespace {
@@ -175,6 +177,23 @@ void copy_tensor_elems(at::Tensor& dest_tensor,
     }
 }
 
+void copy_repeat_padded(at::Tensor dest, const at::Tensor& src) {
+    const int64_t dest_len = dest.size(-1);
+    const int64_t src_len = std::min(src.size(-1), dest_len);
+    if (src_len == 0) {
+        throw std::runtime_error("copy_repeat_padded: source tensor is empty");
+    }
+    dest.narrow(-1, 0, src_len).copy_(src.narrow(-1, 0, src_len));
+
+    // Double the filled region each time.  It stays a multiple of src_len, so the copied
+    // prefix always continues the repeating pattern.
+    for (int64_t filled = src_len; filled < dest_len;) {
+        const int64_t copy_len = std::min(filled, dest_len - filled);
+        dest.narrow(-1, filled, copy_len).copy_(dest.narrow(-1, 0, copy_len));
+        filled += copy_len;
+    }
+}
+
 std::pair<at::Tensor, at::Tensor> quantize_tensor(const at::Tensor& tensor) {
     auto fp_range = tensor.abs().amax(0);
     constexpr int levels = 256;
@@ -37,6 +37,12 @@ void copy_tensor_elems(at::Tensor& dest_tensor,
                        std::size_t src_offset,
                        std::size_t count);
 
+// Copies src into dest along their last dimension, repeating src as many times as needed to
+// fill dest if it is shorter.  dest may be a view, e.g. one slot of a batch tensor, in which
+// case the copy goes straight into the underlying storage.  The padding is done by copying
+// from the already-filled part of dest, so no intermediate tensors are allocated.
+void copy_repeat_padded(at::Tensor dest, const at::Tensor& src);
+
 // Quantize a tensor to int8, returning a pair of tensors `{scales, quantized_tensor}`, where:
 // `scales` is the same size as `tensor` with dimension 0 dropped, dtype float
 // `quantized_tensor` is the same size as `tensor`, dtype int8
@@ -94,6 +94,10 @@ enum class ReadOrder { UNRESTRICTED, BY_CHANNEL, BY_TIME };
 struct DuplexPairingParameters {
     ReadOrder read_order;
     size_t cache_depth;
+    /// Signal bytes the pairing cache holds in memory before spilling to disk, 0 for no limit.
+    size_t max_cache_signal_bytes{0};
+    /// Directory to spill cached signal to, the system temp directory if empty.
+    std::string spill_dir{};
 };
 /// Default cache depth to be used for the duplex pairing cache.
 constexpr static size_t DEFAULT_DUPLEX_CACHE_DEPTH = 10;
@@ -11,11 +11,13 @@
 #include <thread>
 
 using dorado::utils::AsyncQueue;
+using dorado::utils::AsyncQueueBackend;
 using dorado::utils::AsyncQueueStatus;
 
 TEST_CASE(TEST_GROUP ": InputsMatchOutputs") {
+    const auto backend = GENERATE(AsyncQueueBackend::Mutex, AsyncQueueBackend::LockFree);
     const int n = 10;
-    AsyncQueue<int> queue(n);
+    AsyncQueue<int> queue(n, backend);
 
     for (int i = 0; i < n; ++i) {
         const auto status = queue.try_push(std::move(i));
@@ -30,14 +32,16 @@ TEST_CASE(TEST_GROUP ": InputsMatchOutputs") {
 }
 
 TEST_CASE(TEST_GROUP ": PushFailsIfTerminating") {
-    AsyncQueue<int> queue(1);
+    const auto backend = GENERATE(AsyncQueueBackend::Mutex, AsyncQueueBackend::LockFree);
+    AsyncQueue<int> queue(1, backend);
     queue.terminate();
     const auto status = queue.try_push(42);
     CHECK(status == AsyncQueueStatus::Terminate);
 }
 
 TEST_CASE(TEST_GROUP ": PopFailsIfTerminating") {
-    AsyncQueue<int> queue(1);
+    const auto backend = GENERATE(AsyncQueueBackend::Mutex, AsyncQueueBackend::LockFree);
+    AsyncQueue<int> queue(1, backend);
     queue.terminate();
     int val;
     const auto status = queue.try_pop(val);
@@ -45,7 +49,8 @@ TEST_CASE(TEST_GROUP ": PopFailsIfTerminating") {
 }
 
 TEST_CASE(TEST_GROUP ": PushPopSucceedAfterRestarting") {
-    AsyncQueue<int> queue(1);
+    const auto backend = GENERATE(AsyncQueueBackend::Mutex, AsyncQueueBackend::LockFree);
+    AsyncQueue<int> queue(1, backend);
     queue.terminate();
     queue.restart();
     const auto push_status = queue.try_push(42);
@@ -58,7 +63,8 @@ TEST_CASE(TEST_GROUP ": PushPopSucceedAfterRestarting") {
 // Spawned thread sits waiting for an item.
 // Main thread supplies that item.
 TEST_CASE(TEST_GROUP ": PopFromOtherThread") {
-    AsyncQueue<int> queue(1);
+    const auto backend = GENERATE(AsyncQueueBackend::Mutex, AsyncQueueBackend::LockFree);
+    AsyncQueue<int> queue(1, backend);
     std::atomic_bool thread_started{false};
     AsyncQueueStatus pop_status;
 
@@ -85,7 +91,8 @@ TEST_CASE(TEST_GROUP ": PopFromOtherThread") {
 // Spawned thread sits waiting for an item.
 // Main thread terminates wait.
 TEST_CASE(TEST_GROUP ": TerminateFromOtherThread") {
-    AsyncQueue<int> queue(1);
+    const auto backend = GENERATE(AsyncQueueBackend::Mutex, AsyncQueueBackend::LockFree);
+    AsyncQueue<int> queue(1, backend);
     std::atomic_bool thread_started{false};
     AsyncQueueStatus pop_status;
 
@@ -110,8 +117,9 @@ TEST_CASE(TEST_GROUP ": TerminateFromOtherThread") {
 }
 
 TEST_CASE(TEST_GROUP ": process_and_pop_n") {
+    const auto backend = GENERATE(AsyncQueueBackend::Mutex, AsyncQueueBackend::LockFree);
     const int n = 10;
-    AsyncQueue<int> queue(n);
+    AsyncQueue<int> queue(n, backend);
     for (int i = 0; i < n; ++i) {
         const auto status = queue.try_push(std::move(i));
         REQUIRE(status == AsyncQueueStatus::Success);
@@ -134,4 +142,113 @@ TEST_CASE(TEST_GROUP ": process_and_pop_n") {
     std::iota(expected.begin(), expected.end(), 0);
     CHECK(popped_items == expected);
     CHECK(queue.size() == 0);
-}
\ No newline at end of file
+}
+// Several producers and consumers hammer a queue whose capacity is much smaller than
+// the number of items, so the lock-free ring wraps many times.
+TEST_CASE(TEST_GROUP ": MultipleProducersConsumers") {
+    const auto backend = GENERATE(AsyncQueueBackend::Mutex, AsyncQueueBackend::LockFree);
+    const int num_producers = 4;
+    const int num_consumers = 3;
+    const int items_per_producer = 10000;
+    AsyncQueue<int> queue(7, backend);
+
+    std::vector<std::thread> producers;
+    for (int p = 0; p < num_producers; ++p) {
+        producers.emplace_back([&queue, p] {
+            for (int i = 0; i < items_per_producer; ++i) {
+                queue.try_push(p * items_per_producer + i);
+            }
+        });
+    }
+
+    std::vector<std::vector<int>> popped_items(num_consumers);
+    std::vector<std::thread> consumers;
+    for (int c = 0; c < num_consumers; ++c) {
+        consumers.emplace_back([&queue, &popped = popped_items[c]] {
+            int val = -1;
+            while (queue.try_pop(val) == AsyncQueueStatus::Success) {
+                popped.push_back(val);
+            }
+        });
+    }
+
+    for (auto& producer : producers) {
+        producer.join();
+    }
+    queue.terminate();
+    for (auto& consumer : consumers) {
+        consumer.join();
+    }
+
+    std::vector<int> all_items;
+    for (const auto& popped : popped_items) {
+        // Items from a given producer must arrive in order.
+        std::vector<int> last_seen(num_producers, -1);
+        for (int val : popped) {
+            CHECK(val > last_seen[val / items_per_producer]);
+            last_seen[val / items_per_producer] = val;
+        }
+        all_items.insert(all_items.end(), popped.begin(), popped.end());
+    }
+    std::sort(all_items.begin(), all_items.end());
+    std::vector<int> expected(num_producers * items_per_producer);
+    std::iota(expected.begin(), expected.end(), 0);
+    CHECK(all_items == expected);
+}
+
+TEST_CASE(TEST_GROUP ": PopTimesOutWhenEmpty") {
+    const auto backend = GENERATE(AsyncQueueBackend::Mutex, AsyncQueueBackend::LockFree);
+    AsyncQueue<int> queue(1, backend);
+    int val = -1;
+    const auto status = queue.try_pop_until(
+            val, std::chrono::steady_clock::now() + std::chrono::milliseconds(10));
+    CHECK(status == AsyncQueueStatus::Timeout);
+}
+
+// Batch is larger than the queue, so the push has to wait for the consumer.
+TEST_CASE(TEST_GROUP ": try_push_n") {
+    const auto backend = GENERATE(AsyncQueueBackend::Mutex, AsyncQueueBackend::LockFree);
+    const int n = 100;
+    AsyncQueue<int> queue(8, backend);
+
+    std::vector<int> popped_items;
+    auto popping_thread = std::thread([&queue, &popped_items] {
+        auto pop_item = [&popped_items](int popped) { popped_items.push_back(popped); };
+        while (queue.process_and_pop_n(pop_item, 5) == AsyncQueueStatus::Success) {
+        }
+    });
+
+    std::vector<int> items(n);
+    std::iota(items.begin(), items.end(), 0);
+    const auto push_status = queue.try_push_n(items);
+    queue.terminate();
+    popping_thread.join();
+
+    CHECK(push_status == AsyncQueueStatus::Success);
+    CHECK(items.empty());
+    std::vector<int> expected(n);
+    std::iota(expected.begin(), expected.end(), 0);
+    CHECK(popped_items == expected);
+}
+
+TEST_CASE(TEST_GROUP ": try_push_n fails if terminating") {
+    const auto backend = GENERATE(AsyncQueueBackend::Mutex, AsyncQueueBackend::LockFree);
+    AsyncQueue<int> queue(4, backend);
+    queue.terminate();
+    std::vector<int> items{1, 2, 3};
+    const auto status = queue.try_push_n(items);
+    CHECK(status == AsyncQueueStatus::Terminate);
+    CHECK(items.size() == 3);
+    CHECK(queue.size() == 0);
+}
+
+TEST_CASE(TEST_GROUP ": push times out when full") {
+    const auto backend = GENERATE(AsyncQueueBackend::Mutex, AsyncQueueBackend::LockFree);
+    AsyncQueue<int> queue(2, backend);
+    std::vector<int> items{1, 2, 3};
+    const auto timeout = std::chrono::steady_clock::now() + std::chrono::milliseconds(10);
+    CHECK(queue.try_push_n_until(items, timeout) == AsyncQueueStatus::Timeout);
+    CHECK(items == std::vector<int>{3});
+    CHECK(queue.try_push_until(4, timeout) == AsyncQueueStatus::Timeout);
+    CHECK(queue.size() == 2);
+}
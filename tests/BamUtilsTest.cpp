@@ -4,9 +4,12 @@
 #include "utils/barcode_kits.h"
 
 #include <catch2/catch.hpp>
+#include <htslib/bgzf.h>
 #include <htslib/sam.h>
 
 #include <filesystem>
+#include <fstream>
+#include <iterator>
 #include <numeric>
 #include <optional>
 #include <string>
@@ -288,3 +291,70 @@ TEST_CASE("BamUtilsTest: Ref positions consumed", TEST_GROUP) {
         hts_free(a_cigar);
     }
 }
+
+TEST_CASE("BamUtilsTest: append_bam_record matches htslib encoding", TEST_GROUP) {
+    std::vector<BamPtr> records;
+    HtsReader reader((fs::path(get_data_dir("bam_reader")) / "small.sam").string(), std::nullopt);
+    while (reader.read()) {
+        records.push_back(BamPtr(bam_dup1(reader.record.get())));
+    }
+    REQUIRE(records.size() > 1);
+
+    // A CIGAR too long for the BAM n_cigar_op field.
+    const size_t n_cigar = 70000;
+    std::vector<uint32_t> cigar(n_cigar);
+    for (size_t i = 0; i < n_cigar; ++i) {
+        cigar[i] = bam_cigar_gen(1, i % 2 ? BAM_CDEL : BAM_CMATCH);
+    }
+    const std::string seq(n_cigar / 2, 'A');
+    const std::string qual(seq.size(), '!');
+    BamPtr long_cigar_record(bam_init1());
+    REQUIRE(bam_set1(long_cigar_record.get(), 4, "read", 0, 0, 100, 60, n_cigar, cigar.data(), -1,
+                     -1, 0, seq.size(), seq.data(), qual.data(), 0) >= 0);
+    records.push_back(std::move(long_cigar_record));
+
+    const auto bam_path = fs::temp_directory_path() / "bam_utils_record_encoding.bam";
+    BGZF* bgzf = bgzf_open(bam_path.string().c_str(), "wu");
+    REQUIRE(bgzf);
+    std::vector<uint8_t> encoded;
+    for (const auto& record : records) {
+        REQUIRE(bam_write1(bgzf, record.get()) >= 0);
+        utils::append_bam_record(record.get(), encoded);
+    }
+    REQUIRE(bgzf_close(bgzf) == 0);
+
+    std::ifstream bam_file(bam_path, std::ios::binary);
+    const std::vector<uint8_t> expected{std::istreambuf_iterator<char>(bam_file),
+                                        std::istreambuf_iterator<char>()};
+    bam_file.close();
+    fs::remove(bam_path);
+    CHECK(encoded == expected);
+}
+
+TEST_CASE("BamUtilsTest: compress_bgzf_blocks round trip", TEST_GROUP) {
+    const int level = GENERATE(-1, 0, 1, 6);
+    // Enough for several blocks, with a partial one at the end.
+    std::vector<uint8_t> data(3 * BGZF_BLOCK_SIZE + 1000);
+    for (size_t i = 0; i < data.size(); ++i) {
+        data[i] = uint8_t((i * 7919) % 251 + i / 1000);
+    }
+
+    const auto blocks = utils::compress_bgzf_blocks(data.data(), data.size(), level);
+    CHECK(utils::compress_bgzf_blocks(data.data(), 0, level).empty());
+
+    const auto bgzf_path = fs::temp_directory_path() / "bam_utils_bgzf_blocks.gz";
+    BGZF* bgzf = bgzf_open(bgzf_path.string().c_str(), "w");
+    REQUIRE(bgzf);
+    REQUIRE(bgzf_raw_write(bgzf, blocks.data(), blocks.size()) == ssize_t(blocks.size()));
+    REQUIRE(bgzf_close(bgzf) == 0);
+
+    bgzf = bgzf_open(bgzf_path.string().c_str(), "r");
+    REQUIRE(bgzf);
+    std::vector<uint8_t> decompressed(data.size() + 1);
+    const auto num_read = bgzf_read(bgzf, decompressed.data(), decompressed.size());
+    bgzf_close(bgzf);
+    fs::remove(bgzf_path);
+    REQUIRE(num_read == ssize_t(data.size()));
+    decompressed.resize(data.size());
+    CHECK(decompressed == data);
+}
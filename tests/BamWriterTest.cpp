@@ -7,7 +7,10 @@
 #include <catch2/catch.hpp>
 #include <htslib/sam.h>
 
+#include <algorithm>
 #include <filesystem>
+#include <string>
+#include <vector>
 
 #define TEST_GROUP "[bam_utils][hts_writer]"
 
@@ -25,10 +28,11 @@ public:
     ~HtsWriterTestsFixture() { fs::remove(m_out_bam); }
 
 protected:
-    void generate_bam(HtsWriter::OutputMode mode, int num_threads) {
+    void generate_bam(HtsWriter::OutputMode mode, int num_threads, size_t num_shards = 1) {
         HtsReader reader(m_in_sam.string(), std::nullopt);
         PipelineDescriptor pipeline_desc;
-        auto writer = pipeline_desc.add_node<HtsWriter>({}, m_out_bam.string(), mode, num_threads);
+        auto writer = pipeline_desc.add_node<HtsWriter>({}, m_out_bam.string(), mode, num_threads,
+                                                        num_shards);
         auto pipeline = Pipeline::create(std::move(pipeline_desc), nullptr);
 
         auto& writer_ref = dynamic_cast<HtsWriter&>(pipeline->get_node_ref(writer));
@@ -40,9 +44,20 @@ protected:
         pipeline.reset();
     }
 
-    stats::NamedStats stats;
+    // Records of a SAM/BAM file, as strings.
+    static std::vector<std::string> read_records(const fs::path& path) {
+        HtsReader reader(path.string(), std::nullopt);
+        std::vector<std::string> records;
+        kstring_t str = KS_INITIALIZE;
+        while (reader.read()) {
+            REQUIRE(sam_format1(reader.header, reader.record.get(), &str) >= 0);
+            records.emplace_back(ks_str(&str), ks_len(&str));
+        }
+        ks_free(&str);
+        return records;
+    }
 
-private:
+    stats::NamedStats stats;
     fs::path m_in_sam;
     fs::path m_out_bam;
 };
@@ -67,3 +82,38 @@ TEST_CASE_METHOD(HtsWriterTestsFixture, "HtsWriter: Count reads written", TEST_G
     CHECK(stats.at("unique_simplex_reads_written") == 6);
     CHECK(stats.at("split_reads_written") == 2);
 }
+
+TEST_CASE_METHOD(HtsWriterTestsFixture, "HtsWriter: BAM records round trip", TEST_GROUP) {
+    int num_threads = GENERATE(1, 4);
+    HtsWriter::OutputMode mode = GENERATE(HtsWriter::OutputMode::BAM, HtsWriter::OutputMode::UBAM);
+    REQUIRE_NOTHROW(generate_bam(mode, num_threads));
+
+    CHECK(read_records(m_out_bam) == read_records(m_in_sam));
+    CHECK(stats.at("unique_simplex_reads_written") == 6);
+}
+
+TEST_CASE_METHOD(HtsWriterTestsFixture, "HtsWriter: Sharded output", TEST_GROUP) {
+    HtsWriter::OutputMode mode = GENERATE(HtsWriter::OutputMode::BAM, HtsWriter::OutputMode::SAM);
+    const size_t num_shards = 3;
+    REQUIRE_NOTHROW(generate_bam(mode, 4, num_shards));
+
+    CHECK(HtsWriter::get_shard_filename(m_out_bam.string(), 1) ==
+          (m_out_bam.parent_path() / "out_001.bam").string());
+    std::vector<std::string> records;
+    for (size_t shard_idx = 0; shard_idx < num_shards; ++shard_idx) {
+        const fs::path shard_path = HtsWriter::get_shard_filename(m_out_bam.string(), shard_idx);
+        REQUIRE(fs::exists(shard_path));
+        const auto shard_records = read_records(shard_path);
+        records.insert(records.end(), shard_records.begin(), shard_records.end());
+        fs::remove(shard_path);
+    }
+    auto expected_records = read_records(m_in_sam);
+    std::sort(records.begin(), records.end());
+    std::sort(expected_records.begin(), expected_records.end());
+    CHECK(records == expected_records);
+}
+
+TEST_CASE("HtsWriter: Sharded output needs a file", TEST_GROUP) {
+    CHECK_THROWS_WITH(HtsWriter("-", HtsWriter::OutputMode::BAM, 1, 2),
+                      "Sharded output must be written to a file.");
+}
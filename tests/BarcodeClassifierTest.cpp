@@ -13,6 +13,7 @@
 #include <htslib/sam.h>
 
 #include <cstdint>
+#include <cstdlib>
 #include <filesystem>
 #include <string>
 #include <vector>
@@ -76,6 +77,42 @@ TEST_CASE("BarcodeClassifier: test single ended barcode", TEST_GROUP) {
     }
 }
 
+TEST_CASE("BarcodeClassifier: k-mer prefilter", TEST_GROUP) {
+    fs::path data_dir = fs::path(get_data_dir("barcode_demux/single_end"));
+
+    demux::BarcodeClassifier classifier({"SQK-RBK114-96"}, std::nullopt, std::nullopt, 11);
+
+    // Barcoded reads get past the prefilter and are still classified.
+    int num_reads = 0;
+    for (std::string bc : {"SQK-RBK114-96_BC01", "SQK-RBK114-96_RBK39", "SQK-RBK114-96_BC92"}) {
+        auto bc_file = data_dir / (bc + ".fastq");
+        HtsReader reader(bc_file.string(), std::nullopt);
+        while (reader.read()) {
+            std::string seq = utils::extract_sequence(reader.record.get());
+            auto res = classifier.barcode(seq, false, std::nullopt);
+            CHECK(bc == (res.kit + "_" + res.barcode_name));
+            ++num_reads;
+        }
+    }
+
+    // A read which shares no 11-mer with the kit isn't scored.
+    std::string seq;
+    for (int i = 0; i < 100; ++i) {
+        seq += "AC";
+    }
+    CHECK(classifier.barcode(seq, false, std::nullopt).barcode_name == "unclassified");
+
+    auto stats = classifier.sample_stats();
+    CHECK(stats["prefilter_reads_checked"] == num_reads + 1);
+    CHECK(stats["prefilter_reads_rejected"] == 1);
+    CHECK(stats["barcode_reads_scored"] == num_reads);
+
+    // Reads aren't counted or timed without the prefilter.
+    demux::BarcodeClassifier unfiltered({"SQK-RBK114-96"}, std::nullopt, std::nullopt);
+    unfiltered.barcode(seq, false, std::nullopt);
+    CHECK(unfiltered.sample_stats()["barcode_reads_scored"] == 0);
+}
+
 TEST_CASE("BarcodeClassifier: test double ended barcode", TEST_GROUP) {
     fs::path data_dir = fs::path(get_data_dir("barcode_demux/double_end"));
 
@@ -189,7 +226,7 @@ TEST_CASE(
         pipeline_desc.add_node<BarcodeClassifierNode>({sink}, 8);
     } else {
         pipeline_desc.add_node<BarcodeClassifierNode>({sink}, 8, kits, barcode_both_ends, no_trim,
-                                                      std::nullopt, std::nullopt, std::nullopt);
+                                                      std::nullopt, std::nullopt, std::nullopt, 0);
     }
 
     auto pipeline = dorado::Pipeline::create(std::move(pipeline_desc), nullptr);
@@ -348,7 +385,7 @@ TEST_CASE("BarcodeClassifierNode: test reads where trim length == read length",
     bool barcode_both_ends = false;
     bool no_trim = false;
     pipeline_desc.add_node<BarcodeClassifierNode>({sink}, 8, kits, barcode_both_ends, no_trim,
-                                                  std::nullopt, std::nullopt, std::nullopt);
+                                                  std::nullopt, std::nullopt, std::nullopt, 0);
 
     auto pipeline = dorado::Pipeline::create(std::move(pipeline_desc), nullptr);
     fs::path data_dir = fs::path(get_data_dir("barcode_demux"));
@@ -0,0 +1,93 @@
+#include "basecall/decode/beam_search.h"
+
+#include <catch2/catch.hpp>
+#include <torch/torch.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#define CUT_TAG "[BeamSearch]"
+
+namespace {
+
+// Simple LCG, so the inputs don't depend on the standard library's distributions.
+struct InputGenerator {
+    uint32_t state;
+    float next() {
+        state = state * 1664525u + 1013904223u;
+        return float(state >> 8) / float(1 << 24);
+    }
+};
+
+struct ExpectedDecode {
+    size_t beam_width;
+    std::string sequence;
+    std::string qstring;
+    std::string moves;
+};
+
+}  // namespace
+
+// Guards against changes to the beam search output.  The expected values were generated
+// with the original array-of-structs implementation.
+TEST_CASE(CUT_TAG ": decode output is unchanged", CUT_TAG) {
+    const int state_len = 4;
+    const int T = 120;
+    const int num_states = 1 << (2 * state_len);
+    const int C = 4 * num_states;
+
+    InputGenerator rng{12345};
+    std::vector<float> scores(T * C);
+    std::vector<float> back_guides((T + 1) * num_states);
+    std::vector<float> posts((T + 1) * num_states);
+    for (auto& score : scores) {
+        score = rng.next() * 4.0f - 2.0f;
+    }
+    for (int t = 0; t <= T; ++t) {
+        for (int s = 0; s < num_states; ++s) {
+            back_guides[t * num_states + s] = (rng.next() - 0.5f) * float(T - t) * 0.1f;
+        }
+    }
+    for (auto& post : posts) {
+        post = rng.next() * rng.next() * 0.2f;
+    }
+
+    const auto scores_t = torch::from_blob(scores.data(), {T, C}, torch::kFloat);
+    const auto back_guides_t =
+            torch::from_blob(back_guides.data(), {T + 1, num_states}, torch::kFloat);
+    const auto posts_t = torch::from_blob(posts.data(), {T + 1, num_states}, torch::kFloat);
+
+    const ExpectedDecode expected_decodes[] = {
+        {8, "ACCAGCCAAACCGGCTGACACAAACCTGTGGTGGATCTTTGCA",
+         R"(&(&(&(('%''(&''&'&&&&)'''&%'&'&'('&&&&&''&')",
+         "110011111011001000001111010110100100010101100101010001100011"
+         "001100000001100100000000000010001000010100010000101000000010"},
+        {32, "GACAATCACTCTTTTGCCTTCGGCGTACT",
+         R"('&'%(&'&''&&'''&&&&&%%&&('(&()",
+         "101101100101000000001000000110000000010000000100000001000000"
+         "010001010001000101010000100000010000000110001000110010000001"},
+        {64, "CCTCACGGCTGATGGCCGCGGGAAATCGTTT",
+         R"(%&'%'&&'&&&&&&&&'$&'&'&&'&('&%')",
+         "110010001000010001000100000001010000101000001001110010000111"
+         "000101000010000010000001000000001000100001001000010000001100"},
+        {256, "GACAAATTCCAAACTCTTTCCACGACAGCGTGAGC",
+         R"()&&%('''&&&&'&'&''&&&'&&&&%&%&&'&(')",
+         "110101100110001100010000110001000000100100010000010001010001"
+         "000110100001000001010000110000000001101000010000010010000010"},
+    };
+
+    for (const auto& expected : expected_decodes) {
+        CAPTURE(expected.beam_width);
+        const auto [sequence, qstring, moves] = dorado::basecall::decode::beam_search_decode(
+                scores_t, back_guides_t, posts_t, expected.beam_width, 100.0f, 2.0f, 0.0f, 1.0f,
+                1.0f);
+        std::string moves_str;
+        for (auto move : moves) {
+            moves_str += char('0' + move);
+        }
+        CHECK(sequence == expected.sequence);
+        CHECK(qstring == expected.qstring);
+        CHECK(moves_str == expected.moves);
+    }
+}
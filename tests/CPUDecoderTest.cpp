@@ -0,0 +1,45 @@
+#include "basecall/decode/CPUDecoder.h"
+#include "basecall/decode/beam_search.h"
+#include "basecall/decode/forward_backward.h"
+#include "utils/WorkStealingExecutor.h"
+
+#include <catch2/catch.hpp>
+#include <torch/torch.h>
+
+#define CUT_TAG "[CPUDecoder]"
+
+using namespace dorado::basecall::decode;
+
+TEST_CASE(CUT_TAG ": pooled decode matches per-chunk decode", CUT_TAG) {
+    const int num_threads = GENERATE(1, 3, 8);
+    CAPTURE(num_threads);
+    dorado::utils::WorkStealingExecutor executor(num_threads);
+    CPUDecoder decoder(executor);
+
+    // State length 3.
+    const int T = 200;
+    const int num_chunks = 13;
+    const int C = 256;
+    torch::manual_seed(42);
+    const auto scores = torch::randn({T, num_chunks, C}, torch::kFloat) * 2.0f;
+
+    DecoderOptions options;
+    const auto results = decoder.beam_search_part_2(
+            decoder.beam_search_part_1({scores, num_chunks, options}));
+    REQUIRE(results.size() == size_t(num_chunks));
+
+    at::InferenceMode inference_mode_guard;
+    for (int chunk_idx = 0; chunk_idx < num_chunks; ++chunk_idx) {
+        CAPTURE(chunk_idx);
+        const auto chunk_scores = scores.select(1, chunk_idx);
+        const auto fwd = forward_scores(chunk_scores.unsqueeze(1), options.blank_score).squeeze(1);
+        const auto bwd = backward_scores(chunk_scores.unsqueeze(1), options.blank_score).squeeze(1);
+        const auto posts = at::softmax(fwd + bwd, -1);
+        const auto [sequence, qstring, moves] = beam_search_decode(
+                chunk_scores, bwd, posts, options.beam_width, options.beam_cut, options.blank_score,
+                options.q_shift, options.q_scale, 1.0f);
+        CHECK(results[chunk_idx].sequence == sequence);
+        CHECK(results[chunk_idx].qstring == qstring);
+        CHECK(results[chunk_idx].moves == moves);
+    }
+}
@@ -59,3 +59,32 @@ TEST_CASE("CliUtils: Extract tokens from dorado cmdline", TEST_GROUP) {
         CHECK(tokens[i] == expected_tokens[i]);
     }
 }
+
+TEST_CASE("CliUtils: Check integer arguments are range checked", TEST_GROUP) {
+    argparse::ArgumentParser parser;
+    parser.add_argument("--value").default_value(0).scan<'i', int>();
+    auto parse = [&parser](const std::string& value) {
+        parser.parse_args({"dorado", "--value", value});
+    };
+
+    SECTION("in range") {
+        parse("4");
+        CHECK(get_int_in_range(parser, "--value", 1, 16) == 4);
+    }
+    SECTION("bounds are inclusive") {
+        parse("16");
+        CHECK(get_int_in_range(parser, "--value", 16, 16) == 16);
+    }
+    SECTION("no upper bound") {
+        parse("100000");
+        CHECK(get_int_in_range(parser, "--value", 1) == 100000);
+    }
+    SECTION("too small") {
+        parse("0");
+        CHECK_THROWS(get_int_in_range(parser, "--value", 1));
+    }
+    SECTION("too large") {
+        parse("17");
+        CHECK_THROWS(get_int_in_range(parser, "--value", 0, 16));
+    }
+}
@@ -0,0 +1,50 @@
+#include "basecall/decode/forward_backward.h"
+
+#include <catch2/catch.hpp>
+#include <torch/torch.h>
+
+#define CUT_TAG "[ForwardBackward]"
+
+namespace {
+
+// Random [T, N, C] scores with a similar spread to real model output.
+at::Tensor make_scores(int T, int N, int state_len) {
+    const int C = 4 << (2 * state_len);
+    torch::manual_seed(42);
+    return torch::randn({T, N, C}, torch::kFloat) * 2.0f;
+}
+
+}  // namespace
+
+TEST_CASE(CUT_TAG ": kernels match ATen reference", CUT_TAG) {
+    using namespace dorado::basecall::decode;
+
+    const int state_len = GENERATE(1, 2, 3, 5);
+    CAPTURE(state_len);
+    const float stay_score = 2.0f;
+    const auto scores = make_scores(100, 3, state_len);
+
+    const auto fwd_expected = forward_scores_aten(scores, stay_score);
+    const auto bwd_expected = backward_scores_aten(scores, stay_score);
+    const auto fwd = forward_scores(scores, stay_score);
+    const auto bwd = backward_scores(scores, stay_score);
+
+    REQUIRE(fwd.sizes() == fwd_expected.sizes());
+    REQUIRE(bwd.sizes() == bwd_expected.sizes());
+    CHECK(torch::allclose(fwd, fwd_expected, 1e-5, 1e-4));
+    CHECK(torch::allclose(bwd, bwd_expected, 1e-5, 1e-4));
+}
+
+TEST_CASE(CUT_TAG ": kernels handle strided chunk slices", CUT_TAG) {
+    using namespace dorado::basecall::decode;
+
+    // CPUDecoder hands each thread a slice of the chunks, which isn't contiguous.
+    const auto scores = make_scores(50, 6, 3);
+    using Slice = at::indexing::Slice;
+    const auto sliced = scores.index({Slice(), Slice(2, 5)});
+
+    CHECK(torch::allclose(forward_scores(sliced, 2.0f), forward_scores_aten(sliced, 2.0f), 1e-5,
+                          1e-4));
+    CHECK(torch::allclose(backward_scores(sliced, 2.0f), backward_scores_aten(sliced, 2.0f), 1e-5,
+                          1e-4));
+}
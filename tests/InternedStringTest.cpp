@@ -0,0 +1,43 @@
+#include "utils/InternedString.h"
+
+#include <catch2/catch.hpp>
+
+#include <string>
+#include <utility>
+
+#define TEST_GROUP "[utils][InternedString]"
+
+using dorado::utils::InternedString;
+
+TEST_CASE("InternedString: equal strings share storage", TEST_GROUP) {
+    const InternedString a(std::string("run_1234"));
+    const InternedString b("run_1234");
+    const InternedString c("run_5678");
+
+    CHECK(a == b);
+    CHECK(&a.str() == &b.str());
+    CHECK(a != c);
+    CHECK(a == "run_1234");
+    CHECK(std::string("run_5678") == c);
+    CHECK(a.size() == 8);
+}
+
+TEST_CASE("InternedString: default is empty", TEST_GROUP) {
+    InternedString str;
+    CHECK(str.empty());
+    CHECK(str == "");
+    CHECK(str == InternedString(""));
+
+    auto old = std::exchange(str, "model");
+    CHECK(old.empty());
+    CHECK(str == "model");
+}
+
+TEST_CASE("InternedString: converts to std::string", TEST_GROUP) {
+    const InternedString str("flowcell");
+    const std::string& ref = str;
+    std::string copy = str;
+    CHECK(ref == "flowcell");
+    CHECK(copy == "flowcell");
+    CHECK(std::string(str.c_str()) == "flowcell");
+}
@@ -0,0 +1,76 @@
+#include "demux/KmerPrefilter.h"
+
+#include <catch2/catch.hpp>
+
+#include <random>
+#include <string>
+#include <vector>
+
+#define TEST_GROUP "[barcode_demux][KmerPrefilter]"
+
+using dorado::demux::KmerPrefilter;
+
+TEST_CASE("KmerPrefilter: finds shared k-mers", TEST_GROUP) {
+    const KmerPrefilter prefilter({"AACCGGTTAC", "GATTACA"}, 5);
+    // 6 k-mers of the first sequence and 3 of the second.
+    CHECK(prefilter.num_kmers() == 9);
+
+    CHECK(prefilter.has_seed("AACCG"));
+    CHECK(prefilter.has_seed("TTTTTTGGTTATTTTT"));
+    CHECK(prefilter.has_seed("CCCCCTTACA"));
+    CHECK_FALSE(prefilter.has_seed("AACC"));
+    CHECK_FALSE(prefilter.has_seed("AACCNGTTAA"));
+    CHECK_FALSE(prefilter.has_seed("aaccg"));
+    CHECK_FALSE(prefilter.has_seed(""));
+}
+
+TEST_CASE("KmerPrefilter: k-mers with other bases are skipped", TEST_GROUP) {
+    const KmerPrefilter prefilter({"ACGTNNNNNNGGCCA", "TTMAAA"}, 4);
+    CHECK(prefilter.num_kmers() == 3);
+    CHECK(prefilter.has_seed("ACGT"));
+    CHECK(prefilter.has_seed("GGCC"));
+    CHECK(prefilter.has_seed("GCCA"));
+    CHECK_FALSE(prefilter.has_seed("CGTA"));
+    CHECK_FALSE(prefilter.has_seed("TTAAA"));
+}
+
+TEST_CASE("KmerPrefilter: matches a naive search", TEST_GROUP) {
+    const int kmer_length = GENERATE(1, 6, 11, 16);
+    CAPTURE(kmer_length);
+
+    std::mt19937 gen(kmer_length);
+    auto random_sequence = [&gen](size_t length) {
+        std::string seq(length, ' ');
+        for (auto& c : seq) {
+            c = "ACGT"[gen() % 4];
+        }
+        return seq;
+    };
+
+    std::vector<std::string> sequences;
+    for (int i = 0; i < 20; ++i) {
+        sequences.push_back(random_sequence(24));
+    }
+    const KmerPrefilter prefilter(sequences, kmer_length);
+
+    for (int trial = 0; trial < 200; ++trial) {
+        const auto window = random_sequence(trial % 40);
+        bool expected = false;
+        for (size_t i = 0; i + kmer_length <= window.size() && !expected; ++i) {
+            for (const auto& seq : sequences) {
+                if (seq.find(window.substr(i, kmer_length)) != std::string::npos) {
+                    expected = true;
+                    break;
+                }
+            }
+        }
+        CAPTURE(window);
+        CHECK(prefilter.has_seed(window) == expected);
+    }
+}
+
+TEST_CASE("KmerPrefilter: invalid k-mer length", TEST_GROUP) {
+    CHECK_THROWS_AS(KmerPrefilter({"ACGT"}, 0), std::invalid_argument);
+    CHECK_THROWS_AS(KmerPrefilter({"ACGT"}, KmerPrefilter::MAX_KMER_LENGTH + 1),
+                    std::invalid_argument);
+}
@@ -91,3 +91,40 @@ TEST_CASE("Encode sequence for modified basecalling", TEST_GROUP) {
     // clang-format on    
     CHECK(expected_slice2 == slice2.data);
 }
+
+TEST_CASE("Encode all contexts of a sequence into one buffer", TEST_GROUP) {
+    const size_t BLOCK_STRIDE = 2;
+    const size_t SLICE_BLOCKS = 6;
+    std::string sequence{"TATTCAGTACTATTCAGTAC"};
+    auto seq_ints = dorado::utils::sequence_to_ints(sequence);
+    std::vector<uint8_t> moves{1, 1, 0, 1, 0, 0, 1, 1, 0, 1, 0, 1, 0, 0, 1, 0, 1, 1, 0, 0,
+                               1, 1, 0, 1, 0, 0, 1, 1, 0, 1, 0, 1, 0, 0, 1, 0, 1, 1, 0, 0};
+    auto seq_to_sig_map = dorado::utils::moves_to_map(moves, BLOCK_STRIDE,
+                                                      moves.size() * BLOCK_STRIDE, std::nullopt);
+
+    // kmer length 9 has a specialised implementation, so check that as well as the generic one.
+    auto [bases_before, bases_after] = GENERATE(table<int, int>({{1, 1}, {4, 4}, {2, 5}}));
+    CAPTURE(bases_before, bases_after);
+    dorado::modbase::ModBaseEncoder encoder(BLOCK_STRIDE, SLICE_BLOCKS * BLOCK_STRIDE,
+                                            bases_before, bases_after);
+    encoder.init(seq_ints, seq_to_sig_map);
+
+    const std::vector<size_t> positions{0, 1, 4, 9, 10, 18, 19};
+    const size_t context_size = encoder.encoded_context_size();
+    std::vector<int8_t> encoded_data(positions.size() * context_size, -1);
+    auto contexts = encoder.get_contexts(positions, encoded_data.data());
+    REQUIRE(contexts.size() == positions.size());
+
+    for (size_t i = 0; i < positions.size(); ++i) {
+        CAPTURE(i);
+        const auto expected = encoder.get_context(positions[i]);
+        CHECK(expected.data.size() == context_size);
+        CHECK(contexts[i].data.empty());
+        CHECK(contexts[i].first_sample == expected.first_sample);
+        CHECK(contexts[i].num_samples == expected.num_samples);
+        CHECK(contexts[i].lead_samples_needed == expected.lead_samples_needed);
+        CHECK(contexts[i].tail_samples_needed == expected.tail_samples_needed);
+        const auto data_begin = encoded_data.begin() + i * context_size;
+        CHECK(std::vector<int8_t>(data_begin, data_begin + context_size) == expected.data);
+    }
+}
@@ -46,3 +46,40 @@ TEST_CASE(TEST_GROUP ": test motifs", TEST_GROUP) {
     auto hits = matcher.get_motif_hits(SEQ);
     CHECK(hits == expected_results);
 }
+
+TEST_CASE(TEST_GROUP ": multiple motifs in one pass", TEST_GROUP) {
+    using Motif = dorado::modbase::MotifMatcher::Motif;
+    // Hits of each motif are merged into a single sorted list, with positions hit by more than
+    // one motif reported once.
+    dorado::modbase::MotifMatcher matcher(std::vector<Motif>{
+            {"CG", 0},
+            {"DRACH", 2},
+            {"TAC", 2},
+    });
+    CHECK(matcher.get_motif_hits(SEQ) == std::vector<size_t>{3, 9, 14, 18});
+}
+
+TEST_CASE(TEST_GROUP ": motifs which span automata", TEST_GROUP) {
+    using Motif = dorado::modbase::MotifMatcher::Motif;
+    // 40 + 40 bases doesn't fit in one automaton.
+    const std::string long_seq = std::string(40, 'A') + std::string(40, 'C') + SEQ;
+    dorado::modbase::MotifMatcher matcher(std::vector<Motif>{
+            {std::string(40, 'A'), 39},
+            {std::string(40, 'C'), 0},
+            {"CG", 1},
+    });
+    CHECK(matcher.get_motif_hits(long_seq) == std::vector<size_t>{39, 40, 84, 90});
+}
+
+TEST_CASE(TEST_GROUP ": invalid motifs", TEST_GROUP) {
+    using dorado::modbase::MotifMatcher;
+    CHECK_THROWS(MotifMatcher("", 0));
+    CHECK_THROWS(MotifMatcher("CG", 2));
+    CHECK_THROWS(MotifMatcher("CZG", 0));
+    CHECK_THROWS(MotifMatcher(std::string(65, 'N'), 0));
+}
+
+TEST_CASE(TEST_GROUP ": bases which aren't ACGT never match", TEST_GROUP) {
+    dorado::modbase::MotifMatcher matcher("NN", 0);
+    CHECK(matcher.get_motif_hits("ACNGTacgt") == std::vector<size_t>{0, 3});
+}
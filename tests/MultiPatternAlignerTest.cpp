@@ -0,0 +1,98 @@
+#include "demux/MultiPatternAligner.h"
+
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+
+#define TEST_GROUP "[barcode_demux][MultiPatternAligner]"
+
+using dorado::demux::MultiPatternAligner;
+
+namespace {
+
+// Global edit distance by dynamic programming, as edlib computes in EDLIB_MODE_NW.
+int edit_distance(const std::string& pattern, const std::string& text) {
+    std::vector<int> row(text.size() + 1);
+    for (size_t j = 0; j <= text.size(); ++j) {
+        row[j] = int(j);
+    }
+    for (size_t i = 1; i <= pattern.size(); ++i) {
+        int diag = row[0];
+        row[0] = int(i);
+        for (size_t j = 1; j <= text.size(); ++j) {
+            const int up = row[j];
+            row[j] = std::min({up + 1, row[j - 1] + 1, diag + (pattern[i - 1] != text[j - 1])});
+            diag = up;
+        }
+    }
+    return row[text.size()];
+}
+
+std::string random_sequence(std::mt19937& gen, size_t length, const std::string& alphabet) {
+    std::uniform_int_distribution<size_t> dist(0, alphabet.size() - 1);
+    std::string seq(length, ' ');
+    for (auto& c : seq) {
+        c = alphabet[dist(gen)];
+    }
+    return seq;
+}
+
+}  // namespace
+
+TEST_CASE("MultiPatternAligner: matches dynamic programming", TEST_GROUP) {
+    const size_t pattern_length = GENERATE(1, 7, 24, 40, 63, 64);
+    // Pattern counts either side of a whole number of SIMD registers.
+    const size_t num_patterns = GENERATE(1, 4, 5, 96);
+    CAPTURE(pattern_length, num_patterns);
+
+    std::mt19937 gen(int(pattern_length * 100 + num_patterns));
+    std::vector<std::string> patterns;
+    for (size_t i = 0; i < num_patterns; ++i) {
+        patterns.push_back(random_sequence(gen, pattern_length, "ACGT"));
+    }
+    const MultiPatternAligner aligner(patterns);
+    CHECK(aligner.num_patterns() == num_patterns);
+    CHECK(aligner.pattern_length() == pattern_length);
+
+    for (int trial = 0; trial < 20; ++trial) {
+        // Texts range from empty to longer than the patterns, and include characters which
+        // aren't in any pattern.
+        std::string text;
+        if (trial % 2 == 0) {
+            // Mutate one of the patterns, so some distances are small.
+            text = patterns[trial % num_patterns];
+            for (int edit = 0; edit < trial / 4 && !text.empty(); ++edit) {
+                text.erase(gen() % text.size(), 1);
+                text.insert(gen() % (text.size() + 1), 1, "ACGTN"[gen() % 5]);
+            }
+        } else {
+            text = random_sequence(gen, gen() % (pattern_length * 2 + 1), "ACGTN");
+        }
+        CAPTURE(text);
+
+        const auto distances = aligner.edit_distances(text);
+        REQUIRE(distances.size() == num_patterns);
+        for (size_t i = 0; i < num_patterns; ++i) {
+            CHECK(distances[i] == edit_distance(patterns[i], text));
+        }
+    }
+}
+
+TEST_CASE("MultiPatternAligner: characters are compared exactly", TEST_GROUP) {
+    const MultiPatternAligner aligner({"ACGT", "acgt", "NNNN"});
+    CHECK(aligner.edit_distances("ACGT") == std::vector<int>{0, 4, 4});
+    CHECK(aligner.edit_distances("acgt") == std::vector<int>{4, 0, 4});
+    CHECK(aligner.edit_distances("") == std::vector<int>{4, 4, 4});
+}
+
+TEST_CASE("MultiPatternAligner: unsupported patterns", TEST_GROUP) {
+    CHECK_FALSE(MultiPatternAligner::supports({}));
+    CHECK_FALSE(MultiPatternAligner::supports({""}));
+    CHECK_FALSE(MultiPatternAligner::supports({"ACGT", "ACG"}));
+    CHECK_FALSE(MultiPatternAligner::supports({std::string(65, 'A')}));
+    CHECK(MultiPatternAligner::supports({std::string(64, 'A'), std::string(64, 'C')}));
+    CHECK_THROWS_AS(MultiPatternAligner({"ACGT", "ACG"}), std::invalid_argument);
+}
@@ -9,6 +9,12 @@
 #include <catch2/catch.hpp>
 
 #include <filesystem>
+#include <map>
+#include <set>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
 
 #define TEST_GROUP "[PairingNodeTest]"
 
@@ -42,6 +48,55 @@ auto make_read(int delay_ms, size_t seq_len) {
     return make_read(delay_ms, std::string(seq_len, 'A'));
 }
 
+// A read in a channel which may follow another.
+struct ChannelRead {
+    int channel;
+    std::string read_id;
+    std::string prev_read;
+    int delay_ms;
+    std::string seq;
+};
+
+// Channel, template and complement ids, and the overlap in each.
+using PairOverlap =
+        std::tuple<int, std::string, std::string, uint64_t, uint64_t, uint64_t, uint64_t>;
+
+// Passes the reads through a PairingNode with one worker thread, in order, returning the pairs it
+// accepts and its template_index_reuses.
+std::pair<std::set<PairOverlap>, double> pair_reads(const std::vector<ChannelRead>& channel_reads) {
+    dorado::PipelineDescriptor pipeline_desc;
+    std::vector<dorado::Message> messages;
+    auto sink = pipeline_desc.add_node<MessageSinkToVector>({}, 100, messages);
+    auto pairing_node = pipeline_desc.add_node<dorado::PairingNode>(
+            {sink},
+            dorado::DuplexPairingParameters{dorado::ReadOrder::BY_CHANNEL,
+                                            dorado::DEFAULT_DUPLEX_CACHE_DEPTH},
+            1, 100);
+    auto pipeline = dorado::Pipeline::create(std::move(pipeline_desc), nullptr);
+    for (const auto& channel_read : channel_reads) {
+        auto read = make_read(channel_read.delay_ms, channel_read.seq);
+        read->read_common.attributes.channel_number = channel_read.channel;
+        read->read_common.read_id = channel_read.read_id;
+        read->prev_read = channel_read.prev_read;
+        pipeline->push_message(std::move(read));
+    }
+    pipeline->terminate(dorado::DefaultFlushOptions());
+    auto stats = pipeline->get_node_ref(pairing_node).sample_stats();
+
+    std::set<PairOverlap> pairs;
+    for (const auto& message : messages) {
+        if (std::holds_alternative<dorado::ReadPair>(message)) {
+            const auto& pair = std::get<dorado::ReadPair>(message);
+            pairs.emplace(pair.template_read.read_common.attributes.channel_number,
+                          pair.template_read.read_common.read_id,
+                          pair.complement_read.read_common.read_id,
+                          pair.template_read.seq_start, pair.template_read.seq_end,
+                          pair.complement_read.seq_start, pair.complement_read.seq_end);
+        }
+    }
+    return {std::move(pairs), stats["template_index_reuses"]};
+}
+
 }  // namespace
 
 TEST_CASE("Split read pairing", TEST_GROUP) {
@@ -94,3 +149,146 @@ TEST_CASE("Split read pairing", TEST_GROUP) {
             });
     CHECK(num_pairs == 2);
 }
+
+TEST_CASE("Cached reads from many pores are passed on once", TEST_GROUP) {
+    // Reads are too short to pair, so every read should come out exactly once, whether it was
+    // evicted from the cache or left in it until the end.
+    auto read_order = GENERATE(dorado::ReadOrder::BY_CHANNEL, dorado::ReadOrder::BY_TIME);
+    CAPTURE(dorado::to_string(read_order));
+
+    const int num_channels = 64;
+    const int reads_per_channel = 4;
+
+    dorado::PipelineDescriptor pipeline_desc;
+    std::vector<dorado::Message> messages;
+    auto sink = pipeline_desc.add_node<MessageSinkToVector>({}, 1000, messages);
+    pipeline_desc.add_node<dorado::PairingNode>(
+            {sink}, dorado::DuplexPairingParameters{read_order, 2}, 4, 1000);
+    auto pipeline = dorado::Pipeline::create(std::move(pipeline_desc), nullptr);
+
+    for (int i = 0; i < reads_per_channel; ++i) {
+        for (int channel = 0; channel < num_channels; ++channel) {
+            auto read = make_read(i * 100, 100);
+            read->read_common.attributes.channel_number = channel;
+            read->read_common.read_id = std::to_string(channel) + "_" + std::to_string(i);
+            pipeline->push_message(std::move(read));
+        }
+    }
+    pipeline.reset();
+
+    std::set<std::string> read_ids;
+    for (auto& message : messages) {
+        REQUIRE(std::holds_alternative<dorado::SimplexReadPtr>(message));
+        read_ids.insert(std::get<dorado::SimplexReadPtr>(message)->read_common.read_id);
+    }
+    CHECK(messages.size() == size_t(num_channels * reads_per_channel));
+    CHECK(read_ids.size() == messages.size());
+}
+
+TEST_CASE("Reads and pairs keep their signal when cached signal is spilled", TEST_GROUP) {
+    // Each read's signal is filled with its index, so that what comes out can be checked.
+    const int num_channels = 4;
+    const int reads_per_channel = 6;
+    const int64_t num_samples = 200000;
+
+    dorado::PipelineDescriptor pipeline_desc;
+    std::vector<dorado::Message> messages;
+    auto sink = pipeline_desc.add_node<MessageSinkToVector>({}, 1000, messages);
+    // A cache of 3 reads per pore, so that some reads are evicted and the rest are left to be
+    // flushed on terminate, with 1 MB of signal kept in memory.
+    auto pairing_node = pipeline_desc.add_node<dorado::PairingNode>(
+            {sink}, dorado::DuplexPairingParameters{dorado::ReadOrder::BY_TIME, 3, 1 << 20}, 1,
+            1000);
+    auto pipeline = dorado::Pipeline::create(std::move(pipeline_desc), nullptr);
+
+    // Consecutive reads in a channel follow each other closely and are the same length, so each
+    // pairs with the next without an overlap check.  Reads arrive out of order, so some are paired
+    // with reads whose signal has already been spilled.
+    std::map<std::string, float> read_signal_values;
+    for (int i : {0, 2, 4, 1, 3, 5}) {
+        for (int channel = 0; channel < num_channels; ++channel) {
+            auto read_id = [channel](int n) {
+                return std::to_string(channel) + "_" + std::to_string(n);
+            };
+            auto read = make_read(i * 2550, 5000);
+            read->read_common.attributes.channel_number = channel;
+            read->read_common.read_id = read_id(i);
+            read->prev_read = i > 0 ? read_id(i - 1) : "";
+            read->next_read = read_id(i + 1);
+            const auto value = float(read_signal_values.size());
+            read->read_common.raw_data = at::full({num_samples}, value);
+            read_signal_values[read->read_common.read_id] = value;
+            pipeline->push_message(std::move(read));
+        }
+    }
+    pipeline->terminate(dorado::DefaultFlushOptions());
+    auto stats = pipeline->get_node_ref(pairing_node).sample_stats();
+    CHECK(stats["signal_spills"] > 0);
+    CHECK(stats["signal_misses"] > 0);
+
+    auto check_signal = [&](const dorado::ReadCommon& read_common) {
+        CAPTURE(read_common.read_id);
+        REQUIRE(read_signal_values.count(read_common.read_id) == 1);
+        CHECK(read_common.raw_data.numel() == num_samples);
+        CHECK(read_common.raw_data.equal(
+                at::full({num_samples}, read_signal_values.at(read_common.read_id))));
+    };
+    std::set<std::string> read_ids;
+    int num_pairs = 0;
+    for (auto& message : messages) {
+        if (std::holds_alternative<dorado::ReadPair>(message)) {
+            const auto& pair = std::get<dorado::ReadPair>(message);
+            check_signal(pair.template_read.read_common);
+            check_signal(pair.complement_read.read_common);
+            ++num_pairs;
+        } else {
+            REQUIRE(std::holds_alternative<dorado::SimplexReadPtr>(message));
+            const auto& read = std::get<dorado::SimplexReadPtr>(message);
+            check_signal(read->read_common);
+            read_ids.insert(read->read_common.read_id);
+        }
+    }
+    CHECK(read_ids.size() == read_signal_values.size());
+    CHECK(num_pairs == num_channels * (reads_per_channel - 1));
+}
+
+TEST_CASE("Templates checked against several complements are only indexed once", TEST_GROUP) {
+    const std::string seq =
+            ReadFileIntoString(std::filesystem::path(get_aligner_data_dir()) / "long_target.fa");
+    const auto seq_rc = dorado::utils::reverse_complement(seq);
+    auto truncate = [](const std::string& s, float fraction) {
+        return s.substr(0, size_t(s.length() * fraction));
+    };
+
+    // The complements arrive latest first, so each is inserted straight after the template and
+    // checked against it.  Each is too short, compared to the template, to be accepted early.
+    // The last template has the same id as the first, but a different sequence, which its
+    // complement only pairs with in the opposite orientation.
+    const std::vector<ChannelRead> channel_reads{
+            {1, "template", "", 0, seq},
+            {1, "complement_3", "template", 2800, truncate(seq_rc, 0.6f)},
+            {1, "complement_2", "template", 2700, truncate(seq_rc, 0.7f)},
+            {1, "complement_1", "template", 2600, truncate(seq_rc, 0.8f)},
+            {2, "template", "", 0, seq_rc},
+            {2, "complement_4", "template", 2600, truncate(seq, 0.8f)},
+    };
+
+    // The same pairs must be accepted as when each check indexes its template afresh.
+    std::set<PairOverlap> fresh_pairs;
+    for (size_t i = 0; i < channel_reads.size(); ++i) {
+        if (channel_reads[i].prev_read.empty()) {
+            continue;
+        }
+        const auto& temp = channel_reads[i].channel == 1 ? channel_reads[0] : channel_reads[4];
+        const auto [pairs, index_reuses] = pair_reads({temp, channel_reads[i]});
+        CHECK(index_reuses == 0);
+        fresh_pairs.insert(pairs.begin(), pairs.end());
+    }
+    CHECK(fresh_pairs.size() == 4);
+
+    const auto [pairs, index_reuses] = pair_reads(channel_reads);
+    CHECK(pairs == fresh_pairs);
+    // The first template is reused for its second and third complements, but the second template
+    // isn't served from the first's index.
+    CHECK(index_reuses == 2);
+}
@@ -153,3 +153,25 @@ TEST_CASE(TEST_GROUP "Test correct previous and next read ids when loaded by cha
         next_read_id = (*i)->read_common.read_id;
     }
 }
+
+TEST_CASE(TEST_GROUP "Test loading reads from many POD5 files concurrently") {
+    // Recursively, the data dir holds POD5 files for many conditions.
+    std::string data_path(get_pod5_data_dir());
+    const auto num_reads =
+            size_t(dorado::DataLoader::get_num_reads(data_path, std::nullopt, {}, true));
+    REQUIRE(num_reads > 5);
+
+    auto max_reads = GENERATE(size_t(0), size_t(5));
+    CAPTURE(max_reads);
+
+    dorado::PipelineDescriptor pipeline_desc;
+    std::vector<dorado::Message> messages;
+    pipeline_desc.add_node<MessageSinkToVector>({}, 100, messages);
+    auto pipeline = dorado::Pipeline::create(std::move(pipeline_desc), nullptr);
+
+    dorado::DataLoader loader(*pipeline, "cpu", 2, max_reads, std::nullopt, {});
+    loader.load_reads(data_path, true, dorado::ReadOrder::UNRESTRICTED);
+    pipeline.reset();
+
+    CHECK(messages.size() == (max_reads == 0 ? num_reads : max_reads));
+}
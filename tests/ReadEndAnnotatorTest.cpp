@@ -0,0 +1,286 @@
+#include "demux/ReadEndAnnotator.h"
+
+#include "MessageSinkUtils.h"
+#include "TestUtils.h"
+#include "demux/AdapterDetector.h"
+#include "demux/BarcodeClassifier.h"
+#include "demux/Trimmer.h"
+#include "read_pipeline/AdapterDetectorNode.h"
+#include "read_pipeline/BarcodeClassifierNode.h"
+#include "read_pipeline/HtsReader.h"
+#include "read_pipeline/ReadEndAnnotatorNode.h"
+#include "utils/bam_utils.h"
+
+#include <ATen/Functions.h>
+#include <catch2/catch.hpp>
+#include <htslib/sam.h>
+
+#include <algorithm>
+#include <filesystem>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+#define TEST_GROUP "[barcode_demux][ReadEndAnnotator]"
+
+namespace fs = std::filesystem;
+
+using namespace dorado;
+
+namespace {
+
+std::vector<std::string> read_sequences(const std::string& data_sub_dir) {
+    std::vector<std::string> sequences;
+    for (const auto& entry : fs::directory_iterator(get_data_dir(data_sub_dir))) {
+        HtsReader reader(entry.path().string(), std::nullopt);
+        while (reader.read()) {
+            sequences.push_back(utils::extract_sequence(reader.record.get()));
+        }
+    }
+    return sequences;
+}
+
+}  // namespace
+
+TEST_CASE("ReadEndAnnotator: matches adapter detection then barcoding", TEST_GROUP) {
+    const bool find_adapters = GENERATE(true, false);
+    const bool find_primers = GENERATE(true, false);
+    const bool trim_barcodes = GENERATE(true, false);
+    CAPTURE(find_adapters, find_primers, trim_barcodes);
+
+    BarcodingInfo barcoding_info;
+    barcoding_info.kit_name = "SQK-RBK114-96";
+    barcoding_info.trim = trim_barcodes;
+
+    demux::ReadEndAnnotator annotator;
+    demux::AdapterDetector detector;
+    demux::BarcodeClassifier classifier({barcoding_info.kit_name}, std::nullopt, std::nullopt);
+
+    for (const auto& seq : read_sequences("barcode_demux/single_end")) {
+        const int seqlen = int(seq.length());
+        const auto annotation =
+                annotator.annotate(seq, find_adapters, find_primers, &barcoding_info);
+
+        // What AdapterDetectorNode and BarcodeClassifierNode would do.
+        std::pair<int, int> adapter_interval = {0, seqlen};
+        if (find_adapters) {
+            adapter_interval =
+                    Trimmer::determine_trim_interval(detector.find_adapters(seq), seqlen);
+        }
+        if (find_primers) {
+            const auto primer_interval =
+                    Trimmer::determine_trim_interval(detector.find_primers(seq), seqlen);
+            adapter_interval.first = std::max(adapter_interval.first, primer_interval.first);
+            adapter_interval.second = std::min(adapter_interval.second, primer_interval.second);
+        }
+        if (adapter_interval.first >= adapter_interval.second) {
+            adapter_interval = {0, seqlen};
+        }
+        const auto trimmed_seq = seq.substr(adapter_interval.first,
+                                            adapter_interval.second - adapter_interval.first);
+        const auto barcode = classifier.barcode(trimmed_seq, false, std::nullopt);
+        auto barcode_interval = std::make_pair(0, int(trimmed_seq.length()));
+        if (trim_barcodes) {
+            barcode_interval = Trimmer::determine_trim_interval(barcode, int(trimmed_seq.length()));
+        }
+
+        CHECK(annotation.adapters.has_value() == find_adapters);
+        CHECK(annotation.primers.has_value() == find_primers);
+        CHECK(annotation.adapter_trim_interval == adapter_interval);
+        REQUIRE(annotation.barcode.has_value());
+        CHECK(annotation.barcode->barcode_name == barcode.barcode_name);
+        CHECK(annotation.barcode->top_barcode_pos == barcode.top_barcode_pos);
+        CHECK(annotation.barcode_trim_interval == barcode_interval);
+        CHECK(annotation.trim_interval ==
+              std::make_pair(adapter_interval.first + barcode_interval.first,
+                             adapter_interval.first + barcode_interval.second));
+    }
+}
+
+TEST_CASE("ReadEndAnnotator: no barcoding without barcoding info", TEST_GROUP) {
+    demux::ReadEndAnnotator annotator;
+    const std::string seq(500, 'A');
+    const auto annotation = annotator.annotate(seq, true, true, nullptr);
+    CHECK_FALSE(annotation.barcode.has_value());
+    CHECK(annotation.trim_interval == std::make_pair(0, 500));
+}
+
+TEST_CASE("ReadEndAnnotatorNode: matches AdapterDetectorNode then BarcodeClassifierNode",
+          TEST_GROUP) {
+    using Catch::Matchers::Equals;
+    const std::vector<std::string> kits = {"SQK-RBK114-96"};
+
+    // Identical inputs for each path, as both reads and records.  Some signal was trimmed from the
+    // front of each read beforehand, and the move tables have stays, so ts and ns depend on where
+    // in the moves each trim lands.
+    const auto sequences = read_sequences("barcode_demux/single_end");
+    const int stride = 6;
+    const uint64_t num_trimmed_samples = 10;
+    auto make_messages = [&] {
+        std::mt19937 gen(42);
+        std::uniform_int_distribution<int> stay_blocks(0, 2);
+        std::vector<Message> messages;
+        for (size_t i = 0; i < sequences.size(); ++i) {
+            auto read = std::make_unique<SimplexRead>();
+            read->read_common.seq = sequences[i];
+            read->read_common.qstring = std::string(sequences[i].length(), char('!' + i % 40));
+            read->read_common.read_id = std::to_string(i);
+            read->read_common.model_stride = stride;
+            for (size_t j = 0; j < sequences[i].length(); ++j) {
+                read->read_common.moves.push_back(1);
+                read->read_common.moves.insert(read->read_common.moves.end(), stay_blocks(gen),
+                                               0);
+            }
+            read->read_common.raw_data =
+                    at::zeros(int64_t(read->read_common.moves.size()) * stride);
+            read->read_common.num_trimmed_samples = num_trimmed_samples;
+
+            // The same read as a record, named so it can be told apart.
+            read->read_common.read_id = "bam_" + std::to_string(i);
+            auto records = read->read_common.extract_sam_lines(true, 0, false);
+            REQUIRE(records.size() == 1);
+            read->read_common.read_id = std::to_string(i);
+
+            messages.push_back(std::move(read));
+            messages.push_back(std::move(records[0]));
+        }
+        return messages;
+    };
+
+    auto run_pipeline = [&](bool fused) {
+        dorado::PipelineDescriptor pipeline_desc;
+        std::vector<Message> messages;
+        auto sink = pipeline_desc.add_node<MessageSinkToVector>({}, 100, messages);
+        if (fused) {
+            pipeline_desc.add_node<ReadEndAnnotatorNode>({sink}, 2, true, true, kits, false, false,
+                                                         std::nullopt, std::nullopt, std::nullopt,
+                                                         0);
+        } else {
+            auto barcoder = pipeline_desc.add_node<BarcodeClassifierNode>(
+                    {sink}, 2, kits, false, false, std::nullopt, std::nullopt, std::nullopt, 0);
+            pipeline_desc.add_node<AdapterDetectorNode>({barcoder}, 2, true, true);
+        }
+        auto pipeline = dorado::Pipeline::create(std::move(pipeline_desc), nullptr);
+        for (auto& message : make_messages()) {
+            pipeline->push_message(std::move(message));
+        }
+        pipeline->terminate(DefaultFlushOptions());
+
+        // Messages come out in any order, so index them by name.
+        std::map<std::string, Message> by_name;
+        for (auto& message : messages) {
+            if (std::holds_alternative<BamPtr>(message)) {
+                std::string name = bam_get_qname(std::get<BamPtr>(message).get());
+                by_name.emplace(std::move(name), std::move(message));
+            } else {
+                REQUIRE(std::holds_alternative<SimplexReadPtr>(message));
+                auto name = std::get<SimplexReadPtr>(message)->read_common.read_id;
+                by_name.emplace(std::move(name), std::move(message));
+            }
+        }
+        return by_name;
+    };
+
+    auto expected = run_pipeline(false);
+    auto fused = run_pipeline(true);
+    REQUIRE(expected.size() == sequences.size() * 2);
+    REQUIRE(fused.size() == expected.size());
+
+    for (auto& [name, expected_message] : expected) {
+        CAPTURE(name);
+        REQUIRE(fused.count(name) == 1);
+        auto& message = fused.at(name);
+        if (std::holds_alternative<SimplexReadPtr>(expected_message)) {
+            const auto& expected_read = std::get<SimplexReadPtr>(expected_message)->read_common;
+            const auto& read = std::get<SimplexReadPtr>(message)->read_common;
+            CHECK(read.seq == expected_read.seq);
+            CHECK(read.qstring == expected_read.qstring);
+            CHECK_THAT(read.moves, Equals(expected_read.moves));
+            CHECK(read.num_trimmed_samples == expected_read.num_trimmed_samples);
+            CHECK(read.get_raw_data_samples() == expected_read.get_raw_data_samples());
+            CHECK(read.barcode == expected_read.barcode);
+            CHECK(read.barcode_trim_interval == expected_read.barcode_trim_interval);
+            REQUIRE(read.barcoding_result);
+            CHECK(read.barcoding_result->barcode_name ==
+                  expected_read.barcoding_result->barcode_name);
+        } else {
+            bam1_t* expected_rec = std::get<BamPtr>(expected_message).get();
+            bam1_t* rec = std::get<BamPtr>(message).get();
+            CHECK(utils::extract_sequence(rec) == utils::extract_sequence(expected_rec));
+            CHECK_THAT(utils::extract_quality(rec),
+                       Equals(utils::extract_quality(expected_rec)));
+            const auto [stride_out, moves] = utils::extract_move_table(rec);
+            const auto [expected_stride, expected_moves] = utils::extract_move_table(expected_rec);
+            CHECK(stride_out == expected_stride);
+            CHECK_THAT(moves, Equals(expected_moves));
+            for (const char* tag : {"ts", "ns"}) {
+                CAPTURE(tag);
+                auto* expected_tag = bam_aux_get(expected_rec, tag);
+                auto* actual_tag = bam_aux_get(rec, tag);
+                REQUIRE((actual_tag != nullptr) == (expected_tag != nullptr));
+                if (expected_tag) {
+                    CHECK(bam_aux2i(actual_tag) == bam_aux2i(expected_tag));
+                }
+            }
+            REQUIRE(bam_aux_get(rec, "BC"));
+            REQUIRE(bam_aux_get(expected_rec, "BC"));
+            CHECK_THAT(bam_aux2Z(bam_aux_get(rec, "BC")),
+                       Equals(bam_aux2Z(bam_aux_get(expected_rec, "BC"))));
+        }
+    }
+}
+
+TEST_CASE("ReadEndAnnotator: records are left alone if adapter trimming leaves nothing",
+          TEST_GROUP) {
+    const std::string seq = "ACGTACGTAC";
+    const std::string qname = GENERATE(std::string("empty"), std::string("read"));
+    const int seqlen = qname == "empty" ? 0 : int(seq.length());
+    CAPTURE(seqlen);
+
+    BamPtr record(bam_init1());
+    bam_set1(record.get(), qname.length(), qname.c_str(), 4, -1, -1, 0, 0, nullptr, -1, -1, 0,
+             seqlen, seq.c_str(), nullptr, 0);
+
+    // What annotate returns when the adapter and primer trim interval is empty.
+    demux::ReadEndAnnotation annotation;
+    annotation.adapters = AdapterScoreResult{};
+    annotation.adapter_trim_interval = {0, seqlen};
+    annotation.trim_adapters = false;
+    annotation.barcode_trim_interval = {0, seqlen};
+    annotation.trim_interval = {0, seqlen};
+    demux::ReadEndAnnotator::apply(annotation, record);
+
+    CHECK(record->core.l_qseq == seqlen);
+    CHECK(bam_aux_get(record.get(), "ts") == nullptr);
+    CHECK(bam_aux_get(record.get(), "ns") == nullptr);
+}
+
+TEST_CASE("ReadEndAnnotator: the BC tag comes before the trimming tags", TEST_GROUP) {
+    const std::string seq = "ACGTACGTACGTACGTACGT";
+    const std::string qname = "read";
+    const int seqlen = int(seq.length());
+
+    BamPtr record(bam_init1());
+    bam_set1(record.get(), qname.length(), qname.c_str(), 4, -1, -1, 0, 0, nullptr, -1, -1, 0,
+             seqlen, seq.c_str(), nullptr, 0);
+
+    demux::ReadEndAnnotation annotation;
+    annotation.barcode = BarcodeScoreResult{};
+    annotation.barcode->barcode_name = "unclassified";
+    annotation.adapter_trim_interval = {4, seqlen};
+    annotation.trim_adapters = true;
+    annotation.barcode_trim_interval = {0, seqlen - 4};
+    annotation.trim_interval = {4, seqlen};
+    demux::ReadEndAnnotator::apply(annotation, record);
+
+    CHECK(record->core.l_qseq == seqlen - 4);
+    const uint8_t* bc_tag = bam_aux_get(record.get(), "BC");
+    const uint8_t* ts_tag = bam_aux_get(record.get(), "ts");
+    const uint8_t* ns_tag = bam_aux_get(record.get(), "ns");
+    REQUIRE(bc_tag);
+    REQUIRE(ts_tag);
+    REQUIRE(ns_tag);
+    CHECK(bc_tag < ts_tag);
+    CHECK(ts_tag < ns_tag);
+}
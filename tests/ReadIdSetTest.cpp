@@ -0,0 +1,94 @@
+#include "utils/ReadIdSet.h"
+
+#include <catch2/catch.hpp>
+
+#include <cstdio>
+#include <random>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#define TEST_GROUP "[utils][ReadIdSet]"
+
+using dorado::utils::ReadIdSet;
+
+namespace {
+
+std::vector<std::string> random_uuids(size_t count, uint32_t seed) {
+    std::mt19937 gen(seed);
+    std::vector<std::string> uuids;
+    for (size_t i = 0; i < count; ++i) {
+        char uuid[37];
+        std::snprintf(uuid, sizeof(uuid), "%08x-%04x-%04x-%04x-%04x%08x", uint32_t(gen()),
+                      uint32_t(gen() & 0xffff), uint32_t(gen() & 0xffff), uint32_t(gen() & 0xffff),
+                      uint32_t(gen() & 0xffff), uint32_t(gen()));
+        uuids.emplace_back(uuid);
+    }
+    return uuids;
+}
+
+}  // namespace
+
+TEST_CASE("ReadIdSet: parse_uuid", TEST_GROUP) {
+    ReadIdSet::Uuid uuid;
+    REQUIRE(ReadIdSet::parse_uuid("002bd127-db82-436f-b828-28567c3d505d", uuid));
+    CHECK(uuid == ReadIdSet::Uuid{0x00, 0x2b, 0xd1, 0x27, 0xdb, 0x82, 0x43, 0x6f, 0xb8, 0x28,
+                                  0x28, 0x56, 0x7c, 0x3d, 0x50, 0x5d});
+
+    CHECK_FALSE(ReadIdSet::parse_uuid("read_1", uuid));
+    // Uppercase ids would compare unequal to their lowercase form as strings, so they
+    // aren't treated as UUIDs.
+    CHECK_FALSE(ReadIdSet::parse_uuid("002BD127-DB82-436F-B828-28567C3D505D", uuid));
+    CHECK_FALSE(ReadIdSet::parse_uuid("002bd127db82-436f-b828-28567c3d505d0", uuid));
+    CHECK_FALSE(ReadIdSet::parse_uuid("002bd127-db82-436f-b828-28567c3d505g", uuid));
+}
+
+TEST_CASE("ReadIdSet: insert and contains", TEST_GROUP) {
+    ReadIdSet set;
+    CHECK(set.empty());
+    CHECK(set.insert("002bd127-db82-436f-b828-28567c3d505d"));
+    CHECK_FALSE(set.insert("002bd127-db82-436f-b828-28567c3d505d"));
+    CHECK(set.insert("read_1"));
+    CHECK_FALSE(set.insert("read_1"));
+    CHECK(set.insert("00000000-0000-0000-0000-000000000000"));
+    CHECK_FALSE(set.insert(ReadIdSet::Uuid{}));
+    CHECK(set.size() == 3);
+
+    CHECK(set.contains("002bd127-db82-436f-b828-28567c3d505d"));
+    CHECK(set.count("read_1") == 1);
+    CHECK(set.contains(ReadIdSet::Uuid{}));
+    CHECK_FALSE(set.contains("002BD127-DB82-436F-B828-28567C3D505D"));
+    CHECK_FALSE(set.contains("read_2"));
+    CHECK_FALSE(set.contains("0007f755-bc82-432c-82be-76220b107ec5"));
+}
+
+TEST_CASE("ReadIdSet: matches std::unordered_set", TEST_GROUP) {
+    const bool bloom_filter = GENERATE(false, true);
+    const auto uuids = random_uuids(20000, 42);
+    std::unordered_set<std::string> expected;
+    ReadIdSet set;
+    if (bloom_filter) {
+        set.enable_bloom_filter();
+    }
+    for (size_t i = 0; i < uuids.size(); i += 2) {
+        CHECK(set.insert(uuids[i]) == expected.insert(uuids[i]).second);
+    }
+    CHECK(set.size() == expected.size());
+    for (const auto& uuid : uuids) {
+        CHECK(set.contains(uuid) == (expected.count(uuid) == 1));
+    }
+
+    const ReadIdSet copy(expected);
+    CHECK(copy.size() == expected.size());
+    CHECK(copy.count_shared(set) == expected.size());
+    CHECK(copy.memory_bytes() < expected.size() * 40);
+}
+
+TEST_CASE("ReadIdSet: count_shared", TEST_GROUP) {
+    const ReadIdSet a{"002bd127-db82-436f-b828-28567c3d505d", "read_1", "read_2"};
+    const ReadIdSet b{"002bd127-db82-436f-b828-28567c3d505d", "read_2",
+                      "0007f755-bc82-432c-82be-76220b107ec5"};
+    CHECK(a.count_shared(b) == 2);
+    CHECK(b.count_shared(a) == 2);
+    CHECK(a.count_shared(ReadIdSet{}) == 0);
+}
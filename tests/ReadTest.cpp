@@ -5,6 +5,8 @@
 #include <catch2/catch.hpp>
 #include <htslib/sam.h>
 
+#include <vector>
+
 #define TEST_GROUP "[ReadTest]"
 
 using Catch::Matchers::Equals;
@@ -375,3 +377,51 @@ TEST_CASE(TEST_GROUP ": Test mean q-score generation", TEST_GROUP) {
         CHECK(read_common.calculate_mean_qscore() == Approx(8.79143f));
     }
 }
+
+TEST_CASE(TEST_GROUP ": Recycled reads are reset but keep their buffers", TEST_GROUP) {
+    auto read = dorado::make_simplex_read();
+    read->read_common.read_id = "read1";
+    read->read_common.seq = std::string(1000, 'A');
+    read->read_common.moves.assign(5000, 1);
+    read->read_common.run_id = "xyz";
+    read->read_common.read_tag = 42;
+    read->read_common.raw_data = at::empty(4000);
+    read->is_duplex_parent = true;
+    read->next_read = "read2";
+
+    const auto* original = read.get();
+    read.reset();
+
+    // The pool is LIFO, so we get the same object straight back.
+    auto recycled = dorado::make_simplex_read();
+    REQUIRE(recycled.get() == original);
+    CHECK(recycled->read_common.read_id.empty());
+    CHECK(recycled->read_common.seq.empty());
+    CHECK(recycled->read_common.seq.capacity() >= 1000);
+    CHECK(recycled->read_common.moves.empty());
+    CHECK(recycled->read_common.moves.capacity() >= 5000);
+    CHECK(recycled->read_common.run_id.empty());
+    CHECK(recycled->read_common.read_tag == 0);
+    CHECK(!recycled->read_common.raw_data.defined());
+    CHECK(!recycled->is_duplex_parent);
+    CHECK(recycled->next_read.empty());
+    CHECK(recycled->read_common.client_info != nullptr);
+
+    const auto stats = dorado::sample_simplex_read_pool_stats();
+    CHECK(stats.at("reads_reused") >= 1);
+}
+
+TEST_CASE(TEST_GROUP ": Reads beyond the pool's capacity are freed", TEST_GROUP) {
+    const auto discarded_before = dorado::sample_simplex_read_pool_stats().at("reads_discarded");
+
+    // More reads than the pool keeps, so some are freed rather than pooled.
+    std::vector<dorado::SimplexReadPtr> reads;
+    for (int i = 0; i < 1100; ++i) {
+        reads.push_back(dorado::make_simplex_read());
+    }
+    reads.clear();
+
+    const auto stats = dorado::sample_simplex_read_pool_stats();
+    CHECK(stats.at("pooled_reads") == 1024);
+    CHECK(stats.at("reads_discarded") >= discarded_before + 76);
+}
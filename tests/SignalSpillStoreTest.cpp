@@ -0,0 +1,70 @@
+#include "utils/SignalSpillStore.h"
+
+#include <catch2/catch.hpp>
+#include <torch/torch.h>
+
+#include <deque>
+#include <filesystem>
+#include <utility>
+#include <vector>
+
+#define CUT_TAG "[SignalSpillStore]"
+
+TEST_CASE(CUT_TAG ": spilled signal is restored unchanged", CUT_TAG) {
+    dorado::utils::SignalSpillStore store(std::filesystem::temp_directory_path());
+
+    auto dtype = GENERATE(torch::kInt16, torch::kFloat32);
+    CAPTURE(dtype);
+    std::vector<torch::Tensor> signals;
+    std::vector<dorado::utils::SignalSpillStore::Handle> handles;
+    for (int64_t length : {1, 4000, 123457}) {
+        auto signal = torch::randint(-1000, 1000, {length}, torch::TensorOptions().dtype(dtype));
+        handles.push_back(store.spill(signal));
+        signals.push_back(signal);
+    }
+    // A strided view is spilled as its contents.
+    signals.push_back(torch::arange(200, torch::TensorOptions().dtype(dtype)).slice(0, 0, 200, 3));
+    handles.push_back(store.spill(signals.back()));
+
+    CHECK(store.spilled_bytes() > 0);
+    for (size_t i = 0; i < signals.size(); ++i) {
+        const auto restored = store.restore(handles[i]);
+        CHECK(restored.scalar_type() == dtype);
+        CHECK(torch::equal(restored, signals[i]));
+    }
+    CHECK(store.spilled_bytes() == 0);
+}
+
+TEST_CASE(CUT_TAG ": scratch space is reused once restored", CUT_TAG) {
+    dorado::utils::SignalSpillStore store(std::filesystem::temp_directory_path());
+
+    const auto signal = torch::randint(-1000, 1000, {1 << 20}, torch::kInt16);
+    store.restore(store.spill(signal));
+    const auto file_bytes = store.file_bytes();
+    for (int i = 0; i < 100; ++i) {
+        CHECK(torch::equal(store.restore(store.spill(signal)), signal));
+    }
+    CHECK(store.file_bytes() == file_bytes);
+}
+
+TEST_CASE(CUT_TAG ": scratch space is reused while other signal is still spilled", CUT_TAG) {
+    dorado::utils::SignalSpillStore store(std::filesystem::temp_directory_path());
+
+    // Keep a window of differently sized signals spilled, restoring the oldest as each new one
+    // is spilled, so that no part of the file is ever fully drained.
+    std::deque<std::pair<torch::Tensor, dorado::utils::SignalSpillStore::Handle>> spilled;
+    size_t file_bytes = 0;
+    for (int i = 0; i < 2000; ++i) {
+        const auto signal = torch::full({int64_t(i % 7 + 1) << 16}, int16_t(i), torch::kInt16);
+        spilled.emplace_back(signal, store.spill(signal));
+        if (spilled.size() > 16) {
+            const auto& [expected, handle] = spilled.front();
+            CHECK(torch::equal(store.restore(handle), expected));
+            spilled.pop_front();
+        }
+        if (i == 16) {
+            file_bytes = store.file_bytes();
+        }
+    }
+    CHECK(store.file_bytes() == file_bytes);
+}
@@ -0,0 +1,72 @@
+#include "utils/stats.h"
+
+#include <catch2/catch.hpp>
+
+#include <thread>
+#include <vector>
+
+#define TEST_GROUP "[stats]"
+
+using dorado::stats::LatencyHistogram;
+using namespace std::chrono_literals;
+
+TEST_CASE("LatencyHistogram empty", TEST_GROUP) {
+    LatencyHistogram histogram;
+    CHECK(histogram.count() == 0);
+    CHECK(histogram.quantile_ms(0.5) == 0);
+    CHECK(histogram.max_ms() == 0);
+}
+
+TEST_CASE("LatencyHistogram quantiles", TEST_GROUP) {
+    LatencyHistogram histogram;
+    // 90 reads within 1 ms, 9 within 16 ms and one slow one.
+    for (int i = 0; i < 90; ++i) {
+        histogram.record(500us);
+    }
+    for (int i = 0; i < 9; ++i) {
+        histogram.record(10ms);
+    }
+    histogram.record(3s);
+
+    CHECK(histogram.count() == 100);
+    CHECK(histogram.quantile_ms(0.5) == 1);
+    CHECK(histogram.quantile_ms(0.9) == 1);
+    CHECK(histogram.quantile_ms(0.95) == 16);
+    CHECK(histogram.quantile_ms(0.99) == 16);
+    CHECK(histogram.quantile_ms(1) == 3000);
+    CHECK(histogram.max_ms() == 3000);
+
+    dorado::stats::NamedStats stats;
+    histogram.add_to_stats(stats, "latency_ms");
+    CHECK(stats.at("latency_ms_count") == 100);
+    CHECK(stats.at("latency_ms_p50") == 1);
+    CHECK(stats.at("latency_ms_p99") == 16);
+    CHECK(stats.at("latency_ms_max") == 3000);
+    CHECK(stats.at("latency_ms_le_1") == 90);
+    CHECK(stats.at("latency_ms_le_16") == 9);
+    CHECK(stats.at("latency_ms_le_4096") == 1);
+    CHECK(stats.at("latency_ms_le_inf") == 0);
+}
+
+TEST_CASE("LatencyHistogram quantile capped at max", TEST_GROUP) {
+    LatencyHistogram histogram;
+    histogram.record(5ms);
+    CHECK(histogram.quantile_ms(0.5) == 5);
+}
+
+TEST_CASE("LatencyHistogram concurrent records", TEST_GROUP) {
+    LatencyHistogram histogram;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&histogram, t] {
+            for (int i = 0; i < 1000; ++i) {
+                histogram.record(std::chrono::milliseconds(t * 100 + i % 10));
+            }
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    CHECK(histogram.count() == 4000);
+    CHECK(histogram.max_ms() == 309);
+}
@@ -2,8 +2,13 @@
 
 #include "read_pipeline/ReadPipeline.h"
 
+#include <ATen/Functions.h>
 #include <catch2/catch.hpp>
 
+#include <algorithm>
+#include <numeric>
+#include <random>
+
 #define TEST_GROUP "[utils]"
 
 // clang-format off
@@ -77,3 +82,74 @@ TEST_CASE("Test stitch_chunks", TEST_GROUP) {
     REQUIRE(read_common.qstring == expected_qstring);
     REQUIRE(read_common.moves == expected_moves);
 }
+
+TEST_CASE("Test ChunkStitcher matches stitch_chunks for any chunk order", TEST_GROUP) {
+    constexpr size_t CHUNK_SIZE = 10;
+    constexpr size_t OVERLAP = 3;
+
+    auto make_chunks = [&] {
+        std::vector<std::unique_ptr<dorado::utils::Chunk>> chunks;
+        size_t offset = 0;
+        while (chunks.empty() || offset + CHUNK_SIZE < RAW_SIGNAL_SIZE) {
+            if (!chunks.empty()) {
+                offset = std::min(offset + CHUNK_SIZE - OVERLAP, RAW_SIGNAL_SIZE - CHUNK_SIZE);
+            }
+            auto chunk = std::make_unique<dorado::utils::Chunk>(offset, CHUNK_SIZE);
+            chunk->qstring = QSTR[chunks.size()];
+            chunk->seq = SEQS[chunks.size()];
+            chunk->moves = MOVES[chunks.size()];
+            chunks.push_back(std::move(chunk));
+        }
+        return chunks;
+    };
+
+    dorado::ReadCommon expected;
+    expected.raw_data = at::zeros(RAW_SIGNAL_SIZE);
+    dorado::utils::stitch_chunks(expected, make_chunks());
+    CHECK(expected.seq == "ACGTCGCGTCGTCGTCCGT");
+
+    auto seed = GENERATE(range(0, 10));
+    CAPTURE(seed);
+    auto chunks = make_chunks();
+    std::vector<size_t> order(chunks.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::shuffle(order.begin(), order.end(), std::mt19937(seed));
+
+    dorado::ReadCommon read_common;
+    read_common.raw_data = at::zeros(RAW_SIGNAL_SIZE);
+    dorado::utils::ChunkStitcher stitcher(chunks.size());
+    for (size_t i = 0; i < order.size(); ++i) {
+        const bool complete =
+                stitcher.add_chunk(read_common, order[i], std::move(chunks[order[i]]));
+        CHECK(complete == (i + 1 == order.size()));
+    }
+    CHECK(stitcher.num_buffered_chunks() == 0);
+    CHECK(read_common.seq == expected.seq);
+    CHECK(read_common.qstring == expected.qstring);
+    CHECK(read_common.moves == expected.moves);
+    CHECK(read_common.model_stride == expected.model_stride);
+}
+
+TEST_CASE("Test ChunkStitcher frees chunks once stitched", TEST_GROUP) {
+    dorado::ReadCommon read_common;
+    read_common.raw_data = at::zeros(17);
+    dorado::utils::ChunkStitcher stitcher(2);
+
+    auto first_chunk = std::make_unique<dorado::utils::Chunk>(0, 10);
+    first_chunk->seq = SEQS[0];
+    first_chunk->qstring = QSTR[0];
+    first_chunk->moves = MOVES[0];
+    auto second_chunk = std::make_unique<dorado::utils::Chunk>(7, 10);
+    second_chunk->seq = SEQS[1];
+    second_chunk->qstring = QSTR[1];
+    second_chunk->moves = MOVES[1];
+
+    // The first chunk can't be trimmed until the second chunk's position is known.
+    CHECK_FALSE(stitcher.add_chunk(read_common, 0, std::move(first_chunk)));
+    CHECK(stitcher.num_buffered_chunks() == 1);
+    CHECK(read_common.seq.empty());
+
+    CHECK(stitcher.add_chunk(read_common, 1, std::move(second_chunk)));
+    CHECK(stitcher.num_buffered_chunks() == 0);
+    CHECK(read_common.seq == "ACGTCGT");
+}
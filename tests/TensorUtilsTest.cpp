@@ -108,3 +108,26 @@ TEST_CASE(CUT_TAG ": copy_tensor_elems", CUT_TAG) {
         }
     }
 }
+
+TEST_CASE(CUT_TAG ": copy_repeat_padded matches repeat and concat", CUT_TAG) {
+    const int dest_size = 1000;
+    for (int src_size : {1, 7, 333, 500, 999, 1000, 1200}) {
+        CAPTURE(src_size);
+        // Batch slots as in the model runners: [batch, features, time].
+        auto batch = torch::zeros({3, 2, dest_size}, torch::kFloat16);
+        const auto src = torch::rand({2, src_size}, torch::kFloat32);
+        dorado::utils::copy_repeat_padded(batch[1], src);
+
+        using torch::indexing::Slice;
+        const auto clipped = src.index({Slice(), Slice(0, std::min(src_size, dest_size))});
+        const auto clipped_size = int(clipped.size(1));
+        auto [n, overhang] = std::div(dest_size, clipped_size);
+        const auto expected = torch::concat(
+                {clipped.repeat({1, n}), clipped.index({Slice(), Slice(0, overhang)})}, 1);
+
+        CHECK(torch::equal(batch[1], expected.to(torch::kFloat16)));
+        // Neighbouring slots are untouched.
+        CHECK(torch::count_nonzero(batch[0]).item<int64_t>() == 0);
+        CHECK(torch::count_nonzero(batch[2]).item<int64_t>() == 0);
+    }
+}
@@ -1,9 +1,15 @@
 #include "utils/trim.h"
 
+#include "demux/Trimmer.h"
+#include "utils/bam_utils.h"
+
 #include <ATen/ATen.h>
 #include <catch2/catch.hpp>
+#include <htslib/sam.h>
 
 #include <random>
+#include <string>
+#include <vector>
 
 using Slice = at::indexing::Slice;
 using namespace dorado;
@@ -161,3 +167,118 @@ TEST_CASE("Test trim mod base info", TEST_GROUP) {
         CHECK(probs.size() == 0);
     }
 }
+
+TEST_CASE("Test trim BAM record", TEST_GROUP) {
+    using Catch::Matchers::Equals;
+    // Odd length, so the packed sequence ends with a pad nibble.
+    const std::string seq = "TAAACTTACGGTGCATCGACTGA";
+    std::vector<uint8_t> qual(seq.length());
+    for (size_t i = 0; i < qual.size(); ++i) {
+        qual[i] = uint8_t(i);
+    }
+    const int stride = 5;
+    std::vector<uint8_t> moves;
+    for (size_t i = 0; i < seq.length(); ++i) {
+        moves.insert(moves.end(), {1, 0});
+    }
+    const std::string modbase_str = "A+a?,2,0,1;C+m?,4;T+x?,2,2;";
+    const std::vector<uint8_t> modbase_probs = {2, 3, 4, 10, 20, 21};
+    const int num_trimmed_samples = 100;
+
+    BamPtr record(bam_init1());
+    bam_set1(record.get(), 4, "read", 4, -1, -1, 0, 0, nullptr, -1, -1, 0, seq.length(),
+             seq.c_str(), reinterpret_cast<const char*>(qual.data()), 0);
+    bam_aux_append(record.get(), "RG", 'Z', 4, reinterpret_cast<const uint8_t*>("rg1"));
+    std::vector<uint8_t> move_table{uint8_t(stride)};
+    move_table.insert(move_table.end(), moves.begin(), moves.end());
+    bam_aux_update_array(record.get(), "mv", 'c', int(move_table.size()), move_table.data());
+    bam_aux_update_int(record.get(), "ts", num_trimmed_samples);
+    bam_aux_append(record.get(), "MM", 'Z', int(modbase_str.length() + 1),
+                   reinterpret_cast<const uint8_t*>(modbase_str.c_str()));
+    bam_aux_update_array(record.get(), "ML", 'C', int(modbase_probs.size()),
+                         const_cast<uint8_t*>(modbase_probs.data()));
+
+    SECTION("Trim part of the record") {
+        // An odd start shifts every base of the packed sequence by a nibble.
+        const std::pair<int, int> interval = GENERATE(std::make_pair(3, 18), std::make_pair(4, 21),
+                                                      std::make_pair(1, 22));
+        CAPTURE(interval);
+        const auto trimmed = Trimmer::trim_sequence(std::move(record), interval);
+        auto* aln = trimmed.get();
+
+        CHECK_THAT(bam_get_qname(aln), Equals("read"));
+        CHECK(utils::extract_sequence(aln) == utils::trim_sequence(seq, interval));
+        CHECK_THAT(utils::extract_quality(aln), Equals(utils::trim_quality(qual, interval)));
+
+        const auto [positions_trimmed, expected_moves] =
+                utils::trim_move_table(moves, interval);
+        const auto [trimmed_stride, trimmed_moves] = utils::extract_move_table(aln);
+        CHECK(trimmed_stride == stride);
+        CHECK_THAT(trimmed_moves, Equals(expected_moves));
+        const int ts = num_trimmed_samples + positions_trimmed * stride;
+        CHECK(bam_aux2i(bam_aux_get(aln, "ts")) == ts);
+        CHECK(bam_aux2i(bam_aux_get(aln, "ns")) == ts + int(expected_moves.size()) * stride);
+
+        const auto [expected_str, expected_probs] =
+                utils::trim_modbase_info(seq, modbase_str, modbase_probs, interval);
+        const auto [str, probs] = utils::extract_modbase_info(aln);
+        CHECK(str == expected_str);
+        CHECK_THAT(probs, Equals(expected_probs));
+
+        // Other tags are untouched.
+        CHECK_THAT(bam_aux2Z(bam_aux_get(aln, "RG")), Equals("rg1"));
+    }
+
+    SECTION("Invalid interval") {
+        CHECK_THROWS_AS(Trimmer::trim_sequence(std::move(record), {10, 50}),
+                        std::invalid_argument);
+    }
+}
+
+TEST_CASE("Test trim mapped BAM record", TEST_GROUP) {
+    using Catch::Matchers::Equals;
+    const std::string seq = "TAAACTTACGGTGCATCGACTGA";
+    const std::vector<uint8_t> qual(seq.length(), 20);
+    // 3S5M2I6M1D4M3S, starting just before a 16 kb bin boundary, so trimming the front can move
+    // the alignment into another bin.
+    const std::vector<uint32_t> cigar = {
+            bam_cigar_gen(3, BAM_CSOFT_CLIP), bam_cigar_gen(5, BAM_CMATCH),
+            bam_cigar_gen(2, BAM_CINS),       bam_cigar_gen(6, BAM_CMATCH),
+            bam_cigar_gen(1, BAM_CDEL),       bam_cigar_gen(4, BAM_CMATCH),
+            bam_cigar_gen(3, BAM_CSOFT_CLIP)};
+    const hts_pos_t pos = (1 << 14) - 6;
+
+    BamPtr record(bam_init1());
+    bam_set1(record.get(), 4, "read", 0, 0, pos, 60, cigar.size(), cigar.data(), -1, -1, 0,
+             seq.length(), seq.c_str(), reinterpret_cast<const char*>(qual.data()), 0);
+
+    // Within the leading soft clip, within the insertion, either side of the deletion, and
+    // within the trailing soft clip.
+    const std::pair<int, int> interval =
+            GENERATE(std::make_pair(1, 22), std::make_pair(9, 23), std::make_pair(14, 20),
+                     std::make_pair(15, 19), std::make_pair(0, 23));
+    CAPTURE(interval);
+
+    // What the record was trimmed to by building a new one with bam_set1.
+    const auto expected_cigar = utils::trim_cigar(uint32_t(cigar.size()), cigar.data(), interval);
+    const auto expected_pos =
+            pos + utils::ref_pos_consumed(uint32_t(cigar.size()), cigar.data(), interval.first);
+    const auto trimmed_seq = utils::trim_sequence(seq, interval);
+    const auto trimmed_qual = utils::trim_quality(qual, interval);
+    BamPtr expected(bam_init1());
+    bam_set1(expected.get(), 4, "read", 0, 0, expected_pos, 60, expected_cigar.size(),
+             expected_cigar.data(), -1, -1, 0, trimmed_seq.length(), trimmed_seq.c_str(),
+             reinterpret_cast<const char*>(trimmed_qual.data()), 0);
+
+    const auto trimmed = Trimmer::trim_sequence(std::move(record), interval);
+    auto* aln = trimmed.get();
+    auto* expected_aln = expected.get();
+    CHECK(utils::cigar2str(aln->core.n_cigar, bam_get_cigar(aln)) ==
+          utils::cigar2str(expected_aln->core.n_cigar, bam_get_cigar(expected_aln)));
+    CHECK(aln->core.pos == expected_aln->core.pos);
+    CHECK(aln->core.bin == expected_aln->core.bin);
+    CHECK(aln->core.tid == 0);
+    CHECK(aln->core.qual == 60);
+    CHECK(utils::extract_sequence(aln) == trimmed_seq);
+    CHECK_THAT(utils::extract_quality(aln), Equals(trimmed_qual));
+}
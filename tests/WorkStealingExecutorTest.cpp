@@ -0,0 +1,145 @@
+#include "utils/WorkStealingExecutor.h"
+
+#include <catch2/catch.hpp>
+
+#define TEST_GROUP "WorkStealingExecutor "
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <thread>
+#include <vector>
+
+using dorado::utils::WorkStealingExecutor;
+
+namespace {
+
+// Spins until counter reaches target, or gives up after a generous timeout.
+bool wait_for_count(const std::atomic<int>& counter, int target) {
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(30);
+    while (counter.load() < target) {
+        if (std::chrono::steady_clock::now() > deadline) {
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+}
+
+}  // namespace
+
+TEST_CASE(TEST_GROUP ": RunsAllTasks") {
+    const size_t num_threads = GENERATE(1, 4);
+    WorkStealingExecutor executor(num_threads);
+    CHECK(executor.num_threads() == num_threads);
+
+    const int num_tasks = 1000;
+    std::atomic<int> num_run{0};
+    for (int i = 0; i < num_tasks; ++i) {
+        executor.submit([&num_run] { ++num_run; });
+    }
+    REQUIRE(wait_for_count(num_run, num_tasks));
+    CHECK(num_run == num_tasks);
+}
+
+TEST_CASE(TEST_GROUP ": TasksCanSubmitTasks") {
+    WorkStealingExecutor executor(4);
+
+    // Each top level task fans out into more tasks on its own worker, which other workers
+    // can then steal.
+    const int num_parents = 10;
+    const int num_children = 100;
+    std::atomic<int> num_run{0};
+    for (int i = 0; i < num_parents; ++i) {
+        executor.submit([&] {
+            CHECK(executor.is_worker_thread());
+            for (int j = 0; j < num_children; ++j) {
+                executor.submit([&num_run] { ++num_run; });
+            }
+        });
+    }
+    REQUIRE(wait_for_count(num_run, num_parents * num_children));
+
+    const auto stats = executor.sample_stats();
+    CHECK(stats.at("threads") == 4);
+    // The parent tasks may not have been counted yet.
+    CHECK(stats.at("tasks_run") >= num_parents * num_children);
+}
+
+TEST_CASE(TEST_GROUP ": HelpWhileWaiting") {
+    // With a single worker, a task that waits on another task can only make progress by
+    // running that task itself.
+    WorkStealingExecutor executor(1);
+    CHECK_FALSE(executor.is_worker_thread());
+    CHECK_FALSE(executor.help_while_waiting());
+    CHECK(WorkStealingExecutor::current() == nullptr);
+
+    std::atomic<int> num_done{0};
+    executor.submit([&] {
+        CHECK(WorkStealingExecutor::current() == &executor);
+        std::atomic<bool> dependency_done{false};
+        executor.submit([&dependency_done] { dependency_done = true; });
+        while (!dependency_done) {
+            executor.help_while_waiting();
+        }
+        ++num_done;
+    });
+    REQUIRE(wait_for_count(num_done, 1));
+    CHECK(executor.sample_stats().at("tasks_helped") >= 1);
+}
+
+TEST_CASE(TEST_GROUP ": SubmitBehindRunsAfterOtherTasks") {
+    WorkStealingExecutor executor(1);
+    std::vector<int> order;
+    std::atomic<int> num_done{0};
+    executor.submit([&] {
+        executor.submit_behind([&] {
+            order.push_back(2);
+            ++num_done;
+        });
+        executor.submit([&] {
+            order.push_back(1);
+            ++num_done;
+        });
+    });
+    REQUIRE(wait_for_count(num_done, 2));
+    CHECK(order == std::vector<int>{1, 2});
+}
+
+TEST_CASE(TEST_GROUP ": WaitersNestedTooDeeplyToHelpStillProgress") {
+    // Each task waits on one it submits, so with a single worker the chain is nested deeper
+    // than the worker can help, and a spare worker has to run the rest.
+    WorkStealingExecutor executor(1);
+    const int chain_length = 16;
+    std::atomic<int> num_done{0};
+    std::function<void(int)> run_link = [&](int link) {
+        if (link + 1 < chain_length) {
+            const int num_done_before = num_done;
+            executor.submit([&run_link, link] { run_link(link + 1); });
+            while (num_done == num_done_before) {
+                if (!executor.help_while_waiting()) {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                }
+            }
+        }
+        ++num_done;
+    };
+    executor.submit([&run_link] { run_link(0); });
+    REQUIRE(wait_for_count(num_done, chain_length));
+    CHECK(executor.sample_stats().at("spare_workers_started") >= 1);
+}
+
+TEST_CASE(TEST_GROUP ": DestructorRunsPendingTasks") {
+    std::atomic<int> num_run{0};
+    const int num_tasks = 100;
+    {
+        WorkStealingExecutor executor(2);
+        for (int i = 0; i < num_tasks; ++i) {
+            executor.submit([&num_run] {
+                std::this_thread::sleep_for(std::chrono::microseconds(10));
+                ++num_run;
+            });
+        }
+    }
+    CHECK(num_run == num_tasks);
+}